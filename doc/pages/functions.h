@@ -28,7 +28,11 @@ namespace Vaca {
   @itemRow{file_title}
 @titleRow{URL}
   @itemRow{decode_url}
+  @itemRow{decode_url_to}
   @itemRow{encode_url}
+  @itemRow{encode_url_to}
+  @itemRow{url_host}
+  @itemRow{url_object}
 @titleRow{Bindings}
   @itemRow{page_bind, Adapts functions or methods to be connected to signals.}
   @itemRow{Ref}
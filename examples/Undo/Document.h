@@ -33,15 +33,19 @@
 #define DOCUMENT_H
 
 #include <Vaca/Vaca.h>
+#include <vector>
 
 using namespace Vaca;
 
-typedef String::size_type DocPos;
+typedef size_t DocPos;
 
 class Document : public Referenceable
 {
   String m_name;
-  String m_string;
+  TextBuffer m_text;
+  // Snapshots of the text (they share the memory with m_text)
+  std::vector<TextBuffer> m_undo;
+  std::vector<TextBuffer> m_redo;
 
 public:
 
@@ -56,23 +60,53 @@ public:
   }
 
   Char at(DocPos pos) const {
-    return m_string.at(pos);
+    return m_text.at(pos);
   }
 
   DocPos size() const {
-    return m_string.size();
+    return m_text.size();
   }
 
   void add(DocPos pos, Char chr) {
-    m_string.insert(pos, 1, chr);
+    saveUndo();
+    m_text.insert(pos, chr);
   }
 
   void add(DocPos pos, const String& s) {
-    m_string.insert(pos, s);
+    saveUndo();
+    m_text.insert(pos, s);
   }
 
   void remove(DocPos pos, DocPos n) {
-    m_string.erase(pos, n);
+    saveUndo();
+    m_text.erase(pos, n);
+  }
+
+  bool canUndo() const {
+    return !m_undo.empty();
+  }
+
+  bool canRedo() const {
+    return !m_redo.empty();
+  }
+
+  void undo() {
+    m_redo.push_back(m_text);
+    m_text = m_undo.back();
+    m_undo.pop_back();
+  }
+
+  void redo() {
+    m_undo.push_back(m_text);
+    m_text = m_redo.back();
+    m_redo.pop_back();
+  }
+
+private:
+
+  void saveUndo() {
+    m_undo.push_back(m_text);
+    m_redo.clear();
   }
   
 };
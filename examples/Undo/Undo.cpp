@@ -40,6 +40,8 @@ enum {
   ID_NEW_DOCUMENT,
   ID_CLOSE_DOCUMENT,
   ID_EXIT,
+  ID_UNDO,
+  ID_REDO,
   ID_SELECT_DOCUMENT
 };
 
@@ -67,8 +69,12 @@ public:
 
   void onNew();
   void onClose();
+  void onUndo();
+  void onRedo();
 
   bool hasCurrentDoc();
+  bool canUndo();
+  bool canRedo();
   void setCurrentDocument(DocumentPtr doc);
 
   Documents getDocuments() { return m_docs; };
@@ -133,6 +139,7 @@ private:
   {
     MenuBar* menuBar = new MenuBar();
     Menu* docMenu = new Menu(L"Document");
+    Menu* editMenu = new Menu(L"Edit");
     m_listMenu = new Menu(L"List");
 
     docMenu->add(L"New", ID_NEW_DOCUMENT);
@@ -140,7 +147,11 @@ private:
     docMenu->addSeparator();
     docMenu->add(L"Exit", ID_EXIT);
 
+    editMenu->add(L"Undo", ID_UNDO);
+    editMenu->add(L"Redo", ID_REDO);
+
     menuBar->add(docMenu);
+    menuBar->add(editMenu);
     menuBar->add(m_listMenu);
     return menuBar;
   }
@@ -203,6 +214,16 @@ Example::Example()
   cmd->Execute.connect(&Example::onClose, this);
   cmd->Enabled.connect(&Example::hasCurrentDoc, this);
   addCommand(cmd);
+
+  cmd = new SignalCommand(ID_UNDO);
+  cmd->Execute.connect(&Example::onUndo, this);
+  cmd->Enabled.connect(&Example::canUndo, this);
+  addCommand(cmd);
+
+  cmd = new SignalCommand(ID_REDO);
+  cmd->Execute.connect(&Example::onRedo, this);
+  cmd->Enabled.connect(&Example::canRedo, this);
+  addCommand(cmd);
 }
 
 Example::~Example()
@@ -238,11 +259,33 @@ void Example::onClose()
   DocumentChange(m_currentDoc);
 }
 
+void Example::onUndo()
+{
+  m_currentDoc->undo();
+  DocumentChange(m_currentDoc);
+}
+
+void Example::onRedo()
+{
+  m_currentDoc->redo();
+  DocumentChange(m_currentDoc);
+}
+
 bool Example::hasCurrentDoc()
 {
   return m_currentDoc != NULL;
 }
 
+bool Example::canUndo()
+{
+  return m_currentDoc != NULL && m_currentDoc->canUndo();
+}
+
+bool Example::canRedo()
+{
+  return m_currentDoc != NULL && m_currentDoc->canRedo();
+}
+
 void Example::setCurrentDocument(DocumentPtr doc)
 {
   DocumentChange(m_currentDoc = doc);
@@ -42,7 +42,8 @@ namespace Vaca {
 
    This is a SharedPtr, so if you copy instances of brushes they will be
    referencing to the same place. You can't clone brushes because you can't
-   modify them.
+   modify them. Brushes created with the same color in the same thread
+   share the same handle too (see GdiObjectCache).
 
    @win32
      This is a @msdn{HBRUSH} wrapper.
@@ -0,0 +1,86 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_CLOCK_H
+#define VACA_CLOCK_H
+
+#include "Vaca/base.h"
+
+namespace Vaca {
+
+/**
+   A time or an interval of time in nanoseconds.
+
+   It is a signed 64-bit integer, so the difference of two values is
+   negative if the first one is before the second one, and it does
+   not wrap around in practice (it can count 292 years).
+
+   @see Clock
+*/
+typedef long long Nanoseconds;
+
+/**
+   The monotonic clock of the system with nanoseconds resolution.
+
+   The time returned by #now is counted from an arbitrary point (e.g.
+   the system start-up), it is not affected by changes to the
+   date/time of the system. Only the difference between two values
+   has meaning.
+
+   @win32
+     It uses @msdn{QueryPerformanceCounter}.
+   @endwin32
+
+   @see TimePoint, Timer, ConditionVariable#waitUntil
+*/
+class VACA_DLL Clock
+{
+public:
+
+  /**
+     When #sleepUntil is used in precise mode, it spins (yielding the
+     processor) this amount of time before the deadline, because the
+     OS wakes up the thread some time after it was asked.
+  */
+  static const Nanoseconds PreciseMargin = 500000LL; // 500 microseconds
+
+  static Nanoseconds now();
+
+  static void sleepUntil(Nanoseconds deadline, bool precise = false);
+
+  static Nanoseconds fromSeconds(double seconds);
+  static double toSeconds(Nanoseconds ns);
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_CLOCK_H
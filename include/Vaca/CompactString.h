@@ -0,0 +1,145 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_COMPACTSTRING_H
+#define VACA_COMPACTSTRING_H
+
+#include "Vaca/base.h"
+
+#include <cwchar>
+
+namespace Vaca {
+
+/**
+   An immutable UTF-16 string which occupies 32 bytes and stores up to
+   14 UTF-16 characters inline (without heap allocations). Longer
+   strings are allocated once and shared between copies (using atomic
+   reference counting, so copies can be passed to other threads).
+
+   It is used to store many short texts like the cells of a ListItem
+   (see LabelString). It is converted implicitly to String, so it can
+   be used with the String functions (e.g. trim_string, convert_to,
+   file_name, etc.).
+
+   @see LabelString
+*/
+class VACA_DLL CompactString
+{
+public:
+
+#if WCHAR_MAX <= 0xffff
+  typedef wchar_t Char16;
+#else
+  typedef unsigned short Char16;
+#endif
+
+  enum { InlineCapacity = 14 };
+
+private:
+
+  struct Buffer
+  {
+    long refs;
+    size_t size;
+    Char16 data[1];
+  };
+
+  enum { Tag = 15,		// index of the inline size (or HeapTag)
+	 HeapTag = 0xffff };
+
+  union {
+    Char16 m_inline[16];
+    Buffer* m_buffer;
+  };
+
+public:
+
+  CompactString() {
+    m_inline[0] = 0;
+    m_inline[Tag] = 0;
+  }
+
+  CompactString(const Char* str);
+  CompactString(const String& str);
+  CompactString(const Char16* str, size_t size);
+  CompactString(const CompactString& other);
+  ~CompactString();
+
+  CompactString& operator=(const CompactString& other);
+
+  bool isInline() const { return m_inline[Tag] != HeapTag; }
+
+  size_t size() const {
+    return isInline() ? m_inline[Tag]: m_buffer->size;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  // Null-terminated UTF-16 characters
+  const Char16* data() const {
+    return isInline() ? m_inline: m_buffer->data;
+  }
+
+  String str() const;
+  operator String() const { return str(); }
+
+  void swap(CompactString& other);
+
+  int compare(const CompactString& other) const;
+  bool operator==(const CompactString& other) const;
+  bool operator!=(const CompactString& other) const { return !operator==(other); }
+  bool operator<(const CompactString& other) const { return compare(other) < 0; }
+
+private:
+  Char16* allocate(size_t size);
+  void assignWide(const Char* str, size_t size);
+  void release();
+
+};
+
+/**
+   The type used to store the texts of items, it depends on how the
+   library was built: if VACA_COMPACT_STRINGS is defined (the
+   COMPACT_STRINGS option of CMake) it is CompactString, otherwise it
+   is String.
+
+   It is used by the cells of ListItem. TreeNode labels do not use it:
+   they are InternedStrings, so repeated labels are stored only once.
+*/
+#ifdef VACA_COMPACT_STRINGS
+  typedef CompactString LabelString;
+#else
+  typedef String LabelString;
+#endif
+
+} // namespace Vaca
+
+#endif // VACA_COMPACTSTRING_H
@@ -33,6 +33,7 @@
 #define VACA_COMPONENT_H
 
 #include "Vaca/base.h"
+#include "Vaca/InternedString.h"
 #include "Vaca/Referenceable.h"
 #include <map>
 
@@ -49,7 +50,7 @@ namespace Vaca {
 class VACA_DLL Component : public Referenceable
 {
 public:
-  typedef std::map<String, PropertyPtr> Properties;
+  typedef std::map<InternedString, PropertyPtr> Properties;
 
   Component();
   virtual ~Component();
@@ -35,6 +35,7 @@
 #include "Vaca/base.h"
 #include "Vaca/NonCopyable.h"
 #include "Vaca/Exception.h"
+#include "Vaca/Clock.h"
 
 namespace Vaca {
 
@@ -51,15 +52,25 @@ public:
 
 };
 
+/**
+   A condition variable to wait until other thread notifies a change
+   of some shared data (protected by a Mutex).
+
+   Waits can return spuriously (without a notification), so the
+   condition must be checked again after each #wait. The overloads
+   with a predicate do it for you.
+
+   @win32
+     It is made with two semaphores and a mutex.
+   @endwin32
+
+   @see Mutex, ScopedLock, Thread
+*/
 class VACA_DLL ConditionVariable : private NonCopyable
 {
-  HANDLE m_gate;
-  HANDLE m_queue;
-  HANDLE m_mutex;
-  unsigned m_gone;         // # threads that timed out and never made it to m_queue
-  unsigned long m_blocked; // # threads blocked on the condition
-  unsigned m_waiting;      // # threads no longer waiting for the condition but
-			   // still waiting to be removed from m_queue
+  class ConditionVariableImpl;
+  ConditionVariableImpl* m_impl;
+
 public:
 
   ConditionVariable();
@@ -69,6 +80,7 @@ public:
   void notifyAll();
   void wait(ScopedLock& lock);
   bool waitFor(ScopedLock& lock, double seconds);
+  bool waitUntil(ScopedLock& lock, Nanoseconds deadline);
 
   template<typename Predicate>
   void wait(ScopedLock& lock, Predicate pred) {
@@ -76,17 +88,33 @@ public:
       wait(lock);
   }
 
+  /**
+     Waits until @a pred returns true or @a seconds elapsed (the
+     timeout is not restarted by spurious wake-ups).
+
+     @return
+       The last value returned by @a pred.
+  */
+  template<typename Predicate>
+  bool waitFor(ScopedLock& lock, double seconds, Predicate pred) {
+    return waitUntil(lock, Clock::now() + Clock::fromSeconds(seconds), pred);
+  }
+
+  /**
+     Waits until @a pred returns true or the Clock reaches the
+     @a deadline.
+
+     @return
+       The last value returned by @a pred.
+  */
   template<typename Predicate>
-  void waitFor(ScopedLock& lock, double seconds, Predicate pred) {
+  bool waitUntil(ScopedLock& lock, Nanoseconds deadline, Predicate pred) {
     while (!pred())
-      if (!waitFor(lock, seconds))
-	return false;
+      if (!waitUntil(lock, deadline))
+	return pred();
     return true;
   }
 
-private:
-  void enterWait();
-
 };
 
 } // namespace Vaca
@@ -0,0 +1,500 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_COROUTINE_H
+#define VACA_COROUTINE_H
+
+// This header is optional (it is not included by Vaca.h) because it
+// needs a C++20 compiler, the rest of Vaca does not.
+#if !defined(__cpp_impl_coroutine) && \
+    !(defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+  #error Vaca/Coroutine.h needs a C++20 compiler with coroutines
+#endif
+
+#include "Vaca/base.h"
+#include "Vaca/Slot.h"
+#include "Vaca/Message.h"
+#include "Vaca/Thread.h"
+#include "Vaca/ThreadPool.h"
+#include "Vaca/Timer.h"
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace Vaca {
+
+template<typename T = void> class Task;
+
+namespace details {
+
+// Resumes a coroutine, it is used as a slot for enqueueCall, as a
+// task for the ThreadPool, and as a continuation of a Future
+struct ResumeCoroutine
+{
+  std::coroutine_handle<> handle;
+
+  explicit ResumeCoroutine(std::coroutine_handle<> handle) : handle(handle) { }
+
+  void operator()() const { handle.resume(); }
+
+  template<typename R>
+  void operator()(const Future<R>&) const { handle.resume(); }
+};
+
+// Resumes the coroutine in the message loop of the given thread
+inline void enqueueResume(ThreadId threadId, std::coroutine_handle<> handle)
+{
+  enqueueCall(threadId, new Slot0_fun<void, ResumeCoroutine>(ResumeCoroutine(handle)));
+}
+
+/**
+   @internal
+
+   Part of the promise of a Task that does not depend on the type of
+   its result.
+
+   The coroutine and its Task object can finish in different threads
+   (if the coroutine uses #resumeOn), so the state is atomic:
+   @li m_continuation is NULL, the address of the coroutine that
+       awaits this one, or @c this when the coroutine has finished.
+   @li m_released is set by the first one that finishes: the Task
+       object (it was destroyed) or the coroutine (it reached its
+       end). The second one destroys the coroutine frame.
+*/
+class TaskPromiseBase
+{
+  std::atomic<void*> m_continuation;
+  std::atomic<bool> m_released;
+  std::exception_ptr m_error;
+
+public:
+
+  TaskPromiseBase() : m_continuation(NULL), m_released(false) { }
+
+  // the coroutine starts to run as a normal function
+  std::suspend_never initial_suspend() noexcept { return std::suspend_never(); }
+
+  struct FinalAwaiter
+  {
+    bool await_ready() const noexcept { return false; }
+
+    template<typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+      TaskPromiseBase& promise = handle.promise();
+      void* continuation = promise.m_continuation.exchange(&promise);
+
+      // nobody can await this task
+      if (promise.m_released.exchange(true)) {
+	handle.destroy();
+	return std::noop_coroutine();
+      }
+
+      if (continuation != NULL)
+	return std::coroutine_handle<>::from_address(continuation);
+      else
+	return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept { }
+  };
+
+  FinalAwaiter final_suspend() noexcept { return FinalAwaiter(); }
+
+  void unhandled_exception() {
+    m_error = std::current_exception();
+  }
+
+  bool isFinished() const {
+    return m_continuation.load() == this;
+  }
+
+  // returns false if the coroutine has already finished (so the
+  // awaiting one must not be suspended)
+  bool setContinuation(std::coroutine_handle<> continuation) {
+    void* expected = NULL;
+    return m_continuation.compare_exchange_strong(expected, continuation.address());
+  }
+
+  // returns true if the coroutine frame must be destroyed
+  bool release() {
+    return m_released.exchange(true);
+  }
+
+  void checkError() const {
+    if (m_error)
+      std::rethrow_exception(m_error);
+  }
+
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase
+{
+  std::optional<T> m_value;
+
+public:
+
+  Task<T> get_return_object();
+
+  void return_value(T value) {
+    m_value.emplace(std::move(value));
+  }
+
+  T& getValue() {
+    checkError();
+    return *m_value;
+  }
+
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase
+{
+public:
+
+  Task<void> get_return_object();
+
+  void return_void() { }
+
+  void getValue() {
+    checkError();
+  }
+
+};
+
+class ThreadAwaiter
+{
+  ThreadId m_threadId;
+public:
+  explicit ThreadAwaiter(ThreadId threadId) : m_threadId(threadId) { }
+  bool await_ready() const { return false; }
+  void await_suspend(std::coroutine_handle<> handle) const { enqueueResume(m_threadId, handle); }
+  void await_resume() const { }
+};
+
+class ThreadPoolAwaiter
+{
+  ThreadPool& m_pool;
+public:
+  explicit ThreadPoolAwaiter(ThreadPool& pool) : m_pool(pool) { }
+  bool await_ready() const { return false; }
+  void await_suspend(std::coroutine_handle<> handle) const { m_pool.submit<void>(ResumeCoroutine(handle)); }
+  void await_resume() const { }
+};
+
+template<typename R>
+class FutureAwaiter
+{
+  Future<R> m_future;
+public:
+  explicit FutureAwaiter(const Future<R>& future) : m_future(future) { }
+  bool await_ready() const { return m_future.isReady(); }
+  void await_suspend(std::coroutine_handle<> handle) const { m_future.postToUiThread(ResumeCoroutine(handle)); }
+  R await_resume() const { return m_future.get(); }
+};
+
+class DelayAwaiter : private NonCopyable
+{
+  Timer m_timer;
+  std::coroutine_handle<> m_handle;
+public:
+  explicit DelayAwaiter(int msecs) : m_timer(msecs) {
+    m_timer.setPolicy(TimerPolicy::Coalesce);
+  }
+  bool await_ready() const { return false; }
+  void await_suspend(std::coroutine_handle<> handle) {
+    m_handle = handle;
+    m_timer.Tick.connect(&DelayAwaiter::onTick, this);
+    m_timer.start();
+  }
+  void await_resume() const { }
+private:
+  // the coroutine is not resumed inside the Tick event because it
+  // destroys the timer
+  void onTick() {
+    m_timer.stop();
+    enqueueResume(CurrentThread::getId(), m_handle);
+  }
+};
+
+} // namespace details
+
+/**
+   The result of a coroutine which can await (@c co_await) background
+   work, timers or other tasks without blocking the message loop of
+   its thread.
+
+   The coroutine starts running when it is called, until its first
+   @c co_await. Then it is resumed from the message loop of the
+   thread (see CurrentThread#doMessageLoop), so a handler of the UI
+   thread can continue its work in the UI thread without a reentrant
+   call to CurrentThread#pumpMessageQueue:
+
+   @code
+   Task<> MainFrame::openFile(String fileName)
+   {
+     m_status.setText(L"Loading...");
+
+     // the UI thread continues processing messages meanwhile
+     String text = co_await m_pool.submit<String>(Bind<String>(&load_file, fileName));
+
+     m_edit.setText(text);
+     m_status.setText(L"");
+   }
+
+   void MainFrame::onCommand(CommandEvent& ev)
+   {
+     ...
+     openFile(fileName);	// the Task object can be discarded
+   }
+   @endcode
+
+   A coroutine can await:
+   @li A Future of a ThreadPool task: it is resumed in the same thread
+       when the task finishes (see Future#postToUiThread).
+   @li A Task of other coroutine.
+   @li #resumeOn: it continues in the message loop of other thread, or
+       in a ThreadPool.
+   @li #delay: it continues after some milliseconds (using a Timer).
+
+   The threads where a coroutine awaits a Future or #delay must have a
+   message loop (it is how the coroutine is resumed).
+
+   If the Task object is discarded, the coroutine frame is destroyed
+   when it finishes (and an exception thrown by the coroutine is
+   lost).
+
+   @warning
+     This header needs a C++20 compiler, so it is not included in
+     Vaca.h.
+
+   @see waitInMessageLoop
+*/
+template<typename T>
+class Task
+{
+public:
+
+  typedef details::TaskPromise<T> promise_type;
+
+private:
+
+  std::coroutine_handle<promise_type> m_handle;
+
+public:
+
+  explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) { }
+
+  Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) { }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      release();
+      m_handle = std::exchange(other.m_handle, nullptr);
+    }
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() {
+    release();
+  }
+
+  /**
+     Returns true if the coroutine has finished.
+  */
+  bool isReady() const {
+    return m_handle && m_handle.promise().isFinished();
+  }
+
+  /**
+     Returns the result of the finished coroutine.
+
+     @throw
+       The exception that the coroutine threw.
+  */
+  T get() const {
+    assert(isReady());
+    return m_handle.promise().getValue();
+  }
+
+  class Awaiter
+  {
+    std::coroutine_handle<promise_type> m_handle;
+  public:
+    explicit Awaiter(std::coroutine_handle<promise_type> handle) : m_handle(handle) { }
+    bool await_ready() const { return m_handle.promise().isFinished(); }
+    bool await_suspend(std::coroutine_handle<> handle) const { return m_handle.promise().setContinuation(handle); }
+    T await_resume() const { return m_handle.promise().getValue(); }
+  };
+
+  /**
+     The awaiting coroutine is resumed when this one finishes (in the
+     thread where it finishes).
+  */
+  Awaiter operator co_await() const {
+    assert(m_handle);
+    return Awaiter(m_handle);
+  }
+
+private:
+
+  void release() {
+    if (m_handle && m_handle.promise().release())
+      m_handle.destroy();
+    m_handle = nullptr;
+  }
+
+};
+
+template<typename T>
+Task<T> details::TaskPromise<T>::get_return_object()
+{
+  return Task<T>(std::coroutine_handle<TaskPromise<T> >::from_promise(*this));
+}
+
+inline Task<void> details::TaskPromise<void>::get_return_object()
+{
+  return Task<void>(std::coroutine_handle<TaskPromise<void> >::from_promise(*this));
+}
+
+/**
+   Awaits the result of a ThreadPool task, the coroutine is resumed in
+   the message loop of the current thread.
+
+   @throw TaskException
+     If the task threw an exception.
+*/
+template<typename R>
+details::FutureAwaiter<R> operator co_await(const Future<R>& future)
+{
+  return details::FutureAwaiter<R>(future);
+}
+
+/**
+   Continues the coroutine in the message loop of the specified
+   thread (e.g. to go back to the UI thread).
+*/
+inline details::ThreadAwaiter resumeOn(ThreadId threadId)
+{
+  return details::ThreadAwaiter(threadId);
+}
+
+/**
+   Continues the coroutine in the message loop of the specified thread.
+*/
+inline details::ThreadAwaiter resumeOn(const Thread& thread)
+{
+  return details::ThreadAwaiter(thread.getId());
+}
+
+/**
+   Continues the coroutine in some thread of the @a pool.
+
+   @code
+   Task<> Document::save()
+   {
+     ThreadId uiThread = CurrentThread::getId();
+     co_await resumeOn(m_pool);
+     write_to_disk();		// in the pool
+     co_await resumeOn(uiThread);
+     setModified(false);	// in the UI thread again
+   }
+   @endcode
+*/
+inline details::ThreadPoolAwaiter resumeOn(ThreadPool& pool)
+{
+  return details::ThreadPoolAwaiter(pool);
+}
+
+/**
+   Lets the message loop process the pending messages, and then
+   continues the coroutine.
+*/
+inline details::ThreadAwaiter yieldToMessageLoop()
+{
+  return details::ThreadAwaiter(CurrentThread::getId());
+}
+
+/**
+   Continues the coroutine after @a msecs milliseconds in the message
+   loop of the current thread (the ticks of a Timer are processed in
+   the message loop).
+*/
+inline details::DelayAwaiter delay(int msecs)
+{
+  return details::DelayAwaiter(msecs);
+}
+
+/**
+   Processes the messages of the current thread until the @a task
+   finishes, and returns its result.
+
+   It is a message loop which does not need visible frames (like
+   CurrentThread#doMessageLoop does), useful for tests and console
+   programs that use coroutines.
+
+   @throw
+     The exception that the coroutine threw.
+*/
+template<typename T>
+T waitInMessageLoop(const Task<T>& task)
+{
+  Message message;
+  int idle = 0;
+
+  while (!task.isReady()) {
+    if (CurrentThread::peekMessage(message)) {
+      CurrentThread::processMessage(message);
+      idle = 0;
+    }
+    else {
+      // the ticks of timers are notified with an empty message
+      Timer::pollTimers();
+
+      // after a while without messages, we stop spinning
+      if (++idle > 100)
+	CurrentThread::sleep(1);
+    }
+  }
+
+  return task.get();
+}
+
+} // namespace Vaca
+
+#endif // VACA_COROUTINE_H
@@ -88,13 +88,24 @@ public:
   int getLeading() const { return m_textMetric.tmInternalLeading; }
 };
 
+/**
+   Helper for Font class to destroy Win32's HFONT handles.
+
+   @internal
+*/
+struct VACA_DLL Win32DestroyFont
+{
+  static void destroy(HFONT handle);
+};
+
 /**
    A shared pointer to a font that can be used in Graphics or Widget to
    draw text.
 
    This is a SharedPtr, so if you copy instances of fonts they will be
    referencing to the same place. You can't clone fonts because you
-   can't modify them.
+   can't modify them. Fonts created with the same attributes in the
+   same thread share the same handle too (see GdiObjectCache).
 
    @win32
      This is a @msdn{HFONT} wrapper.
@@ -102,7 +113,7 @@ public:
 
    @see Graphics#setFont, Graphics#drawString
 */
-class VACA_DLL Font : private SharedPtr<GdiObject<HFONT> >
+class VACA_DLL Font : private SharedPtr<GdiObject<HFONT, Win32DestroyFont> >
 {
   friend class Application;
 
@@ -0,0 +1,254 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_FORMAT_H
+#define VACA_FORMAT_H
+
+#include "Vaca/base.h"
+#include "Vaca/Exception.h"
+#include "Vaca/StringView.h"
+
+namespace Vaca {
+
+/**
+   Thrown by format_text and format_append when the format string is
+   ill-formed, or when a replacement field references an argument
+   that was not given.
+*/
+class FormatException : public Exception
+{
+public:
+  FormatException() : Exception() { }
+  FormatException(const String& message) : Exception(message) { }
+  virtual ~FormatException() throw() { }
+};
+
+/**
+   An argument of format_text.
+
+   It is created implicitly from the value to be formatted, and it
+   only keeps a reference to strings (so it must not be stored).
+   Narrow strings and other pointers are rejected at compile time
+   instead of being formatted as bools.
+*/
+class VACA_DLL FormatArg
+{
+public:
+
+  enum Type {
+    SignedType,
+    UnsignedType,
+    FloatType,
+    DoubleType,
+    CharType,
+    BoolType,
+    StringType
+  };
+
+private:
+
+  Type m_type;
+  union {
+    long long m_signed;
+    unsigned long long m_unsigned;
+    float m_float;
+    double m_double;
+    Char m_char;
+    bool m_bool;
+    struct {
+      const Char* data;
+      size_t size;
+    } m_string;
+  };
+
+public:
+
+  FormatArg(int value) : m_type(SignedType) { m_signed = value; }
+  FormatArg(long value) : m_type(SignedType) { m_signed = value; }
+  FormatArg(unsigned int value) : m_type(UnsignedType) { m_unsigned = value; }
+  FormatArg(unsigned long value) : m_type(UnsignedType) { m_unsigned = value; }
+  FormatArg(long long value) : m_type(SignedType) { m_signed = value; }
+  FormatArg(unsigned long long value) : m_type(UnsignedType) { m_unsigned = value; }
+  FormatArg(float value) : m_type(FloatType) { m_float = value; }
+  FormatArg(double value) : m_type(DoubleType) { m_double = value; }
+  FormatArg(Char value) : m_type(CharType) { m_char = value; }
+  FormatArg(bool value) : m_type(BoolType) { m_bool = value; }
+
+  FormatArg(const Char* str) : m_type(StringType) {
+    m_string.data = str;
+    m_string.size = std::wcslen(str);
+  }
+
+  FormatArg(const String& str) : m_type(StringType) {
+    m_string.data = str.c_str();
+    m_string.size = str.size();
+  }
+
+  FormatArg(const StringView& str) : m_type(StringType) {
+    m_string.data = str.data();
+    m_string.size = str.size();
+  }
+
+  Type getType() const { return m_type; }
+  long long getSigned() const { return m_signed; }
+  unsigned long long getUnsigned() const { return m_unsigned; }
+  float getFloat() const { return m_float; }
+  double getDouble() const { return m_double; }
+  Char getChar() const { return m_char; }
+  bool getBool() const { return m_bool; }
+  StringView getString() const { return StringView(m_string.data, m_string.size); }
+
+private:
+  // Not defined: a char* or a pointer to an object would be
+  // converted to bool silently.
+  FormatArg(const char* str);
+  template<typename T> FormatArg(const T* ptr);
+
+};
+
+VACA_DLL void vformat_append(String& dst, const Char* fmt, const FormatArg* args, int count);
+
+// ======================================================================
+// format_append
+
+inline void format_append(String& dst, const Char* fmt)
+{
+  vformat_append(dst, fmt, NULL, 0);
+}
+
+inline void format_append(String& dst, const Char* fmt,
+			  const FormatArg& a1)
+{
+  vformat_append(dst, fmt, &a1, 1);
+}
+
+inline void format_append(String& dst, const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2)
+{
+  FormatArg args[] = { a1, a2 };
+  vformat_append(dst, fmt, args, 2);
+}
+
+inline void format_append(String& dst, const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2, const FormatArg& a3)
+{
+  FormatArg args[] = { a1, a2, a3 };
+  vformat_append(dst, fmt, args, 3);
+}
+
+inline void format_append(String& dst, const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2, const FormatArg& a3,
+			  const FormatArg& a4)
+{
+  FormatArg args[] = { a1, a2, a3, a4 };
+  vformat_append(dst, fmt, args, 4);
+}
+
+inline void format_append(String& dst, const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2, const FormatArg& a3,
+			  const FormatArg& a4, const FormatArg& a5)
+{
+  FormatArg args[] = { a1, a2, a3, a4, a5 };
+  vformat_append(dst, fmt, args, 5);
+}
+
+inline void format_append(String& dst, const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2, const FormatArg& a3,
+			  const FormatArg& a4, const FormatArg& a5, const FormatArg& a6)
+{
+  FormatArg args[] = { a1, a2, a3, a4, a5, a6 };
+  vformat_append(dst, fmt, args, 6);
+}
+
+// ======================================================================
+// format_text
+
+inline String format_text(const Char* fmt)
+{
+  String res;
+  vformat_append(res, fmt, NULL, 0);
+  return res;
+}
+
+inline String format_text(const Char* fmt,
+			  const FormatArg& a1)
+{
+  String res;
+  vformat_append(res, fmt, &a1, 1);
+  return res;
+}
+
+inline String format_text(const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2)
+{
+  String res;
+  format_append(res, fmt, a1, a2);
+  return res;
+}
+
+inline String format_text(const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2, const FormatArg& a3)
+{
+  String res;
+  format_append(res, fmt, a1, a2, a3);
+  return res;
+}
+
+inline String format_text(const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2, const FormatArg& a3,
+			  const FormatArg& a4)
+{
+  String res;
+  format_append(res, fmt, a1, a2, a3, a4);
+  return res;
+}
+
+inline String format_text(const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2, const FormatArg& a3,
+			  const FormatArg& a4, const FormatArg& a5)
+{
+  String res;
+  format_append(res, fmt, a1, a2, a3, a4, a5);
+  return res;
+}
+
+inline String format_text(const Char* fmt,
+			  const FormatArg& a1, const FormatArg& a2, const FormatArg& a3,
+			  const FormatArg& a4, const FormatArg& a5, const FormatArg& a6)
+{
+  String res;
+  format_append(res, fmt, a1, a2, a3, a4, a5, a6);
+  return res;
+}
+
+} // namespace Vaca
+
+#endif // VACA_FORMAT_H
@@ -0,0 +1,109 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_GDIOBJECTCACHE_H
+#define VACA_GDIOBJECTCACHE_H
+
+#include "Vaca/base.h"
+#include "Vaca/LruCache.h"
+#include "Vaca/SharedPtr.h"
+#include "Vaca/Referenceable.h"
+
+#include <vector>
+
+namespace Vaca {
+
+/**
+   Identifies the attributes used to create a GDI object (the type
+   of object, color, width, style, font face, etc.).
+
+   @internal
+*/
+class VACA_DLL GdiObjectKey
+{
+  std::vector<int> m_data;
+
+public:
+
+  enum Type { PenObject, BrushObject, FontObject };
+
+  explicit GdiObjectKey(Type type);
+
+  void add(int value);
+  void add(const Char* str);
+
+  bool operator<(const GdiObjectKey& other) const;
+};
+
+/**
+   Cache of GDI objects to share them between Pen, Brush and Font
+   instances created with the same attributes.
+
+   Painting code usually creates the same pens and brushes each time
+   (e.g. a @c Brush(getBgColor()) in each paint event). With this
+   cache the second Brush with the same color does not create a new
+   HBRUSH, it references the one created by the first Brush. The
+   least recently used objects are released when the cache is full.
+
+   Each thread has its own cache (see CurrentThread#getGdiObjectCache),
+   so objects are shared only between instances created in the same
+   thread.
+
+   @see Pen, Brush, Font
+*/
+class VACA_DLL GdiObjectCache : private NonCopyable
+{
+  LruCache<GdiObjectKey, SharedPtr<Referenceable> > m_cache;
+  size_t m_createdObjects;
+
+public:
+
+  GdiObjectCache();
+  virtual ~GdiObjectCache();
+
+  Referenceable* find(const GdiObjectKey& key);
+  void insert(const GdiObjectKey& key, Referenceable* object);
+  void clear();
+
+  size_t getCapacity() const;
+  void setCapacity(size_t capacity);
+  size_t size() const;
+
+  size_t getHits() const;
+  size_t getMisses() const;
+  size_t getCreatedObjects() const;
+  void resetStats();
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_GDIOBJECTCACHE_H
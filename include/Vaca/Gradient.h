@@ -0,0 +1,103 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_GRADIENT_H
+#define VACA_GRADIENT_H
+
+#include "Vaca/base.h"
+#include "Vaca/Color.h"
+#include "Vaca/ImagePixels.h"
+#include "Vaca/Rect.h"
+
+#include <vector>
+
+namespace Vaca {
+
+/**
+   A linear gradient of colors.
+
+   A gradient has two or more color stops. Each stop is a color in a
+   position (offset) of the gradient, from 0.0 (the start) to 1.0 (the
+   end). The colors between two stops are linearly interpolated.
+
+   The gradient is rendered with span kernels that write the pixels
+   directly in an ImagePixels (they use SSE2 when the compiler targets
+   it). Optionally the gradient can be dithered with an ordered (4x4
+   Bayer) matrix to hide the bands of low-contrast gradients.
+
+   @code
+   Gradient gradient(Color::Red, Color::Blue);
+   gradient.addStop(0.5, Color::White);
+   gradient.fillRect(pixels, Rect(pixels.getSize()), Orientation::Horizontal);
+   @endcode
+
+   @see Graphics#fillGradientRect
+*/
+class VACA_DLL Gradient
+{
+public:
+
+  /**
+     A color in a position of the gradient.
+  */
+  struct Stop
+  {
+    double offset;
+    Color color;
+
+    Stop(double offset, const Color& color)
+      : offset(offset), color(color) { }
+  };
+
+private:
+  std::vector<Stop> m_stops;
+  bool m_dithering;
+
+public:
+
+  Gradient();
+  Gradient(const Color& startColor, const Color& endColor);
+  virtual ~Gradient();
+
+  void addStop(double offset, const Color& color);
+  void clearStops();
+  const std::vector<Stop>& getStops() const;
+
+  bool isDithering() const;
+  void setDithering(bool state);
+
+  void fillRect(ImagePixels& pixels, const Rect& rc, Orientation orientation) const;
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_GRADIENT_H
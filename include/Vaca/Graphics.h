@@ -36,6 +36,7 @@
 #include "Vaca/NonCopyable.h"
 #include "Vaca/Rect.h"
 #include "Vaca/Font.h"
+#include "Vaca/GraphicsPath.h"
 
 #include <list>
 #include <vector>
@@ -192,6 +193,7 @@ public:
 
   void fillGradientRect(const Rect& rc, const Color& startColor, const Color& endColor, Orientation orientation);
   void fillGradientRect(int x, int y, int w, int h, const Color& startColor, const Color& endColor, Orientation orientation);
+  void fillGradientRect(const Rect& rc, const Gradient& gradient, Orientation orientation);
   void drawGradientRect(const Rect& rc, const Color& topLeft, const Color& topRight, const Color& bottomLeft, const Color& bottomRight);
   void drawGradientRect(int x, int y, int w, int h, const Color& topLeft, const Color& topRight, const Color& bottomLeft, const Color& bottomRight);
 
@@ -213,6 +215,7 @@ public:
 private:
 
   void initialize();
+  void tracePolylines(const GraphicsPath::Polylines& polylines, const Point& pt);
 
   void drawBezier(const Pen& pen, CONST POINT* lppt, int numPoints);
   void drawBezierTo(const Pen& pen, CONST POINT* lppt, int numPoints);
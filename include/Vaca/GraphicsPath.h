@@ -85,9 +85,45 @@ public:
     const Point& getPoint() const;
   };
 
+  /**
+     A GraphicsPath converted to polylines.
+
+     Curves are approximated with line segments (see
+     GraphicsPath#getPolylines). All figures are stored in one
+     compact buffer of points, so it can be given directly to
+     the routines that draw or hit-test polygons.
+  */
+  class VACA_DLL Polylines
+  {
+    friend class GraphicsPath;
+    std::vector<Point> m_points;
+    std::vector<int> m_sizes;	// number of points of each figure
+    std::vector<bool> m_closed;	// true if the figure is closed
+    double m_tolerance;
+  public:
+    Polylines();
+
+    double getTolerance() const;
+    const std::vector<Point>& getPoints() const;
+    const std::vector<int>& getFigureSizes() const;
+    int getFigureCount() const;
+    bool isFigureClosed(int figure) const;
+
+  private:
+    void clear();
+    void addPoint(double x, double y);
+    void addBezier(double x0, double y0, double x1, double y1,
+		   double x2, double y2, double x3, double y3, int level);
+    void closeFigure(int start, bool closed);
+  };
+
 private:
   std::vector<Node> m_nodes;
 
+  // cache of #getPolylines
+  mutable Polylines m_polylines;
+  mutable bool m_polylinesValid;
+
 public:
   typedef std::vector<Node>::iterator iterator;
   typedef std::vector<Node>::const_iterator const_iterator;
@@ -122,10 +158,13 @@ public:
   GraphicsPath& flatten();
   GraphicsPath& widen(const Pen& pen);
 
+  const Polylines& getPolylines(double tolerance = 0.25) const;
+
   Region toRegion() const;
 
 private:
   void addNode(int type, const Point& pt);
+  void invalidatePolylines();
 
 };
 
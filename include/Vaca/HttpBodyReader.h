@@ -0,0 +1,103 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_HTTPBODYREADER_H
+#define VACA_HTTPBODYREADER_H
+
+#include "Vaca/base.h"
+#include "Vaca/NonCopyable.h"
+
+namespace Vaca {
+
+/**
+   Receives the body of a response of HttpClient while it is being
+   downloaded, instead of accumulating it in HttpResponse#getBody.
+
+   The chunked transfer encoding and the gzip/deflate content
+   encodings are already decoded when #onData is called.
+
+   @warning
+     The member functions are called from the network thread of the
+     HttpClient, not from the thread that made the request. The
+     reader must exist until the callback of the request is called.
+
+   @see HttpClient#get, HttpFileWriter, HttpMemoryWriter
+*/
+class VACA_DLL HttpBodyReader : private NonCopyable
+{
+public:
+  HttpBodyReader();
+  virtual ~HttpBodyReader();
+
+  virtual bool onResponse(const HttpResponse& response);
+  virtual bool onData(const char* data, std::size_t size) = 0;
+};
+
+/**
+   Writes the body of a response directly in a file descriptor
+   (e.g. a file opened with @c open, or @c fileno of a @c FILE).
+*/
+class VACA_DLL HttpFileWriter : public HttpBodyReader
+{
+  int m_fd;
+  std::size_t m_size;
+
+public:
+  explicit HttpFileWriter(int fd);
+
+  std::size_t getSize() const;
+
+  virtual bool onData(const char* data, std::size_t size);
+};
+
+/**
+   Writes the body of a response in a memory block of a fixed size
+   (e.g. a view of a memory-mapped file).
+*/
+class VACA_DLL HttpMemoryWriter : public HttpBodyReader
+{
+  char* m_data;
+  std::size_t m_capacity;
+  std::size_t m_size;
+
+public:
+  HttpMemoryWriter(char* data, std::size_t capacity);
+
+  char* getData() const;
+  std::size_t getSize() const;
+
+  virtual bool onResponse(const HttpResponse& response);
+  virtual bool onData(const char* data, std::size_t size);
+};
+
+} // namespace Vaca
+
+#endif // VACA_HTTPBODYREADER_H
@@ -0,0 +1,235 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_HTTPCLIENT_H
+#define VACA_HTTPCLIENT_H
+
+#include "Vaca/base.h"
+#include "Vaca/Exception.h"
+#include "Vaca/NonCopyable.h"
+#include "Vaca/Slot.h"
+
+#include <string>
+#include <vector>
+
+namespace Vaca {
+
+/**
+   This exception is thrown when HttpClient cannot initialize its
+   sockets.
+*/
+class VACA_DLL HttpClientException : public Exception
+{
+public:
+  HttpClientException() : Exception() { }
+  HttpClientException(const String& message) : Exception(message) { }
+  virtual ~HttpClientException() throw() { }
+};
+
+/**
+   The response of a request made with HttpClient.
+
+   If the request could not be completed (e.g. the server cannot be
+   reached), #getError returns the reason and #getStatusCode is zero.
+*/
+class VACA_DLL HttpResponse
+{
+  int m_statusCode;
+  String m_error;
+  std::vector<std::pair<std::string, std::string> > m_headers;
+  std::string m_body;
+
+public:
+
+  HttpResponse();
+
+  int getStatusCode() const;
+  void setStatusCode(int statusCode);
+
+  const String& getError() const;
+  void setError(const String& error);
+
+  bool hasHeader(const String& headerName) const;
+  String getHeader(const String& headerName) const;
+  void addHeader(const std::string& name, const std::string& value);
+
+  long long getContentLength() const;
+
+  const std::string& getBody() const;
+  std::string& getBody();
+
+private:
+  const std::string* findHeader(const std::string& name) const;
+
+};
+
+/**
+   Counters of the connections and requests of a HttpClient.
+
+   @see HttpClient#getStats
+*/
+struct HttpClientStats
+{
+  /**
+     Requests sent to servers (retries included).
+  */
+  unsigned long requests;
+
+  /**
+     Connections opened.
+  */
+  unsigned long connections;
+
+  /**
+     Requests sent through a connection that was already used by
+     other request (keep-alive).
+  */
+  unsigned long reused;
+
+  /**
+     Requests sent while the connection was still waiting for the
+     response of previous requests (pipelining).
+  */
+  unsigned long pipelined;
+
+  /**
+     Requests sent again because their connection was closed before
+     receiving the response.
+  */
+  unsigned long retried;
+
+  /**
+     Requests canceled by their HttpBodyReader.
+  */
+  unsigned long canceled;
+};
+
+/**
+   Asynchronous HTTP/1.1 client.
+
+   The requests are sent from a background thread, which keeps the
+   connections to each host open (keep-alive) to reuse them, up to
+   a maximum of connections per host. When all the connections to a
+   host are busy, GET and HEAD requests are pipelined: they are sent
+   through a connection which is waiting the responses of previous
+   requests.
+
+   The callback of each request is called with the HttpResponse in the
+   thread that made the request, from its message loop (see
+   CurrentThread#doMessageLoop), so it can touch widgets:
+
+   @code
+   void onStatus(const HttpResponse& response);
+   ...
+   HttpClient client;
+   client.get(L"http://localhost:8080/status", &onStatus);
+   @endcode
+
+   Large bodies can be received with a HttpBodyReader, which gets the
+   bytes as they arrive (without accumulating them in
+   HttpResponse#getBody):
+
+   @code
+   HttpFileWriter writer(fd);
+   client.get(L"http://localhost:8080/big.zip", &writer, &onDownloaded);
+   @endcode
+
+   It uses plain sockets (Winsock or BSD sockets), so only the "http"
+   scheme is supported. The chunked transfer encoding is supported, and
+   if Vaca was compiled with zlib (HTTP_COMPRESSION option) the
+   requests accept gzip/deflate content encodings, which are decoded
+   automatically.
+
+   @see HttpRequest
+*/
+class VACA_DLL HttpClient : private NonCopyable
+{
+  class HttpClientImpl;
+  HttpClientImpl* m_impl;
+
+public:
+
+  typedef Slot1<void, const HttpResponse&> Callback;
+
+  explicit HttpClient(int maxConnectionsPerHost = 2, int maxPipelineDepth = 4);
+  ~HttpClient();
+
+  /**
+     Sends a GET request to @a url, @a callback will receive the
+     HttpResponse.
+  */
+  template<typename F>
+  void get(const String& url, F callback) {
+    enqueue(L"GET", url, L"", std::string(), NULL, new Slot1_fun<void, F, const HttpResponse&>(callback));
+  }
+
+  /**
+     Sends a GET request to @a url, its body is given to @a reader
+     (which must exist until @a callback is called).
+  */
+  template<typename F>
+  void get(const String& url, HttpBodyReader* reader, F callback) {
+    enqueue(L"GET", url, L"", std::string(), reader, new Slot1_fun<void, F, const HttpResponse&>(callback));
+  }
+
+  /**
+     Sends a POST request to @a url with the specified @a body.
+  */
+  template<typename F>
+  void post(const String& url, const std::string& body, F callback) {
+    enqueue(L"POST", url, L"", body, NULL, new Slot1_fun<void, F, const HttpResponse&>(callback));
+  }
+
+  /**
+     Sends a request with the specified @a method. The @a headers
+     are added to the request as they are (each one must end with
+     "\r\n"). @a reader can be NULL.
+  */
+  template<typename F>
+  void request(const String& method, const String& url,
+	       const String& headers, const std::string& body,
+	       HttpBodyReader* reader, F callback) {
+    enqueue(method, url, headers, body, reader, new Slot1_fun<void, F, const HttpResponse&>(callback));
+  }
+
+  int getPendingCount() const;
+  HttpClientStats getStats() const;
+
+private:
+  void enqueue(const String& method, const String& url,
+	       const String& headers, const std::string& body,
+	       HttpBodyReader* reader, Callback* callback);
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_HTTPCLIENT_H
@@ -54,6 +54,8 @@ public:
 
 /**
    Sends a HTTP request to the specified URL to get its content.
+
+   @see HttpClient, to download large bodies with a HttpBodyReader
 */
 class VACA_DLL HttpRequest
 {
@@ -71,7 +73,7 @@ class VACA_DLL HttpRequest
 
   class InetSession : public InetHandle {
   public:
-    InetSession(InetConnection& conn, const String& host);
+    InetSession(InetConnection& conn, const String& host, int port);
   };
 
   class InetRequest : public InetHandle {
@@ -0,0 +1,116 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_INTERNEDSTRING_H
+#define VACA_INTERNEDSTRING_H
+
+#include "Vaca/base.h"
+#include "Vaca/StringView.h"
+
+namespace Vaca {
+
+/**
+   A pointer-sized handle to an immutable string stored in a global
+   pool, where each different string is stored only once.
+
+   Interning a string (creating an InternedString from a String) has
+   to look it up in the pool, but then comparisons for equality and
+   hashes are O(1), and a copy only increments a reference counter.
+   So they are good names for properties (or other identifiers used
+   as map keys), and thousands of tree nodes with the same label
+   share the same characters.
+
+   The pool is thread-safe and each string is freed when the last
+   InternedString that references it is destroyed. Use #find to look
+   for a string without adding it to the pool.
+
+   The operator< compares the characters (like String's operator<),
+   so a std::map with InternedString keys is sorted alphabetically.
+*/
+class VACA_DLL InternedString
+{
+public:
+
+  struct Entry
+  {
+    long refs;
+    size_t hash;
+    size_t size;
+    Char text[1];
+  };
+
+private:
+
+  Entry* m_entry;
+
+public:
+
+  InternedString();
+  InternedString(const Char* str);
+  InternedString(const String& str);
+  InternedString(const StringView& str);
+  InternedString(const InternedString& other);
+  ~InternedString();
+
+  InternedString& operator=(const InternedString& other);
+
+  const Char* c_str() const { return m_entry->text; }
+  size_t size() const { return m_entry->size; }
+  bool empty() const { return m_entry->size == 0; }
+  size_t hash() const { return m_entry->hash; }
+
+  StringView view() const { return StringView(m_entry->text, m_entry->size); }
+  String str() const { return String(m_entry->text, m_entry->size); }
+
+  bool operator==(const InternedString& other) const { return m_entry == other.m_entry; }
+  bool operator!=(const InternedString& other) const { return m_entry != other.m_entry; }
+  bool operator<(const InternedString& other) const { return compare(other) < 0; }
+
+  int compare(const InternedString& other) const;
+  void swap(InternedString& other);
+
+  static bool find(const StringView& str, InternedString& result);
+
+  static size_t getPoolCount();
+  static size_t getPoolBytes();
+
+private:
+  explicit InternedString(Entry* entry) : m_entry(entry) { }
+
+  void release();
+
+  static Entry* intern(const Char* str, size_t size);
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_INTERNEDSTRING_H
@@ -33,6 +33,7 @@
 #define VACA_LISTITEM_H
 
 #include "Vaca/base.h"
+#include "Vaca/CompactString.h"
 #include "Vaca/Component.h"
 
 #include <vector>
@@ -47,7 +48,7 @@ class VACA_DLL ListItem : public Component
   friend class ListView;
 
   int			m_index;
-  std::vector<String>	m_text;
+  std::vector<LabelString> m_text;
   int			m_image;
   ListView*		m_owner;
 
@@ -0,0 +1,253 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_LRUCACHE_H
+#define VACA_LRUCACHE_H
+
+#include "Vaca/base.h"
+#include "Vaca/NonCopyable.h"
+
+#include <list>
+#include <map>
+
+namespace Vaca {
+
+/**
+   A map with a limited capacity that discards the least recently
+   used entries when it gets full.
+
+   Each entry has a cost (e.g. its size in bytes, or just 1 to limit
+   the number of entries). When the sum of the costs exceeds the
+   capacity, the least recently used entries are removed until the
+   new entry fits.
+
+   The cache counts the hits and misses of #find, so you can tune
+   the capacity for your program.
+
+   @warning
+     This class is not thread-safe, protect it with a Mutex if it is
+     shared between threads.
+
+   @tparam Key Must have the less-than operator.
+   @tparam Value Must be copyable.
+*/
+template<typename Key, typename Value>
+class LruCache : private NonCopyable
+{
+  // the most recently used key is at the front
+  typedef std::list<const Key*> UsageList;
+
+  struct Entry
+  {
+    Value value;
+    size_t cost;
+    typename UsageList::iterator usage;
+  };
+
+  typedef std::map<Key, Entry> EntryMap;
+
+  EntryMap m_entries;
+  UsageList m_usage;
+  size_t m_capacity;
+  size_t m_cost;
+  size_t m_hits;
+  size_t m_misses;
+  size_t m_evictions;
+
+public:
+
+  /**
+     Creates an empty cache.
+
+     @param capacity
+       Maximum sum of the costs of all entries.
+  */
+  LruCache(size_t capacity)
+    : m_capacity(capacity)
+    , m_cost(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+  {
+  }
+
+  size_t getCapacity() const { return m_capacity; }
+  size_t getCost() const { return m_cost; }
+  size_t size() const { return m_entries.size(); }
+  bool empty() const { return m_entries.empty(); }
+
+  size_t getHits() const { return m_hits; }
+  size_t getMisses() const { return m_misses; }
+  size_t getEvictions() const { return m_evictions; }
+
+  /**
+     Changes the capacity of the cache, removing the least recently
+     used entries that do not fit anymore.
+  */
+  void setCapacity(size_t capacity)
+  {
+    m_capacity = capacity;
+    shrink(0);
+  }
+
+  /**
+     Resets the hits, misses and evictions counters.
+  */
+  void resetStats()
+  {
+    m_hits = m_misses = m_evictions = 0;
+  }
+
+  /**
+     Returns the value of the entry with the specified @a key and
+     marks it as the most recently used one.
+
+     @return
+       A pointer to the value which is valid until the next
+       modification of the cache, or NULL if the key is not in
+       the cache.
+  */
+  Value* find(const Key& key)
+  {
+    typename EntryMap::iterator it = m_entries.find(key);
+    if (it == m_entries.end()) {
+      ++m_misses;
+      return NULL;
+    }
+
+    ++m_hits;
+    m_usage.splice(m_usage.begin(), m_usage, it->second.usage);
+    return &it->second.value;
+  }
+
+  /**
+     Adds (or replaces) the entry with the specified @a key, removing
+     the least recently used entries to get space for it.
+
+     @return
+       False if the @a cost of the entry is greater than the
+       capacity of the cache (so it is not added).
+  */
+  bool insert(const Key& key, const Value& value, size_t cost = 1)
+  {
+    erase(key);
+
+    if (cost > m_capacity)
+      return false;
+
+    shrink(cost);
+
+    typename EntryMap::iterator it =
+      m_entries.insert(std::make_pair(key, Entry())).first;
+
+    it->second.value = value;
+    it->second.cost = cost;
+    it->second.usage = m_usage.insert(m_usage.begin(), &it->first);
+    m_cost += cost;
+    return true;
+  }
+
+  /**
+     Removes the entry with the specified @a key.
+
+     @return
+       True if the entry was in the cache.
+  */
+  bool erase(const Key& key)
+  {
+    typename EntryMap::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+      return false;
+
+    remove(it);
+    return true;
+  }
+
+  /**
+     Removes all entries which satisfy the @a pred predicate.
+
+     @param pred
+       A function or functor called as @c pred(key, value) that
+       returns true for the entries to be removed.
+
+     @return
+       The number of removed entries.
+  */
+  template<typename Predicate>
+  size_t eraseIf(Predicate pred)
+  {
+    size_t count = 0;
+    typename EntryMap::iterator it = m_entries.begin();
+    while (it != m_entries.end()) {
+      typename EntryMap::iterator next = it;
+      ++next;
+      if (pred(it->first, it->second.value)) {
+	remove(it);
+	++count;
+      }
+      it = next;
+    }
+    return count;
+  }
+
+  /**
+     Removes all entries (the counters are not reset).
+  */
+  void clear()
+  {
+    m_entries.clear();
+    m_usage.clear();
+    m_cost = 0;
+  }
+
+private:
+
+  void remove(typename EntryMap::iterator it)
+  {
+    m_cost -= it->second.cost;
+    m_usage.erase(it->second.usage);
+    m_entries.erase(it);
+  }
+
+  // removes entries until "extra" cost units can be added
+  void shrink(size_t extra)
+  {
+    while (!m_usage.empty() && m_cost + extra > m_capacity) {
+      remove(m_entries.find(*m_usage.back()));
+      ++m_evictions;
+    }
+  }
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_LRUCACHE_H
@@ -68,12 +68,15 @@ class VACA_DLL Message
 public:
 
   Message();
-  Message(const String& name);
+  Message(const String& name, bool coalescible = false);
   Message(const Message& msg, void* payload);
   virtual ~Message();
 
   void* getPayload();
 
+  bool isCoalescible() const;
+  bool coalesce(const Message& next);
+
   inline bool operator==(const Message& message) const {
     return m_msg.message == message.m_msg.message;
   }
@@ -0,0 +1,81 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_MESSAGEQUEUE_H
+#define VACA_MESSAGEQUEUE_H
+
+#include "Vaca/base.h"
+#include "Vaca/Message.h"
+#include "Vaca/NonCopyable.h"
+
+namespace Vaca {
+
+/**
+   A queue of messages where several threads can put messages
+   (producers) and only one thread takes them (the consumer).
+
+   It is lock-free: #push is an atomic exchange, and #pop does not
+   wait the producers. There is no limit in the number of messages.
+
+   Each Thread has one of these queues (see Thread#enqueueMessage).
+   The queue says to the producers when the consumer must be woken up,
+   so only the first message of a batch needs a signal of the
+   operating system.
+
+   @see Thread#enqueueMessage, CurrentThread#getMessage
+*/
+class VACA_DLL MessageQueue : private NonCopyable
+{
+  struct Node;
+
+  Node* volatile m_head;	// last pushed node (producers)
+  Node* m_tail;			// next node to pop (consumer)
+  Node* m_stub;
+  volatile long m_signaled;
+
+public:
+
+  MessageQueue();
+  ~MessageQueue();
+
+  bool push(const Message& message);
+  bool pop(Message& message);
+  const Message* front();
+
+private:
+  void pushNode(Node* node);
+  bool popNode(Message& message);
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_MESSAGEQUEUE_H
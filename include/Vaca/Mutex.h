@@ -44,18 +44,26 @@ namespace Vaca {
    This kind of mutex can be used to synchronize multiple threads of
    the same process. No multiple processes!
 
+   It is an adaptive mutex: when it is locked by other thread, #lock
+   spins a little (with exponential backoff) before blocking the
+   thread, because critical sections are usually short. The number
+   of spins adapts to what each mutex needed in the last locks.
+
    @win32
      This is a @msdn{CRITICAL_SECTION} wrapper.
    @endwin32
 
-   @see ScopedLock, ConditionVariable, Thread,
+   @see ScopedLock, ConditionVariable, SharedMutex, Thread,
 	@wikipedia{Critical_section, Critical Section in Wikipedia}
 	@wikipedia{Mutex, Mutex in Wikipedia}
 */
 class VACA_DLL Mutex : private NonCopyable
 {
+  friend class ConditionVariable;
+
   class MutexImpl;
   MutexImpl* m_impl;
+  volatile int m_spins;
 
 public:
 
@@ -68,6 +76,10 @@ public:
 
 };
 
+namespace details {
+  VACA_DLL int getProcessorCount();
+}
+
 } // namespace Vaca
 
 #endif // VACA_MUTEX_H
@@ -0,0 +1,160 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_PATH_H
+#define VACA_PATH_H
+
+#include "Vaca/base.h"
+#include "Vaca/Enum.h"
+#include "Vaca/StringView.h"
+
+namespace Vaca {
+
+/**
+   Which characters separate the components of a path.
+
+   One of the following values:
+   @li PathSeparator::Windows: both '\\' and '/' are separators, and
+       '\\' is used to join components.
+   @li PathSeparator::Posix: only '/' is a separator (a '\\' is a
+       valid character of a file name).
+
+   The default value depends on the platform where Vaca is compiled.
+*/
+struct PathSeparatorEnum
+{
+  enum enumeration {
+    Windows,
+    Posix
+  };
+#ifdef VACA_ON_WINDOWS
+  static const enumeration default_value = Windows;
+#else
+  static const enumeration default_value = Posix;
+#endif
+};
+
+typedef Enum<PathSeparatorEnum> PathSeparator;
+
+/**
+   A non-owning view of a file name path.
+
+   All the components are returned as views of the original
+   characters, so nothing is copied or allocated (the path must live
+   longer than the view).
+
+   @see PathBuilder, file_path, file_name, file_extension, file_title
+*/
+class VACA_DLL PathView
+{
+  StringView m_path;
+  PathSeparator m_separator;
+
+public:
+
+  PathView(const StringView& path, PathSeparator separator = PathSeparator())
+    : m_path(path), m_separator(separator) { }
+
+  const StringView& getPath() const { return m_path; }
+  PathSeparator getSeparator() const { return m_separator; }
+
+  bool isSeparator(Char chr) const {
+    return chr == L'/' || (chr == L'\\' && m_separator == PathSeparator::Windows);
+  }
+
+  Char getPreferredSeparator() const {
+    return m_separator == PathSeparator::Windows ? L'\\': L'/';
+  }
+
+  StringView getRoot() const;
+  StringView getDirectory() const;
+  StringView getFileName() const;
+  StringView getExtension() const;
+  StringView getTitle() const;
+
+  bool nextComponent(size_t& pos, StringView& component) const;
+
+private:
+  size_t findFileName() const;
+
+};
+
+/**
+   Builds a path in a String which reserves its capacity once.
+
+   Components can be pushed and popped, so the same builder can be
+   used to walk a directory tree without allocating for each entry:
+   @code
+   PathBuilder path(L"C:\\Windows");
+   path /= L"System32";		// C:\Windows\System32
+   path /= L"drivers";		// C:\Windows\System32\drivers
+   path.pop();			// C:\Windows\System32
+   @endcode
+
+   @see PathView
+*/
+class VACA_DLL PathBuilder
+{
+  String m_path;
+  PathSeparator m_separator;
+
+public:
+
+  enum { DefaultCapacity = 260 };
+
+  explicit PathBuilder(PathSeparator separator = PathSeparator(),
+		       size_t capacity = DefaultCapacity);
+  explicit PathBuilder(const StringView& path,
+		       PathSeparator separator = PathSeparator(),
+		       size_t capacity = DefaultCapacity);
+
+  const String& str() const { return m_path; }
+  const Char* c_str() const { return m_path.c_str(); }
+  size_t size() const { return m_path.size(); }
+  bool empty() const { return m_path.empty(); }
+
+  PathView view() const { return PathView(m_path, m_separator); }
+
+  size_t push(const StringView& component);
+  void pop();
+  void truncate(size_t size);
+  void clear();
+
+  PathBuilder& operator/=(const StringView& component) {
+    push(component);
+    return *this;
+  }
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_PATH_H
@@ -133,7 +133,8 @@ typedef Enum<PenJoinEnum> PenJoin;
 
    This is a SharedPtr, so if you copy instances of pens they will be
    referencing to the same place. You can't clone pens because you can't
-   modify them.
+   modify them. Pens created with the same attributes in the same thread
+   share the same handle too (see GdiObjectCache).
 
    @win32
      This is a @msdn{HPEN} wrapper.
@@ -33,19 +33,21 @@
 #define VACA_PROPERTY_H
 
 #include "Vaca/base.h"
+#include "Vaca/InternedString.h"
 #include "Vaca/Referenceable.h"
 
 namespace Vaca {
 
 class VACA_DLL Property : public Referenceable
 {
-  String m_name;
+  InternedString m_name;
 
 public:
   Property(const String& name);
   virtual ~Property();
 
   String getName() const;
+  const InternedString& getInternedName() const;
 };
 
 } // namespace Vaca
@@ -0,0 +1,116 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_SCOPEDSHAREDLOCK_H
+#define VACA_SCOPEDSHAREDLOCK_H
+
+#include "Vaca/base.h"
+#include "Vaca/SharedMutex.h"
+#include "Vaca/NonCopyable.h"
+
+namespace Vaca {
+
+/**
+   Locks a SharedMutex in shared mode (as a reader) during the
+   life-time of the object.
+
+   @code
+   {
+     ScopedSharedLock hold(mutex);
+     // read the shared data...
+   }
+   @endcode
+
+   @see SharedMutex, ScopedExclusiveLock, ScopedLock
+*/
+class ScopedSharedLock : private NonCopyable
+{
+  SharedMutex& m_mutex;
+
+  // not defined
+  ScopedSharedLock();
+
+public:
+
+  ScopedSharedLock(SharedMutex& mutex)
+    : m_mutex(mutex)
+  {
+    m_mutex.lockShared();
+  }
+
+  ~ScopedSharedLock()
+  {
+    m_mutex.unlockShared();
+  }
+
+  SharedMutex& getMutex() const
+  {
+    return m_mutex;
+  }
+
+};
+
+/**
+   Locks a SharedMutex in exclusive mode (as a writer) during the
+   life-time of the object.
+
+   @see SharedMutex, ScopedSharedLock, ScopedLock
+*/
+class ScopedExclusiveLock : private NonCopyable
+{
+  SharedMutex& m_mutex;
+
+  // not defined
+  ScopedExclusiveLock();
+
+public:
+
+  ScopedExclusiveLock(SharedMutex& mutex)
+    : m_mutex(mutex)
+  {
+    m_mutex.lock();
+  }
+
+  ~ScopedExclusiveLock()
+  {
+    m_mutex.unlock();
+  }
+
+  SharedMutex& getMutex() const
+  {
+    return m_mutex;
+  }
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_SCOPEDSHAREDLOCK_H
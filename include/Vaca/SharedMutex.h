@@ -0,0 +1,83 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_SHAREDMUTEX_H
+#define VACA_SHAREDMUTEX_H
+
+#include "Vaca/base.h"
+#include "Vaca/ConditionVariable.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/NonCopyable.h"
+
+namespace Vaca {
+
+/**
+   A mutex that can be locked by several readers at the same time
+   (shared mode) or by one writer (exclusive mode).
+
+   Use it to protect data structures that are read much more times
+   than modified. The readers do not block each other: when there is
+   no writer, #lockShared and #unlockShared are just one atomic
+   operation.
+
+   Writers have preference: when a writer is waiting, new readers
+   wait too (so a continuous stream of readers cannot starve the
+   writers).
+
+   @see ScopedSharedLock, ScopedExclusiveLock, Mutex
+*/
+class VACA_DLL SharedMutex : private NonCopyable
+{
+  volatile long m_state;	  // number of readers, or WRITER
+  volatile long m_waitingWriters;
+  volatile long m_waitingReaders;
+  Mutex m_mutex;		  // to block the threads
+  ConditionVariable m_writers;
+  ConditionVariable m_readers;
+
+public:
+
+  SharedMutex();
+  ~SharedMutex();
+
+  void lock();
+  bool tryLock();
+  void unlock();
+
+  void lockShared();
+  bool tryLockShared();
+  void unlockShared();
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_SHAREDMUTEX_H
@@ -33,6 +33,7 @@
 #define VACA_STRING_H
 
 #include "Vaca/base.h"
+#include "Vaca/StringView.h"
 #include <vector>
 
 namespace Vaca {
@@ -50,12 +51,15 @@ namespace Vaca {
 
   VACA_DLL String trim_string(const String& str);
   VACA_DLL String trim_string(const Char* str);
+  VACA_DLL StringView trim_view(const StringView& str);
+  VACA_DLL void trim_string_in_place(String& str);
 
   VACA_DLL std::string to_utf8(const String& string);
   VACA_DLL String from_utf8(const std::string& string);
 
   // Split a string in parts
   VACA_DLL void split_string(const String& string, std::vector<String>& parts, const String& separators);
+  VACA_DLL void split_string(const StringView& string, std::vector<StringView>& parts, const StringView& separators);
 
   // ============================================================
   // CONVERSION
@@ -89,6 +93,27 @@ namespace Vaca {
     return convert_to<String, const char*>(from);
   }
 
+  // Locale independent conversions to/from caller buffers (they do
+  // not allocate memory)
+  enum { NumberBufferSize = 32 };
+
+  VACA_DLL int format_number(int value, Char* buf, int size);
+  VACA_DLL int format_number(long value, Char* buf, int size);
+  VACA_DLL int format_number(unsigned int value, Char* buf, int size);
+  VACA_DLL int format_number(unsigned long value, Char* buf, int size);
+  VACA_DLL int format_number(long long value, Char* buf, int size);
+  VACA_DLL int format_number(unsigned long long value, Char* buf, int size);
+  VACA_DLL int format_number(float value, Char* buf, int size);
+  VACA_DLL int format_number(double value, Char* buf, int size);
+  VACA_DLL int format_number(double value, Char type, int precision, Char* buf, int size);
+
+  VACA_DLL const Char* parse_number(const Char* begin, const Char* end, int& value);
+  VACA_DLL const Char* parse_number(const Char* begin, const Char* end, long& value);
+  VACA_DLL const Char* parse_number(const Char* begin, const Char* end, unsigned int& value);
+  VACA_DLL const Char* parse_number(const Char* begin, const Char* end, unsigned long& value);
+  VACA_DLL const Char* parse_number(const Char* begin, const Char* end, float& value);
+  VACA_DLL const Char* parse_number(const Char* begin, const Char* end, double& value);
+
   // Copy to a raw string
   VACA_DLL void copy_string_to(const String& src, Char* dest, int size);
 
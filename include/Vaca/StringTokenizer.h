@@ -0,0 +1,89 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_STRINGTOKENIZER_H
+#define VACA_STRINGTOKENIZER_H
+
+#include "Vaca/base.h"
+#include "Vaca/StringView.h"
+
+namespace Vaca {
+
+/**
+   Splits a string in tokens lazily.
+
+   Each call to #next returns the following token as a StringView
+   over the original string, so no memory is allocated. The string
+   and the separators must live longer than the tokenizer.
+
+   Every separator character ends a token, so consecutive separators
+   produce empty tokens, and a string with @e N separators has @e N+1
+   tokens (like split_string).
+
+   @code
+   StringTokenizer tok(L"a,b;c", L",;");
+   StringView token;
+   while (tok.next(token))
+     ...
+   @endcode
+
+   @see split_string
+*/
+class VACA_DLL StringTokenizer
+{
+  StringView m_string;
+  StringView m_separators;
+  size_t m_pos;
+  bool m_finished;
+
+  // bit set of separators in the range [0, 256)
+  unsigned int m_table[8];
+
+public:
+
+  StringTokenizer(const StringView& string, const StringView& separators);
+
+  bool next(StringView& token);
+  void reset();
+
+  bool isSeparator(Char chr) const {
+    unsigned int code = chr;
+    if (code < 256)
+      return (m_table[code >> 5] & (1u << (code & 31))) != 0;
+    else
+      return m_separators.find(chr) != StringView::npos;
+  }
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_STRINGTOKENIZER_H
@@ -0,0 +1,107 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_STRINGVIEW_H
+#define VACA_STRINGVIEW_H
+
+#include "Vaca/base.h"
+
+#include <cassert>
+#include <cwchar>
+
+namespace Vaca {
+
+/**
+   A non-owning reference to a range of characters.
+
+   A view does not copy the characters, so it is cheap to create and
+   to pass by value, but the referenced string must live longer than
+   the view (and must not be modified while the view is used).
+
+   @see StringTokenizer
+*/
+class VACA_DLL StringView
+{
+  const Char* m_data;
+  size_t m_size;
+
+public:
+
+  typedef const Char* const_iterator;
+
+  static const size_t npos = static_cast<size_t>(-1);
+
+  StringView()
+    : m_data(L""), m_size(0) { }
+
+  StringView(const Char* str)
+    : m_data(str), m_size(std::wcslen(str)) { }
+
+  StringView(const Char* str, size_t size)
+    : m_data(str), m_size(size) { }
+
+  StringView(const String& str)
+    : m_data(str.c_str()), m_size(str.size()) { }
+
+  const Char* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  const_iterator begin() const { return m_data; }
+  const_iterator end() const { return m_data + m_size; }
+
+  Char operator[](size_t index) const {
+    assert(index < m_size);
+    return m_data[index];
+  }
+
+  String str() const { return String(m_data, m_size); }
+
+  StringView substr(size_t pos, size_t count = npos) const;
+  void removePrefix(size_t count);
+  void removeSuffix(size_t count);
+
+  size_t find(Char chr, size_t pos = 0) const;
+  size_t rfind(Char chr, size_t pos = npos) const;
+  size_t find(const StringView& str, size_t pos = 0) const;
+  bool startsWith(const StringView& str) const;
+  bool endsWith(const StringView& str) const;
+
+  int compare(const StringView& str) const;
+  bool operator==(const StringView& str) const;
+  bool operator!=(const StringView& str) const;
+  bool operator<(const StringView& str) const;
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_STRINGVIEW_H
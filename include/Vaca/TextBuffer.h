@@ -0,0 +1,104 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_TEXTBUFFER_H
+#define VACA_TEXTBUFFER_H
+
+#include "Vaca/base.h"
+
+namespace Vaca {
+
+/**
+   A text document which can be modified in O(log n) and copied in
+   O(1).
+
+   The text is stored as a piece table: the characters are appended
+   to immutable blocks of memory, and the document is a balanced tree
+   (a treap) of pieces of those blocks. Each node knows the length
+   and the number of line breaks ('\\n') of its subtree, so it is fast
+   to go from a line number to an offset and vice versa.
+
+   The tree is never modified, a change creates new nodes for the
+   path that was modified, so a copy of a TextBuffer is a snapshot
+   which shares all the memory with the original one (useful to
+   implement undo).
+
+   @warning Snapshots share the memory without synchronization: a
+	    TextBuffer and its copies must be used in the same thread.
+*/
+class VACA_DLL TextBuffer
+{
+public:
+  // Internal data, see TextBuffer.cpp
+  struct Piece;
+  struct Storage;
+
+private:
+  Piece* m_root;
+  Storage* m_storage;
+
+public:
+
+  TextBuffer();
+  explicit TextBuffer(const String& text);
+  TextBuffer(const Char* text, size_t size);
+  TextBuffer(const TextBuffer& other);
+  ~TextBuffer();
+
+  TextBuffer& operator=(const TextBuffer& other);
+
+  size_t size() const;
+  bool empty() const;
+  size_t getLineCount() const;
+
+  Char at(size_t offset) const;
+  String getText() const;
+  String getText(size_t offset, size_t count) const;
+  String getLine(size_t line) const;
+
+  void insert(size_t offset, Char chr);
+  void insert(size_t offset, const String& text);
+  void insert(size_t offset, const Char* text, size_t size);
+  void erase(size_t offset, size_t count);
+  void clear();
+
+  size_t lineFromOffset(size_t offset) const;
+  size_t offsetFromLine(size_t line) const;
+
+private:
+  Piece* createPieces(const Char* text, size_t size);
+  bool extendPiece(size_t offset, const Char* text, size_t size);
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_TEXTBUFFER_H
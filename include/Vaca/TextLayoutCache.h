@@ -0,0 +1,79 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_TEXTLAYOUTCACHE_H
+#define VACA_TEXTLAYOUTCACHE_H
+
+#include "Vaca/base.h"
+
+namespace Vaca {
+
+/**
+   Cache of text measurements used by Graphics#measureString.
+
+   Widgets measure the same strings with the same fonts again and
+   again to calculate their preferred sizes (e.g. Label, LinkLabel,
+   ButtonBase). This cache remembers the size of the last measured
+   strings (using the font, the text, the width to fit in and the
+   flags as the key), and discards the least recently used ones when
+   the memory budget is exhausted.
+
+   The cache is shared by all threads. Its entries for a font are
+   removed when the font's handle is destroyed.
+
+   It is more like a namespace than a class, because all member
+   functions are static.
+
+   @see Graphics#measureString, LruCache
+*/
+class VACA_DLL TextLayoutCache
+{
+public:
+
+  static bool find(HFONT font, const String& text, int fitInWidth, int flags, Size& size);
+  static void insert(HFONT font, const String& text, int fitInWidth, int flags, const Size& size);
+  static void removeFont(HFONT font);
+  static void clear();
+
+  static size_t getMemoryBudget();
+  static void setMemoryBudget(size_t bytes);
+  static size_t getMemoryUsage();
+  static size_t getEntryCount();
+
+  static size_t getHits();
+  static size_t getMisses();
+  static void resetStats();
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_TEXTLAYOUTCACHE_H
@@ -34,7 +34,6 @@
 
 #include "Vaca/base.h"
 #include "Vaca/Exception.h"
-#include "Vaca/Message.h"
 #include "Vaca/NonCopyable.h"
 #include "Vaca/Slot.h"
 
@@ -107,8 +106,10 @@ class VACA_DLL Thread : public NonCopyable
 
 private:
 
-  HANDLE m_handle;
+  class ThreadImpl;
+  ThreadImpl* m_impl;
   ThreadId m_id;
+  MessageQueue* m_queue;
 
 public:
 
@@ -119,7 +120,8 @@ public:
      Creates a new thread running the specified function or functor @a f.
 
      @throw CreateThreadException
-       If the thread couldn't be created by Win32's @c CreateThread.
+       If the thread couldn't be created (by Win32's @c CreateThread
+       or @c pthread_create).
   */
   template<typename F>
   explicit Thread(F f) {
@@ -144,6 +146,25 @@ private:
 
 };
 
+/**
+   Counters of the message loop of a thread.
+
+   @see CurrentThread::getMessageStats
+*/
+struct MessageStats
+{
+  /**
+     Messages taken from the queues of the thread.
+  */
+  unsigned long received;
+
+  /**
+     Messages returned by CurrentThread#getMessage and
+     CurrentThread#peekMessage (the others were coalesced).
+  */
+  unsigned long dispatched;
+};
+
 namespace CurrentThread
 {
   VACA_DLL ThreadId getId();
@@ -161,6 +182,9 @@ namespace CurrentThread
   VACA_DLL bool getMessage(Message& msg);
   VACA_DLL bool peekMessage(Message& msg);
   VACA_DLL void processMessage(Message& msg);
+  VACA_DLL MessageStats getMessageStats();
+
+  VACA_DLL GdiObjectCache& getGdiObjectCache();
 
   namespace details {
     VACA_DLL bool preTranslateMessage(Message& message);
@@ -176,6 +200,7 @@ namespace CurrentThread
 
 namespace details {
   VACA_DLL void removeAllThreadData();
+  VACA_DLL void enqueueCall(ThreadId threadId, Slot0<void>* slot);
 }
 
 } // namespace Vaca
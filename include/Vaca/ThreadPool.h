@@ -0,0 +1,319 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_THREADPOOL_H
+#define VACA_THREADPOOL_H
+
+#include "Vaca/base.h"
+#include "Vaca/ConditionVariable.h"
+#include "Vaca/Exception.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/NonCopyable.h"
+#include "Vaca/Slot.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Vaca {
+
+/**
+   This exception is thrown by Future#get when the task finished
+   throwing an exception.
+
+   The message is the one of the original exception (if it was a
+   Vaca::Exception).
+*/
+class TaskException : public Exception
+{
+public:
+
+  TaskException() : Exception() { }
+  TaskException(const String& message) : Exception(message) { }
+  virtual ~TaskException() throw() { }
+
+};
+
+template<typename R> class Future;
+
+namespace details {
+
+/**
+   @internal
+
+   State of a task shared between the ThreadPool (which runs it) and
+   the Future objects (which wait its result). The references are
+   counted atomically because they are released from different
+   threads.
+*/
+class VACA_DLL TaskState : private NonCopyable
+{
+  volatile long m_refs;
+  ThreadPool* m_pool;
+  Mutex m_mutex;
+  ConditionVariable m_done;
+  volatile bool m_ready;
+  bool m_failed;
+  String m_error;
+  Slot0<void>* m_continuation;
+  ThreadId m_continuationThread;
+
+public:
+
+  TaskState(ThreadPool* pool);
+  virtual ~TaskState();
+
+  void ref();
+  void unref();
+
+  void run();
+  bool isReady() const;
+  void wait();
+  void checkError() const;
+  void setContinuation(Slot0<void>* continuation);
+
+protected:
+  virtual void execute() = 0;
+
+};
+
+template<typename R>
+class TaskValue : public TaskState
+{
+protected:
+  R m_value;
+public:
+  TaskValue(ThreadPool* pool) : TaskState(pool), m_value() { }
+  const R& getValue() const { return m_value; }
+};
+
+template<>
+class TaskValue<void> : public TaskState
+{
+public:
+  TaskValue(ThreadPool* pool) : TaskState(pool) { }
+  void getValue() const { }
+};
+
+template<typename R, typename F>
+class TaskValue_fun : public TaskValue<R>
+{
+  F m_f;
+public:
+  TaskValue_fun(ThreadPool* pool, const F& f) : TaskValue<R>(pool), m_f(f) { }
+protected:
+  virtual void execute() { this->m_value = m_f(); }
+};
+
+template<typename F>
+class TaskValue_fun<void, F> : public TaskValue<void>
+{
+  F m_f;
+public:
+  TaskValue_fun(ThreadPool* pool, const F& f) : TaskValue<void>(pool), m_f(f) { }
+protected:
+  virtual void execute() { m_f(); }
+};
+
+// Calls C with the Future of a finished task
+template<typename R, typename C>
+class Continuation : public Slot0<void>
+{
+  Future<R> m_future;
+  C m_c;
+public:
+  Continuation(const Future<R>& future, const C& c) : m_future(future), m_c(c) { }
+  Continuation(const Continuation& s) : Slot0<void>(s), m_future(s.m_future), m_c(s.m_c) { }
+  void operator()() { m_c(m_future); }
+  Continuation* clone() const { return new Continuation(*this); }
+};
+
+} // namespace details
+
+/**
+   Handle to get the result of a task which was submitted to a
+   ThreadPool.
+
+   Copies of a Future refer to the same task.
+
+   @see ThreadPool#submit
+*/
+template<typename R>
+class Future
+{
+  details::TaskValue<R>* m_state;
+
+public:
+
+  Future() : m_state(NULL) { }
+
+  explicit Future(details::TaskValue<R>* state) : m_state(state) {
+    if (m_state)
+      m_state->ref();
+  }
+
+  Future(const Future& other) : m_state(other.m_state) {
+    if (m_state)
+      m_state->ref();
+  }
+
+  ~Future() {
+    if (m_state)
+      m_state->unref();
+  }
+
+  Future& operator=(const Future& other) {
+    Future copy(other);
+    std::swap(m_state, copy.m_state);
+    return *this;
+  }
+
+  /**
+     Returns true if this Future is associated with a task.
+  */
+  bool isValid() const {
+    return m_state != NULL;
+  }
+
+  /**
+     Returns true if the task has finished (it does not wait).
+  */
+  bool isReady() const {
+    assert(m_state != NULL);
+    return m_state->isReady();
+  }
+
+  /**
+     Waits the task to finish. If it is called from a thread of the
+     pool, that thread runs other tasks meanwhile.
+  */
+  void wait() const {
+    assert(m_state != NULL);
+    m_state->wait();
+  }
+
+  /**
+     Waits the task and returns its result.
+
+     @throw TaskException
+       If the task finished throwing an exception.
+  */
+  R get() const {
+    wait();
+    m_state->checkError();
+    return m_state->getValue();
+  }
+
+  /**
+     Calls @a continuation(future) in the current thread (the UI
+     thread) when the task finishes. The call is enqueued as a
+     message, so it runs in the message loop of this thread (see
+     CurrentThread#doMessageLoop).
+
+     @code
+     void onHashReady(Future<String> future);
+     ...
+     pool.submit<String>(Bind<String>(&hash_file, fileName))
+       .postToUiThread(&onHashReady);
+     @endcode
+  */
+  template<typename C>
+  void postToUiThread(C continuation) const {
+    assert(m_state != NULL);
+    m_state->setContinuation(new details::Continuation<R, C>(*this, continuation));
+  }
+
+};
+
+/**
+   A set of threads to run small tasks.
+
+   Each thread of the pool (worker) has its own double-ended queue of
+   tasks (a Chase-Lev deque): the tasks submitted from a worker are
+   pushed in its queue, and the worker takes them from the same end
+   (the last one first, while it is hot in the cache). When a worker
+   has nothing to do, it steals tasks from the other end of the queue
+   of other worker. Tasks submitted from other threads go to a shared
+   queue.
+
+   The idle workers sleep until a new task is submitted.
+
+   @code
+   ThreadPool pool;
+   Future<int> a = pool.submit<int>(&compute_a);
+   Future<int> b = pool.submit<int>(Bind<int>(&compute_b, 10));
+   int c = a.get() + b.get();
+   @endcode
+
+   @see Future, Thread
+*/
+class VACA_DLL ThreadPool : private NonCopyable
+{
+  class ThreadPoolImpl;
+  ThreadPoolImpl* m_impl;
+
+  friend class details::TaskState;
+
+public:
+
+  explicit ThreadPool(int threads = 0);
+  ~ThreadPool();
+
+  int getThreadCount() const;
+
+  /**
+     Submits the function or functor @a f to be executed in some
+     thread of the pool. @a R is the type that @a f returns.
+
+     @return
+       A Future to wait the result of @a f.
+  */
+  template<typename R, typename F>
+  Future<R> submit(F f) {
+    details::TaskValue<R>* task = new details::TaskValue_fun<R, F>(this, f);
+    Future<R> future(task);
+    enqueue(task);
+    return future;
+  }
+
+  void waitForAll();
+
+  static int getProcessorCount();
+
+private:
+  void enqueue(details::TaskState* task);
+  bool isWorkerThread() const;
+  bool runPendingTask();
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_THREADPOOL_H
@@ -0,0 +1,125 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_TILERENDERER_H
+#define VACA_TILERENDERER_H
+
+#include "Vaca/base.h"
+#include "Vaca/NonCopyable.h"
+#include "Vaca/Signal.h"
+#include "Vaca/Size.h"
+#include "Vaca/Rect.h"
+
+namespace Vaca {
+
+/**
+   Renders big surfaces splitting them in tiles which are painted
+   by a pool of threads.
+
+   The target Image is divided in cache-sized tiles (256x256 pixels
+   by default). The tiles are painted by the thread which calls
+   #render and by the threads of a ThreadPool (created by the first
+   render and reused by the next ones). Each thread uses a tile-sized
+   back buffer, and for each tile it takes from the queue it generates
+   a #Paint event with a Graphics clipped to that tile and with the
+   origin moved so the painter can use the coordinates of the whole
+   image. When the tile is finished, it is composed in the target
+   Image.
+
+   The painter is replayed once per tile, so it should skip the
+   shapes outside the current tile using Graphics#getClipBounds or
+   Graphics#isVisible. In this way each tile only rasterizes the
+   commands that touch it.
+
+   Example:
+   @code
+   void drawChart(Graphics& g)
+   {
+     Rect bounds = g.getClipBounds();
+     for (...each shape...)
+       if (bounds.intersects(shape.getBounds()))
+	 shape.draw(g);
+   }
+
+   Image image(8192, 8192, 32);
+   TileRenderer renderer;
+   renderer.Paint.connect(&drawChart);
+   renderer.render(image);
+   @endcode
+
+   @warning
+     The Paint signal is fired from several threads at the same
+     time, so the painter must not modify shared state without
+     synchronization.
+
+   @see Image, Graphics
+*/
+class VACA_DLL TileRenderer : private NonCopyable
+{
+  Size m_tileSize;
+  int m_threads;
+  ThreadPool* m_pool;
+
+public:
+
+  TileRenderer(const Size& tileSize = Size(256, 256), int threads = 0);
+  virtual ~TileRenderer();
+
+  Size getTileSize() const;
+  void setTileSize(const Size& tileSize);
+
+  int getThreadCount() const;
+  void setThreadCount(int threads);
+
+  void render(Image& image);
+  void render(Image& image, const Rect& bounds);
+
+  static int getProcessorCount();
+
+  // Signals
+  Signal1<void, Graphics&> Paint; ///< @see onPaint
+
+protected:
+
+  // Events
+  virtual void onPaint(Graphics& g);
+
+private:
+
+  class TileQueue;
+  static void render_tiles(TileQueue* queue);
+  ThreadPool* getPool(int workers);
+
+};
+
+} // namespace Vaca
+
+#endif // VACA_TILERENDERER_H
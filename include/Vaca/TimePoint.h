@@ -33,16 +33,18 @@
 #define VACA_TIMEPOINT_H
 
 #include "Vaca/base.h"
+#include "Vaca/Clock.h"
 
 namespace Vaca {
 
 /**
    Class to measure elapsed time, like a chronometer.
+
+   @see Clock
 */
 class VACA_DLL TimePoint
 {
-  LARGE_INTEGER m_point;
-  LARGE_INTEGER m_freq;
+  Nanoseconds m_point;
 
 public:
   TimePoint();
@@ -51,6 +53,7 @@ public:
   void reset();
 
   double elapsed() const;
+  Nanoseconds elapsedNanoseconds() const;
 };
 
 } // namespace Vaca
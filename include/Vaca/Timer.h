@@ -36,9 +36,78 @@
 #include "Vaca/Signal.h"
 #include "Vaca/NonCopyable.h"
 #include "Vaca/Thread.h"
+#include "Vaca/Clock.h"
 
 namespace Vaca {
 
+/**
+   @see TimerPolicy
+*/
+struct TimerPolicyEnum
+{
+  enum enumeration {
+    FireAll,
+    Coalesce,
+    SkipMissed
+  };
+  static const enumeration default_value = FireAll;
+};
+
+/**
+   What a Timer does with the ticks that were accumulated while its
+   thread was busy (without processing messages).
+
+   One of the following values:
+   @li TimerPolicy::FireAll: generates one Tick for each accumulated
+       tick (while they do not take more time than the interval).
+   @li TimerPolicy::Coalesce: generates only one Tick for all the
+       accumulated ticks.
+   @li TimerPolicy::SkipMissed: discards the ticks that are more
+       than one interval late, only on-time ticks are generated.
+
+   @see Timer#setPolicy
+*/
+typedef Enum<TimerPolicyEnum> TimerPolicy;
+
+/**
+   Statistics of the delivery of Tick events of a Timer.
+
+   The lag is the time between the moment a tick was due and the
+   moment it was delivered in the Timer's thread: a big lag means
+   that the thread was stalled.
+
+   @see Timer#getStats
+*/
+struct TimerStats
+{
+  /**
+     Tick events generated.
+  */
+  unsigned long ticks;
+
+  /**
+     Ticks that were discarded by the TimerPolicy.
+  */
+  unsigned long dropped;
+
+  /**
+     Times the Timer's thread received pending ticks (each one is a
+     lag sample).
+  */
+  unsigned long deliveries;
+
+  /**
+     Sum of the lag of all deliveries (divide it by @c deliveries to
+     get the average).
+  */
+  Nanoseconds totalLag;
+
+  /**
+     The biggest lag.
+  */
+  Nanoseconds maxLag;
+};
+
 /**
    Class to schedule events every @e x milliseconds.
 
@@ -57,10 +126,13 @@ class VACA_DLL Timer : private NonCopyable
 
   ThreadId m_threadOwnerId;
   bool m_running : 1;
-  bool m_firstTick : 1;
+  bool m_highPrecision : 1;
+  TimerPolicy m_policy;
   int m_interval;
-  int m_timeCounter;
-  int m_tickCounter;
+  Nanoseconds m_deadline;
+  Nanoseconds m_firstDue;
+  volatile int m_tickCounter;
+  TimerStats m_stats;
 
 public:
 
@@ -72,6 +144,15 @@ public:
 
   bool isRunning();
 
+  bool isHighPrecision();
+  void setHighPrecision(bool state);
+
+  TimerPolicy getPolicy();
+  void setPolicy(TimerPolicy policy);
+
+  TimerStats getStats();
+  void resetStats();
+
   void start();
   void stop();
 
@@ -92,6 +173,7 @@ private:
   static void stop_timer_thread();
   static void remove_timer(Timer* t);
   static void fire_timers_for_thread();
+  void fire_ticks(int ticks, Nanoseconds firstDue);
 
 };
 
@@ -34,6 +34,7 @@
 
 #include "Vaca/base.h"
 #include "Vaca/Component.h"
+#include "Vaca/InternedString.h"
 #include "Vaca/NonCopyable.h"
 
 #include <vector>
@@ -46,20 +47,24 @@ typedef std::vector<TreeNode*> TreeNodeList;
    A TreeView node.  It has a text label, an image, a selected image
    asociated, and a state (collapsed/expanded). A node can be parent
    of sub-TreeNodes.
+
+   The label is an InternedString, so big trees where the same labels
+   are repeated (e.g. the folders of a file system) store each
+   different label only once.
 */
 class VACA_DLL TreeNode : public Component
 {
   friend class TreeView;
   friend class TreeViewIterator;
 
-  String       m_text;
-  int          m_image;
-  int          m_selectedImage;
-  TreeNode*    m_parent;
-  TreeNodeList m_children;
-  HTREEITEM    m_handle;
-  TreeView*    m_owner;
-  bool         m_deleted;
+  InternedString m_text;
+  int            m_image;
+  int            m_selectedImage;
+  TreeNode*      m_parent;
+  TreeNodeList   m_children;
+  HTREEITEM      m_handle;
+  TreeView*      m_owner;
+  bool           m_deleted;
 
 public:
 
@@ -0,0 +1,64 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_UNICODE_H
+#define VACA_UNICODE_H
+
+#include "Vaca/base.h"
+#include <string>
+
+namespace Vaca {
+
+/**
+   @defgroup unicode_utils Unicode Transcoding
+
+   Conversions between UTF-8 and the wide strings of Vaca (String),
+   which are UTF-16 where @c wchar_t has 16 bits (Windows), or UTF-32
+   where it has 32 bits.
+
+   Invalid sequences are replaced with the U+FFFD replacement
+   character (one for each maximal invalid subpart, as the Unicode
+   standard recommends), so the conversions never fail.
+
+   @see to_utf8, from_utf8
+   @{
+*/
+
+  VACA_DLL bool is_valid_utf8(const char* src, size_t len);
+
+  VACA_DLL void utf8_to_wide(const char* src, size_t len, String& dst);
+  VACA_DLL void wide_to_utf8(const Char* src, size_t len, std::string& dst);
+
+/** @} */
+
+} // namespace Vaca
+
+#endif // VACA_UNICODE_H
@@ -0,0 +1,94 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VACA_URL_H
+#define VACA_URL_H
+
+#include "Vaca/base.h"
+#include "Vaca/StringView.h"
+
+namespace Vaca {
+
+/**
+   Splits an URL in its components without copying them.
+
+   An URL like "http://user@www.example.com:8080/path/file.html?q=1#top"
+   is parsed in one pass as:
+   @li getScheme(): "http"
+   @li getUserInfo(): "user"
+   @li getHost(): "www.example.com"
+   @li getPort(): "8080"
+   @li getPath(): "/path/file.html"
+   @li getQuery(): "q=1"
+   @li getFragment(): "top"
+
+   Missing components are empty views. The URL is not validated nor
+   decoded (use decode_url for that), and the parsed string must live
+   longer than the view.
+
+   @see url_host, url_object
+*/
+class VACA_DLL UrlView
+{
+  StringView m_scheme;
+  StringView m_userInfo;
+  StringView m_host;
+  StringView m_port;
+  StringView m_path;
+  StringView m_query;
+  StringView m_fragment;
+
+public:
+
+  UrlView() { }
+  explicit UrlView(const StringView& url) { parse(url); }
+
+  void parse(const StringView& url);
+
+  const StringView& getScheme() const { return m_scheme; }
+  const StringView& getUserInfo() const { return m_userInfo; }
+  const StringView& getHost() const { return m_host; }
+  const StringView& getPort() const { return m_port; }
+  const StringView& getPath() const { return m_path; }
+  const StringView& getQuery() const { return m_query; }
+  const StringView& getFragment() const { return m_fragment; }
+
+  int getPortNumber() const;
+  StringView getObject() const;
+
+};
+
+VACA_DLL size_t encode_url_to(const StringView& src, size_t& pos, Char* dst, size_t size);
+VACA_DLL size_t decode_url_to(const StringView& src, size_t& pos, Char* dst, size_t size);
+
+} // namespace Vaca
+
+#endif // VACA_URL_H
@@ -50,6 +50,7 @@
 #include "Vaca/CheckBox.h"
 #include "Vaca/ClientLayout.h"
 #include "Vaca/Clipboard.h"
+#include "Vaca/Clock.h"
 #include "Vaca/CloseEvent.h"
 #include "Vaca/Color.h"
 #include "Vaca/ColorDialog.h"
@@ -57,6 +58,7 @@
 #include "Vaca/Command.h"
 #include "Vaca/CommandEvent.h"
 #include "Vaca/CommonDialog.h"
+#include "Vaca/CompactString.h"
 #include "Vaca/Component.h"
 #include "Vaca/ConditionVariable.h"
 #include "Vaca/Constraint.h"
@@ -80,15 +82,21 @@
 #include "Vaca/FocusEvent.h"
 #include "Vaca/Font.h"
 #include "Vaca/FontDialog.h"
+#include "Vaca/Format.h"
 #include "Vaca/Frame.h"
 #include "Vaca/GdiObject.h"
+#include "Vaca/GdiObjectCache.h"
+#include "Vaca/Gradient.h"
 #include "Vaca/Graphics.h"
 #include "Vaca/GraphicsPath.h"
 #include "Vaca/GroupBox.h"
+#include "Vaca/HttpBodyReader.h"
+#include "Vaca/HttpClient.h"
 #include "Vaca/HttpRequest.h"
 #include "Vaca/Icon.h"
 #include "Vaca/Image.h"
 #include "Vaca/ImageList.h"
+#include "Vaca/InternedString.h"
 #include "Vaca/KeyEvent.h"
 #include "Vaca/Keys.h"
 #include "Vaca/Label.h"
@@ -99,16 +107,19 @@
 #include "Vaca/ListColumn.h"
 #include "Vaca/ListItem.h"
 #include "Vaca/ListView.h"
+#include "Vaca/LruCache.h"
 #include "Vaca/Mdi.h"
 #include "Vaca/Menu.h"
 #include "Vaca/MenuItemEvent.h"
 #include "Vaca/Message.h"
+#include "Vaca/MessageQueue.h"
 #include "Vaca/MouseEvent.h"
 #include "Vaca/MsgBox.h"
 #include "Vaca/Mutex.h"
 #include "Vaca/NonCopyable.h"
 #include "Vaca/PaintEvent.h"
 #include "Vaca/ParseException.h"
+#include "Vaca/Path.h"
 #include "Vaca/Pen.h"
 #include "Vaca/Point.h"
 #include "Vaca/PreferredSizeEvent.h"
@@ -125,11 +136,13 @@
 #include "Vaca/RichEdit.h"
 #include "Vaca/Scintilla.h"
 #include "Vaca/ScopedLock.h"
+#include "Vaca/ScopedSharedLock.h"
 #include "Vaca/ScrollEvent.h"
 #include "Vaca/ScrollInfo.h"
 #include "Vaca/ScrollableWidget.h"
 #include "Vaca/Separator.h"
 #include "Vaca/SetCursorEvent.h"
+#include "Vaca/SharedMutex.h"
 #include "Vaca/SharedPtr.h"
 #include "Vaca/Signal.h"
 #include "Vaca/Size.h"
@@ -140,11 +153,17 @@
 #include "Vaca/SplitBar.h"
 #include "Vaca/StatusBar.h"
 #include "Vaca/String.h"
+#include "Vaca/StringTokenizer.h"
+#include "Vaca/StringView.h"
 #include "Vaca/Style.h"
 #include "Vaca/System.h"
 #include "Vaca/Tab.h"
+#include "Vaca/TextBuffer.h"
 #include "Vaca/TextEdit.h"
+#include "Vaca/TextLayoutCache.h"
 #include "Vaca/Thread.h"
+#include "Vaca/ThreadPool.h"
+#include "Vaca/TileRenderer.h"
 #include "Vaca/TimePoint.h"
 #include "Vaca/Timer.h"
 #include "Vaca/ToggleButton.h"
@@ -152,6 +171,8 @@
 #include "Vaca/TreeNode.h"
 #include "Vaca/TreeView.h"
 #include "Vaca/TreeViewEvent.h"
+#include "Vaca/Unicode.h"
+#include "Vaca/Url.h"
 #include "Vaca/Vaca.h"
 #include "Vaca/Widget.h"
 #include "Vaca/WidgetClass.h"
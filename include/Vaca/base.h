@@ -426,6 +426,7 @@ class CancelableEvent;
 class CheckBox;
 class ClientLayout;
 class Clipboard;
+class Clock;
 class CloseEvent;
 class Color;
 class ColorDialog;
@@ -434,6 +435,7 @@ class Command;
 class CommandEvent;
 class CommandsClient;
 class CommonDialog;
+class CompactString;
 class Component;
 class ConditionVariable;
 class Constraint;
@@ -455,17 +457,29 @@ class FocusEvent;
 class Font;
 class FontDialog;
 class FontMetrics;
+class FormatArg;
+class FormatException;
 class Frame;
+class GdiObjectCache;
+class GdiObjectKey;
+class Gradient;
 class Graphics;
 class GraphicsPath;
 class GroupBox;
+class HttpBodyReader;
+class HttpClient;
+class HttpClientException;
+class HttpFileWriter;
+class HttpMemoryWriter;
 class HttpRequest;
 class HttpRequestException;
+class HttpResponse;
 class Icon;
 class Image;
 class ImageHandle;
 class ImageList;
 class ImagePixels;
+class InternedString;
 class KeyEvent;
 class Label;
 class Layout;
@@ -486,6 +500,7 @@ class MenuItem;
 class MenuItemEvent;
 class MenuSeparator;
 class Message;
+class MessageQueue;
 class MouseEvent;
 class MsgBox;
 class Mutex;
@@ -493,6 +508,8 @@ class Node;
 class NonCopyable;
 class OpenFileDialog;
 class PaintEvent;
+class PathBuilder;
+class PathView;
 class Pen;
 class Point;
 class PopupMenu;
@@ -511,24 +528,33 @@ class ResourceId;
 class SaveFileDialog;
 class SciEdit;
 class SciRegister;
+class ScopedExclusiveLock;
 class ScopedLock;
+class ScopedSharedLock;
 class ScreenGraphics;
 class ScrollEvent;
 class ScrollInfo;
 class Separator;
 class SetCursorEvent;
+class SharedMutex;
 class Size;
 class Slider;
 class SpinButton;
 class Spinner;
 class SplitBar;
 class StatusBar;
+class StringTokenizer;
+class StringView;
 class System;
 class Tab;
 class TabBase;
 class TabPage;
+class TextBuffer;
 class TextEdit;
+class TextLayoutCache;
 class Thread;
+class ThreadPool;
+class TileRenderer;
 class TimePoint;
 class Timer;
 class ToggleButton;
@@ -539,6 +565,7 @@ class TreeNode;
 class TreeView;
 class TreeViewEvent;
 class TreeViewIterator;
+class UrlView;
 class Widget;
 class WidgetClassName;
 
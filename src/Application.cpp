@@ -96,6 +96,9 @@ Application::~Application()
   Application::m_HINSTANCE = NULL;
   Application::m_instance = NULL;
 
+  // release the pens, brushes and fonts shared in this thread
+  CurrentThread::getGdiObjectCache().clear();
+
 #ifndef NDEBUG
   Referenceable::showLeaks();
 #endif
@@ -30,6 +30,8 @@
 // OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Vaca/Brush.h"
+#include "Vaca/GdiObjectCache.h"
+#include "Vaca/Thread.h"
 
 #if defined(VACA_WINDOWS)
   #include "win32/BrushImpl.h"
@@ -39,9 +41,30 @@
 
 using namespace Vaca;
 
+// Returns the key to share the brushes in the GdiObjectCache.
+static GdiObjectKey make_brush_key(const Color& color)
+{
+  GdiObjectKey key(GdiObjectKey::BrushObject);
+  key.add(color.getR());
+  key.add(color.getG());
+  key.add(color.getB());
+  return key;
+}
+
+/**
+   Creates a black brush.
+*/
 Brush::Brush()
-  : m_impl(new BrushImpl())
 {
+  GdiObjectCache& cache = CurrentThread::getGdiObjectCache();
+  GdiObjectKey key = make_brush_key(Color(0, 0, 0));
+
+  m_impl.reset(static_cast<BrushImpl*>(cache.find(key)));
+  if (!m_impl) {
+    m_impl.reset(new BrushImpl());
+    if (m_impl->isValid())
+      cache.insert(key, m_impl.get());
+  }
 }
 
 Brush::Brush(const Brush& brush)
@@ -49,9 +72,23 @@ Brush::Brush(const Brush& brush)
 {
 }
 
+/**
+   Creates a solid brush.
+
+   If a brush with the same color was created before in this thread,
+   the new one will reference the same handle (see GdiObjectCache).
+*/
 Brush::Brush(const Color& color)
-  : m_impl(new BrushImpl(color))
 {
+  GdiObjectCache& cache = CurrentThread::getGdiObjectCache();
+  GdiObjectKey key = make_brush_key(color);
+
+  m_impl.reset(static_cast<BrushImpl*>(cache.find(key)));
+  if (!m_impl) {
+    m_impl.reset(new BrushImpl(color));
+    if (m_impl->isValid())
+      cache.insert(key, m_impl.get());
+  }
 }
 
 Brush::~Brush()
@@ -0,0 +1,131 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/Clock.h"
+
+#if defined(VACA_ON_WINDOWS)
+  #include <windows.h>
+#else
+  #include <sched.h>
+  #include <time.h>
+  #include <errno.h>
+#endif
+
+using namespace Vaca;
+
+/**
+   Returns the current time of the monotonic clock.
+*/
+Nanoseconds Clock::now()
+{
+#if defined(VACA_ON_WINDOWS)
+  static LONGLONG freq = 0;
+  if (freq == 0) {
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    freq = f.QuadPart;
+  }
+
+  LARGE_INTEGER count;
+  QueryPerformanceCounter(&count);
+
+  // split in seconds and the rest, so "count*1e9" cannot overflow
+  return (count.QuadPart / freq) * 1000000000LL
+    + (count.QuadPart % freq) * 1000000000LL / freq;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<Nanoseconds>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/**
+   Blocks the current thread until the specified time of the clock.
+
+   The OS can wake up the thread a little after the deadline (usually
+   some tens of microseconds, or a full scheduler tick on Windows).
+
+   @param deadline
+     Time to wake up (it is compared with #now).
+
+   @param precise
+     If it is true, the thread sleeps only until #PreciseMargin before
+     the deadline, and then yields the processor until the deadline
+     is reached. It consumes CPU but the error is much less.
+*/
+void Clock::sleepUntil(Nanoseconds deadline, bool precise)
+{
+  for (;;) {
+    Nanoseconds left = deadline - now();
+    if (left <= 0)
+      return;
+
+    if (precise) {
+      if (left <= PreciseMargin) {
+#if defined(VACA_ON_WINDOWS)
+	::SwitchToThread();
+#else
+	sched_yield();
+#endif
+	continue;
+      }
+      left -= PreciseMargin;
+    }
+
+#if defined(VACA_ON_WINDOWS)
+    // round up, in precise mode round down (the rest is spinned)
+    DWORD msecs = static_cast<DWORD>(precise ? left / 1000000LL:
+				     (left + 999999LL) / 1000000LL);
+    ::Sleep(msecs);
+#else
+    struct timespec req;
+    req.tv_sec = static_cast<time_t>(left / 1000000000LL);
+    req.tv_nsec = static_cast<long>(left % 1000000000LL);
+    nanosleep(&req, NULL);
+#endif
+  }
+}
+
+/**
+   Converts an interval in seconds to nanoseconds.
+*/
+Nanoseconds Clock::fromSeconds(double seconds)
+{
+  return static_cast<Nanoseconds>(seconds * 1000000000.0);
+}
+
+/**
+   Converts an interval in nanoseconds to seconds.
+*/
+double Clock::toSeconds(Nanoseconds ns)
+{
+  return static_cast<double>(ns) / 1000000000.0;
+}
@@ -0,0 +1,237 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/CompactString.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#ifdef VACA_ON_WINDOWS
+  #include <windows.h>
+#endif
+
+using namespace Vaca;
+
+typedef CompactString::Char16 Char16;
+
+static inline void add_ref(long* refs)
+{
+#ifdef VACA_ON_WINDOWS
+  InterlockedIncrement(refs);
+#else
+  __sync_add_and_fetch(refs, 1);
+#endif
+}
+
+// Returns the new number of references
+static inline long remove_ref(long* refs)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedDecrement(refs);
+#else
+  return __sync_sub_and_fetch(refs, 1);
+#endif
+}
+
+CompactString::CompactString(const Char* str)
+{
+  assert(str != NULL);
+
+  assignWide(str, std::wcslen(str));
+}
+
+CompactString::CompactString(const String& str)
+{
+  assignWide(str.c_str(), str.size());
+}
+
+/**
+   Creates a string from @a size UTF-16 characters.
+*/
+CompactString::CompactString(const Char16* str, size_t size)
+{
+  std::memcpy(allocate(size), str, size*sizeof(Char16));
+}
+
+/**
+   Copies the other string. It does not allocate memory: long strings
+   are shared.
+*/
+CompactString::CompactString(const CompactString& other)
+{
+  std::memcpy(m_inline, other.m_inline, sizeof(m_inline));
+  if (!isInline())
+    add_ref(&m_buffer->refs);
+}
+
+CompactString::~CompactString()
+{
+  release();
+}
+
+CompactString& CompactString::operator=(const CompactString& other)
+{
+  CompactString copy(other);
+  swap(copy);
+  return *this;
+}
+
+/**
+   Returns the string as a String (converting the UTF-16 surrogate
+   pairs in one character if wchar_t has 32 bits).
+*/
+String CompactString::str() const
+{
+  const Char16* src = data();
+  size_t len = size();
+
+  if (sizeof(Char) == sizeof(Char16))
+    return String(reinterpret_cast<const Char*>(src), len);
+
+  String res;
+  res.reserve(len);
+
+  for (size_t i=0; i<len; ++i) {
+    unsigned int chr = src[i];
+    if (chr >= 0xD800 && chr <= 0xDBFF && i+1 < len &&
+	src[i+1] >= 0xDC00 && src[i+1] <= 0xDFFF) {
+      chr = 0x10000 + ((chr - 0xD800) << 10) + (src[i+1] - 0xDC00);
+      ++i;
+    }
+    res.push_back(static_cast<Char>(chr));
+  }
+  return res;
+}
+
+void CompactString::swap(CompactString& other)
+{
+  Char16 tmp[16];
+  std::memcpy(tmp, m_inline, sizeof(m_inline));
+  std::memcpy(m_inline, other.m_inline, sizeof(m_inline));
+  std::memcpy(other.m_inline, tmp, sizeof(m_inline));
+}
+
+/**
+   Compares the UTF-16 characters of both strings.
+
+   @return A negative value if this string goes before @a other, zero
+	   if they are equal, or a positive value otherwise.
+*/
+int CompactString::compare(const CompactString& other) const
+{
+  const Char16* a = data();
+  const Char16* b = other.data();
+  size_t n = std::min(size(), other.size());
+
+  for (size_t i=0; i<n; ++i)
+    if (a[i] != b[i])
+      return a[i] < b[i] ? -1: 1;
+
+  return size() < other.size() ? -1: (size() > other.size() ? 1: 0);
+}
+
+bool CompactString::operator==(const CompactString& other) const
+{
+  size_t n = size();
+  if (n != other.size())
+    return false;
+
+  const Char16* a = data();
+  const Char16* b = other.data();
+  return a == b || std::memcmp(a, b, n*sizeof(Char16)) == 0;
+}
+
+/**
+   Prepares the storage for @a size characters (inline or in a new
+   buffer) and returns where they must be written. The null
+   terminator is already set.
+
+   @internal
+*/
+Char16* CompactString::allocate(size_t size)
+{
+  if (size <= InlineCapacity) {
+    m_inline[Tag] = static_cast<Char16>(size);
+    m_inline[size] = 0;
+    return m_inline;
+  }
+
+  Buffer* buffer = static_cast<Buffer*>(::operator new(sizeof(Buffer) + size*sizeof(Char16)));
+  buffer->refs = 1;
+  buffer->size = size;
+  buffer->data[size] = 0;
+
+  m_buffer = buffer;
+  m_inline[Tag] = HeapTag;
+  return buffer->data;
+}
+
+/**
+   Converts @a size wide characters to UTF-16.
+
+   @internal
+*/
+void CompactString::assignWide(const Char* str, size_t size)
+{
+  if (sizeof(Char) == sizeof(Char16)) {
+    std::memcpy(allocate(size), str, size*sizeof(Char16));
+    return;
+  }
+
+  // characters out of the BMP need a surrogate pair
+  size_t len = size;
+  for (size_t i=0; i<size; ++i)
+    if (static_cast<unsigned int>(str[i]) > 0xFFFF &&
+	static_cast<unsigned int>(str[i]) <= 0x10FFFF)
+      ++len;
+
+  Char16* dst = allocate(len);
+
+  for (size_t i=0; i<size; ++i) {
+    unsigned int chr = static_cast<unsigned int>(str[i]);
+    if (chr <= 0xFFFF)
+      *dst++ = static_cast<Char16>(chr);
+    else if (chr <= 0x10FFFF) {
+      chr -= 0x10000;
+      *dst++ = static_cast<Char16>(0xD800 + (chr >> 10));
+      *dst++ = static_cast<Char16>(0xDC00 + (chr & 0x3FF));
+    }
+    else
+      *dst++ = 0xFFFD;
+  }
+}
+
+void CompactString::release()
+{
+  if (!isInline() && remove_ref(&m_buffer->refs) == 0)
+    ::operator delete(m_buffer);
+}
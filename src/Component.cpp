@@ -60,9 +60,22 @@ Component::~Component()
   VACA_TRACE("delete Component (%p)\n", this);
 }
 
+// Looks for the property without adding the name to the pool of
+// interned strings: if the name is not in the pool, no component has
+// a property with that name.
+static Component::Properties::iterator find_property(Component::Properties& properties,
+						     const String& name)
+{
+  InternedString key;
+  if (InternedString::find(name, key))
+    return properties.find(key);
+  else
+    return properties.end();
+}
+
 PropertyPtr Component::getProperty(const String& name)
 {
-  Properties::iterator it = m_properties.find(name);
+  Properties::iterator it = find_property(m_properties, name);
   if (it != m_properties.end())
     return it->second;
   else
@@ -71,22 +84,25 @@ PropertyPtr Component::getProperty(const String& name)
 
 void Component::setProperty(PropertyPtr property)
 {
-  m_properties[property->getName()] = property;
+  m_properties[property->getInternedName()] = property;
 }
 
 bool Component::hasProperty(const String& name)
 {
-  Properties::iterator it = m_properties.find(name);
+  Properties::iterator it = find_property(m_properties, name);
   return it != m_properties.end();
 }
 
 void Component::removeProperty(const String& name)
 {
-  Properties::iterator it = m_properties.find(name);
+  Properties::iterator it = find_property(m_properties, name);
   if (it != m_properties.end())
     m_properties.erase(it);
 }
 
+/**
+   Returns the properties of the component sorted by name.
+*/
 const Component::Properties& Component::getProperties() const
 {
   return m_properties;
@@ -36,22 +36,17 @@
 #include "Vaca/ConditionVariable.h"
 #include "Vaca/ScopedLock.h"
 
-#include <limits>
+#if defined(VACA_ON_WINDOWS)
+  #include "win32/ConditionVariableImpl.h"
+#elif defined(VACA_ON_UNIXLIKE)
+  #include "unix/MutexImpl.h"
+  #include "unix/ConditionVariableImpl.h"
+#else
+  #error Your platform does not support condition variables
+#endif
 
 using namespace Vaca;
 
-class ScopedUnlock : private NonCopyable
-{
-  ScopedLock& m_lock;
-public:
-  ScopedUnlock(ScopedLock& lock) : m_lock(lock) {
-    m_lock.getMutex().unlock();
-  }
-  ~ScopedUnlock() {
-    m_lock.getMutex().lock();
-  }
-};
-
 /**
    Creates a new ConditionVariable.
 
@@ -59,195 +54,69 @@ public:
      If the creation of the ConditionVariable fails.
 */
 ConditionVariable::ConditionVariable()
-  : m_gone(0)
-  , m_blocked(0)
-  , m_waiting(0)
 {
-  m_gate = CreateSemaphore(0, 1, 1, NULL);
-  m_queue = CreateSemaphore(0, 0, (std::numeric_limits<long>::max)(), NULL);
-  m_mutex = CreateMutex(0, 0, NULL);
-
-  if (!m_gate || !m_queue || !m_mutex) {
-    if (m_gate) CloseHandle(m_gate);
-    if (m_queue) CloseHandle(m_queue);
-    if (m_mutex) CloseHandle(m_mutex);
-    throw CreateConditionVariableException();
-  }
+  m_impl = new ConditionVariableImpl();
 }
 
 ConditionVariable::~ConditionVariable()
 {
-  CloseHandle(m_gate);
-  CloseHandle(m_queue);
-  CloseHandle(m_mutex);
+  delete m_impl;
 }
 
+/**
+   Wakes up one of the threads waiting this condition (if there is
+   one).
+*/
 void ConditionVariable::notifyOne()
 {
-  unsigned signals = 0;
-
-  WaitForSingleObject(m_mutex, INFINITE);
-  if (m_waiting != 0) { // the m_gate is already closed
-    if (m_blocked == 0) {
-      ReleaseMutex(m_mutex);
-      return;
-    }
-
-    ++m_waiting;
-    --m_blocked;
-    signals = 1;
-  }
-  else {
-    WaitForSingleObject(m_gate, INFINITE);
-    if (m_blocked > m_gone) {
-      if (m_gone != 0) {
-	m_blocked -= m_gone;
-	m_gone = 0;
-      }
-      signals = m_waiting = 1;
-      --m_blocked;
-    }
-    else
-      ReleaseSemaphore(m_gate, 1, 0);
-  }
-
-  ReleaseMutex(m_mutex);
-  if (signals)
-    ReleaseSemaphore(m_queue, signals, 0);
+  m_impl->notifyOne();
 }
 
+/**
+   Wakes up all the threads waiting this condition.
+*/
 void ConditionVariable::notifyAll()
 {
-  unsigned signals = 0;
-
-  WaitForSingleObject(m_mutex, INFINITE);
-  if (m_waiting != 0) { // the m_gate is already closed
-    if (m_blocked == 0) {
-      ReleaseMutex(m_mutex);
-      return;
-    }
-
-    m_waiting += (signals = m_blocked);
-    m_blocked = 0;
-  }
-  else {
-    WaitForSingleObject(m_gate, INFINITE);
-    if (m_blocked > m_gone) {
-      if (m_gone != 0) {
-	m_blocked -= m_gone;
-	m_gone = 0;
-      }
-      signals = m_waiting = m_blocked;
-      m_blocked = 0;
-    }
-    else
-      ReleaseSemaphore(m_gate, 1, 0);
-  }
-
-  ReleaseMutex(m_mutex);
-  if (signals)
-    ReleaseSemaphore(m_queue, signals, 0);
+  m_impl->notifyAll();
 }
 
+/**
+   Unlocks the mutex held by @a lock and waits a notification. The
+   mutex is locked again before returning.
+
+   It can return without a notification (spurious wake-up), so you
+   should check your condition in a loop (or use the overload that
+   receives a predicate).
+*/
 void ConditionVariable::wait(ScopedLock& lock)
 {
-  enterWait();
-  ScopedUnlock unlock(lock);
-
-  WaitForSingleObject(m_queue, INFINITE);
-
-  unsigned was_waiting = 0;
-  unsigned was_gone = 0;
-
-  WaitForSingleObject(m_mutex, INFINITE);
-  was_waiting = m_waiting;
-  was_gone = m_gone;
-  if (was_waiting != 0) {
-    if (--m_waiting == 0) {
-      if (m_blocked != 0) {
-	ReleaseSemaphore(m_gate, 1, 0); // open m_gate
-	was_waiting = 0;
-      }
-      else if (m_gone != 0)
-	m_gone = 0;
-    }
-  }
-  else if (++m_gone == ((std::numeric_limits<unsigned>::max)() / 2)) {
-    // timeout occured, normalize the m_gone count
-    // this may occur if many calls to wait with a timeout are made and
-    // no call to notify_* is made
-    WaitForSingleObject(m_gate, INFINITE);
-    m_blocked -= m_gone;
-    ReleaseSemaphore(m_gate, 1, 0);
-    m_gone = 0;
-  }
-  ReleaseMutex(m_mutex);
-
-  if (was_waiting == 1) {
-    for (; was_gone; --was_gone) {
-      // better now than spurious later
-      WaitForSingleObject(m_queue, INFINITE);
-    }
-    ReleaseSemaphore(m_gate, 1, 0);
-  }
+  m_impl->wait(lock);
 }
 
+/**
+   Like #wait but waits @a seconds as maximum.
+
+   @return
+     False if the time-out elapsed.
+
+   @see waitUntil
+*/
 bool ConditionVariable::waitFor(ScopedLock& lock, double seconds)
 {
-  enterWait();
-  ScopedUnlock unlock(lock);
-
-  int milliseconds = static_cast<int>(seconds*1000.0);
-
-  bool ret = (WaitForSingleObject(m_queue, milliseconds) == WAIT_OBJECT_0);
-
-  unsigned was_waiting = 0;
-  unsigned was_gone = 0;
-
-  WaitForSingleObject(m_mutex, INFINITE);
-  was_waiting = m_waiting;
-  was_gone = m_gone;
-  if (was_waiting != 0) {
-    if (!ret) { // timeout
-      if (m_blocked != 0)
-	--m_blocked;
-      else
-	++m_gone; // count spurious wakeups
-    }
-    if (--m_waiting == 0) {
-      if (m_blocked != 0) {
-	ReleaseSemaphore(m_gate, 1, 0); // open m_gate
-	was_waiting = 0;
-      }
-      else if (m_gone != 0)
-	m_gone = 0;
-    }
-  }
-  else if (++m_gone == ((std::numeric_limits<unsigned>::max)() / 2)) {
-    // timeout occured, normalize the m_gone count
-    // this may occur if many calls to wait with a timeout are made and
-    // no call to notify_* is made
-    WaitForSingleObject(m_gate, INFINITE);
-    m_blocked -= m_gone;
-    ReleaseSemaphore(m_gate, 1, 0);
-    m_gone = 0;
-  }
-  ReleaseMutex(m_mutex);
-
-  if (was_waiting == 1) {
-    for (; was_gone; --was_gone) {
-      // better now than spurious later
-      WaitForSingleObject(m_queue, INFINITE);
-    }
-    ReleaseSemaphore(m_gate, 1, 0);
-  }
-
-  return ret;
+  return m_impl->waitUntil(lock, Clock::now() + Clock::fromSeconds(seconds));
 }
 
-void ConditionVariable::enterWait()
+/**
+   Like #wait but waits until the Clock reaches the @a deadline as
+   maximum.
+
+   On POSIX systems it waits using the @c CLOCK_MONOTONIC clock, so
+   it is not affected by changes to the system time.
+
+   @return
+     False if the time-out elapsed.
+*/
+bool ConditionVariable::waitUntil(ScopedLock& lock, Nanoseconds deadline)
 {
-  WaitForSingleObject(m_gate, INFINITE);
-  ++m_blocked;
-  ReleaseSemaphore(m_gate, 1, 0);
+  return m_impl->waitUntil(lock, deadline);
 }
@@ -32,6 +32,7 @@
 #include "Vaca/Cursor.h"
 #include "Vaca/Application.h"
 #include "Vaca/Debug.h"
+#include "Vaca/Format.h"
 #include "Vaca/ResourceException.h"
 #include "Vaca/String.h"
 
@@ -103,7 +104,7 @@ Cursor::Cursor(SysCursor cursor)
 
   HCURSOR handle = ::LoadCursor(NULL, winCursor);
   if (handle == NULL)
-    throw ResourceException(format_string(L"Can't load the SysCursor %d", int(cursor)));
+    throw ResourceException(format_text(L"Can't load the SysCursor {}", int(cursor)));
 
   get()->setHandle(handle);
 }
@@ -32,9 +32,9 @@
 #include "Vaca/Debug.h"
 #include "Vaca/Mutex.h"
 #include "Vaca/ScopedLock.h"
-#include "Vaca/System.h"
 #include "Vaca/Thread.h"
 
+#include <cstdarg>
 #include <cstdio>
 
 using namespace std;
@@ -77,7 +77,7 @@ void Vaca::details::trace(const char* filename, size_t line, const char* fmt, ..
   va_end(ap);
 
   fprintf(dbg->file, "%s:%d: [%d] %s", filename, line,
-	  static_cast<unsigned>(::GetCurrentThreadId()), buf);
+	  static_cast<unsigned>(CurrentThread::getId()), buf);
   fflush(dbg->file);
 #endif
 }
@@ -32,8 +32,15 @@
 #include "Vaca/Exception.h"
 #include "Vaca/String.h"
 
-#include <lmerr.h>
-#include <wininet.h>
+#if defined(VACA_ON_WINDOWS)
+  #include <lmerr.h>
+  #include <wininet.h>
+#else
+  #include "Vaca/Unicode.h"
+  #include <cerrno>
+  #include <cstdio>
+  #include <cstring>
+#endif
 
 using namespace Vaca;
 
@@ -89,6 +96,7 @@ int Exception::getErrorCode() const
 
 void Exception::initialize()
 {
+#if defined(VACA_ON_WINDOWS)
   HMODULE hmodule = NULL;
   DWORD flags =
     FORMAT_MESSAGE_ALLOCATE_BUFFER |
@@ -133,4 +141,19 @@ void Exception::initialize()
     LocalFree(msgbuf);
   }
   m_what += convert_to<std::string>(m_message);
+#else
+  m_errorCode = errno;
+
+  char buf[32];
+  std::sprintf(buf, "%d - ", m_errorCode);
+  m_what += buf;
+  if (m_errorCode != 0) {
+    m_what += std::strerror(m_errorCode);
+    m_what += "\n";
+  }
+
+  std::string message;
+  wide_to_utf8(m_message.c_str(), m_message.size(), message);
+  m_what += message;
+#endif
 }
@@ -31,16 +31,42 @@
 
 #include "Vaca/Font.h"
 #include "Vaca/Debug.h"
+#include "Vaca/GdiObjectCache.h"
 #include "Vaca/Graphics.h"
 #include "Vaca/String.h"
+#include "Vaca/TextLayoutCache.h"
+#include "Vaca/Thread.h"
 
 using namespace Vaca;
 
+#define GdiObj GdiObject<HFONT, Win32DestroyFont>
+
+/**
+   Removes the cached measures of the font (see TextLayoutCache)
+   and deletes the handle calling Win32's DeleteObject.
+
+   Stock fonts are never deleted, so their measures are kept.
+*/
+void Win32DestroyFont::destroy(HFONT handle)
+{
+  static const int stockFonts[] = { OEM_FIXED_FONT, ANSI_FIXED_FONT,
+				    ANSI_VAR_FONT, SYSTEM_FONT,
+				    DEVICE_DEFAULT_FONT, SYSTEM_FIXED_FONT,
+				    DEFAULT_GUI_FONT };
+
+  for (size_t i=0; i<sizeof(stockFonts)/sizeof(stockFonts[0]); ++i)
+    if (reinterpret_cast<HGDIOBJ>(handle) == GetStockObject(stockFonts[i]))
+      return;
+
+  TextLayoutCache::removeFont(handle);
+  ::DeleteObject(handle);
+}
+
 /**
    Constructs the default font.
 */
 Font::Font()
-  : SharedPtr<GdiObject<HFONT> >(new GdiObject<HFONT>(reinterpret_cast<HFONT>(GetStockObject(DEFAULT_GUI_FONT))))
+  : SharedPtr<GdiObj>(new GdiObj(reinterpret_cast<HFONT>(GetStockObject(DEFAULT_GUI_FONT))))
 {
 }
 
@@ -48,7 +74,7 @@ Font::Font()
    Makes a reference to the specified font.
 */
 Font::Font(const Font& font)
-  : SharedPtr<GdiObject<HFONT> >(font)
+  : SharedPtr<GdiObj>(font)
 {
 }
 
@@ -96,7 +122,7 @@ Font::Font(String familyName, int size, FontStyle style)
    Wrapper constructor for HFONT.
 */
 Font::Font(HFONT hfont)
-  : SharedPtr<GdiObject<HFONT> >(new GdiObject<HFONT>(hfont))
+  : SharedPtr<GdiObj>(new GdiObj(hfont))
 {
 }
 
@@ -144,13 +170,40 @@ FontStyle Font::getStyle() const
 */
 Font& Font::operator=(const Font& font)
 {
-  SharedPtr<GdiObject<HFONT> >::operator=(font);
+  SharedPtr<GdiObj>::operator=(font);
   return *this;
 }
 
+/**
+   Creates the font for the specified @a lplf attributes, or uses
+   the one created before in this thread with the same attributes
+   (see GdiObjectCache).
+*/
 void Font::assign(LPLOGFONT lplf)
 {
-  SharedPtr<GdiObject<HFONT> >::operator=(Font(CreateFontIndirect(lplf)));
+  GdiObjectCache& cache = CurrentThread::getGdiObjectCache();
+  GdiObjectKey key(GdiObjectKey::FontObject);
+  key.add(lplf->lfHeight);
+  key.add(lplf->lfWidth);
+  key.add(lplf->lfEscapement);
+  key.add(lplf->lfOrientation);
+  key.add(lplf->lfWeight);
+  key.add(lplf->lfItalic);
+  key.add(lplf->lfUnderline);
+  key.add(lplf->lfStrikeOut);
+  key.add(lplf->lfCharSet);
+  key.add(lplf->lfOutPrecision);
+  key.add(lplf->lfClipPrecision);
+  key.add(lplf->lfQuality);
+  key.add(lplf->lfPitchAndFamily);
+  key.add(lplf->lfFaceName);
+
+  reset(static_cast<GdiObj*>(cache.find(key)));
+  if (!get()) {
+    reset(new GdiObj(CreateFontIndirect(lplf)));
+    if (get()->isValid())
+      cache.insert(key, get());
+  }
 }
 
 HFONT Font::getHandle() const
@@ -0,0 +1,388 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/Format.h"
+#include "Vaca/String.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cwchar>
+
+using namespace Vaca;
+
+namespace {
+
+enum { FormatBufferSize = 256 };
+
+/**
+   Collects the output of vformat_append in a stack buffer, so a
+   typical UI string reaches the destination with just one append
+   (i.e. one allocation of the exact size).
+
+   @internal
+*/
+class FormatWriter
+{
+  String& m_dst;
+  Char m_buf[FormatBufferSize];
+  size_t m_len;
+
+public:
+
+  FormatWriter(String& dst) : m_dst(dst), m_len(0) { }
+
+  void write(const Char* str, size_t size)
+  {
+    if (m_len + size <= FormatBufferSize) {
+      std::wmemcpy(m_buf + m_len, str, size);
+      m_len += size;
+    }
+    else {
+      flush();
+      if (size <= FormatBufferSize) {
+	std::wmemcpy(m_buf, str, size);
+	m_len = size;
+      }
+      else
+	m_dst.append(str, size);
+    }
+  }
+
+  void fill(Char chr, size_t count)
+  {
+    while (count > 0) {
+      if (m_len == FormatBufferSize)
+	flush();
+
+      size_t n = std::min<size_t>(count, FormatBufferSize - m_len);
+      std::wmemset(m_buf + m_len, chr, n);
+      m_len += n;
+      count -= n;
+    }
+  }
+
+  void flush()
+  {
+    m_dst.append(m_buf, m_len);
+    m_len = 0;
+  }
+
+};
+
+/**
+   The parsed "[[fill]align][0][width][.precision][type]" part of a
+   replacement field.
+
+   @internal
+*/
+struct FormatSpec
+{
+  Char fill;
+  Char align;			// 0, '<', '>' or '^'
+  bool zero;
+  size_t width;
+  int precision;		// -1 if it was not specified
+  Char type;			// 0, 'x', 'X', 'f' or 'e'
+};
+
+void throw_format_error(const Char* msg, const Char* fmt, const Char* pos)
+{
+  throw FormatException(String(msg) +
+			L" at index " + convert_to<String>(static_cast<int>(pos - fmt)) +
+			L" of \"" + fmt + L"\"");
+}
+
+bool is_digit(Char chr)
+{
+  return chr >= L'0' && chr <= L'9';
+}
+
+size_t parse_size(const Char*& p)
+{
+  size_t value = 0;
+  while (is_digit(*p) && value < 0x10000)
+    value = value*10 + (*p++ - L'0');
+  return value;
+}
+
+const Char* parse_spec(const Char* fmt, const Char* p, FormatSpec& spec)
+{
+  spec.fill = L' ';
+  spec.align = 0;
+  spec.zero = false;
+  spec.width = 0;
+  spec.precision = -1;
+  spec.type = 0;
+
+  if (*p == L':') {
+    ++p;
+
+    if (*p != 0 && *p != L'}' && (p[1] == L'<' || p[1] == L'>' || p[1] == L'^')) {
+      spec.fill = *p;
+      spec.align = p[1];
+      p += 2;
+    }
+    else if (*p == L'<' || *p == L'>' || *p == L'^')
+      spec.align = *p++;
+
+    if (*p == L'0') {
+      spec.zero = true;
+      ++p;
+    }
+
+    spec.width = parse_size(p);
+
+    if (*p == L'.') {
+      ++p;
+      if (!is_digit(*p))
+	throw_format_error(L"Expected a precision", fmt, p);
+      spec.precision = static_cast<int>(parse_size(p));
+      if (spec.precision > 64)
+	throw_format_error(L"Precision too large", fmt, p);
+    }
+
+    if (*p == L'x' || *p == L'X' || *p == L'f' || *p == L'e')
+      spec.type = *p++;
+  }
+
+  if (*p != L'}')
+    throw_format_error(L"Invalid format specification", fmt, p);
+
+  return p+1;
+}
+
+template<typename T>
+int format_hex(T value, bool upper, Char* buf)
+{
+  const Char* digits = upper ? L"0123456789ABCDEF": L"0123456789abcdef";
+  Char tmp[sizeof(T)*2];
+  int n = 0;
+  do {
+    tmp[n++] = digits[value & 15];
+    value >>= 4;
+  } while (value != 0);
+
+  for (int i=0; i<n; ++i)
+    buf[i] = tmp[n-1-i];
+  return n;
+}
+
+void write_arg(FormatWriter& out, const FormatArg& arg, const FormatSpec& spec,
+	       const Char* fmt, const Char* pos)
+{
+  // big enough for DBL_MAX with 64 decimals
+  Char buf[400];
+  const Char* str = buf;
+  size_t len = 0;
+  bool numeric = true;
+
+  switch (arg.getType()) {
+
+    case FormatArg::SignedType:
+    case FormatArg::UnsignedType:
+      if (spec.type == L'x' || spec.type == L'X') {
+	if (arg.getType() == FormatArg::UnsignedType)
+	  len = format_hex(arg.getUnsigned(), spec.type == L'X', buf);
+	else if (arg.getSigned() < 0) {
+	  buf[0] = L'-';
+	  len = 1 + format_hex(0ull - static_cast<unsigned long long>(arg.getSigned()),
+			       spec.type == L'X', buf+1);
+	}
+	else
+	  len = format_hex(static_cast<unsigned long long>(arg.getSigned()),
+			   spec.type == L'X', buf);
+      }
+      else if (spec.type != 0 || spec.precision >= 0)
+	throw_format_error(L"Invalid format for an integer", fmt, pos);
+      else if (arg.getType() == FormatArg::UnsignedType)
+	len = format_number(arg.getUnsigned(), buf, NumberBufferSize);
+      else
+	len = format_number(arg.getSigned(), buf, NumberBufferSize);
+      break;
+
+    case FormatArg::FloatType:
+    case FormatArg::DoubleType: {
+      double value = (arg.getType() == FormatArg::FloatType ? arg.getFloat():
+							       arg.getDouble());
+      if (spec.type == L'x' || spec.type == L'X')
+	throw_format_error(L"Invalid format for a floating point number", fmt, pos);
+
+      // NaN and infinities are always written as "nan" and "inf"
+      if ((spec.type != 0 || spec.precision >= 0) && value - value == 0.0)
+	len = format_number(value,
+			    spec.type != 0 ? spec.type: L'f',
+			    spec.precision >= 0 ? spec.precision: 6,
+			    buf, sizeof(buf) / sizeof(Char));
+
+      if (len == 0) {
+	if (arg.getType() == FormatArg::FloatType)
+	  len = format_number(arg.getFloat(), buf, NumberBufferSize);
+	else
+	  len = format_number(arg.getDouble(), buf, NumberBufferSize);
+      }
+      break;
+    }
+
+    case FormatArg::CharType:
+    case FormatArg::BoolType:
+    case FormatArg::StringType:
+      if (spec.type != 0 || spec.zero)
+	throw_format_error(L"Invalid format for a string", fmt, pos);
+
+      numeric = false;
+      if (arg.getType() == FormatArg::CharType) {
+	buf[0] = arg.getChar();
+	len = 1;
+      }
+      else if (arg.getType() == FormatArg::BoolType) {
+	str = arg.getBool() ? L"true": L"false";
+	len = arg.getBool() ? 4: 5;
+      }
+      else {
+	StringView view = arg.getString();
+	str = view.data();
+	len = view.size();
+	if (spec.precision >= 0)
+	  len = std::min<size_t>(len, spec.precision);
+      }
+      break;
+  }
+
+  if (len >= spec.width) {
+    out.write(str, len);
+    return;
+  }
+
+  size_t padding = spec.width - len;
+
+  // zero padding goes between the sign and the digits
+  if (numeric && spec.zero && spec.align == 0) {
+    if (*str == L'-') {
+      out.write(str++, 1);
+      --len;
+    }
+    out.fill(L'0', padding);
+    out.write(str, len);
+    return;
+  }
+
+  Char align = spec.align != 0 ? spec.align: (numeric ? L'>': L'<');
+  size_t before = (align == L'>' ? padding:
+		   align == L'^' ? padding/2: 0);
+
+  out.fill(spec.fill, before);
+  out.write(str, len);
+  out.fill(spec.fill, padding - before);
+}
+
+} // anonymous namespace
+
+/**
+   Appends to @a dst the @a fmt string replacing each "{}" with the
+   next argument of @a args (or "{n}" with the @a n th argument,
+   starting from zero). Use "{{" and "}}" to write literal braces.
+
+   A replacement field can specify a format after a colon:
+   "{:[[fill]align][0][width][.precision][type]}". The @a align can be
+   '<', '>' or '^' (numbers are right aligned and strings left aligned
+   by default), a '0' pads numbers with zeros after the sign, and the
+   @a type can be 'x' or 'X' for hexadecimal integers, or 'f' and 'e'
+   for fixed and scientific notation of floating point numbers (with a
+   @a precision of 6 by default). For strings, the @a precision is the
+   maximum number of characters to write.
+
+   Numbers are formatted with format_number, so they are locale
+   independent and (without a precision) round trip.
+
+   The output is collected in a stack buffer, so @a dst is grown once
+   for typical strings, and nothing else is allocated.
+
+   Usually you call it through the format_append and format_text
+   overloads:
+   @code
+   String title = format_text(L"{} - {} ({:.1f}%)", fileName, appName, progress);
+   @endcode
+
+   @throw FormatException
+     If @a fmt is ill-formed, or a field uses an argument that was not
+     given, or a format that is not valid for the argument type.
+*/
+void Vaca::vformat_append(String& dst, const Char* fmt, const FormatArg* args, int count)
+{
+  assert(fmt != NULL);
+
+  FormatWriter out(dst);
+  const Char* p = fmt;
+  int next = 0;
+
+  while (*p != 0) {
+    // literal text
+    const Char* start = p;
+    while (*p != 0 && *p != L'{' && *p != L'}')
+      ++p;
+    if (p != start)
+      out.write(start, p - start);
+
+    if (*p == 0)
+      break;
+
+    if (*p == L'}') {
+      if (p[1] != L'}')
+	throw_format_error(L"Unmatched '}'", fmt, p);
+      out.write(p, 1);
+      p += 2;
+      continue;
+    }
+
+    if (p[1] == L'{') {
+      out.write(p, 1);
+      p += 2;
+      continue;
+    }
+
+    // replacement field
+    const Char* field = p++;
+    int index;
+    if (is_digit(*p))
+      index = static_cast<int>(parse_size(p));
+    else
+      index = next++;
+
+    if (index >= count)
+      throw_format_error(L"Argument index out of range", fmt, field);
+
+    FormatSpec spec;
+    p = parse_spec(fmt, p, spec);
+    write_arg(out, args[index], spec, fmt, field);
+  }
+
+  out.flush();
+}
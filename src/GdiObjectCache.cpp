@@ -0,0 +1,164 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/GdiObjectCache.h"
+
+using namespace Vaca;
+
+// default number of objects in the cache of each thread
+#define DEFAULT_CAPACITY	64
+
+// ======================================================================
+// GdiObjectKey
+
+GdiObjectKey::GdiObjectKey(Type type)
+{
+  m_data.reserve(16);
+  m_data.push_back(type);
+}
+
+void GdiObjectKey::add(int value)
+{
+  m_data.push_back(value);
+}
+
+/**
+   Adds a string to the key (e.g. the face name of a font).
+*/
+void GdiObjectKey::add(const Char* str)
+{
+  for (; *str; ++str)
+    m_data.push_back(*str);
+
+  m_data.push_back(0);
+}
+
+bool GdiObjectKey::operator<(const GdiObjectKey& other) const
+{
+  return m_data < other.m_data;
+}
+
+// ======================================================================
+// GdiObjectCache
+
+GdiObjectCache::GdiObjectCache()
+  : m_cache(DEFAULT_CAPACITY)
+  , m_createdObjects(0)
+{
+}
+
+GdiObjectCache::~GdiObjectCache()
+{
+}
+
+/**
+   Returns the object created with the attributes of @a key, or NULL
+   if it is not in the cache.
+*/
+Referenceable* GdiObjectCache::find(const GdiObjectKey& key)
+{
+  SharedPtr<Referenceable>* object = m_cache.find(key);
+  return object ? object->get(): NULL;
+}
+
+/**
+   Adds a new created object to the cache.
+
+   The cache keeps a reference to the @a object, so it is not
+   destroyed until it is evicted from the cache.
+
+   @param object
+     A new object which must be referenced by a SharedPtr of the
+     caller.
+*/
+void GdiObjectCache::insert(const GdiObjectKey& key, Referenceable* object)
+{
+  ++m_createdObjects;
+  m_cache.insert(key, SharedPtr<Referenceable>(object));
+}
+
+/**
+   Releases all objects of the cache. The objects are destroyed if
+   they are not referenced from other places.
+*/
+void GdiObjectCache::clear()
+{
+  m_cache.clear();
+}
+
+size_t GdiObjectCache::getCapacity() const
+{
+  return m_cache.getCapacity();
+}
+
+/**
+   Changes the maximum number of objects in the cache.
+
+   @param capacity
+     The new capacity, use zero to disable the cache.
+*/
+void GdiObjectCache::setCapacity(size_t capacity)
+{
+  m_cache.setCapacity(capacity);
+}
+
+size_t GdiObjectCache::size() const
+{
+  return m_cache.size();
+}
+
+/**
+   Returns the number of objects that were shared.
+*/
+size_t GdiObjectCache::getHits() const
+{
+  return m_cache.getHits();
+}
+
+size_t GdiObjectCache::getMisses() const
+{
+  return m_cache.getMisses();
+}
+
+/**
+   Returns the number of GDI objects that were created (i.e. that
+   could not be shared).
+*/
+size_t GdiObjectCache::getCreatedObjects() const
+{
+  return m_createdObjects;
+}
+
+void GdiObjectCache::resetStats()
+{
+  m_cache.resetStats();
+  m_createdObjects = 0;
+}
@@ -0,0 +1,404 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/Gradient.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// SSE2 is available in all x64 processors, and in x86 when the
+// compiler is configured to generate SSE2 code
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define VACA_GRADIENT_SSE2
+  #include <emmintrin.h>
+#endif
+
+using namespace Vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // RGB channels in 16.16 fixed point
+  struct Channels
+  {
+    int r, g, b;
+  };
+
+  // A range of pixels in the axis of the gradient that interpolates
+  // two colors.
+  struct Segment
+  {
+    int first;			// first pixel in the axis
+    int count;			// number of pixels
+    Channels start;		// color of the first pixel
+    Channels step;		// value added to each next pixel
+  };
+
+}
+
+// ordered dithering matrix (4x4 Bayer)
+static const int bayer_matrix[4][4] = {
+  {  0,  8,  2, 10 },
+  { 12,  4, 14,  6 },
+  {  3, 11,  1,  9 },
+  { 15,  7, 13,  5 }
+};
+
+// Returns the values to be added to the channels of the pixels in
+// the given row before truncating them to 8 bits. Without dithering
+// they are 0.5 (round to nearest).
+static void get_thresholds(bool dithering, int row, int thresholds[4])
+{
+  for (int i=0; i<4; ++i)
+    thresholds[i] = dithering ? (bayer_matrix[row & 3][i]*2 + 1) << 11: 0x8000;
+}
+
+/**
+   The span kernel: fills @a count pixels starting with the @a color
+   and adding @a step to each next pixel.
+
+   @param x
+     Position of the first pixel in the gradient (to select the
+     dithering threshold of each pixel).
+*/
+static void fill_span(pixel_type* dst, int count, int x,
+		      Channels color, const Channels& step,
+		      const int thresholds[4])
+{
+#ifdef VACA_GRADIENT_SSE2
+  if (count >= 4) {
+    int blocks = count / 4;
+    __m128i r = _mm_setr_epi32(color.r, color.r+step.r, color.r+2*step.r, color.r+3*step.r);
+    __m128i g = _mm_setr_epi32(color.g, color.g+step.g, color.g+2*step.g, color.g+3*step.g);
+    __m128i b = _mm_setr_epi32(color.b, color.b+step.b, color.b+2*step.b, color.b+3*step.b);
+    __m128i r4 = _mm_set1_epi32(4*step.r);
+    __m128i g4 = _mm_set1_epi32(4*step.g);
+    __m128i b4 = _mm_set1_epi32(4*step.b);
+    __m128i th = _mm_setr_epi32(thresholds[x & 3],
+				thresholds[(x+1) & 3],
+				thresholds[(x+2) & 3],
+				thresholds[(x+3) & 3]);
+    __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+
+    for (int i=0; i<blocks; ++i) {
+      __m128i pixels =
+	_mm_or_si128(alpha,
+	  _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(_mm_add_epi32(r, th), 16), 16),
+	    _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(_mm_add_epi32(g, th), 16), 8),
+			 _mm_srli_epi32(_mm_add_epi32(b, th), 16))));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), pixels);
+
+      r = _mm_add_epi32(r, r4);
+      g = _mm_add_epi32(g, g4);
+      b = _mm_add_epi32(b, b4);
+      dst += 4;
+    }
+
+    // continue with the remaining pixels
+    color.r += 4*blocks*step.r;
+    color.g += 4*blocks*step.g;
+    color.b += 4*blocks*step.b;
+    x += 4*blocks;
+    count -= 4*blocks;
+  }
+#endif
+
+  for (; count > 0; --count, ++dst, ++x) {
+    int th = thresholds[x & 3];
+
+    *dst = 0xff000000
+      | (((color.r + th) >> 16) << 16)
+      | (((color.g + th) >> 16) << 8)
+      | ((color.b + th) >> 16);
+
+    color.r += step.r;
+    color.g += step.g;
+    color.b += step.b;
+  }
+}
+
+// Fills the pixels from "begin" to "end" (positions in the axis of
+// the gradient), "dst" is the pixel in the "begin" position.
+static void fill_segments(pixel_type* dst, int begin, int end,
+			  const std::vector<Segment>& segments,
+			  const int thresholds[4])
+{
+  for (std::vector<Segment>::const_iterator
+	 it=segments.begin(); it!=segments.end(); ++it) {
+    int first = std::max(it->first, begin);
+    int last = std::min(it->first + it->count, end);
+    if (first >= last)
+      continue;
+
+    int skip = first - it->first;
+    Channels color = it->start;
+    color.r += skip*it->step.r;
+    color.g += skip*it->step.g;
+    color.b += skip*it->step.b;
+
+    fill_span(dst + first - begin, last - first, first, color, it->step, thresholds);
+  }
+}
+
+// Returns the color of the pixel in the "pos" position of the axis
+static Channels get_color(const std::vector<Segment>& segments, int pos)
+{
+  for (std::vector<Segment>::const_iterator
+	 it=segments.begin(); it!=segments.end(); ++it) {
+    if (pos >= it->first && pos < it->first + it->count) {
+      int skip = pos - it->first;
+      Channels color = it->start;
+      color.r += skip*it->step.r;
+      color.g += skip*it->step.g;
+      color.b += skip*it->step.b;
+      return color;
+    }
+  }
+
+  Channels black = { 0, 0, 0 };
+  return black;
+}
+
+static int to_fixed(double value)
+{
+  return static_cast<int>(std::floor(value*65536.0 + 0.5));
+}
+
+// Color in a position "t" (from 0.0 to 1.0) between two colors
+static Channels mix(const Color& a, const Color& b, double t)
+{
+  Channels color = {
+    to_fixed(a.getR() + (b.getR() - a.getR())*t),
+    to_fixed(a.getG() + (b.getG() - a.getG())*t),
+    to_fixed(a.getB() + (b.getB() - a.getB())*t)
+  };
+  return color;
+}
+
+static void add_segment(std::vector<Segment>& segments, int first, int last,
+			const Channels& start, const Channels& end)
+{
+  Segment seg;
+  seg.first = first;
+  seg.count = last - first + 1;
+  seg.start = start;
+
+  // the step is truncated toward zero, so the last pixel never goes
+  // beyond the "end" color
+  int n = std::max(1, seg.count - 1);
+  seg.step.r = (end.r - start.r) / n;
+  seg.step.g = (end.g - start.g) / n;
+  seg.step.b = (end.b - start.b) / n;
+
+  segments.push_back(seg);
+}
+
+// Returns the position of the last pixel which is before or at the
+// given offset of the axis
+static int pixel_at(double offset, int last)
+{
+  return std::min(last, static_cast<int>(std::floor(offset*last + 1e-9)));
+}
+
+static bool stop_less_than(const Gradient::Stop& a, const Gradient::Stop& b)
+{
+  return a.offset < b.offset;
+}
+
+// Converts the stops of the gradient to segments of pixels for an
+// axis of "length" pixels.
+static void make_segments(std::vector<Gradient::Stop> stops, int length,
+			  std::vector<Segment>& segments)
+{
+  segments.clear();
+  if (stops.empty() || length <= 0)
+    return;
+
+  std::stable_sort(stops.begin(), stops.end(), stop_less_than);
+
+  int last = length-1;
+  int next = 0;
+
+  // pixels before the first stop
+  int end = pixel_at(stops.front().offset, last);
+  if (end >= next) {
+    Channels color = mix(stops.front().color, stops.front().color, 0.0);
+    add_segment(segments, next, end, color, color);
+    next = end+1;
+  }
+
+  for (size_t i=1; i<stops.size() && next <= last; ++i) {
+    const Gradient::Stop& a = stops[i-1];
+    const Gradient::Stop& b = stops[i];
+
+    end = pixel_at(b.offset, last);
+    if (end < next)
+      continue;
+
+    double range = b.offset - a.offset;
+    double t0 = (last > 0 ? double(next)/last: 0.0) - a.offset;
+    double t1 = (last > 0 ? double(end)/last: 0.0) - a.offset;
+    t0 = std::max(0.0, std::min(1.0, t0 / range));
+    t1 = std::max(0.0, std::min(1.0, t1 / range));
+
+    add_segment(segments, next, end,
+		mix(a.color, b.color, t0),
+		mix(a.color, b.color, t1));
+    next = end+1;
+  }
+
+  // pixels after the last stop
+  if (next <= last) {
+    Channels color = mix(stops.back().color, stops.back().color, 0.0);
+    add_segment(segments, next, last, color, color);
+  }
+}
+
+// ======================================================================
+// Gradient
+
+/**
+   Creates a gradient without stops.
+*/
+Gradient::Gradient()
+  : m_dithering(false)
+{
+}
+
+/**
+   Creates a gradient from @a startColor (offset 0.0) to @a endColor
+   (offset 1.0).
+*/
+Gradient::Gradient(const Color& startColor, const Color& endColor)
+  : m_dithering(false)
+{
+  addStop(0.0, startColor);
+  addStop(1.0, endColor);
+}
+
+Gradient::~Gradient()
+{
+}
+
+/**
+   Adds a color stop to the gradient.
+
+   @param offset
+     Position of the color, from 0.0 to 1.0. Two stops with the
+     same offset make an abrupt change of color.
+*/
+void Gradient::addStop(double offset, const Color& color)
+{
+  m_stops.push_back(Stop(std::max(0.0, std::min(1.0, offset)), color));
+}
+
+void Gradient::clearStops()
+{
+  m_stops.clear();
+}
+
+const std::vector<Gradient::Stop>& Gradient::getStops() const
+{
+  return m_stops;
+}
+
+bool Gradient::isDithering() const
+{
+  return m_dithering;
+}
+
+/**
+   Enables or disables the ordered dithering.
+
+   Dithering is useful to draw gradients with few colors (e.g. from
+   a dark gray to other dark gray) in big areas, where the bands of
+   each color are too visible.
+*/
+void Gradient::setDithering(bool state)
+{
+  m_dithering = state;
+}
+
+/**
+   Fills the @a rc rectangle of @a pixels with the gradient.
+
+   @param rc
+     The gradient starts in the left (or top) side of this rectangle
+     and ends in the right (or bottom) side. The parts of the
+     rectangle outside the @a pixels are not filled.
+
+   @param orientation
+     Orientation::Horizontal to change the color from left to right,
+     or Orientation::Vertical to change it from top to bottom.
+*/
+void Gradient::fillRect(ImagePixels& pixels, const Rect& rc, Orientation orientation) const
+{
+  Rect clip = rc.createIntersect(Rect(pixels.getSize()));
+  if (clip.isEmpty() || m_stops.empty())
+    return;
+
+  int scanline = pixels.getScanlineSize();
+  pixel_type* dst = &pixels[clip.y*scanline + clip.x];
+  int thresholds[4];
+  std::vector<Segment> segments;
+
+  if (orientation == Orientation::Horizontal) {
+    make_segments(m_stops, rc.w, segments);
+
+    // rows are equal (or equal every four rows when dithering)
+    int period = m_dithering ? 4: 1;
+
+    for (int y=clip.y; y<clip.y+clip.h; ++y, dst += scanline) {
+      if (y - clip.y >= period)
+	std::memcpy(dst, dst - period*scanline, clip.w*sizeof(pixel_type));
+      else {
+	get_thresholds(m_dithering, y - rc.y, thresholds);
+	fill_segments(dst, clip.x - rc.x, clip.x - rc.x + clip.w,
+		      segments, thresholds);
+      }
+    }
+  }
+  else {
+    make_segments(m_stops, rc.h, segments);
+
+    Channels step = { 0, 0, 0 };
+
+    for (int y=clip.y; y<clip.y+clip.h; ++y, dst += scanline) {
+      get_thresholds(m_dithering, y - rc.y, thresholds);
+      fill_span(dst, clip.w, clip.x - rc.x,
+		get_color(segments, y - rc.y), step, thresholds);
+    }
+  }
+}
@@ -34,6 +34,7 @@
 #include "Vaca/ImageList.h"
 #include "Vaca/Debug.h"
 #include "Vaca/Font.h"
+#include "Vaca/Gradient.h"
 #include "Vaca/Rect.h"
 #include "Vaca/Point.h"
 #include "Vaca/Size.h"
@@ -43,8 +44,10 @@
 #include "Vaca/Pen.h"
 #include "Vaca/Brush.h"
 #include "Vaca/GraphicsPath.h"
+#include "Vaca/TextLayoutCache.h"
 #include "Vaca/win32.h"
 
+#include <algorithm>
 #include <cmath>
 #ifndef M_PI
 #  define M_PI 3.14159265358979323846
@@ -437,21 +440,32 @@ void Graphics::strokeAndFillPath(const Pen& pen, const Brush& brush)
   SelectObject(m_handle, oldBrush);
 }
 
+/**
+   Draws the edges of the @a path in the @a pt position.
+
+   The curves of the path are not tessellated each time, this routine
+   uses the polylines cached in the path (see GraphicsPath#getPolylines).
+*/
 void Graphics::strokePath(const GraphicsPath& path, const Pen& pen, const Point& pt)
 {
-  tracePath(path, pt);
+  tracePolylines(path.getPolylines(), pt);
   strokePath(pen);
 }
 
+/**
+   Fills the area of the @a path in the @a pt position.
+
+   @see strokePath(const GraphicsPath&, const Pen&, const Point&)
+*/
 void Graphics::fillPath(const GraphicsPath& path, const Brush& brush, const Point& pt)
 {
-  tracePath(path, pt);
+  tracePolylines(path.getPolylines(), pt);
   fillPath(brush);
 }
 
 void Graphics::strokeAndFillPath(const GraphicsPath& path, const Pen& pen, const Brush& brush, const Point& pt)
 {
-  tracePath(path, pt);
+  tracePolylines(path.getPolylines(), pt);
   strokeAndFillPath(pen, brush);
 }
 
@@ -725,24 +739,25 @@ void Graphics::draw3dRect(int x, int y, int w, int h, const Color& topLeft, cons
 {
   assert(m_handle);
 
-  HPEN pen1 = CreatePen(PS_SOLID, 1, convert_to<COLORREF>(topLeft));
-  HPEN pen2 = CreatePen(PS_SOLID, 1, convert_to<COLORREF>(bottomRight));
-
-  POINT oldPos;
-  HGDIOBJ oldPen = SelectObject(m_handle, pen1);
-  MoveToEx(m_handle, x, y+h-2, &oldPos);
-  LineTo(m_handle, x, y);
-  LineTo(m_handle, x+w-1, y);
+  if (w <= 0 || h <= 0)
+    return;
 
-  SelectObject(m_handle, pen2);
-  LineTo(m_handle, x+w-1, y+h-1);
-  LineTo(m_handle, x-1, y+h-1);
+  // the edges are filled with solid rectangles (the brushes are
+  // shared by the GdiObjectCache of the thread), this is cheaper than
+  // creating two pens and tracing four lines
+  Brush brush1(topLeft);
+  Brush brush2(bottomRight);
+  RECT rc;
 
-  SelectObject(m_handle, oldPen);
-  MoveToEx(m_handle, oldPos.x, oldPos.y, NULL);
+  SetRect(&rc, x, y, x+w-1, y+1);		// top
+  ::FillRect(m_handle, &rc, convert_to<HBRUSH>(brush1));
+  SetRect(&rc, x, y+1, x+1, y+h-1);		// left
+  ::FillRect(m_handle, &rc, convert_to<HBRUSH>(brush1));
 
-  DeleteObject(pen1);
-  DeleteObject(pen2);
+  SetRect(&rc, x+w-1, y, x+w, y+h-1);		// right
+  ::FillRect(m_handle, &rc, convert_to<HBRUSH>(brush2));
+  SetRect(&rc, x, y+h-1, x+w, y+h);		// bottom
+  ::FillRect(m_handle, &rc, convert_to<HBRUSH>(brush2));
 }
 
 /**
@@ -977,55 +992,87 @@ void Graphics::fillGradientRect(const Rect& rc, const Color& startColor, const C
   fillGradientRect(rc.x, rc.y, rc.w, rc.h, startColor, endColor, orientation);
 }
 
-typedef BOOL (WINAPI * GFProc)(HDC, PTRIVERTEX, ULONG, PVOID, ULONG, ULONG);
-
 void Graphics::fillGradientRect(int x, int y, int w, int h,
 				const Color& startColor,
 				const Color& endColor,
 				Orientation orientation)
+{
+  fillGradientRect(Rect(x, y, w, h), Gradient(startColor, endColor), orientation);
+}
+
+// Draws the pixels (a top-down 32bpp DIB) in the (x, y, w, h)
+// rectangle of the device context, stretching them if they are
+// smaller.
+static void draw_pixels(HDC hdc, int x, int y, int w, int h,
+			ImagePixels& pixels, int srcWidth, int srcHeight)
+{
+  BITMAPINFO bmi;
+  ZeroMemory(&bmi, sizeof(BITMAPINFO));
+  bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+  bmi.bmiHeader.biWidth = pixels.getWidth();
+  bmi.bmiHeader.biHeight = -pixels.getHeight();
+  bmi.bmiHeader.biPlanes = 1;
+  bmi.bmiHeader.biBitCount = 32;
+  bmi.bmiHeader.biCompression = BI_RGB;
+
+  StretchDIBits(hdc,
+		x, y, w, h,
+		0, 0, srcWidth, srcHeight,
+		&pixels[0], &bmi, DIB_RGB_COLORS, SRCCOPY);
+}
+
+/**
+   Fills the rectangle with the specified @a gradient.
+
+   The gradient is rendered by the span kernels of Gradient#fillRect
+   in a band of pixels which is copied to the device context. As a
+   gradient changes only in one axis, without dithering the band is
+   just one row (or column) of pixels stretched to the whole
+   rectangle. With dithering the band is a tile of 64 rows (or
+   columns) which is repeated along the rectangle.
+*/
+void Graphics::fillGradientRect(const Rect& rc, const Gradient& gradient, Orientation orientation)
 {
   assert(m_handle);
 
-  TRIVERTEX vert[2] ;
-  GRADIENT_RECT gRect;
-
-  vert[0].x        = x;
-  vert[0].y        = y;
-  vert[0].Red      = startColor.getR() | (startColor.getR() << 8);
-  vert[0].Green    = startColor.getG() | (startColor.getG() << 8);
-  vert[0].Blue     = startColor.getB() | (startColor.getB() << 8);
-  vert[0].Alpha    = 0xff00;
-
-  vert[1].x        = x+w;
-  vert[1].y        = y+h;
-  vert[1].Red      = endColor.getR() | (endColor.getR() << 8);
-  vert[1].Green    = endColor.getG() | (endColor.getG() << 8);
-  vert[1].Blue     = endColor.getB() | (endColor.getB() << 8);
-  vert[1].Alpha    = 0xff00;
-
-  gRect.UpperLeft  = 0;
-  gRect.LowerRight = 1;
-
-#if (WINVER >= 0x0500)
-  GradientFill(m_handle, vert, 2, &gRect, 1,
-	       orientation == Orientation::Horizontal
-	       ? GRADIENT_FILL_RECT_H:
-		 GRADIENT_FILL_RECT_V);
-#else
-  static GFProc pGF = NULL;
+  if (rc.isEmpty())
+    return;
 
-  if (pGF == NULL) {
-    HMODULE hMsImg32 = LoadLibrary(_T("msimg32.dll"));
-    if (hMsImg32 != NULL)
-      pGF = (GFProc)GetProcAddress(hMsImg32, "GradientFill");
+  // the tile is a multiple of four pixels (the period of dithering)
+  const int tile = 64;
+  bool horizontal = (orientation == Orientation::Horizontal);
+  int band = gradient.isDithering() ? tile: 1;
+
+  if (horizontal) {
+    band = std::min(band, rc.h);
+
+    ImagePixels pixels(rc.w, band);
+    gradient.fillRect(pixels, Rect(0, 0, rc.w, band), orientation);
+
+    if (!gradient.isDithering())
+      draw_pixels(m_handle, rc.x, rc.y, rc.w, rc.h, pixels, rc.w, 1);
+    else {
+      for (int y=0; y<rc.h; y+=band) {
+	int h = std::min(band, rc.h-y);
+	draw_pixels(m_handle, rc.x, rc.y+y, rc.w, h, pixels, rc.w, h);
+      }
+    }
   }
+  else {
+    band = std::min(band, rc.w);
+
+    ImagePixels pixels(band, rc.h);
+    gradient.fillRect(pixels, Rect(0, 0, band, rc.h), orientation);
 
-  if (pGF != NULL) {
-    pGF(m_handle, vert, 2, &gRect, 1,
-	orientation == Horizontal ? GRADIENT_FILL_RECT_H:
-				    GRADIENT_FILL_RECT_V);
+    if (!gradient.isDithering())
+      draw_pixels(m_handle, rc.x, rc.y, rc.w, rc.h, pixels, 1, rc.h);
+    else {
+      for (int x=0; x<rc.w; x+=band) {
+	int w = std::min(band, rc.w-x);
+	draw_pixels(m_handle, rc.x+x, rc.y, w, rc.h, pixels, w, rc.h);
+      }
+    }
   }
-#endif
 }
 
 void Graphics::drawGradientRect(const Rect& rc,
@@ -1094,6 +1141,13 @@ void Graphics::drawFocus(const Rect& rc)
 }
 
 /**
+   Returns the size of the @a str when it is drawn with the current
+   font (see #setFont) inside a rectangle of @a fitInWidth width.
+
+   The measures made in the screen are cached (see TextLayoutCache),
+   so widgets can ask for their preferred size again and again
+   without calling DrawText each time.
+
    @warning
      In Win98, 32767 is the limit for @a fitInWidth.
 */
@@ -1101,8 +1155,19 @@ Size Graphics::measureString(const String& str, int fitInWidth, int flags)
 {
   assert(m_handle);
 
+  HFONT font = m_font.getHandle();
+  Size size;
+
+  // printers and scaled DCs give other measures
+  bool useCache =
+    GetDeviceCaps(m_handle, TECHNOLOGY) == DT_RASDISPLAY &&
+    GetMapMode(m_handle) == MM_TEXT;
+
+  if (useCache && TextLayoutCache::find(font, str, fitInWidth, flags, size))
+    return size;
+
   RECT rc = { 0, 0, fitInWidth, 0 };
-  HGDIOBJ oldFont = SelectObject(m_handle, reinterpret_cast<HGDIOBJ>(m_font.getHandle()));
+  HGDIOBJ oldFont = SelectObject(m_handle, reinterpret_cast<HGDIOBJ>(font));
 
   if (!str.empty()) {
     DrawText(m_handle, str.c_str(), static_cast<int>(str.size()), &rc, flags | DT_CALCRECT);
@@ -1118,7 +1183,11 @@ Size Graphics::measureString(const String& str, int fitInWidth, int flags)
 
   SelectObject(m_handle, oldFont);
 
-  return convert_to<Rect>(rc).getSize();
+  size = convert_to<Rect>(rc).getSize();
+  if (useCache)
+    TextLayoutCache::insert(font, str, fitInWidth, flags, size);
+
+  return size;
 }
 
 /**
@@ -1156,6 +1225,42 @@ HDC Graphics::getHandle() const
   return m_handle;
 }
 
+/**
+   Like #tracePath but using the already flattened @a polylines of a
+   GraphicsPath.
+*/
+void Graphics::tracePolylines(const GraphicsPath::Polylines& polylines, const Point& pt)
+{
+  assert(m_handle);
+
+  // move the logical origin instead of copying all points
+  POINT oldOrigin;
+  OffsetWindowOrgEx(m_handle, -pt.x, -pt.y, &oldOrigin);
+
+  BeginPath(m_handle);
+
+  if (!polylines.getPoints().empty()) {
+    // Point has the same layout of Win32's POINT
+    const POINT* points = reinterpret_cast<const POINT*>(&polylines.getPoints()[0]);
+
+    for (int figure=0; figure<polylines.getFigureCount(); ++figure) {
+      int size = polylines.getFigureSizes()[figure];
+
+      MoveToEx(m_handle, points->x, points->y, NULL);
+      PolylineTo(m_handle, points+1, size-1);
+
+      if (polylines.isFigureClosed(figure))
+	CloseFigure(m_handle);
+
+      points += size;
+    }
+  }
+
+  EndPath(m_handle);
+
+  SetWindowOrgEx(m_handle, oldOrigin.x, oldOrigin.y, NULL);
+}
+
 void Graphics::drawBezier(const Pen& pen, CONST POINT* lppt, int numPoints)
 {
   assert(m_handle);
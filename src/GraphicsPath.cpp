@@ -37,8 +37,14 @@
 #include "Vaca/Graphics.h"
 #include "Vaca/win32.h"
 
+#include <cassert>
+#include <cmath>
+
 using namespace Vaca;
 
+// Maximum number of subdivisions of a Bezier curve (2^10 segments)
+#define MAX_BEZIER_LEVEL 10
+
 // ======================================================================
 //
 
@@ -76,10 +82,132 @@ const Point& GraphicsPath::Node::getPoint() const
   return m_point;
 }
 
+// ======================================================================
+// GraphicsPath::Polylines
+
+GraphicsPath::Polylines::Polylines()
+  : m_tolerance(0.0)
+{
+}
+
+/**
+   Returns the maximum distance (in pixels) between the curves of the
+   original path and the segments that approximate them.
+*/
+double GraphicsPath::Polylines::getTolerance() const
+{
+  return m_tolerance;
+}
+
+/**
+   Returns the points of all figures, one after the other.
+
+   @see getFigureSizes
+*/
+const std::vector<Point>& GraphicsPath::Polylines::getPoints() const
+{
+  return m_points;
+}
+
+/**
+   Returns the number of points of each figure.
+*/
+const std::vector<int>& GraphicsPath::Polylines::getFigureSizes() const
+{
+  return m_sizes;
+}
+
+int GraphicsPath::Polylines::getFigureCount() const
+{
+  return m_sizes.size();
+}
+
+/**
+   Returns true if the last point of the @a figure must be connected
+   with its first point.
+*/
+bool GraphicsPath::Polylines::isFigureClosed(int figure) const
+{
+  assert(figure >= 0 && figure < getFigureCount());
+  return m_closed[figure];
+}
+
+void GraphicsPath::Polylines::clear()
+{
+  // the capacity of the vectors is kept to reuse the memory
+  m_points.clear();
+  m_sizes.clear();
+  m_closed.clear();
+}
+
+void GraphicsPath::Polylines::addPoint(double x, double y)
+{
+  Point pt(static_cast<int>(std::floor(x + 0.5)),
+	   static_cast<int>(std::floor(y + 0.5)));
+
+  // consecutive points that are rounded to the same pixel are useless
+  if (m_points.empty() || m_points.back() != pt)
+    m_points.push_back(pt);
+}
+
+/**
+   Adds the points of a cubic Bezier curve (without the start
+   point @a x0, @a y0) subdividing the curve until each segment is
+   near enough to it (see #getTolerance).
+
+   The flatness test is the Roger Willcocks' estimation of the
+   distance between the control points and the chord.
+*/
+void GraphicsPath::Polylines::addBezier(double x0, double y0, double x1, double y1,
+					double x2, double y2, double x3, double y3,
+					int level)
+{
+  double ux = 3.0*x1 - 2.0*x0 - x3; ux *= ux;
+  double uy = 3.0*y1 - 2.0*y0 - y3; uy *= uy;
+  double vx = 3.0*x2 - 2.0*x3 - x0; vx *= vx;
+  double vy = 3.0*y2 - 2.0*y3 - y0; vy *= vy;
+  if (ux < vx) ux = vx;
+  if (uy < vy) uy = vy;
+
+  if (ux+uy <= 16.0*m_tolerance*m_tolerance || level == MAX_BEZIER_LEVEL) {
+    addPoint(x3, y3);
+    return;
+  }
+
+  // de Casteljau subdivision in t=0.5
+  double x01 = (x0+x1)/2, y01 = (y0+y1)/2;
+  double x12 = (x1+x2)/2, y12 = (y1+y2)/2;
+  double x23 = (x2+x3)/2, y23 = (y2+y3)/2;
+  double x012 = (x01+x12)/2, y012 = (y01+y12)/2;
+  double x123 = (x12+x23)/2, y123 = (y12+y23)/2;
+  double xm = (x012+x123)/2, ym = (y012+y123)/2;
+
+  addBezier(x0, y0, x01, y01, x012, y012, xm, ym, level+1);
+  addBezier(xm, ym, x123, y123, x23, y23, x3, y3, level+1);
+}
+
+/**
+   Finishes the figure that starts in the @a start point.
+*/
+void GraphicsPath::Polylines::closeFigure(int start, bool closed)
+{
+  int size = m_points.size() - start;
+
+  // a figure without segments isn't drawn
+  if (size < 2) {
+    m_points.resize(start);
+    return;
+  }
+
+  m_sizes.push_back(size);
+  m_closed.push_back(closed);
+}
+
 // ======================================================================
 // GraphicsPath
 
 GraphicsPath::GraphicsPath()
+  : m_polylinesValid(false)
 {
 }
 
@@ -87,13 +215,22 @@ GraphicsPath::~GraphicsPath()
 {
 }
 
+/**
+   Returns an iterator to modify the nodes of the path.
+
+   @warning
+     The result of #getPolylines is discarded because the nodes could
+     be modified through the iterator.
+*/
 GraphicsPath::iterator GraphicsPath::begin()
 {
+  invalidatePolylines();
   return m_nodes.begin();
 }
 
 GraphicsPath::iterator GraphicsPath::end()
 {
+  invalidatePolylines();
   return m_nodes.end();
 }
 
@@ -110,6 +247,7 @@ GraphicsPath::const_iterator GraphicsPath::end() const
 void GraphicsPath::clear()
 {
   m_nodes.clear();
+  invalidatePolylines();
 }
 
 bool GraphicsPath::empty() const
@@ -124,10 +262,25 @@ unsigned GraphicsPath::size() const
 
 GraphicsPath& GraphicsPath::offset(int dx, int dy)
 {
-  for (iterator it=begin(); it!=end(); ++it) {
+  for (iterator it=m_nodes.begin(); it!=m_nodes.end(); ++it) {
     it->getPoint().x += dx;
     it->getPoint().y += dy;
   }
+
+  // the flattening of a translated path is the same translated
+  // polyline, so we can keep the cached points (except for the
+  // implicit start of the first figure, which is always the origin)
+  if (m_polylinesValid && !m_nodes.empty() && m_nodes.front().getType() == GraphicsPath::MoveTo) {
+    for (std::vector<Point>::iterator
+	   it = m_polylines.m_points.begin(),
+	   end = m_polylines.m_points.end(); it != end; ++it) {
+      it->x += dx;
+      it->y += dy;
+    }
+  }
+  else
+    invalidatePolylines();
+
   return *this;
 }
 
@@ -138,8 +291,10 @@ GraphicsPath& GraphicsPath::offset(const Point& point)
 
 GraphicsPath& GraphicsPath::moveTo(const Point& pt)
 {
-  if (!m_nodes.empty() && m_nodes.back().getType() == GraphicsPath::MoveTo)
+  if (!m_nodes.empty() && m_nodes.back().getType() == GraphicsPath::MoveTo) {
     m_nodes.back().m_point = pt;
+    invalidatePolylines();
+  }
   else
     addNode(GraphicsPath::MoveTo, pt);
   return *this;
@@ -179,17 +334,38 @@ GraphicsPath& GraphicsPath::curveTo(int x1, int y1, int x2, int y2, int x3, int
 
 GraphicsPath& GraphicsPath::closeFigure()
 {
-  if (!m_nodes.empty())
+  if (!m_nodes.empty()) {
     m_nodes.back().m_flags |= GraphicsPath::CloseFigure;
+    invalidatePolylines();
+  }
   return *this;
 }
 
+/**
+   Replaces all curves of the path with lines.
+
+   @see getPolylines
+*/
 GraphicsPath& GraphicsPath::flatten()
 {
-  ScreenGraphics g;
-  g.tracePath(*this, Point(0, 0));
-  ::FlattenPath(g.getHandle());
-  g.getPath(*this);
+  const Polylines& polylines = getPolylines();
+  std::vector<Node> nodes;
+  nodes.reserve(polylines.m_points.size());
+
+  std::vector<Point>::const_iterator pt = polylines.m_points.begin();
+  for (int figure=0; figure<polylines.getFigureCount(); ++figure) {
+    int size = polylines.m_sizes[figure];
+
+    nodes.push_back(Node(GraphicsPath::MoveTo, *pt++));
+    for (int c=1; c<size; ++c)
+      nodes.push_back(Node(GraphicsPath::LineTo, *pt++));
+
+    if (polylines.m_closed[figure])
+      nodes.back().setCloseFigure(true);
+  }
+
+  // the polylines of the new nodes are the same
+  m_nodes.swap(nodes);
   return *this;
 }
 
@@ -207,14 +383,115 @@ GraphicsPath& GraphicsPath::widen(const Pen& pen)
   return *this;
 }
 
+/**
+   Returns the path converted to polylines.
+
+   Each Bezier curve is subdivided adaptively, so flat curves need
+   few points and sharp curves get more points.
+
+   The result is cached in the path, so it is calculated again only
+   if the path is modified or a different @a tolerance is used. As
+   the flattening does not depend on the position where the path is
+   drawn, the same polylines are reused for Graphics#strokePath and
+   Graphics#fillPath in any position, and for #toRegion.
+
+   @param tolerance
+     Maximum distance (in pixels) between the curves and the segments
+     that approximate them.
+*/
+const GraphicsPath::Polylines& GraphicsPath::getPolylines(double tolerance) const
+{
+  assert(tolerance > 0.0);
+
+  if (m_polylinesValid && m_polylines.m_tolerance == tolerance)
+    return m_polylines;
+
+  Polylines& polylines(m_polylines);
+  polylines.clear();
+  polylines.m_tolerance = tolerance;
+
+  // like Graphics#tracePath, the first figure starts in the origin
+  Point current(0, 0);
+  int start = 0;
+  polylines.addPoint(0, 0);
+
+  for (const_iterator it=m_nodes.begin(), end=m_nodes.end(); it!=end; ++it) {
+    const Point& pt(it->getPoint());
+
+    switch (it->getType()) {
+
+      case GraphicsPath::MoveTo:
+	polylines.closeFigure(start, false);
+	start = polylines.m_points.size();
+	polylines.m_points.push_back(pt);
+	break;
+
+      case GraphicsPath::LineTo:
+	polylines.addPoint(pt.x, pt.y);
+	break;
+
+      case GraphicsPath::BezierControl1: {
+	const Point& pt1(pt);
+	++it;
+	assert(it != end && it->getType() == GraphicsPath::BezierControl2);
+	const Point& pt2(it->getPoint());
+	++it;
+	assert(it != end && it->getType() == GraphicsPath::BezierTo);
+	const Point& pt3(it->getPoint());
+
+	polylines.addBezier(current.x, current.y,
+			    pt1.x, pt1.y,
+			    pt2.x, pt2.y,
+			    pt3.x, pt3.y, 0);
+	break;
+      }
+    }
+
+    current = it->getPoint();
+
+    // after closing a figure, the next one starts in the same point
+    // that the closed figure started
+    if (it->isCloseFigure()) {
+      current = polylines.m_points[start];
+      polylines.closeFigure(start, true);
+      start = polylines.m_points.size();
+      polylines.m_points.push_back(current);
+    }
+  }
+
+  polylines.closeFigure(start, false);
+
+  m_polylinesValid = true;
+  return m_polylines;
+}
+
+/**
+   Creates a region with the area of the path.
+
+   It uses the cached polylines of the path (see #getPolylines), so
+   hit-testing the same path several times is cheap.
+*/
 Region GraphicsPath::toRegion() const
 {
-  ScreenGraphics g;
-  g.tracePath(*this, Point(0, 0));
-  return g.getRegionFromPath();
+  const Polylines& polylines = getPolylines();
+
+  if (polylines.m_sizes.empty())
+    return Region();
+
+  // Point has the same layout of Win32's POINT
+  return Region(::CreatePolyPolygonRgn(reinterpret_cast<const POINT*>(&polylines.m_points[0]),
+				       &polylines.m_sizes[0],
+				       polylines.m_sizes.size(),
+				       ALTERNATE));
 }
 
 void GraphicsPath::addNode(int type, const Point& pt)
 {
   m_nodes.push_back(Node(type, pt));
+  invalidatePolylines();
+}
+
+void GraphicsPath::invalidatePolylines()
+{
+  m_polylinesValid = false;
 }
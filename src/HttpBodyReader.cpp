@@ -0,0 +1,172 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/HttpBodyReader.h"
+#include "Vaca/HttpClient.h"
+
+#include <cstring>
+
+#ifdef VACA_ON_WINDOWS
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+using namespace Vaca;
+
+// ======================================================================
+// HttpBodyReader
+
+HttpBodyReader::HttpBodyReader()
+{
+}
+
+HttpBodyReader::~HttpBodyReader()
+{
+}
+
+/**
+   Called when the status line and the headers of the response were
+   received, before its body.
+
+   @return
+     False to cancel the request (the connection is closed and the
+     response fails).
+*/
+bool HttpBodyReader::onResponse(const HttpResponse&)
+{
+  return true;
+}
+
+/**
+   @fn bool HttpBodyReader::onData(const char* data, std::size_t size)
+
+   Called for each block of received bytes of the body.
+
+   @param data
+     Points to the internal buffers of the HttpClient (bytes from the
+     socket, or the output of the gzip/deflate decoder). They are
+     valid only during this call, so the bytes must be consumed or
+     copied here.
+
+   @return
+     False to cancel the request.
+*/
+
+// ======================================================================
+// HttpFileWriter
+
+/**
+   @param fd
+     An open file descriptor. It is not closed by the writer.
+*/
+HttpFileWriter::HttpFileWriter(int fd)
+  : m_fd(fd)
+  , m_size(0)
+{
+}
+
+/**
+   Returns the number of bytes written in the file.
+*/
+std::size_t HttpFileWriter::getSize() const
+{
+  return m_size;
+}
+
+bool HttpFileWriter::onData(const char* data, std::size_t size)
+{
+  while (size > 0) {
+#ifdef VACA_ON_WINDOWS
+    int bytes = ::_write(m_fd, data, static_cast<unsigned int>(size));
+#else
+    ssize_t bytes = ::write(m_fd, data, size);
+#endif
+    if (bytes <= 0)
+      return false;
+
+    data += bytes;
+    size -= bytes;
+    m_size += bytes;
+  }
+  return true;
+}
+
+// ======================================================================
+// HttpMemoryWriter
+
+/**
+   @param data
+     Where the body will be written.
+
+   @param capacity
+     Size of @a data. If the body is bigger, the request fails.
+*/
+HttpMemoryWriter::HttpMemoryWriter(char* data, std::size_t capacity)
+  : m_data(data)
+  , m_capacity(capacity)
+  , m_size(0)
+{
+}
+
+char* HttpMemoryWriter::getData() const
+{
+  return m_data;
+}
+
+/**
+   Returns the number of bytes written in the memory block.
+*/
+std::size_t HttpMemoryWriter::getSize() const
+{
+  return m_size;
+}
+
+/**
+   Cancels the request if the Content-Length says that the body will
+   not fit in the memory block.
+*/
+bool HttpMemoryWriter::onResponse(const HttpResponse& response)
+{
+  m_size = 0;
+  return (response.hasHeader(L"Content-Encoding") ||
+	  response.getContentLength() <= static_cast<long long>(m_capacity));
+}
+
+bool HttpMemoryWriter::onData(const char* data, std::size_t size)
+{
+  if (size > m_capacity - m_size)
+    return false;
+
+  std::memcpy(m_data + m_size, data, size);
+  m_size += size;
+  return true;
+}
@@ -0,0 +1,1259 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// <winsock2.h> must be included before <windows.h>
+#if defined(_WIN32)
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+#endif
+
+#include "Vaca/HttpClient.h"
+#include "Vaca/Bind.h"
+#include "Vaca/HttpBodyReader.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/Thread.h"
+#include "Vaca/Unicode.h"
+#include "Vaca/Url.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+#ifdef VACA_ZLIB
+  #include <zlib.h>
+#endif
+
+#if defined(VACA_ON_WINDOWS)
+  #include "win32/SocketImpl.h"
+#elif defined(VACA_ON_UNIXLIKE)
+  #include "unix/SocketImpl.h"
+#else
+  #error Implement sockets in your platform
+#endif
+
+using namespace Vaca;
+
+typedef unsigned long long uint64;
+
+static bool equal_nocase(const std::string& a, const char* b)
+{
+  size_t i;
+  for (i=0; i<a.size() && b[i] != 0; ++i)
+    if (std::tolower(static_cast<unsigned char>(a[i])) !=
+	std::tolower(static_cast<unsigned char>(b[i])))
+      return false;
+  return i == a.size() && b[i] == 0;
+}
+
+static std::string trim(const std::string& str)
+{
+  size_t begin = str.find_first_not_of(" \t");
+  if (begin == std::string::npos)
+    return std::string();
+  size_t end = str.find_last_not_of(" \t");
+  return str.substr(begin, end-begin+1);
+}
+
+// Parses the digits (in base 10 or 16) at the beginning of "str" as
+// a 64-bit length (strtoul has only 32 bits on Windows). Returns the
+// number of digits, or zero if there are not digits or the value is
+// greater than "max".
+static size_t parse_length(const std::string& str, int base, uint64 max, uint64& value)
+{
+  size_t i;
+  value = 0;
+  for (i=0; i<str.size(); ++i) {
+    int digit;
+    char c = str[i];
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if (base == 16 && c >= 'a' && c <= 'f')
+      digit = c - 'a' + 10;
+    else if (base == 16 && c >= 'A' && c <= 'F')
+      digit = c - 'A' + 10;
+    else
+      break;
+
+    if (value > (max - digit) / base)
+      return 0;			// overflow
+    value = value*base + digit;
+  }
+  return i;
+}
+
+// Parses the value of a Content-Length header (only digits)
+static bool parse_content_length(const std::string& str, uint64& value)
+{
+  return (!str.empty() &&
+	  parse_length(str, 10, std::numeric_limits<long long>::max(), value) == str.size());
+}
+
+static std::string to_ascii(const StringView& str)
+{
+  std::string result;
+  wide_to_utf8(str.data(), str.size(), result);
+  return result;
+}
+
+#ifdef VACA_ZLIB
+
+// Returns true if the "headers" (lines ending with "\r\n") contain
+// the specified header
+static bool has_header(const std::string& headers, const char* name)
+{
+  size_t pos = 0;
+  while (pos < headers.size()) {
+    size_t eol = headers.find("\r\n", pos);
+    if (eol == std::string::npos)
+      eol = headers.size();
+
+    size_t colon = headers.find(':', pos);
+    if (colon < eol && equal_nocase(trim(headers.substr(pos, colon-pos)), name))
+      return true;
+
+    pos = eol+2;
+  }
+  return false;
+}
+
+// Incremental decoder of the gzip and deflate content encodings
+class Inflater : private NonCopyable
+{
+  z_stream m_stream;
+  bool m_deflate;		// "deflate" encoding (it could be raw deflate)
+  bool m_more;			// the output was full, there can be more
+  bool m_end;
+  const char* m_input;
+  size_t m_inputSize;
+  uLong m_inputStart;		// total_in before the current input
+
+public:
+
+  static Inflater* create(const std::string& encoding)
+  {
+    if (equal_nocase(encoding, "gzip") || equal_nocase(encoding, "x-gzip"))
+      return new Inflater(false);
+    else if (equal_nocase(encoding, "deflate"))
+      return new Inflater(true);
+    else
+      return NULL;
+  }
+
+  explicit Inflater(bool deflate)
+    : m_deflate(deflate), m_more(false), m_end(false)
+    , m_input(NULL), m_inputSize(0), m_inputStart(0)
+  {
+    // 15+32 = zlib or gzip format, detected from the header
+    init(15+32);
+  }
+
+  ~Inflater()
+  {
+    inflateEnd(&m_stream);
+  }
+
+  void setInput(const char* data, size_t size)
+  {
+    m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    m_stream.avail_in = static_cast<uInt>(size);
+    m_input = data;
+    m_inputSize = size;
+    m_inputStart = m_stream.total_in;
+  }
+
+  // Decodes the next block of the input in "buffer", returns the
+  // number of decoded bytes, zero if the input was consumed, or -1 if
+  // it is not valid
+  int next(char* buffer, size_t size)
+  {
+    if (m_end || (m_stream.avail_in == 0 && !m_more))
+      return 0;
+
+    m_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    m_stream.avail_out = static_cast<uInt>(size);
+
+    int ret = inflate(&m_stream, Z_NO_FLUSH);
+
+    // some servers send "deflate" without the zlib header
+    if (ret == Z_DATA_ERROR && m_deflate &&
+	m_stream.total_out == 0 && m_inputStart == 0) {
+      m_deflate = false;
+      inflateEnd(&m_stream);
+      init(-15);
+      setInput(m_input, m_inputSize);
+      return next(buffer, size);
+    }
+
+    if (ret == Z_STREAM_END)
+      m_end = true;
+    else if (ret != Z_OK && ret != Z_BUF_ERROR)
+      return -1;
+
+    m_more = (m_stream.avail_out == 0);
+    return static_cast<int>(size - m_stream.avail_out);
+  }
+
+private:
+
+  void init(int windowBits)
+  {
+    std::memset(&m_stream, 0, sizeof(m_stream));
+    inflateInit2(&m_stream, windowBits);
+  }
+
+};
+
+#else
+
+// Without zlib the bodies are given as they are received (the
+// requests do not include Accept-Encoding)
+class Inflater
+{
+public:
+  static Inflater* create(const std::string&) { return NULL; }
+  void setInput(const char*, size_t) { }
+  int next(char*, size_t) { return 0; }
+};
+
+#endif
+
+// ======================================================================
+// HttpResponse
+
+HttpResponse::HttpResponse()
+  : m_statusCode(0)
+{
+}
+
+/**
+   Returns the status code sent by the server (e.g. 200), or zero if
+   the request failed.
+*/
+int HttpResponse::getStatusCode() const
+{
+  return m_statusCode;
+}
+
+void HttpResponse::setStatusCode(int statusCode)
+{
+  m_statusCode = statusCode;
+}
+
+/**
+   Returns why the request failed, or an empty string if a response
+   was received.
+*/
+const String& HttpResponse::getError() const
+{
+  return m_error;
+}
+
+void HttpResponse::setError(const String& error)
+{
+  m_error = error;
+}
+
+bool HttpResponse::hasHeader(const String& headerName) const
+{
+  return findHeader(to_ascii(headerName)) != NULL;
+}
+
+/**
+   Returns the value of the specified header (the name is
+   case-insensitive).
+
+   @return
+     The value of the specified header, or an empty string if the
+     header is not found.
+*/
+String HttpResponse::getHeader(const String& headerName) const
+{
+  String value;
+  const std::string* header = findHeader(to_ascii(headerName));
+  if (header)
+    utf8_to_wide(header->c_str(), header->size(), value);
+  return value;
+}
+
+void HttpResponse::addHeader(const std::string& name, const std::string& value)
+{
+  m_headers.push_back(std::make_pair(name, value));
+}
+
+/**
+   Returns the value of the Content-Length header, or -1 if the
+   response does not have it (e.g. chunked responses) or it is not
+   a valid number.
+
+   If the response has a Content-Encoding, it is the size of the
+   encoded body.
+*/
+long long HttpResponse::getContentLength() const
+{
+  const std::string* header = findHeader("Content-Length");
+  uint64 length;
+  if (header && parse_content_length(*header, length))
+    return static_cast<long long>(length);
+  else
+    return -1;
+}
+
+/**
+   Returns the content of the response. It is empty if the body was
+   given to a HttpBodyReader.
+*/
+const std::string& HttpResponse::getBody() const
+{
+  return m_body;
+}
+
+std::string& HttpResponse::getBody()
+{
+  return m_body;
+}
+
+const std::string* HttpResponse::findHeader(const std::string& name) const
+{
+  std::vector<std::pair<std::string, std::string> >::const_iterator it;
+  for (it = m_headers.begin(); it != m_headers.end(); ++it)
+    if (equal_nocase(it->first, name.c_str()))
+      return &it->second;
+  return NULL;
+}
+
+// ======================================================================
+// HttpClientImpl
+
+class HttpClient::HttpClientImpl : private NonCopyable
+{
+  struct Host;
+
+  // A request and its response. It goes from the thread that makes
+  // the request to the network thread, and comes back to the first
+  // thread with the response (see Delivery).
+  struct Request
+  {
+    std::string host;
+    int port;
+    std::string method;
+    std::string data;		// request line, headers and body
+    bool idempotent;		// it can be pipelined and retried
+    bool retried;
+    HttpBodyReader* reader;	// receives the body (or NULL)
+    Callback* callback;
+    HttpResponse response;
+
+    Request() : port(0), idempotent(false), retried(false)
+	      , reader(NULL), callback(NULL) { }
+    ~Request() { delete callback; }
+  };
+
+  // Calls the callback of a request in the thread that made it
+  class Delivery : public Slot0<void>
+  {
+    Request* m_request;
+  public:
+    Delivery(Request* request) : m_request(request) { }
+    void operator()() {
+      std::auto_ptr<Request> request(m_request);
+      (*request->callback)(request->response);
+    }
+    Delivery* clone() const {
+      assert(false);		// it is never copied
+      return NULL;
+    }
+  };
+
+  enum State {
+    StatusLine,			// waiting "HTTP/1.1 200 OK"
+    Headers,			// waiting headers (or the empty line)
+    Body,			// waiting "bodyLeft" bytes
+    BodyUntilClose,		// the body ends when the server closes
+    ChunkSize,			// waiting the size of the next chunk
+    ChunkData,			// waiting "bodyLeft" bytes of the chunk
+    ChunkEnd,			// waiting the "\r\n" after the chunk
+    Trailers			// waiting headers after the last chunk
+  };
+
+  // Maximum length of a header line
+  static const size_t maxLineLength = 65536;
+
+  // Bodies with Content-Length up to this size are preallocated
+  static const size_t maxReserve = 64*1024*1024;
+
+  // Value of Connection::bodyLeft when the response does not have
+  // Content-Length
+  static const uint64 unknownLength = static_cast<uint64>(-1);
+
+  struct Connection
+  {
+    socket_t socket;
+    Host* host;
+    bool connecting;		// non-blocking connect in progress
+    bool persistent;		// the server has answered with keep-alive
+    bool closing;		// no more requests can be sent through it
+    unsigned long used;		// requests sent through this connection
+    std::deque<Request*> inflight; // sent requests, waiting responses
+    std::string output;		// bytes to be sent
+    size_t outputPos;
+    std::string line;		// incomplete line of the status/headers
+    State state;		// of the response of inflight.front()
+    bool started;		// some byte of the response was received
+    bool keepAlive;		// of the current response
+    bool chunked;		// of the current response
+    std::string encoding;	// Content-Encoding of the current response
+    Inflater* inflater;		// decoder of the encoding (or NULL)
+    uint64 bodyLeft;		// bytes of the body or chunk (64 bits)
+
+    Connection(socket_t socket, Host* host)
+      : socket(socket), host(host)
+      , connecting(true), persistent(false), closing(false), used(0)
+      , outputPos(0), state(StatusLine), started(false)
+      , keepAlive(false), chunked(false), inflater(NULL), bodyLeft(0) { }
+    ~Connection() { delete inflater; }
+  };
+
+  struct Host
+  {
+    std::string name;
+    int port;
+    std::deque<Request*> queue;	// requests without connection
+    std::vector<Connection*> connections;
+  };
+
+  ThreadId m_threadId;
+  int m_maxConnections;
+  int m_maxDepth;
+
+  // the following members are protected by m_mutex (they are used
+  // from both threads)
+  mutable Mutex m_mutex;
+  std::deque<Request*> m_incoming;
+  bool m_stop;
+  int m_pending;
+  HttpClientStats m_stats;
+
+  // used only from the network thread
+  std::map<std::string, Host*> m_hosts;
+  std::vector<char> m_buffer;	// received bytes
+  std::vector<char> m_decoded;	// output of the inflaters
+
+  socket_t m_wakeup[2];		// [1] is written to wake up the wait_sockets() of [0]
+  size_t m_sockets;		// sockets to wait (m_wakeup[0] and connections)
+  Thread* m_thread;
+
+public:
+
+  HttpClientImpl(int maxConnections, int maxDepth)
+    : m_threadId(CurrentThread::getId())
+    , m_maxConnections(maxConnections)
+    , m_maxDepth(maxDepth)
+    , m_stop(false)
+    , m_pending(0)
+    , m_buffer(65536)
+    , m_decoded(65536)
+    , m_sockets(1)
+    , m_thread(NULL)
+  {
+    std::memset(&m_stats, 0, sizeof(m_stats));
+
+    init_sockets();
+    if (!make_socket_pair(m_wakeup))
+      throw HttpClientException(L"Can't create sockets for the HTTP client");
+    set_nonblocking(m_wakeup[0]);
+
+    m_thread = new Thread(Bind<void>(&HttpClientImpl::run, this));
+  }
+
+  ~HttpClientImpl()
+  {
+    {
+      ScopedLock hold(m_mutex);
+      m_stop = true;
+    }
+    wakeUp();
+    m_thread->join();
+    delete m_thread;
+
+    // requests that were not completed (their callbacks are not called)
+    for (std::map<std::string, Host*>::iterator
+	   it = m_hosts.begin(); it != m_hosts.end(); ++it) {
+      Host* host = it->second;
+      while (!host->connections.empty()) {
+	Connection* conn = host->connections.back();
+	host->connections.pop_back();
+	deleteAll(conn->inflight);
+	close_socket(conn->socket);
+	delete conn;
+      }
+      deleteAll(host->queue);
+      delete host;
+    }
+    deleteAll(m_incoming);
+
+    close_socket(m_wakeup[0]);
+    close_socket(m_wakeup[1]);
+  }
+
+  void enqueue(const String& method, const String& url,
+	       const String& headers, const std::string& body,
+	       HttpBodyReader* reader, Callback* callback)
+  {
+    std::auto_ptr<Request> request(new Request);
+    request->reader = reader;
+    request->callback = callback;
+    request->method = to_ascii(method);
+    request->idempotent = (request->method == "GET" ||
+			   request->method == "HEAD");
+
+    UrlView view(url);
+    std::string hostName = to_ascii(view.getHost());
+    std::string target = to_ascii(view.getObject());
+    int port = view.getPortNumber();
+    if (port < 0)
+      port = 80;
+    if (target.empty())
+      target = "/";
+
+    {
+      ScopedLock hold(m_mutex);
+      ++m_pending;
+    }
+
+    if (!(view.getScheme() == L"http") || hostName.empty()) {
+      request->response.setError(L"Unsupported URL " + url);
+      deliver(request.release());
+      return;
+    }
+
+    char buf[32];
+    std::sprintf(buf, ":%d", port);
+
+    std::string& data = request->data;
+    data = request->method + " " + target + " HTTP/1.1\r\n";
+    data += "Host: " + hostName + (port != 80 ? buf: "") + "\r\n";
+    data += "User-Agent: Vaca\r\n";
+    data += to_ascii(headers);
+#ifdef VACA_ZLIB
+    if (!has_header(to_ascii(headers), "Accept-Encoding"))
+      data += "Accept-Encoding: gzip, deflate\r\n";
+#endif
+    if (!body.empty() || !request->idempotent) {
+      std::sprintf(buf, "%lu", static_cast<unsigned long>(body.size()));
+      data += "Content-Length: " + std::string(buf) + "\r\n";
+    }
+    data += "\r\n";
+    data += body;
+
+    request->host = hostName;
+    request->port = port;
+
+    {
+      ScopedLock hold(m_mutex);
+      m_incoming.push_back(request.release());
+    }
+    wakeUp();
+  }
+
+  int getPendingCount() const
+  {
+    ScopedLock hold(m_mutex);
+    return m_pending;
+  }
+
+  HttpClientStats getStats() const
+  {
+    ScopedLock hold(m_mutex);
+    return m_stats;
+  }
+
+private:
+
+  template<typename Container>
+  static void deleteAll(Container& container)
+  {
+    for (typename Container::iterator
+	   it = container.begin(); it != container.end(); ++it)
+      delete *it;
+    container.clear();
+  }
+
+  void wakeUp()
+  {
+    char c = 0;
+    send_bytes(m_wakeup[1], &c, 1);
+  }
+
+  // Sends the request back to the thread that made it
+  void deliver(Request* request)
+  {
+    {
+      ScopedLock hold(m_mutex);
+      --m_pending;
+    }
+    details::enqueueCall(m_threadId, new Delivery(request));
+  }
+
+  void fail(Request* request, const String& error)
+  {
+    request->response = HttpResponse();
+    request->response.setError(error);
+    deliver(request);
+  }
+
+  // ======================================================================
+  // Network thread
+
+  void run()
+  {
+    for (;;) {
+      // take the new requests
+      {
+	ScopedLock hold(m_mutex);
+	if (m_stop)
+	  break;
+
+	while (!m_incoming.empty()) {
+	  Request* request = m_incoming.front();
+	  m_incoming.pop_front();
+	  getHost(request)->queue.push_back(request);
+	}
+      }
+
+      std::vector<Connection*> connections;
+      std::map<std::string, Host*>::iterator it;
+      for (it = m_hosts.begin(); it != m_hosts.end(); ++it) {
+	dispatch(it->second);
+	connections.insert(connections.end(),
+			   it->second->connections.begin(),
+			   it->second->connections.end());
+      }
+
+      // wait until some socket is ready (the first one is m_wakeup[0])
+      std::vector<socket_wait> sockets(connections.size()+1);
+      sockets[0].socket = m_wakeup[0];
+      sockets[0].read = true;
+      sockets[0].write = false;
+
+      for (size_t i=0; i<connections.size(); ++i) {
+	Connection* conn = connections[i];
+	sockets[i+1].socket = conn->socket;
+	sockets[i+1].read = !conn->connecting;
+	sockets[i+1].write = (conn->connecting || conn->outputPos < conn->output.size());
+      }
+
+      if (!wait_sockets(sockets))
+	continue;
+
+      if (sockets[0].readable) {
+	while (recv_bytes(m_wakeup[0], &m_buffer[0], m_buffer.size()) > 0)
+	  ;
+      }
+
+      for (size_t i=0; i<connections.size(); ++i) {
+	Connection* conn = connections[i];
+	bool writable = sockets[i+1].writable;
+	bool readable = sockets[i+1].readable;
+
+	if (conn->connecting) {
+	  if (!writable)
+	    continue;
+
+	  if (get_socket_error(conn->socket) != 0) {
+	    close(conn, L"Can't connect to " + host_name(conn->host));
+	    continue;
+	  }
+	  conn->connecting = false;
+	}
+
+	if (writable && !flush(conn))
+	  continue;
+
+	if (readable)
+	  receive(conn);
+      }
+    }
+  }
+
+  static String host_name(Host* host)
+  {
+    String name;
+    utf8_to_wide(host->name.c_str(), host->name.size(), name);
+    return name;
+  }
+
+  Host* getHost(Request* request)
+  {
+    char port[32];
+    std::sprintf(port, ":%d", request->port);
+
+    Host*& host = m_hosts[request->host + port];
+    if (!host) {
+      host = new Host;
+      host->name = request->host;
+      host->port = request->port;
+    }
+    return host;
+  }
+
+  // Assigns the queued requests of the host to its connections
+  void dispatch(Host* host)
+  {
+    while (!host->queue.empty()) {
+      Request* request = host->queue.front();
+      Connection* conn = findConnection(host, request);
+      if (!conn) {
+	// if the host cannot be reached, its requests fail (they
+	// wait if no more sockets can be waited)
+	if (host->connections.empty() && m_sockets < max_waited_sockets) {
+	  host->queue.pop_front();
+	  fail(request, L"Can't connect to " + host_name(host));
+	  continue;
+	}
+	break;
+      }
+
+      host->queue.pop_front();
+      send(conn, request);
+    }
+  }
+
+  Connection* findConnection(Host* host, Request* request)
+  {
+    std::vector<Connection*>::iterator it;
+
+    // an idle connection
+    for (it = host->connections.begin(); it != host->connections.end(); ++it) {
+      if (!(*it)->closing && (*it)->inflight.empty())
+	return *it;
+    }
+
+    // a new connection
+    if (static_cast<int>(host->connections.size()) < m_maxConnections &&
+	m_sockets < max_waited_sockets) {
+      Connection* conn = open(host);
+      if (conn)
+	return conn;
+    }
+
+    // pipelining in the less busy connection (only with
+    // connections that has already answered with keep-alive)
+    Connection* best = NULL;
+    if (request->idempotent) {
+      for (it = host->connections.begin(); it != host->connections.end(); ++it) {
+	Connection* conn = *it;
+	if (!conn->closing && conn->persistent &&
+	    static_cast<int>(conn->inflight.size()) < m_maxDepth &&
+	    conn->inflight.back()->idempotent &&
+	    (!best || best->inflight.size() > conn->inflight.size()))
+	  best = conn;
+      }
+    }
+    return best;
+  }
+
+  Connection* open(Host* host)
+  {
+    char port[32];
+    std::sprintf(port, "%d", host->port);
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses = NULL;
+    if (getaddrinfo(host->name.c_str(), port, &hints, &addresses) != 0)
+      return NULL;
+
+    socket_t s = invalid_socket;
+    for (addrinfo* ai = addresses; ai != NULL; ai = ai->ai_next) {
+      s = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (s == invalid_socket)
+	continue;
+
+      int on = 1;
+      setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&on), sizeof(on));
+
+      if (set_nonblocking(s) &&
+	  (::connect(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0 ||
+	   would_block()))
+	break;
+
+      close_socket(s);
+      s = invalid_socket;
+    }
+    freeaddrinfo(addresses);
+
+    if (s == invalid_socket)
+      return NULL;
+
+    Connection* conn = new Connection(s, host);
+    host->connections.push_back(conn);
+    ++m_sockets;
+    {
+      ScopedLock hold(m_mutex);
+      m_stats.connections++;
+    }
+    return conn;
+  }
+
+  void send(Connection* conn, Request* request)
+  {
+    {
+      ScopedLock hold(m_mutex);
+      m_stats.requests++;
+      if (conn->used > 0)
+	m_stats.reused++;
+      if (!conn->inflight.empty())
+	m_stats.pipelined++;
+    }
+
+    conn->used++;
+    conn->inflight.push_back(request);
+    conn->output += request->data;
+
+    if (!conn->connecting)
+      flush(conn);
+  }
+
+  // Sends the pending output, returns false if the connection was closed
+  bool flush(Connection* conn)
+  {
+    while (conn->outputPos < conn->output.size()) {
+      int bytes = send_bytes(conn->socket,
+			     conn->output.data() + conn->outputPos,
+			     static_cast<int>(conn->output.size() - conn->outputPos));
+      if (bytes > 0)
+	conn->outputPos += bytes;
+      else if (bytes < 0 && would_block())
+	return true;
+      else {
+	close(conn, L"Connection lost with " + host_name(conn->host));
+	return false;
+      }
+    }
+
+    conn->output.clear();
+    conn->outputPos = 0;
+    return true;
+  }
+
+  void receive(Connection* conn)
+  {
+    for (;;) {
+      int bytes = recv_bytes(conn->socket, &m_buffer[0], static_cast<int>(m_buffer.size()));
+      if (bytes > 0) {
+	if (!conn->inflight.empty())
+	  conn->started = true;
+
+	if (!parse(conn, &m_buffer[0], bytes)) {
+	  close(conn, L"Connection closed by " + host_name(conn->host));
+	  return;
+	}
+      }
+      else if (bytes < 0 && would_block())
+	break;
+      else {
+	// the server has closed the connection
+	close(conn, L"Connection closed by " + host_name(conn->host));
+	return;
+      }
+    }
+  }
+
+  // Parses the received bytes. The body is given to the reader of the
+  // request directly from the receive buffer (only the status line and
+  // headers are copied). Returns false if the connection cannot be
+  // used anymore.
+  bool parse(Connection* conn, const char* data, size_t size)
+  {
+    const char* end = data + size;
+    bool ok = true;
+
+    while (ok && data < end && !conn->inflight.empty()) {
+      Request* request = conn->inflight.front();
+
+      switch (conn->state) {
+
+	case Body:
+	case BodyUntilClose:
+	case ChunkData: {
+	  size_t bytes = end - data;
+	  if (conn->state != BodyUntilClose && bytes > conn->bodyLeft)
+	    bytes = static_cast<size_t>(conn->bodyLeft);
+
+	  ok = write(conn, request, data, bytes);
+	  data += bytes;
+	  if (!ok || conn->state == BodyUntilClose)
+	    break;
+
+	  conn->bodyLeft -= bytes;
+	  if (conn->bodyLeft == 0) {
+	    if (conn->state == Body)
+	      ok = complete(conn);
+	    else
+	      conn->state = ChunkEnd;
+	  }
+	  break;
+	}
+
+	default: {
+	  const char* eol = static_cast<const char*>(std::memchr(data, '\n', end-data));
+	  if (!eol) {
+	    conn->line.append(data, end);
+	    data = end;
+	    if (conn->line.size() > maxLineLength)
+	      ok = cancel(conn, L"Invalid response");
+	    break;
+	  }
+
+	  std::string line;
+	  line.swap(conn->line);
+	  line.append(data, eol);
+	  data = eol+1;
+
+	  if (!line.empty() && line[line.size()-1] == '\r')
+	    line.erase(line.size()-1);
+
+	  ok = parseLine(conn, request, line);
+	  break;
+	}
+      }
+    }
+
+    // the next response has started to arrive
+    if (data < end)
+      conn->started = true;
+    return ok;
+  }
+
+  bool parseLine(Connection* conn, Request* request, const std::string& line)
+  {
+    HttpResponse& response = request->response;
+
+    switch (conn->state) {
+
+      case StatusLine: {
+	int major = 0, minor = 0, code = 0;
+	if (std::sscanf(line.c_str(), "HTTP/%d.%d %d", &major, &minor, &code) != 3)
+	  return false;
+
+	response = HttpResponse();
+	response.setStatusCode(code);
+	conn->keepAlive = (major == 1 && minor >= 1);
+	conn->chunked = false;
+	conn->encoding.clear();
+	conn->bodyLeft = unknownLength;
+	conn->state = Headers;
+	return true;
+      }
+
+      case Headers:
+      case Trailers: {
+	if (line.empty()) {
+	  if (conn->state == Trailers)
+	    return complete(conn);
+	  else
+	    return startBody(conn, request);
+	}
+
+	size_t colon = line.find(':');
+	if (colon == std::string::npos)
+	  return true;
+
+	std::string name = line.substr(0, colon);
+	std::string value = trim(line.substr(colon+1));
+	response.addHeader(name, value);
+
+	if (conn->state == Trailers)
+	  return true;
+
+	if (equal_nocase(name, "Connection")) {
+	  if (equal_nocase(value, "close"))
+	    conn->keepAlive = false;
+	  else if (equal_nocase(value, "keep-alive"))
+	    conn->keepAlive = true;
+	}
+	else if (equal_nocase(name, "Content-Length")) {
+	  if (!parse_content_length(value, conn->bodyLeft))
+	    return cancel(conn, L"Invalid Content-Length");
+	}
+	else if (equal_nocase(name, "Content-Encoding"))
+	  conn->encoding = value;
+	else if (equal_nocase(name, "Transfer-Encoding")) {
+	  if (equal_nocase(value, "chunked"))
+	    conn->chunked = true;
+	  else if (!equal_nocase(value, "identity"))
+	    return cancel(conn, L"Unsupported transfer encoding");
+	}
+	return true;
+      }
+
+      case ChunkSize: {
+	// the chunk extensions (after ';') are ignored
+	uint64 size;
+	size_t digits = parse_length(line, 16, unknownLength-1, size);
+	if (digits == 0 ||
+	    (digits < line.size() &&
+	     line[digits] != ';' && line[digits] != ' ' && line[digits] != '\t'))
+	  return cancel(conn, L"Invalid chunk");
+
+	if (size == 0)
+	  conn->state = Trailers;
+	else {
+	  conn->bodyLeft = size;
+	  conn->state = ChunkData;
+	}
+	return true;
+      }
+
+      case ChunkEnd:
+	if (!line.empty())
+	  return cancel(conn, L"Invalid chunk");
+
+	conn->state = ChunkSize;
+	return true;
+
+      default:
+	assert(false);
+	return false;
+    }
+  }
+
+  // The headers of the response were received
+  bool startBody(Connection* conn, Request* request)
+  {
+    HttpResponse& response = request->response;
+    int code = response.getStatusCode();
+
+    // "100 Continue" and other informational responses
+    if (code >= 100 && code < 200) {
+      conn->state = StatusLine;
+      return true;
+    }
+
+    if (request->reader && !request->reader->onResponse(response)) {
+      {
+	ScopedLock hold(m_mutex);
+	m_stats.canceled++;
+      }
+      return cancel(conn, L"Canceled by the body reader");
+    }
+
+    if (request->method == "HEAD" || code == 204 || code == 304)
+      return complete(conn);
+
+    conn->inflater = Inflater::create(conn->encoding);
+
+    if (conn->chunked)
+      conn->state = ChunkSize;
+    else if (conn->bodyLeft == unknownLength) {
+      conn->state = BodyUntilClose;
+      conn->keepAlive = false;
+    }
+    else if (conn->bodyLeft == 0)
+      return complete(conn);
+    else {
+      conn->state = Body;
+
+      // avoid reallocations of the body
+      if (!request->reader && !conn->inflater)
+	response.getBody().reserve(static_cast<size_t>(std::min<uint64>(conn->bodyLeft, maxReserve)));
+    }
+    return true;
+  }
+
+  // Decodes the bytes of the body (if it is needed) and gives them to
+  // the request
+  bool write(Connection* conn, Request* request, const char* data, size_t size)
+  {
+    if (!conn->inflater)
+      return consume(conn, request, data, size);
+
+    conn->inflater->setInput(data, size);
+
+    int bytes;
+    while ((bytes = conn->inflater->next(&m_decoded[0], m_decoded.size())) > 0) {
+      if (!consume(conn, request, &m_decoded[0], bytes))
+	return false;
+    }
+
+    if (bytes < 0)
+      return cancel(conn, L"Invalid compressed data");
+    return true;
+  }
+
+  bool consume(Connection* conn, Request* request, const char* data, size_t size)
+  {
+    if (!request->reader) {
+      request->response.getBody().append(data, size);
+      return true;
+    }
+
+    if (request->reader->onData(data, size))
+      return true;
+
+    {
+      ScopedLock hold(m_mutex);
+      m_stats.canceled++;
+    }
+    return cancel(conn, L"Canceled by the body reader");
+  }
+
+  // The response of the first request fails, the connection must be
+  // closed (the other requests are retried)
+  bool cancel(Connection* conn, const String& error)
+  {
+    Request* request = conn->inflight.front();
+    conn->inflight.pop_front();
+    conn->started = false;
+
+    fail(request, error);
+    return false;
+  }
+
+  // The response of the first request is complete
+  bool complete(Connection* conn)
+  {
+    Request* request = conn->inflight.front();
+    conn->inflight.pop_front();
+    conn->state = StatusLine;
+    conn->started = false;
+
+    delete conn->inflater;
+    conn->inflater = NULL;
+
+    if (conn->keepAlive)
+      conn->persistent = true;
+    else
+      conn->closing = true;
+
+    deliver(request);
+    return !conn->closing;
+  }
+
+  // Closes the connection, its requests without response are sent
+  // again (if it is possible) or they fail
+  void close(Connection* conn, const String& error)
+  {
+    Host* host = conn->host;
+
+    // a response without Content-Length is complete now
+    if (!conn->inflight.empty() && conn->state == BodyUntilClose)
+      complete(conn);
+
+    while (!conn->inflight.empty()) {
+      Request* request = conn->inflight.back();
+      conn->inflight.pop_back();
+
+      // the first request can be partially received
+      bool started = (conn->inflight.empty() && conn->started);
+
+      if (request->idempotent && !request->retried && !started) {
+	request->retried = true;
+	host->queue.push_front(request);
+
+	ScopedLock hold(m_mutex);
+	m_stats.retried++;
+      }
+      else
+	fail(request, error);
+    }
+
+    close_socket(conn->socket);
+    remove_from_container(host->connections, conn);
+    --m_sockets;
+    delete conn;
+  }
+
+};
+
+// ======================================================================
+// HttpClient
+
+/**
+   Creates a client and its network thread.
+
+   @param maxConnectionsPerHost
+     Number of connections that can be opened to each host.
+
+   @param maxPipelineDepth
+     Number of requests that can wait their responses in each
+     connection. Use 1 to disable pipelining.
+
+   @throw HttpClientException
+*/
+HttpClient::HttpClient(int maxConnectionsPerHost, int maxPipelineDepth)
+  : m_impl(new HttpClientImpl(maxConnectionsPerHost, maxPipelineDepth))
+{
+  assert(maxConnectionsPerHost > 0);
+  assert(maxPipelineDepth > 0);
+}
+
+/**
+   Closes all the connections. The callbacks of the requests that did
+   not receive a response are not called.
+*/
+HttpClient::~HttpClient()
+{
+  delete m_impl;
+}
+
+/**
+   Returns the number of requests that are waiting their response
+   (their callbacks could be still waiting in the message queue).
+*/
+int HttpClient::getPendingCount() const
+{
+  return m_impl->getPendingCount();
+}
+
+HttpClientStats HttpClient::getStats() const
+{
+  return m_impl->getStats();
+}
+
+void HttpClient::enqueue(const String& method, const String& url,
+			 const String& headers, const std::string& body,
+			 HttpBodyReader* reader, Callback* callback)
+{
+  m_impl->enqueue(method, url, headers, body, reader, callback);
+}
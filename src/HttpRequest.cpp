@@ -31,6 +31,7 @@
 
 #include "Vaca/HttpRequest.h"
 #include "Vaca/String.h"
+#include "Vaca/Url.h"
 
 #include <memory>
 #include <cassert>
@@ -73,10 +74,11 @@ HttpRequest::InetConnection::InetConnection(const String& agentName)
 // HttpRequest::InetSession
 
 HttpRequest::InetSession::InetSession(InetConnection& conn,
-				      const String& host)
+				      const String& host,
+				      int port)
   : InetHandle(InternetConnect(conn.handle,
 			       host.c_str(),
-			       INTERNET_DEFAULT_HTTP_PORT,
+			       port >= 0 ? port: INTERNET_DEFAULT_HTTP_PORT,
 			       NULL, NULL, INTERNET_SERVICE_HTTP, 0, 0),
 	       String(L"Can't open a HTTP session with ") + host)
 {
@@ -103,7 +105,7 @@ HttpRequest::InetRequest::InetRequest(InetSession& ses,
 HttpRequest::HttpRequest(const String& url,
 			 const String& method)
     : conn(L"Mozilla/4.0 (compatible; MSIE 7.0; Windows NT 5.1)")
-    , ses(conn, url_host(url))
+    , ses(conn, url_host(url), UrlView(url).getPortNumber())
     , req(ses, method, url_object(url))
 {
 }
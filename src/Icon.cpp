@@ -32,6 +32,7 @@
 #include "Vaca/Icon.h"
 #include "Vaca/Application.h"
 #include "Vaca/Debug.h"
+#include "Vaca/Format.h"
 #include "Vaca/ResourceException.h"
 #include "Vaca/String.h"
 
@@ -77,7 +78,7 @@ Icon::Icon(ResourceId iconId, const Size& sz)
 		 IMAGE_ICON,
 		 sz.w, sz.h, 0));
   if (handle == NULL)
-    throw ResourceException(format_string(L"Can't load the icon resource %d", iconId.getId()));
+    throw ResourceException(format_text(L"Can't load the icon resource {}", iconId.getId()));
 
   get()->setHandle(handle);
 }
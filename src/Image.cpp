@@ -31,6 +31,7 @@
 
 #include "Vaca/Image.h"
 #include "Vaca/Debug.h"
+#include "Vaca/Format.h"
 #include "Vaca/Graphics.h"
 #include "Vaca/Application.h"
 #include "Vaca/ResourceException.h"
@@ -75,8 +76,8 @@ Image::Image(ResourceId imageId)
   // HBITMAP
   HBITMAP hbmp = LoadBitmap(Application::getHandle(), imageId.toLPTSTR());
   if (hbmp == NULL)
-    throw ResourceException(format_string(L"Can't load the image resource %d",
-					  imageId.getId()));
+    throw ResourceException(format_text(L"Can't load the image resource {}",
+					imageId.getId()));
 
   get()->m_hdc = GetDC(GetDesktopWindow());
   get()->setHandle(hbmp);
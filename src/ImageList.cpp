@@ -32,6 +32,7 @@
 #include "Vaca/ImageList.h"
 #include "Vaca/Application.h"
 #include "Vaca/Debug.h"
+#include "Vaca/Format.h"
 #include "Vaca/ResourceException.h"
 #include "Vaca/String.h"
 #include "Vaca/win32.h"
@@ -73,8 +74,8 @@ ImageList::ImageList(ResourceId bitmapId, int widthPerIcon, Color maskColor)
 			LR_CREATEDIBSECTION);
 
   if (himagelist == NULL)
-    throw ResourceException(format_string(L"Can't create the image-list resource %d",
-					  bitmapId.getId()));
+    throw ResourceException(format_text(L"Can't create the image-list resource {}",
+					bitmapId.getId()));
 
   get()->setHandle(himagelist);
 }
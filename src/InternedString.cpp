@@ -0,0 +1,370 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/InternedString.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <new>
+
+#ifdef VACA_ON_WINDOWS
+  #include <windows.h>
+#endif
+
+using namespace Vaca;
+
+typedef InternedString::Entry Entry;
+
+// initial number of slots of the hash table (a power of two)
+#define POOL_TABLE_SIZE		1024
+
+// The empty string is not in the pool, and its references are not
+// counted (it is the only entry with size == 0)
+static Entry empty_entry = { 0, 0, 0, { 0 } };
+
+// The pool: an open addressing hash table (with linear probing) of
+// entries allocated with malloc()
+static Mutex pool_mutex;
+static Entry** pool_table = NULL;
+static size_t pool_table_size = 0;
+static size_t pool_count = 0;
+static size_t pool_bytes = 0;
+
+static inline void add_ref(long* refs)
+{
+#ifdef VACA_ON_WINDOWS
+  InterlockedIncrement(refs);
+#else
+  __sync_add_and_fetch(refs, 1);
+#endif
+}
+
+// Returns the new number of references
+static inline long remove_ref(long* refs)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedDecrement(refs);
+#else
+  return __sync_sub_and_fetch(refs, 1);
+#endif
+}
+
+// Returns the number of references before the operation
+static inline long compare_and_swap(long* refs, long oldValue, long newValue)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedCompareExchange(refs, newValue, oldValue);
+#else
+  return __sync_val_compare_and_swap(refs, oldValue, newValue);
+#endif
+}
+
+static size_t hash_string(const Char* str, size_t size)
+{
+  // FNV-1a over the characters
+  size_t hash = static_cast<size_t>(2166136261u);
+  for (size_t i=0; i<size; ++i) {
+    hash ^= static_cast<size_t>(str[i]);
+    hash *= static_cast<size_t>(16777619u);
+  }
+  // zero is the hash of the empty string
+  return hash != 0 ? hash: 1;
+}
+
+static inline size_t entry_bytes(size_t size)
+{
+  return sizeof(Entry) + size*sizeof(Char);
+}
+
+static void pool_rehash(size_t newSize)
+{
+  Entry** table = static_cast<Entry**>(std::calloc(newSize, sizeof(Entry*)));
+  if (table == NULL)
+    throw std::bad_alloc();
+
+  for (size_t i=0; i<pool_table_size; ++i) {
+    Entry* entry = pool_table[i];
+    if (entry != NULL) {
+      size_t j = entry->hash & (newSize-1);
+      while (table[j] != NULL)
+	j = (j+1) & (newSize-1);
+      table[j] = entry;
+    }
+  }
+
+  std::free(pool_table);
+  pool_table = table;
+  pool_table_size = newSize;
+}
+
+// Returns the slot of the table where the string is (or the empty
+// slot where it should be added). The pool_mutex must be locked.
+static size_t pool_slot(const Char* str, size_t size, size_t hash)
+{
+  size_t mask = pool_table_size-1;
+  size_t i = hash & mask;
+  for (; pool_table[i] != NULL; i = (i+1) & mask) {
+    const Entry* entry = pool_table[i];
+    if (entry->hash == hash &&
+	entry->size == size &&
+	std::wmemcmp(entry->text, str, size) == 0)
+      break;
+  }
+  return i;
+}
+
+// Removes the entry from the table and frees it. The pool_mutex must
+// be locked.
+static void pool_remove(Entry* entry)
+{
+  size_t mask = pool_table_size-1;
+  size_t i = entry->hash & mask;
+  while (pool_table[i] != entry)
+    i = (i+1) & mask;
+
+  // move back the next entries of the cluster that cannot be reached
+  // from their home slot after emptying the slot "i"
+  for (size_t j = (i+1) & mask; pool_table[j] != NULL; j = (j+1) & mask) {
+    size_t home = pool_table[j]->hash & mask;
+    bool reachable = (i <= j ? (i < home && home <= j):
+				(i < home || home <= j));
+    if (!reachable) {
+      pool_table[i] = pool_table[j];
+      i = j;
+    }
+  }
+  pool_table[i] = NULL;
+
+  --pool_count;
+  pool_bytes -= entry_bytes(entry->size);
+  std::free(entry);
+}
+
+/**
+   Creates the empty string. It does not touch the pool.
+*/
+InternedString::InternedString()
+  : m_entry(&empty_entry)
+{
+}
+
+InternedString::InternedString(const Char* str)
+  : m_entry(intern(str, std::wcslen(str)))
+{
+}
+
+InternedString::InternedString(const String& str)
+  : m_entry(intern(str.c_str(), str.size()))
+{
+}
+
+InternedString::InternedString(const StringView& str)
+  : m_entry(intern(str.data(), str.size()))
+{
+}
+
+InternedString::InternedString(const InternedString& other)
+  : m_entry(other.m_entry)
+{
+  if (m_entry->size != 0)
+    add_ref(&m_entry->refs);
+}
+
+/**
+   Releases the string, it is removed from the pool if this was the
+   last reference to it.
+*/
+InternedString::~InternedString()
+{
+  release();
+}
+
+InternedString& InternedString::operator=(const InternedString& other)
+{
+  InternedString copy(other);
+  swap(copy);
+  return *this;
+}
+
+/**
+   Compares the characters of both strings, like String::compare.
+*/
+int InternedString::compare(const InternedString& other) const
+{
+  if (m_entry == other.m_entry)
+    return 0;
+
+  size_t size = std::min(m_entry->size, other.m_entry->size);
+  int res = std::wmemcmp(m_entry->text, other.m_entry->text, size);
+  if (res != 0)
+    return res;
+  else if (m_entry->size < other.m_entry->size)
+    return -1;
+  else
+    return m_entry->size > other.m_entry->size ? 1: 0;
+}
+
+void InternedString::swap(InternedString& other)
+{
+  std::swap(m_entry, other.m_entry);
+}
+
+/**
+   Looks for @a str in the pool without adding it.
+
+   @return True if the string is in the pool, and then @a result is
+	   set to it (the empty string is always found). False if no
+	   InternedString has those characters.
+*/
+bool InternedString::find(const StringView& str, InternedString& result)
+{
+  if (str.empty()) {
+    result = InternedString();
+    return true;
+  }
+
+  size_t hash = hash_string(str.data(), str.size());
+  Entry* entry = NULL;
+  {
+    ScopedLock hold(pool_mutex);
+
+    if (pool_table != NULL) {
+      entry = pool_table[pool_slot(str.data(), str.size(), hash)];
+      if (entry != NULL)
+	add_ref(&entry->refs);
+    }
+  }
+
+  if (entry == NULL)
+    return false;
+
+  InternedString found(entry);
+  result.swap(found);
+  return true;
+}
+
+/**
+   Returns the number of different strings in the pool.
+*/
+size_t InternedString::getPoolCount()
+{
+  ScopedLock hold(pool_mutex);
+  return pool_count;
+}
+
+/**
+   Returns the memory used by the pool, in bytes: the strings and the
+   hash table.
+*/
+size_t InternedString::getPoolBytes()
+{
+  ScopedLock hold(pool_mutex);
+  return pool_bytes + pool_table_size * sizeof(Entry*);
+}
+
+/**
+   Removes one reference to the entry, and removes the entry from the
+   pool if it was the last one.
+
+   @internal
+*/
+void InternedString::release()
+{
+  if (m_entry->size == 0)
+    return;
+
+  // while there are other references, just decrement the counter
+  // (the first guess of the counter is 2, compare_and_swap returns
+  // the real value if it is not)
+  long refs = 2;
+  while (refs > 1) {
+    long prev = compare_and_swap(&m_entry->refs, refs, refs-1);
+    if (prev == refs)
+      return;
+    refs = prev;
+  }
+
+  // this could be the last reference: intern() and find() add
+  // references to entries of the pool only with the pool_mutex
+  // locked, so we have to lock it to remove the entry safely
+  ScopedLock hold(pool_mutex);
+  if (remove_ref(&m_entry->refs) == 0)
+    pool_remove(m_entry);
+}
+
+/**
+   Returns the entry of the pool with the characters of @a str (with
+   a new reference), adding it if it is not there yet.
+
+   @internal
+*/
+Entry* InternedString::intern(const Char* str, size_t size)
+{
+  if (size == 0)
+    return &empty_entry;
+
+  size_t hash = hash_string(str, size);
+
+  ScopedLock hold(pool_mutex);
+
+  if (pool_table == NULL)
+    pool_rehash(POOL_TABLE_SIZE);
+
+  size_t i = pool_slot(str, size, hash);
+  if (pool_table[i] != NULL) {
+    add_ref(&pool_table[i]->refs);
+    return pool_table[i];
+  }
+
+  // a new string
+  Entry* entry = static_cast<Entry*>(std::malloc(entry_bytes(size)));
+  if (entry == NULL)
+    throw std::bad_alloc();
+
+  entry->refs = 1;
+  entry->hash = hash;
+  entry->size = size;
+  std::wmemcpy(entry->text, str, size);
+  entry->text[size] = 0;
+
+  pool_table[i] = entry;
+  pool_bytes += entry_bytes(size);
+
+  // keep the load factor under 1/2
+  if (++pool_count > pool_table_size/2)
+    pool_rehash(pool_table_size*2);
+
+  return entry;
+}
@@ -32,6 +32,7 @@
 #include "Vaca/Menu.h"
 #include "Vaca/MenuItemEvent.h"
 #include "Vaca/Debug.h"
+#include "Vaca/Format.h"
 #include "Vaca/System.h"
 #include "Vaca/Mdi.h"
 #include "Vaca/ResourceException.h"
@@ -348,7 +349,7 @@ Menu::Menu(CommandId menuId)
 		       MAKEINTRESOURCE(menuId));
 
   if (m_handle == NULL)
-    throw ResourceException(format_string(L"Can't load the menu resource %d", menuId));
+    throw ResourceException(format_text(L"Can't load the menu resource {}", menuId));
 
   subClass();
 }
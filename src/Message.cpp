@@ -30,10 +30,23 @@
 // OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Vaca/Message.h"
+#include "Vaca/Format.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
 #include "Vaca/String.h"
 
 using namespace Vaca;
 
+#ifndef WM_MOUSEHWHEEL
+#define WM_MOUSEHWHEEL 0x020E
+#endif
+
+// Registered messages (0xC000-0xFFFF) created as coalescible, one bit
+// for each message. It is only read by the message loops, so only
+// the writers need the mutex.
+static Mutex coalescible_mutex;
+static unsigned char coalescible_messages[0x4000 / 8];
+
 Message::Message()
 {
 }
@@ -45,20 +58,35 @@ Message::Message()
    a customized message you have to overload the Widget#preTranslateMessage
    member function.
 
+   @param name
+     Name of the message, the same name in any thread (or process)
+     gives the same type of message.
+
+   @param coalescible
+     True if consecutive messages of this type to the same destination
+     can be merged by the message loop: only the last one is
+     processed (see #coalesce). Do not use it for messages which
+     transfer the ownership of the payload.
+
    @see Widget#enqueueMessage, Widget#preTranslateMessage,
 	@ref page_tn_015, @link page_examples Threads example@endlink
 */
-Message::Message(const String& name)
+Message::Message(const String& name, bool coalescible)
 {
   UINT message = ::RegisterWindowMessage(name.c_str());
   if (message == 0 || message < 0xC000 || message > 0xFFFF)
-    throw MessageException(format_string(L"Error registering type of message '%s'.", name.c_str()));
+    throw MessageException(format_text(L"Error registering type of message '{}'.", name));
 
   m_msg.hwnd = NULL;
   m_msg.message = message;
   m_msg.wParam = 0;
   m_msg.lParam = 0;
   m_msg.time = 0;
+
+  if (coalescible) {
+    ScopedLock hold(coalescible_mutex);
+    coalescible_messages[(message - 0xC000) / 8] |= 1 << (message % 8);
+  }
 }
 
 /**
@@ -106,3 +134,77 @@ void* Message::getPayload()
   return reinterpret_cast<void*>(m_msg.lParam);
 }
 
+/**
+   Returns true if the message loop can merge this message with the
+   next one (see #coalesce).
+
+   Coalescible messages are mouse movements, mouse-wheel rotations,
+   dragging of scroll-bar thumbs and the custom messages created as
+   coalescible (see Message#Message(const String&, bool)).
+*/
+bool Message::isCoalescible() const
+{
+  switch (m_msg.message) {
+
+    case WM_MOUSEMOVE:
+    case WM_NCMOUSEMOVE:
+    case WM_MOUSEWHEEL:
+    case WM_MOUSEHWHEEL:
+      return true;
+
+    case WM_HSCROLL:
+    case WM_VSCROLL:
+      return LOWORD(m_msg.wParam) == SB_THUMBTRACK;
+
+    default:
+      if (m_msg.message >= 0xC000 && m_msg.message <= 0xFFFF)
+	return (coalescible_messages[(m_msg.message - 0xC000) / 8]
+		& (1 << (m_msg.message % 8))) != 0;
+      return false;
+  }
+}
+
+/**
+   Merges the @a next message in this one, if both have the same type
+   and destination. This message takes the state of @a next (e.g.
+   the last position of the mouse), except for mouse-wheel messages
+   which accumulate the rotation.
+
+   @return
+     True if the messages were merged (so @a next must be discarded).
+*/
+bool Message::coalesce(const Message& next)
+{
+  if (!isCoalescible() ||
+      next.m_msg.message != m_msg.message ||
+      next.m_msg.hwnd != m_msg.hwnd)
+    return false;
+
+  switch (m_msg.message) {
+
+    case WM_MOUSEWHEEL:
+    case WM_MOUSEHWHEEL: {
+      int delta = (short)HIWORD(m_msg.wParam) + (short)HIWORD(next.m_msg.wParam);
+      if (delta < -32768 || delta > 32767)
+	return false;
+
+      m_msg = next.m_msg;
+      m_msg.wParam = MAKEWPARAM(LOWORD(next.m_msg.wParam), delta);
+      break;
+    }
+
+    case WM_HSCROLL:
+    case WM_VSCROLL:
+      if (LOWORD(next.m_msg.wParam) != SB_THUMBTRACK ||
+	  next.m_msg.lParam != m_msg.lParam) // from other scroll bar
+	return false;
+
+      m_msg = next.m_msg;
+      break;
+
+    default:
+      m_msg = next.m_msg;
+      break;
+  }
+  return true;
+}
@@ -0,0 +1,608 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/Thread.h"
+#include "Vaca/Debug.h"
+#include "Vaca/Frame.h"
+#include "Vaca/GdiObjectCache.h"
+#include "Vaca/Message.h"
+#include "Vaca/MessageQueue.h"
+#include "Vaca/Signal.h"
+#include "Vaca/Timer.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/Slot.h"
+#include "Vaca/TimePoint.h"
+
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+using namespace Vaca;
+
+// ======================================================================
+
+// TODO
+// - replace with some C++0x's Thread-Local Storage
+// - use __thread in GCC, and __declspec( thread ) in MSVC
+// - use TlsAlloc
+
+struct ThreadData
+{
+  /**
+     The ID of this thread.
+  */
+  ThreadId threadId;
+
+  /**
+     Visible frames in this thread. A frame is an instance of Frame
+     class.
+  */
+  std::vector<Frame*> frames;
+
+  TimePoint updateIndicatorsMark;
+  bool updateIndicators : 1;
+
+  /**
+     True if the message-loop must be stopped.
+  */
+  bool breakLoop : 1;
+
+  /**
+     Widget used to call createHandle.
+  */
+  Widget* outsideWidget;
+
+  /**
+     Pens, brushes and fonts shared in this thread.
+  */
+  GdiObjectCache gdiObjects;
+
+  /**
+     Messages from other threads (see Thread#enqueueMessage).
+  */
+  MessageQueue messages;
+
+  /**
+     Number of consecutive messages taken from "messages" (see
+     CurrentThread#getMessage).
+  */
+  int messagesInARow;
+
+  /**
+     Message removed from the OS queue while other message was
+     coalesced, but that could not be merged in it. It is returned
+     by the next CurrentThread#getMessage or CurrentThread#peekMessage.
+  */
+  Message pending;
+  bool hasPending;
+
+  /**
+     Messages received and dispatched (see CurrentThread#getMessageStats).
+  */
+  MessageStats stats;
+
+  ThreadData(ThreadId id) {
+    threadId = id;
+    breakLoop = false;
+    updateIndicators = true;
+    outsideWidget = NULL;
+    messagesInARow = 0;
+    hasPending = false;
+    stats.received = 0;
+    stats.dispatched = 0;
+  }
+
+};
+
+static Mutex data_mutex;
+static std::vector<ThreadData*> dataOfEachThread;
+
+static ThreadData* get_thread_data(ThreadId id)
+{
+  ScopedLock hold(data_mutex);
+  std::vector<ThreadData*>::iterator it, end = dataOfEachThread.end();
+
+  // first of all search the thread-data in the list "dataOfEachThread"...
+  for (it=dataOfEachThread.begin();
+       it!=end;
+       ++it) {
+    if ((*it)->threadId == id)	// it's already created...
+      return *it;		// return it
+  }
+
+  // create the data for the this thread
+  ThreadData* data = new ThreadData(id);
+  VACA_TRACE("new data-thread %d\n", id);
+
+  // add it to the list
+  dataOfEachThread.push_back(data);
+
+  // return the allocated data
+  return data;
+}
+
+static ThreadData* get_thread_data()
+{
+  return get_thread_data(CurrentThread::getId());
+}
+
+
+// RegisterWindowMessage returns the same ID for all threads, so
+// there is no problem if two threads initialize these messages at the
+// same time
+
+// Message used to call a slot in other thread (see details::enqueueCall)
+static UINT get_call_message()
+{
+  static UINT message = 0;
+  if (message == 0)
+    message = ::RegisterWindowMessage(L"Vaca.Thread.Call");
+  return message;
+}
+
+// Message posted to wake up a thread when its MessageQueue receives
+// the first message of a batch
+static UINT get_wakeup_message()
+{
+  static UINT message = 0;
+  if (message == 0)
+    message = ::RegisterWindowMessage(L"Vaca.Thread.WakeUp");
+  return message;
+}
+
+static bool same_message(const MSG& a, const MSG& b)
+{
+  return (a.hwnd == b.hwnd &&
+	  a.message == b.message &&
+	  a.wParam == b.wParam &&
+	  a.lParam == b.lParam &&
+	  a.time == b.time);
+}
+
+// Called for each message taken from the queues: merges the next
+// messages of the same queue in it (see Message#coalesce)
+static void take_message(ThreadData* data, Message& message, bool fromQueue)
+{
+  ++data->stats.received;
+
+  while (message.isCoalescible()) {
+    if (fromQueue) {
+      const Message* next = data->messages.front();
+      if (!next || !message.coalesce(*next))
+	break;
+
+      Message discarded;
+      data->messages.pop(discarded);
+    }
+    else {
+      Message next;
+      LPMSG msg = (LPMSG)message;
+      LPMSG nextMsg = (LPMSG)next;
+      nextMsg->hwnd = NULL;
+      if (!::PeekMessage(nextMsg, NULL, 0, 0, PM_NOREMOVE) ||
+	  nextMsg->message != msg->message ||
+	  nextMsg->hwnd != msg->hwnd)
+	break;
+
+      // Remove only the peeked message: a message posted after the
+      // PM_NOREMOVE could be before it in the queue (posted messages
+      // go before input messages). -1 filters thread messages.
+      Message removed;
+      LPMSG removedMsg = (LPMSG)removed;
+      if (!::PeekMessage(removedMsg,
+			 nextMsg->hwnd != NULL ? nextMsg->hwnd: (HWND)-1,
+			 nextMsg->message, nextMsg->message, PM_REMOVE))
+	break;
+
+      if (!same_message(*removedMsg, *nextMsg) || !message.coalesce(removed)) {
+	data->pending = removed;
+	data->hasPending = true;
+	break;
+      }
+    }
+    ++data->stats.received;
+  }
+
+  ++data->stats.dispatched;
+}
+
+static void enqueue_message(ThreadId threadId, MessageQueue& queue, const Message& message)
+{
+  if (queue.push(message)) {
+    // If this fails is because the thread does not have a message
+    // queue yet, anyway it will look our queue before waiting
+    // messages (see CurrentThread::getMessage)
+    ::PostThreadMessage(threadId, get_wakeup_message(), 0, 0);
+  }
+}
+
+/**
+   Puts a message in the queue of the thread. It can be called from
+   any thread, and it does not wait: the message is put in a
+   lock-free MessageQueue and the thread is woken up only for the
+   first message of each batch.
+
+   The thread receives the message in its message loop (see
+   CurrentThread#getMessage).
+*/
+void Thread::enqueueMessage(const Message& message)
+{
+  // the queue is looked up once (the ThreadData is never deleted
+  // until the end of the program)
+  if (!m_queue)
+    m_queue = &get_thread_data(m_id)->messages;
+
+  enqueue_message(m_id, *m_queue, message);
+}
+
+// ======================================================================
+// CurrentThread
+
+void CurrentThread::enqueueMessage(const Message& message)
+{
+  ThreadData* data = get_thread_data();
+  enqueue_message(data->threadId, data->messages, message);
+}
+
+/**
+   Does the message loop while there are
+   visible @link Vaca::Frame frames@endlink.
+
+   @see Frame::setVisible
+*/
+void Vaca::CurrentThread::doMessageLoop()
+{
+  // message loop
+  Message msg;
+  while (getMessage(msg))
+    processMessage(msg);
+}
+
+/**
+   Does the message loop until the @a widget is hidden.
+*/
+void Vaca::CurrentThread::doMessageLoopFor(Widget* widget)
+{
+  // get widget HWND
+  HWND hwnd = widget->getHandle();
+  assert(::IsWindow(hwnd));
+
+  // get parent HWND
+  HWND hparent = widget->getParentHandle();
+
+  // disable the parent HWND
+  if (hparent != NULL)
+    ::EnableWindow(hparent, FALSE);
+
+  // message loop
+  Message message;
+  while (widget->isVisible() && getMessage(message))
+    processMessage(message);
+
+  // enable the parent HWND
+  if (hparent)
+    ::EnableWindow(hparent, TRUE);
+}
+
+void Vaca::CurrentThread::pumpMessageQueue()
+{
+  Message msg;
+  while (peekMessage(msg))
+    processMessage(msg);
+}
+
+void Vaca::CurrentThread::breakMessageLoop()
+{
+  get_thread_data()->breakLoop = true;
+  ::PostThreadMessage(CurrentThread::getId(), WM_NULL, 0, 0);
+}
+
+/**
+   Gets a message waiting for it: locks the execution of the program
+   until a message is received from the operating system.
+
+   @return
+     True if the @a message parameter was filled (because a message was received)
+     or false if there aren't more visible @link Frame frames@endlink
+     to dispatch messages.
+*/
+bool Vaca::CurrentThread::getMessage(Message& message)
+{
+  ThreadData* data = get_thread_data();
+
+  // break this loop? (explicit break or no-more visible frames)
+  if (data->breakLoop || data->frames.empty())
+    return false;
+
+  // we have to update indicators?
+  if (data->updateIndicators &&
+      data->updateIndicatorsMark.elapsed() > 0.1) {
+    data->updateIndicators = false;
+
+    // for each registered frame we should call updateIndicators to
+    // update the state of all visible indicators (like top-level
+    // items in the menu-bar and buttons in the tool-bar)
+    for (std::vector<Frame*>::iterator
+	   it = data->frames.begin(),
+	   end = data->frames.end(); it != end; ++it) {
+      (*it)->updateIndicators();
+    }
+  }
+
+  LPMSG msg = (LPMSG)message;
+
+  for (;;) {
+    // a message that take_message() could not coalesce
+    if (data->hasPending) {
+      data->hasPending = false;
+      message = data->pending;
+      break;
+    }
+
+    // messages from other threads go first, but after a long run of
+    // them we look the OS queue, so input and painting do not starve
+    if (data->messagesInARow < 64 && data->messages.pop(message)) {
+      ++data->messagesInARow;
+      take_message(data, message, true);
+      return true;
+    }
+
+    bool more = (data->messagesInARow > 0);
+    data->messagesInARow = 0;
+
+    // get the message from the OS queue (without waiting if there
+    // could be more messages in our queue)
+    msg->hwnd = NULL;
+    if (more) {
+      if (!::PeekMessage(msg, NULL, 0, 0, PM_REMOVE))
+	continue;
+
+      if (msg->message == WM_QUIT)
+	return false;
+    }
+    // WM_QUIT received?
+    else if (::GetMessage(msg, NULL, 0, 0) == 0)
+      return false;
+
+    // a wake-up only says that there are messages in our queue
+    if (msg->message != get_wakeup_message())
+      break;
+  }
+
+  take_message(data, message, false);
+
+  // WM_NULL message... maybe Timers or CallInNextRound
+  if (msg->message == WM_NULL)
+    Timer::pollTimers();
+
+  return true;
+}
+
+/**
+   Gets a message without waiting for it, if the queue is empty, this
+   member function returns false.
+
+   The message is removed from the queue.
+
+   @return
+     Returns true if the @a msg parameter was filled with the next message
+     in the queue or false if the queue was empty.
+*/
+bool CurrentThread::peekMessage(Message& message)
+{
+  ThreadData* data = get_thread_data();
+  LPMSG msg = (LPMSG)message;
+
+  for (;;) {
+    if (data->hasPending) {
+      data->hasPending = false;
+      message = data->pending;
+      take_message(data, message, false);
+      return true;
+    }
+
+    if (data->messages.pop(message)) {
+      take_message(data, message, true);
+      return true;
+    }
+
+    msg->hwnd = NULL;
+    if (!::PeekMessage(msg, NULL, 0, 0, PM_REMOVE))
+      return false;
+
+    // a wake-up only says that there are messages in our queue
+    if (msg->message != get_wakeup_message()) {
+      take_message(data, message, false);
+      return true;
+    }
+  }
+}
+
+void CurrentThread::processMessage(Message& message)
+{
+  LPMSG msg = (LPMSG)message;
+
+  if (!CurrentThread::details::preTranslateMessage(message)) {
+    // Send preTranslateMessage to the active window (useful for
+    // modeless dialogs). WARNING: Don't use GetForegroundWindow
+    // because it returns windows from other applications
+    HWND hactive = GetActiveWindow();
+    if (hactive != NULL && hactive != msg->hwnd) {
+      Widget* activeWidget = Widget::fromHandle(hactive);
+      if (activeWidget != NULL && activeWidget->preTranslateMessage(message))
+	return;
+    }
+
+    //if (!TranslateAccelerator(msg->hwnd, hAccelTable, msg))
+    //{
+    ::TranslateMessage(msg);
+    ::DispatchMessage(msg);
+    //}
+  }
+}
+
+/**
+   Returns how many messages the current thread received, and how
+   many were dispatched (returned by #getMessage or #peekMessage).
+   The difference is the number of messages merged with the
+   following one (e.g. mouse movements, see Message#coalesce).
+*/
+MessageStats CurrentThread::getMessageStats()
+{
+  return get_thread_data()->stats;
+}
+
+/**
+   Returns the cache of GDI objects (pens, brushes and fonts) of the
+   current thread.
+
+   You can use it to change the capacity of the cache, or to know
+   how many objects were created.
+
+   @see GdiObjectCache
+*/
+GdiObjectCache& CurrentThread::getGdiObjectCache()
+{
+  return get_thread_data()->gdiObjects;
+}
+
+// ======================================================================
+// Vaca internals
+
+/**
+   Pretranslates the message. The main function is to retrieve the
+   Widget pointer (using Widget::fromHandle()) and then (if it isn't
+   NULL), call its Widget#preTranslateMessage.
+*/
+bool CurrentThread::details::preTranslateMessage(Message& message)
+{
+  LPMSG msg = (LPMSG)message;
+
+  // a slot enqueued with details::enqueueCall
+  if (msg->hwnd == NULL && msg->message == get_call_message()) {
+    std::auto_ptr<Slot0<void> > slot(reinterpret_cast<Slot0<void>*>(msg->lParam));
+    (*slot)();
+    return true;
+  }
+
+  // TODO process messages that produce a update-indicators event
+  if ((msg->message == WM_ACTIVATE) ||
+      (msg->message == WM_CLOSE) ||
+      (msg->message == WM_SETFOCUS) ||
+      (msg->message == WM_KILLFOCUS) ||
+      (msg->message >= WM_LBUTTONDOWN && msg->message <= WM_MBUTTONDBLCLK) ||
+      (msg->message >= WM_KEYDOWN && msg->message <= WM_DEADCHAR)) {
+    ThreadData* data = get_thread_data();
+    data->updateIndicators = true;
+    data->updateIndicatorsMark = TimePoint();
+  }
+
+  if (msg->hwnd != NULL) {
+    Widget* widget = Widget::fromHandle(msg->hwnd);
+    if (widget && widget->preTranslateMessage(message))
+      return true;
+  }
+
+  return false;
+}
+
+/**
+    @internal
+ */
+Widget* CurrentThread::details::getOutsideWidget()
+{
+  return get_thread_data()->outsideWidget;
+}
+
+/**
+   @internal
+ */
+void CurrentThread::details::setOutsideWidget(Widget* widget)
+{
+  get_thread_data()->outsideWidget = widget;
+}
+
+/**
+   @internal
+ */
+void CurrentThread::details::addFrame(Frame* frame)
+{
+  get_thread_data()->frames.push_back(frame);
+}
+
+/**
+   @internal
+ */
+void CurrentThread::details::removeFrame(Frame* frame)
+{
+  remove_from_container(get_thread_data()->frames, frame);
+
+  // when this thread doesn't have more Frames to continue we must to
+  // break the current message loop
+  if (get_thread_data()->frames.empty())
+    CurrentThread::breakMessageLoop();
+}
+
+void details::removeAllThreadData()
+{
+  ScopedLock hold(data_mutex);
+  std::vector<ThreadData*>::iterator it, end = dataOfEachThread.end();
+
+  for (it=dataOfEachThread.begin(); it!=end; ++it) {
+    VACA_TRACE("delete data-thread %d\n", (*it)->threadId);
+    delete *it;
+  }
+
+  dataOfEachThread.clear();
+}
+
+/**
+   Enqueues a message in the specified thread to call the @a slot in
+   that thread (the message is processed in CurrentThread#processMessage).
+   The slot is deleted after the call.
+
+   @see ThreadPool, Future#postToUiThread
+*/
+void details::enqueueCall(ThreadId threadId, Slot0<void>* slot)
+{
+  Message message;
+  LPMSG msg = (LPMSG)message;
+  msg->hwnd = NULL;
+  msg->message = get_call_message();
+  msg->wParam = 0;
+  msg->lParam = reinterpret_cast<LPARAM>(slot);
+  msg->time = 0;
+
+  ThreadData* data = get_thread_data(threadId);
+  enqueue_message(threadId, data->messages, message);
+}
@@ -0,0 +1,183 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/MessageQueue.h"
+
+#ifdef VACA_ON_WINDOWS
+  #include <windows.h>
+#endif
+
+using namespace Vaca;
+
+/**
+   @internal
+*/
+struct MessageQueue::Node
+{
+  Node* volatile next;
+  Message message;
+
+  Node() : next(NULL) { }
+  Node(const Message& message) : next(NULL), message(message) { }
+};
+
+// Both are full memory barriers
+static inline long atomic_exchange(volatile long* value, long newValue)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedExchange(value, newValue);
+#else
+  __sync_synchronize();
+  return __sync_lock_test_and_set(value, newValue);
+#endif
+}
+
+template<typename T>
+static inline T* atomic_exchange_pointer(T* volatile* value, T* newValue)
+{
+#ifdef VACA_ON_WINDOWS
+  return reinterpret_cast<T*>(InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(value), newValue));
+#else
+  __sync_synchronize();
+  return __sync_lock_test_and_set(value, newValue);
+#endif
+}
+
+MessageQueue::MessageQueue()
+  : m_signaled(0)
+{
+  m_stub = new Node;
+  m_head = m_tail = m_stub;
+}
+
+/**
+   Destroys the queue and the messages that were not taken.
+*/
+MessageQueue::~MessageQueue()
+{
+  Message message;
+  while (popNode(message))
+    ;
+  delete m_stub;
+}
+
+/**
+   Puts a copy of the @a message at the end of the queue. It can be
+   called from any thread.
+
+   @return
+     True if this is the first message since the consumer found the
+     queue empty, so the caller has to wake up the consumer. It
+     returns false for the rest of messages of the batch.
+*/
+bool MessageQueue::push(const Message& message)
+{
+  pushNode(new Node(message));
+  return atomic_exchange(&m_signaled, 1) == 0;
+}
+
+/**
+   Takes the first message of the queue. Only the consumer thread can
+   call this routine.
+
+   @return
+     False if the queue is empty (or if the only message is being
+     pushed right now, in that case its producer will wake up the
+     consumer).
+*/
+bool MessageQueue::pop(Message& message)
+{
+  if (popNode(message))
+    return true;
+
+  // the queue looks empty, the next producer must wake up the
+  // consumer (we check the queue again because a producer could
+  // have pushed a message without signaling)
+  atomic_exchange(&m_signaled, 0);
+  return popNode(message);
+}
+
+/**
+   Returns the first message of the queue without taking it, or NULL
+   if the queue is empty. Only the consumer thread can call this
+   routine, and the pointer is valid until the next #pop.
+*/
+const Message* MessageQueue::front()
+{
+  // skips the stub (it is not a message)
+  if (m_tail == m_stub) {
+    Node* next = m_tail->next;
+    if (next == NULL)
+      return NULL;
+    m_tail = next;
+  }
+  return &m_tail->message;
+}
+
+// Vyukov's intrusive MPSC queue
+void MessageQueue::pushNode(Node* node)
+{
+  node->next = NULL;
+  Node* prev = atomic_exchange_pointer(&m_head, node);
+  prev->next = node;
+}
+
+bool MessageQueue::popNode(Message& message)
+{
+  Node* tail = m_tail;
+  Node* next = tail->next;
+
+  if (tail == m_stub) {
+    if (next == NULL)
+      return false;
+
+    m_tail = next;
+    tail = next;
+    next = next->next;
+  }
+
+  if (next == NULL) {
+    // a producer is between the exchange and the link
+    if (tail != m_head)
+      return false;
+
+    // tail is the last node, we put the stub after it to take it
+    pushNode(m_stub);
+    next = tail->next;
+    if (next == NULL)
+      return false;
+  }
+
+  m_tail = next;
+  message = tail->message;
+  delete tail;
+  return true;
+}
@@ -39,8 +39,56 @@
   #error Your platform does not support mutexes
 #endif 
 
+#if defined(VACA_ON_UNIXLIKE)
+  #include <unistd.h>
+#endif
+
 using namespace Vaca;
 
+// Maximum number of times that Mutex#lock tries to get the mutex
+// before blocking, and maximum pause between two tries
+#define MAX_SPINS	40
+#define MAX_BACKOFF	16
+
+static inline void cpu_relax()
+{
+#if defined(VACA_ON_WINDOWS)
+  YieldProcessor();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+  __asm__ __volatile__("pause");
+#endif
+}
+
+/**
+   Returns the number of processors in the system (at least one).
+
+   @see ThreadPool#getProcessorCount
+
+   @internal
+*/
+int details::getProcessorCount()
+{
+#if defined(VACA_ON_WINDOWS)
+  SYSTEM_INFO si;
+  GetSystemInfo(&si);
+  int processors = si.dwNumberOfProcessors;
+#else
+  int processors = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+  return processors > 1 ? processors: 1;
+}
+
+// Spinning does not make sense with only one processor: the thread
+// that has the mutex cannot run (and unlock it) while we spin. The
+// number of processors is read once, before main() creates threads
+// (a mutex locked before this initialization does not spin)
+static bool multiprocessor = (details::getProcessorCount() > 1);
+
+static inline bool can_spin()
+{
+  return multiprocessor;
+}
+
 /**
    Creates a new mutex.
 
@@ -51,6 +99,7 @@ using namespace Vaca;
 Mutex::Mutex()
 {
   m_impl = new MutexImpl();
+  m_spins = 0;
 }
 
 /**
@@ -71,15 +120,47 @@ Mutex::~Mutex()
    Locks the mutex if it is free (not locked by another thread) or
    waits the mutex to be unlocked.
 
+   If the mutex is locked, it tries again some times (waiting more
+   between each try) before blocking the thread. The limit of tries
+   follows the average of tries that the last locks needed (like the
+   adaptive mutexes of glibc).
+
    @see unlock, ScopedLock, Thread
 
    @win32
-     It uses @msdn{EnterCriticalSection}.
+     It uses @msdn{TryEnterCriticalSection} to spin and then
+     @msdn{EnterCriticalSection}.
    @endwin32
 */
 void Mutex::lock()
 {
-  return m_impl->lock();
+  if (m_impl->tryLock())
+    return;
+
+  if (can_spin()) {
+    int spins = m_spins;
+    int limit = (spins*2 + 10 < MAX_SPINS) ? spins*2 + 10: MAX_SPINS;
+    int backoff = 1;
+
+    for (int tries=1; tries<=limit; ++tries) {
+      for (int i=0; i<backoff; ++i)
+	cpu_relax();
+
+      if (backoff < MAX_BACKOFF)
+	backoff <<= 1;
+
+      if (m_impl->tryLock()) {
+	// m_spins is modified only by the thread that has the mutex
+	m_spins = spins + (tries - spins) / 8;
+	return;
+      }
+    }
+
+    m_impl->lock();
+    m_spins = spins + (limit - spins) / 8;
+  }
+  else
+    m_impl->lock();
 }
 
 /**
@@ -0,0 +1,1385 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/String.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+  #include <intrin.h>
+  #pragma intrinsic(_umul128)
+#endif
+
+// The Clinger's fast path needs floating point operations rounded to
+// the precision of each type (it is not the case of the x87 FPU)
+#if !((defined(_M_IX86) && !(defined(_M_IX86_FP) && _M_IX86_FP >= 2)) || \
+      (defined(__i386__) && !defined(__SSE2__)))
+  #define VACA_NUMBER_FAST_PATH
+#endif
+
+using namespace Vaca;
+
+typedef unsigned long long uint64;
+typedef unsigned int uint32;
+
+#include "NumberTables.h"
+
+// ======================================================================
+// Integers
+// ======================================================================
+
+static const char digit_pairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+// Writes the digits of "value" backward, from "end", two digits at a
+// time. Returns the position of the first digit.
+static Char* write_digits(uint64 value, Char* end)
+{
+  // 64-bit divisions are slow in 32-bit processors
+  while (value > 0xffffffffULL) {
+    uint32 i = static_cast<uint32>(value % 100) * 2;
+    value /= 100;
+    *--end = digit_pairs[i+1];
+    *--end = digit_pairs[i];
+  }
+
+  uint32 value32 = static_cast<uint32>(value);
+  while (value32 >= 100) {
+    uint32 i = (value32 % 100) * 2;
+    value32 /= 100;
+    *--end = digit_pairs[i+1];
+    *--end = digit_pairs[i];
+  }
+
+  if (value32 >= 10) {
+    *--end = digit_pairs[value32*2+1];
+    *--end = digit_pairs[value32*2];
+  }
+  else
+    *--end = static_cast<Char>('0' + value32);
+
+  return end;
+}
+
+// Copies the "len" characters of "src" to the user buffer
+static int copy_to_buffer(const Char* src, int len, Char* buf, int size)
+{
+  if (len >= size)
+    return 0;
+
+  std::memcpy(buf, src, len*sizeof(Char));
+  buf[len] = 0;
+  return len;
+}
+
+static int format_integer(uint64 magnitude, bool negative, Char* buf, int size)
+{
+  Char tmp[24];
+  Char* end = tmp + 24;
+  Char* begin = write_digits(magnitude, end);
+
+  if (negative)
+    *--begin = '-';
+
+  return copy_to_buffer(begin, end - begin, buf, size);
+}
+
+static inline bool is_digit(Char chr)
+{
+  return chr >= '0' && chr <= '9';
+}
+
+// Parses the sign and the digits of an integer. "overflow" is true if
+// the magnitude does not fit in 64 bits.
+static const Char* parse_integer(const Char* begin, const Char* end,
+				 bool& negative, uint64& magnitude, bool& overflow)
+{
+  const Char* p = begin;
+
+  negative = false;
+  magnitude = 0;
+  overflow = false;
+
+  if (p != end && (*p == '-' || *p == '+'))
+    negative = (*p++ == '-');
+
+  if (p == end || !is_digit(*p))
+    return begin;
+
+  const uint64 max = std::numeric_limits<uint64>::max();
+  for (; p != end && is_digit(*p); ++p) {
+    uint32 digit = *p - '0';
+    if (magnitude > (max - digit) / 10)
+      overflow = true;
+    else
+      magnitude = magnitude*10 + digit;
+  }
+  return p;
+}
+
+// Converts the parsed integer to a signed type, saturating it to the
+// limits of the type (like strtol)
+template<typename T>
+static const Char* parse_signed(const Char* begin, const Char* end, T& value)
+{
+  bool negative, overflow;
+  uint64 magnitude;
+  const Char* p = parse_integer(begin, end, negative, magnitude, overflow);
+  if (p == begin)
+    return begin;
+
+  const uint64 max = static_cast<uint64>(std::numeric_limits<T>::max());
+
+  if (negative) {
+    if (overflow || magnitude > max+1)
+      value = std::numeric_limits<T>::min();
+    else if (magnitude == max+1)
+      value = std::numeric_limits<T>::min();
+    else
+      value = -static_cast<T>(magnitude);
+  }
+  else {
+    if (overflow || magnitude > max)
+      value = std::numeric_limits<T>::max();
+    else
+      value = static_cast<T>(magnitude);
+  }
+  return p;
+}
+
+// Converts the parsed integer to an unsigned type (a negative number
+// is negated in the unsigned type, like strtoul does)
+template<typename T>
+static const Char* parse_unsigned(const Char* begin, const Char* end, T& value)
+{
+  bool negative, overflow;
+  uint64 magnitude;
+  const Char* p = parse_integer(begin, end, negative, magnitude, overflow);
+  if (p == begin)
+    return begin;
+
+  if (overflow || magnitude > std::numeric_limits<T>::max())
+    value = std::numeric_limits<T>::max();
+  else if (negative)
+    value = static_cast<T>(0) - static_cast<T>(magnitude);
+  else
+    value = static_cast<T>(magnitude);
+  return p;
+}
+
+// ======================================================================
+// 128-bit arithmetic
+// ======================================================================
+
+// Returns the low 64 bits of a*b, and the high 64 bits in "high"
+static inline uint64 umul128(uint64 a, uint64 b, uint64& high)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+  return _umul128(a, b, &high);
+#elif defined(__SIZEOF_INT128__)
+  unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+  high = static_cast<uint64>(r >> 64);
+  return static_cast<uint64>(r);
+#else
+  uint64 aLo = static_cast<uint32>(a), aHi = a >> 32;
+  uint64 bLo = static_cast<uint32>(b), bHi = b >> 32;
+  uint64 b00 = aLo * bLo;
+  uint64 b01 = aLo * bHi;
+  uint64 b10 = aHi * bLo;
+  uint64 b11 = aHi * bHi;
+  uint64 mid1 = b10 + (b00 >> 32);
+  uint64 mid2 = b01 + static_cast<uint32>(mid1);
+  high = b11 + (mid1 >> 32) + (mid2 >> 32);
+  return (mid2 << 32) | static_cast<uint32>(b00);
+#endif
+}
+
+static inline int leading_zeros(uint64 value)
+{
+  int n = 0;
+  if (!(value & 0xffffffff00000000ULL)) { n += 32; value <<= 32; }
+  if (!(value & 0xffff000000000000ULL)) { n += 16; value <<= 16; }
+  if (!(value & 0xff00000000000000ULL)) { n += 8; value <<= 8; }
+  if (!(value & 0xf000000000000000ULL)) { n += 4; value <<= 4; }
+  if (!(value & 0xc000000000000000ULL)) { n += 2; value <<= 2; }
+  if (!(value & 0x8000000000000000ULL)) { n += 1; }
+  return n;
+}
+
+// ======================================================================
+// Shortest round-trip formatting (Ryu algorithm, by Ulf Adams)
+// ======================================================================
+
+static const int pow5_inv_bitcount = 125;
+static const int pow5_bitcount = 125;
+
+// floor(log10(2^e)), floor(log10(5^e)), and ceil(log2(5^e)) (or 1 if e == 0)
+static inline uint32 log10_pow2(int e) { return (static_cast<uint32>(e) * 78913) >> 18; }
+static inline uint32 log10_pow5(int e) { return (static_cast<uint32>(e) * 732923) >> 20; }
+static inline int pow5_bits(int e) { return static_cast<int>(((static_cast<uint32>(e) * 1217359) >> 19) + 1); }
+
+static inline uint32 pow5_factor(uint64 value)
+{
+  uint32 count = 0;
+  for (; value % 5 == 0; value /= 5)
+    ++count;
+  return count;
+}
+
+static inline bool multiple_of_pow5(uint64 value, uint32 p)
+{
+  return pow5_factor(value) >= p;
+}
+
+static inline bool multiple_of_pow2(uint64 value, uint32 p)
+{
+  return (value & ((1ULL << p) - 1)) == 0;
+}
+
+// (m * mul) >> j, where mul is a 128-bit number and 64 < j < 128
+static inline uint64 mul_shift64(uint64 m, const uint64* mul, int j)
+{
+  uint64 high1, high0;
+  uint64 low1 = umul128(m, mul[1], high1);
+  umul128(m, mul[0], high0);
+
+  uint64 sum = high0 + low1;
+  if (sum < high0)
+    ++high1;
+
+  int dist = j - 64;
+  return (high1 << (64 - dist)) | (sum >> dist);
+}
+
+/**
+   Finds the shortest decimal number (output * 10^exponent) which is
+   rounded to the given binary floating point number.
+
+   It is used for doubles and floats (the interval of valid decimal
+   numbers depends on the precision of the type).
+
+   @internal
+*/
+static void shortest_decimal(uint64 ieeeMantissa, uint32 ieeeExponent,
+			     int mantissaBits, int bias,
+			     uint64& output, int& exponent)
+{
+  int e2;
+  uint64 m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - bias - mantissaBits - 2;
+    m2 = ieeeMantissa;
+  }
+  else {
+    e2 = static_cast<int>(ieeeExponent) - bias - mantissaBits - 2;
+    m2 = (1ULL << mantissaBits) | ieeeMantissa;
+  }
+  const bool acceptBounds = (m2 & 1) == 0;
+
+  // interval of valid decimal representations
+  const uint64 mv = 4 * m2;
+  const uint32 mmShift = (ieeeMantissa != 0 || ieeeExponent <= 1) ? 1: 0;
+
+  // convert to a decimal power base
+  uint64 vr, vp, vm;
+  int e10;
+  bool vmIsTrailingZeros = false;
+  bool vrIsTrailingZeros = false;
+
+  if (e2 >= 0) {
+    const uint32 q = log10_pow2(e2) - (e2 > 3 ? 1: 0);
+    const int k = pow5_inv_bitcount + pow5_bits(q) - 1;
+    const int i = -e2 + static_cast<int>(q) + k;
+    e10 = static_cast<int>(q);
+
+    vr = mul_shift64(4*m2,            pow5_inv_split[q], i);
+    vp = mul_shift64(4*m2 + 2,        pow5_inv_split[q], i);
+    vm = mul_shift64(4*m2 - 1 - mmShift, pow5_inv_split[q], i);
+
+    if (q <= 21) {
+      // only one of mp, mv, and mm can be a multiple of 5
+      if (mv % 5 == 0)
+	vrIsTrailingZeros = multiple_of_pow5(mv, q);
+      else if (acceptBounds)
+	vmIsTrailingZeros = multiple_of_pow5(mv - 1 - mmShift, q);
+      else
+	vp -= multiple_of_pow5(mv + 2, q) ? 1: 0;
+    }
+  }
+  else {
+    const uint32 q = log10_pow5(-e2) - (-e2 > 1 ? 1: 0);
+    const int i = -e2 - static_cast<int>(q);
+    const int k = pow5_bits(i) - pow5_bitcount;
+    const int j = static_cast<int>(q) - k;
+    e10 = static_cast<int>(q) + e2;
+
+    vr = mul_shift64(4*m2,            pow5_split[i], j);
+    vp = mul_shift64(4*m2 + 2,        pow5_split[i], j);
+    vm = mul_shift64(4*m2 - 1 - mmShift, pow5_split[i], j);
+
+    if (q <= 1) {
+      // mv = 4 * m2, so it always has at least two trailing 0 bits
+      vrIsTrailingZeros = true;
+      if (acceptBounds)
+	vmIsTrailingZeros = (mmShift == 1);
+      else
+	--vp;
+    }
+    else if (q < 63)
+      vrIsTrailingZeros = multiple_of_pow2(mv, q);
+  }
+
+  // find the shortest decimal representation in the interval
+  int removed = 0;
+  uint32 lastRemovedDigit = 0;
+
+  if (vmIsTrailingZeros || vrIsTrailingZeros) {
+    // general case (it happens rarely)
+    for (;;) {
+      uint64 vpDiv10 = vp / 10;
+      uint64 vmDiv10 = vm / 10;
+      if (vpDiv10 <= vmDiv10)
+	break;
+
+      uint32 vmMod10 = static_cast<uint32>(vm - 10*vmDiv10);
+      uint64 vrDiv10 = vr / 10;
+      uint32 vrMod10 = static_cast<uint32>(vr - 10*vrDiv10);
+      vmIsTrailingZeros &= (vmMod10 == 0);
+      vrIsTrailingZeros &= (lastRemovedDigit == 0);
+      lastRemovedDigit = vrMod10;
+      vr = vrDiv10;
+      vp = vpDiv10;
+      vm = vmDiv10;
+      ++removed;
+    }
+
+    if (vmIsTrailingZeros) {
+      for (;;) {
+	uint64 vmDiv10 = vm / 10;
+	uint32 vmMod10 = static_cast<uint32>(vm - 10*vmDiv10);
+	if (vmMod10 != 0)
+	  break;
+
+	uint64 vrDiv10 = vr / 10;
+	uint32 vrMod10 = static_cast<uint32>(vr - 10*vrDiv10);
+	vrIsTrailingZeros &= (lastRemovedDigit == 0);
+	lastRemovedDigit = vrMod10;
+	vr = vrDiv10;
+	vp = vp / 10;
+	vm = vmDiv10;
+	++removed;
+      }
+    }
+
+    // round to even if the exact number is .....50..0
+    if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0)
+      lastRemovedDigit = 4;
+
+    // take vr+1 if vr is outside bounds or we need to round up
+    output = vr +
+      (((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5) ? 1: 0);
+  }
+  else {
+    // common case
+    bool roundUp = false;
+
+    // remove two digits at a time
+    if (vp / 100 > vm / 100) {
+      uint64 vrDiv100 = vr / 100;
+      roundUp = (vr - 100*vrDiv100) >= 50;
+      vr = vrDiv100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+
+    for (;;) {
+      uint64 vpDiv10 = vp / 10;
+      uint64 vmDiv10 = vm / 10;
+      if (vpDiv10 <= vmDiv10)
+	break;
+
+      uint64 vrDiv10 = vr / 10;
+      roundUp = (vr - 10*vrDiv10) >= 5;
+      vr = vrDiv10;
+      vp = vpDiv10;
+      vm = vmDiv10;
+      ++removed;
+    }
+
+    output = vr + ((vr == vm || roundUp) ? 1: 0);
+  }
+
+  exponent = e10 + removed;
+}
+
+/**
+   Writes the decimal number "output * 10^exponent" in the shortest
+   notation: fixed point for numbers from 1e-7 to 1e21 (e.g. 0.125 or
+   1500), and scientific notation for the others (e.g. 1.5e+30).
+
+   @internal
+*/
+static int write_decimal(bool negative, uint64 output, int exponent, Char* buf, int size)
+{
+  Char digits[24];
+  Char* end = digits + 24;
+  Char* begin = write_digits(output, end);
+  int k = end - begin;		// number of digits
+  int n = k + exponent;		// position of the decimal point
+
+  Char tmp[40];
+  Char* p = tmp;
+
+  if (negative)
+    *p++ = '-';
+
+  if (k <= n && n <= 21) {
+    for (int i=0; i<k; ++i) *p++ = begin[i];
+    for (int i=k; i<n; ++i) *p++ = '0';
+  }
+  else if (0 < n && n <= 21) {
+    for (int i=0; i<n; ++i) *p++ = begin[i];
+    *p++ = '.';
+    for (int i=n; i<k; ++i) *p++ = begin[i];
+  }
+  else if (-6 < n && n <= 0) {
+    *p++ = '0';
+    *p++ = '.';
+    for (int i=n; i<0; ++i) *p++ = '0';
+    for (int i=0; i<k; ++i) *p++ = begin[i];
+  }
+  else {
+    *p++ = begin[0];
+    if (k > 1) {
+      *p++ = '.';
+      for (int i=1; i<k; ++i) *p++ = begin[i];
+    }
+    *p++ = 'e';
+    *p++ = (n-1 < 0) ? '-': '+';
+
+    Char exp[8];
+    Char* expEnd = exp + 8;
+    Char* expBegin = write_digits(n-1 < 0 ? 1-n: n-1, expEnd);
+    while (expBegin != expEnd)
+      *p++ = *expBegin++;
+  }
+
+  return copy_to_buffer(tmp, p - tmp, buf, size);
+}
+
+static int write_special(bool negative, bool nan, Char* buf, int size)
+{
+  if (nan)
+    return copy_to_buffer(L"nan", 3, buf, size);
+  else if (negative)
+    return copy_to_buffer(L"-inf", 4, buf, size);
+  else
+    return copy_to_buffer(L"inf", 3, buf, size);
+}
+
+// ======================================================================
+// Correctly rounded parsing (Eisel-Lemire algorithm, with a slow path
+// based on decimal arithmetic for the rare inputs with more than 19
+// significant digits which are near to a halfway point)
+// ======================================================================
+
+namespace {
+
+  struct DoubleInfo
+  {
+    typedef double Float;
+    typedef uint64 Bits;
+    enum {
+      mantissa_bits = 52,
+      exponent_bits = 11,
+      minimum_exponent = -1023,
+      infinite_power = 0x7ff,
+      smallest_power_of_ten = -342,
+      largest_power_of_ten = 308,
+      min_round_to_even = -4,
+      max_round_to_even = 23,
+      max_fast_power = 22
+    };
+    static const uint64 max_fast_mantissa = 1ULL << 53;
+  };
+
+  struct FloatInfo
+  {
+    typedef float Float;
+    typedef uint32 Bits;
+    enum {
+      mantissa_bits = 23,
+      exponent_bits = 8,
+      minimum_exponent = -127,
+      infinite_power = 0xff,
+      smallest_power_of_ten = -65,
+      largest_power_of_ten = 38,
+      min_round_to_even = -17,
+      max_round_to_even = 10,
+      max_fast_power = 10
+    };
+    static const uint64 max_fast_mantissa = 1ULL << 24;
+  };
+
+  // A binary floating point number being built
+  struct AdjustedMantissa
+  {
+    uint64 mantissa;
+    int power2;
+  };
+
+  // A decimal number 0.d[0]d[1]...d[nd-1] * 10^dp for the slow path
+  struct Decimal
+  {
+    enum { max_digits = 800 };
+    unsigned char d[max_digits];
+    int nd;
+    int dp;
+    bool trunc;		// discarded non-zero digits beyond d[nd-1]
+  };
+
+}
+
+static const double exact_powers_of_ten[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Computes w * 5^q with 64 + "precision" bits of precision
+static void product_approximation(int q, uint64 w, int precision, uint64& low, uint64& high)
+{
+  const uint64* pow5 = pow5_128[q - DoubleInfo::smallest_power_of_ten];
+  const uint64 mask = ~0ULL >> precision;
+
+  low = umul128(w, pow5[0], high);
+
+  if ((high & mask) == mask) {
+    uint64 high2;
+    umul128(w, pow5[1], high2);
+    low += high2;
+    if (high2 > low)
+      ++high;
+  }
+}
+
+// floor(log2(10^q)) + 63
+static inline int power(int q)
+{
+  return (((152170 + 65536) * q) >> 16) + 63;
+}
+
+/**
+   Eisel-Lemire algorithm: converts w * 10^q to the nearest binary
+   floating point number (w must be the exact decimal significand).
+
+   @internal
+*/
+template<typename Info>
+static AdjustedMantissa compute_float(int q, uint64 w)
+{
+  AdjustedMantissa answer;
+
+  if (w == 0 || q < Info::smallest_power_of_ten) {
+    answer.mantissa = 0;
+    answer.power2 = 0;
+    return answer;
+  }
+  if (q > Info::largest_power_of_ten) {
+    answer.mantissa = 0;
+    answer.power2 = Info::infinite_power;
+    return answer;
+  }
+
+  int lz = leading_zeros(w);
+  w <<= lz;
+
+  uint64 low, high;
+  product_approximation(q, w, Info::mantissa_bits + 3, low, high);
+
+  int upperbit = static_cast<int>(high >> 63);
+  int shift = upperbit + 64 - Info::mantissa_bits - 3;
+
+  answer.mantissa = high >> shift;
+  answer.power2 = power(q) + upperbit - lz - Info::minimum_exponent;
+
+  // subnormal
+  if (answer.power2 <= 0) {
+    if (-answer.power2 + 1 >= 64) {
+      answer.mantissa = 0;
+      answer.power2 = 0;
+      return answer;
+    }
+    answer.mantissa >>= -answer.power2 + 1;
+    answer.mantissa += (answer.mantissa & 1);
+    answer.mantissa >>= 1;
+    answer.power2 = (answer.mantissa < (1ULL << Info::mantissa_bits)) ? 0: 1;
+    return answer;
+  }
+
+  // we round up, but if we are exactly in the middle and the number
+  // is even, we have to round down
+  if (low <= 1 &&
+      q >= Info::min_round_to_even &&
+      q <= Info::max_round_to_even &&
+      (answer.mantissa & 3) == 1) {
+    if ((answer.mantissa << shift) == high)
+      answer.mantissa &= ~1ULL;
+  }
+
+  answer.mantissa += (answer.mantissa & 1);
+  answer.mantissa >>= 1;
+  if (answer.mantissa >= (2ULL << Info::mantissa_bits)) {
+    answer.mantissa = (1ULL << Info::mantissa_bits);
+    ++answer.power2;
+  }
+  answer.mantissa &= ~(1ULL << Info::mantissa_bits);
+
+  if (answer.power2 >= Info::infinite_power) {
+    answer.mantissa = 0;
+    answer.power2 = Info::infinite_power;
+  }
+  return answer;
+}
+
+static void decimal_trim(Decimal& a)
+{
+  while (a.nd > 0 && a.d[a.nd-1] == 0)
+    --a.nd;
+  if (a.nd == 0)
+    a.dp = 0;
+}
+
+// a = a * 2^k (k <= 60)
+static void decimal_left_shift(Decimal& a, int k)
+{
+  // number of new digits (at most, the unused ones are removed later)
+  int delta = k*3/10 + 1;
+  int w = a.nd + delta;
+  uint64 n = 0;
+
+  for (int r=a.nd-1; r>=0; --r) {
+    n += static_cast<uint64>(a.d[r]) << k;
+    uint64 quo = n / 10;
+    uint32 rem = static_cast<uint32>(n - 10*quo);
+    if (--w < Decimal::max_digits)
+      a.d[w] = rem;
+    else if (rem != 0)
+      a.trunc = true;
+    n = quo;
+  }
+
+  while (n > 0) {
+    uint64 quo = n / 10;
+    uint32 rem = static_cast<uint32>(n - 10*quo);
+    if (--w < Decimal::max_digits)
+      a.d[w] = rem;
+    else if (rem != 0)
+      a.trunc = true;
+    n = quo;
+  }
+
+  // "w" is the number of unused digits at the beginning
+  a.nd = std::min<int>(a.nd + delta, Decimal::max_digits) - w;
+  std::memmove(a.d, a.d + w, a.nd);
+  a.dp += delta - w;
+  decimal_trim(a);
+}
+
+// a = a / 2^k (k <= 60)
+static void decimal_right_shift(Decimal& a, int k)
+{
+  int r = 0;
+  int w = 0;
+  uint64 n = 0;
+
+  // pick up enough leading digits to cover the first shift
+  for (; (n >> k) == 0; ++r) {
+    if (r >= a.nd) {
+      if (n == 0) {
+	a.nd = 0;
+	return;
+      }
+      while ((n >> k) == 0) {
+	n *= 10;
+	++r;
+      }
+      break;
+    }
+    n = n*10 + a.d[r];
+  }
+  a.dp -= r-1;
+
+  const uint64 mask = (1ULL << k) - 1;
+
+  // pick up a digit, put down a digit
+  for (; r < a.nd; ++r) {
+    a.d[w++] = static_cast<unsigned char>(n >> k);
+    n = (n & mask)*10 + a.d[r];
+  }
+
+  // put down extra digits
+  while (n > 0) {
+    unsigned char digit = static_cast<unsigned char>(n >> k);
+    n &= mask;
+    if (w < Decimal::max_digits)
+      a.d[w++] = digit;
+    else if (digit > 0)
+      a.trunc = true;
+    n *= 10;
+  }
+
+  a.nd = w;
+  decimal_trim(a);
+}
+
+static void decimal_shift(Decimal& a, int k)
+{
+  const int max_shift = 60;
+
+  if (a.nd == 0)
+    return;
+
+  for (; k > max_shift; k -= max_shift)
+    decimal_left_shift(a, max_shift);
+  for (; k < -max_shift; k += max_shift)
+    decimal_right_shift(a, max_shift);
+
+  if (k > 0)
+    decimal_left_shift(a, k);
+  else if (k < 0)
+    decimal_right_shift(a, -k);
+}
+
+static uint64 decimal_rounded_integer(const Decimal& a)
+{
+  if (a.dp > 20)
+    return ~0ULL;
+
+  int i;
+  uint64 n = 0;
+  for (i=0; i<a.dp && i<a.nd; ++i)
+    n = n*10 + a.d[i];
+  for (; i<a.dp; ++i)
+    n *= 10;
+
+  // round to nearest, ties to even
+  if (a.dp >= 0 && a.dp < a.nd) {
+    if (a.d[a.dp] == 5 && a.dp+1 == a.nd) {
+      if (a.trunc || (a.dp > 0 && a.d[a.dp-1] % 2 != 0))
+	++n;
+    }
+    else if (a.d[a.dp] >= 5)
+      ++n;
+  }
+  return n;
+}
+
+/**
+   Slow path: converts the decimal number to a binary floating point
+   number shifting it by powers of two (from the Go's strconv package).
+
+   @internal
+*/
+template<typename Info>
+static AdjustedMantissa decimal_to_float(Decimal& d)
+{
+  static const int powtab[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+  const int bias = Info::minimum_exponent;
+  AdjustedMantissa answer;
+  int exp;
+
+  if (d.nd == 0 || d.dp < -330) {
+    answer.mantissa = 0;
+    answer.power2 = 0;
+    return answer;
+  }
+  if (d.dp > 310)
+    goto overflow;
+
+  // scale by powers of two until the number is in [0.5, 1.0)
+  exp = 0;
+  while (d.dp > 0) {
+    int n = (d.dp >= 9) ? 27: powtab[d.dp];
+    decimal_shift(d, -n);
+    exp += n;
+  }
+  while (d.dp < 0 || (d.dp == 0 && d.d[0] < 5)) {
+    int n = (-d.dp >= 9) ? 27: powtab[-d.dp];
+    decimal_shift(d, n);
+    exp -= n;
+  }
+
+  // the range is [0.5, 1) but the floating point range is [1, 2)
+  --exp;
+
+  // the minimum exponent is bias+1
+  if (exp < bias+1) {
+    int n = bias+1 - exp;
+    decimal_shift(d, -n);
+    exp += n;
+  }
+
+  if (exp - bias >= Info::infinite_power)
+    goto overflow;
+
+  // extract 1 + mantissa_bits bits
+  decimal_shift(d, 1 + Info::mantissa_bits);
+  answer.mantissa = decimal_rounded_integer(d);
+
+  // rounding might have added a bit
+  if (answer.mantissa == (2ULL << Info::mantissa_bits)) {
+    answer.mantissa >>= 1;
+    ++exp;
+    if (exp - bias >= Info::infinite_power)
+      goto overflow;
+  }
+
+  // subnormal
+  if ((answer.mantissa & (1ULL << Info::mantissa_bits)) == 0)
+    exp = bias;
+
+  answer.mantissa &= (1ULL << Info::mantissa_bits) - 1;
+  answer.power2 = exp - bias;
+  return answer;
+
+overflow:
+  answer.mantissa = 0;
+  answer.power2 = Info::infinite_power;
+  return answer;
+}
+
+static bool match_word(const Char*& p, const Char* end, const char* word)
+{
+  const Char* q = p;
+  for (; *word; ++word, ++q) {
+    if (q == end || (*q | 0x20) != *word)
+      return false;
+  }
+  p = q;
+  return true;
+}
+
+/**
+   Parses a floating point number: an optional sign, digits with an
+   optional decimal point, and an optional exponent (or "inf",
+   "infinity", "nan").
+
+   @internal
+*/
+template<typename Info>
+static const Char* parse_float(const Char* begin, const Char* end,
+			       typename Info::Float& value)
+{
+  typedef typename Info::Float Float;
+  typedef typename Info::Bits Bits;
+
+  const Char* p = begin;
+  bool negative = false;
+
+  if (p != end && (*p == '-' || *p == '+'))
+    negative = (*p++ == '-');
+
+  // special values
+  if (p != end && (*p == 'i' || *p == 'I' || *p == 'n' || *p == 'N')) {
+    if (match_word(p, end, "inf")) {
+      match_word(p, end, "inity");
+      value = std::numeric_limits<Float>::infinity();
+    }
+    else if (match_word(p, end, "nan"))
+      value = std::numeric_limits<Float>::quiet_NaN();
+    else
+      return begin;
+
+    if (negative)
+      value = -value;
+    return p;
+  }
+
+  // significand (the first 19 significant digits)
+  const Char* digitsBegin = p;
+  uint64 w = 0;
+  int digits = 0;
+  int exp10 = 0;
+  bool truncated = false;
+  bool any = false;
+
+  for (; p != end && is_digit(*p); ++p) {
+    uint32 digit = *p - '0';
+    any = true;
+    if (digits == 0 && digit == 0)
+      continue;
+    else if (digits < 19) {
+      w = w*10 + digit;
+      ++digits;
+    }
+    else {
+      ++exp10;
+      if (digit != 0)
+	truncated = true;
+    }
+  }
+
+  if (p != end && *p == '.') {
+    const Char* dot = p++;
+    for (; p != end && is_digit(*p); ++p) {
+      uint32 digit = *p - '0';
+      any = true;
+      if (digits == 0 && digit == 0)
+	--exp10;
+      else if (digits < 19) {
+	w = w*10 + digit;
+	++digits;
+	--exp10;
+      }
+      else if (digit != 0)
+	truncated = true;
+    }
+    if (!any)
+      p = dot;
+  }
+
+  if (!any)
+    return begin;
+
+  const Char* digitsEnd = p;
+
+  // exponent
+  int explicitExp = 0;
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    const Char* q = p+1;
+    bool negativeExp = false;
+    if (q != end && (*q == '-' || *q == '+'))
+      negativeExp = (*q++ == '-');
+
+    if (q != end && is_digit(*q)) {
+      for (; q != end && is_digit(*q); ++q) {
+	if (explicitExp < 100000)
+	  explicitExp = explicitExp*10 + (*q - '0');
+      }
+      if (negativeExp)
+	explicitExp = -explicitExp;
+      p = q;
+    }
+  }
+  exp10 += explicitExp;
+
+  AdjustedMantissa am;
+  bool done = false;
+
+#ifdef VACA_NUMBER_FAST_PATH
+  // Clinger's fast path: w and 10^|exp10| are exact
+  if (!truncated &&
+      w <= Info::max_fast_mantissa &&
+      exp10 >= -Info::max_fast_power &&
+      exp10 <= Info::max_fast_power) {
+    Float result = static_cast<Float>(w);
+    if (exp10 < 0)
+      result = result / static_cast<Float>(exact_powers_of_ten[-exp10]);
+    else
+      result = result * static_cast<Float>(exact_powers_of_ten[exp10]);
+    value = negative ? -result: result;
+    return p;
+  }
+#endif
+
+  if (w == 0) {
+    am.mantissa = 0;
+    am.power2 = 0;
+    done = true;
+  }
+  else if (!truncated) {
+    am = compute_float<Info>(exp10, w);
+    done = true;
+  }
+  else {
+    // the exact value is between w and w+1, if both are rounded to
+    // the same number we have the result
+    am = compute_float<Info>(exp10, w);
+    AdjustedMantissa am2 = compute_float<Info>(exp10, w+1);
+    done = (am.mantissa == am2.mantissa && am.power2 == am2.power2);
+  }
+
+  if (!done) {
+    Decimal d;
+    int dp = 0;
+    bool sawDot = false;
+
+    d.nd = 0;
+    d.trunc = false;
+
+    for (const Char* q=digitsBegin; q!=digitsEnd; ++q) {
+      if (*q == '.') {
+	sawDot = true;
+	continue;
+      }
+      unsigned char digit = static_cast<unsigned char>(*q - '0');
+      if (d.nd == 0 && digit == 0) {
+	if (sawDot)
+	  --dp;
+	continue;
+      }
+      if (!sawDot)
+	++dp;
+      if (d.nd < Decimal::max_digits)
+	d.d[d.nd++] = digit;
+      else if (digit != 0)
+	d.trunc = true;
+    }
+    d.dp = dp + explicitExp;
+    decimal_trim(d);
+
+    am = decimal_to_float<Info>(d);
+  }
+
+  Bits bits = static_cast<Bits>(am.mantissa)
+    | (static_cast<Bits>(am.power2) << Info::mantissa_bits);
+  if (negative)
+    bits |= static_cast<Bits>(1) << (Info::mantissa_bits + Info::exponent_bits);
+
+  std::memcpy(&value, &bits, sizeof(Float));
+  return p;
+}
+
+// ======================================================================
+// Formatting with a fixed precision (using the exact decimal value of
+// the double, like the Go's strconv package)
+// ======================================================================
+
+// a = value
+static void decimal_assign(Decimal& a, uint64 value)
+{
+  unsigned char tmp[20];
+  int n = 0;
+  while (value > 0) {
+    tmp[n++] = static_cast<unsigned char>(value % 10);
+    value /= 10;
+  }
+
+  a.nd = 0;
+  for (int i=n-1; i>=0; --i)
+    a.d[a.nd++] = tmp[i];
+  a.dp = n;
+  a.trunc = false;
+  decimal_trim(a);
+}
+
+// Rounds "a" to "nd" digits (to nearest, ties to even)
+static void decimal_round(Decimal& a, int nd)
+{
+  if (nd < 0 || nd >= a.nd)
+    return;
+
+  bool up;
+  if (a.d[nd] == 5 && nd+1 == a.nd)
+    up = a.trunc || (nd > 0 && a.d[nd-1] % 2 != 0);
+  else
+    up = a.d[nd] >= 5;
+
+  if (up) {
+    int i = nd-1;
+    while (i >= 0 && a.d[i] == 9)
+      --i;
+
+    if (i < 0) {		// 999 -> 1000
+      a.d[0] = 1;
+      a.nd = 1;
+      ++a.dp;
+    }
+    else {
+      ++a.d[i];
+      a.nd = i+1;
+    }
+  }
+  else {
+    a.nd = nd;
+    decimal_trim(a);
+  }
+}
+
+// Digit "i" of "a" (zero after the last digit)
+static inline Char decimal_digit(const Decimal& a, int i)
+{
+  return static_cast<Char>('0' + (i >= 0 && i < a.nd ? a.d[i]: 0));
+}
+
+// ======================================================================
+// Public API
+// ======================================================================
+
+/**
+   Writes the decimal representation of @a value in @a buf.
+
+   These functions do not depend on the locale and do not allocate
+   memory. A buffer of NumberBufferSize characters is enough for any
+   number.
+
+   @param size
+     Size of @a buf in characters (including the null character
+     which is written at the end).
+
+   @return
+     The number of characters written (without the null character),
+     or 0 if the buffer is too small.
+
+   @see parse_number
+*/
+int Vaca::format_number(int value, Char* buf, int size)
+{
+  return format_number(static_cast<long>(value), buf, size);
+}
+
+int Vaca::format_number(long value, Char* buf, int size)
+{
+  uint64 magnitude = value < 0 ? 0 - static_cast<uint64>(value): static_cast<uint64>(value);
+  return format_integer(magnitude, value < 0, buf, size);
+}
+
+int Vaca::format_number(unsigned int value, Char* buf, int size)
+{
+  return format_integer(value, false, buf, size);
+}
+
+int Vaca::format_number(unsigned long value, Char* buf, int size)
+{
+  return format_integer(value, false, buf, size);
+}
+
+int Vaca::format_number(long long value, Char* buf, int size)
+{
+  uint64 magnitude = value < 0 ? 0 - static_cast<uint64>(value): static_cast<uint64>(value);
+  return format_integer(magnitude, value < 0, buf, size);
+}
+
+int Vaca::format_number(unsigned long long value, Char* buf, int size)
+{
+  return format_integer(value, false, buf, size);
+}
+
+/**
+   Writes the shortest decimal representation of @a value which is
+   parsed back to the same float.
+*/
+int Vaca::format_number(float value, Char* buf, int size)
+{
+  uint32 bits;
+  std::memcpy(&bits, &value, sizeof(float));
+
+  bool negative = (bits >> 31) != 0;
+  uint32 ieeeMantissa = bits & ((1u << 23) - 1);
+  uint32 ieeeExponent = (bits >> 23) & 0xff;
+
+  if (ieeeExponent == 0xff)
+    return write_special(negative, ieeeMantissa != 0, buf, size);
+  if (ieeeExponent == 0 && ieeeMantissa == 0)
+    return copy_to_buffer(negative ? L"-0": L"0", negative ? 2: 1, buf, size);
+
+  uint64 output;
+  int exponent;
+  shortest_decimal(ieeeMantissa, ieeeExponent, 23, 127, output, exponent);
+  return write_decimal(negative, output, exponent, buf, size);
+}
+
+/**
+   Writes the shortest decimal representation of @a value which is
+   parsed back to the same double (e.g. 0.1 is written as "0.1", and
+   0.1+0.2 as "0.30000000000000004").
+*/
+int Vaca::format_number(double value, Char* buf, int size)
+{
+  uint64 bits;
+  std::memcpy(&bits, &value, sizeof(double));
+
+  bool negative = (bits >> 63) != 0;
+  uint64 ieeeMantissa = bits & ((1ULL << 52) - 1);
+  uint32 ieeeExponent = static_cast<uint32>((bits >> 52) & 0x7ff);
+
+  if (ieeeExponent == 0x7ff)
+    return write_special(negative, ieeeMantissa != 0, buf, size);
+  if (ieeeExponent == 0 && ieeeMantissa == 0)
+    return copy_to_buffer(negative ? L"-0": L"0", negative ? 2: 1, buf, size);
+
+  uint64 output;
+  int exponent;
+  shortest_decimal(ieeeMantissa, ieeeExponent, 52, 1023, output, exponent);
+  return write_decimal(negative, output, exponent, buf, size);
+}
+
+/**
+   Writes @a value with @a precision decimals in fixed point notation
+   (@a type equal to 'f', e.g. "20.32") or in scientific notation
+   (@a type equal to 'e', e.g. "1.5e+03"), like the @c printf
+   formats but always with a dot as decimal separator.
+
+   The result is correctly rounded (to nearest, ties to even) from
+   the exact value of the double. A buffer of 330 characters plus
+   @a precision is enough for any number.
+*/
+int Vaca::format_number(double value, Char type, int precision, Char* buf, int size)
+{
+  assert(type == 'f' || type == 'e');
+  assert(precision >= 0);
+
+  uint64 bits;
+  std::memcpy(&bits, &value, sizeof(double));
+
+  bool negative = (bits >> 63) != 0;
+  uint64 mantissa = bits & ((1ULL << 52) - 1);
+  int exponent = static_cast<int>((bits >> 52) & 0x7ff);
+
+  if (exponent == 0x7ff)
+    return write_special(negative, mantissa != 0, buf, size);
+
+  // value = mantissa * 2^(exponent-1075)
+  if (exponent == 0)
+    exponent = 1;		// subnormal
+  else
+    mantissa |= 1ULL << 52;
+
+  Decimal d;
+  decimal_assign(d, mantissa);
+  decimal_shift(d, exponent - 1075);
+
+  int len;
+  int exp10 = 0;
+  if (type == 'f') {
+    decimal_round(d, d.dp + precision);
+    len = (d.dp > 0 ? d.dp: 1) + (precision > 0 ? 1+precision: 0);
+  }
+  else {
+    decimal_round(d, 1 + precision);
+    exp10 = (d.nd > 0 ? d.dp-1: 0);
+    int absExp = exp10 < 0 ? -exp10: exp10;
+    len = 1 + (precision > 0 ? 1+precision: 0) + 2 + (absExp >= 100 ? 3: 2);
+  }
+  if (negative)
+    ++len;
+
+  if (len >= size)
+    return 0;
+
+  Char* p = buf;
+  if (negative)
+    *p++ = '-';
+
+  if (type == 'f') {
+    // integer part
+    if (d.dp > 0) {
+      for (int i=0; i<d.dp; ++i)
+	*p++ = decimal_digit(d, i);
+    }
+    else
+      *p++ = '0';
+
+    if (precision > 0) {
+      *p++ = '.';
+      for (int i=0; i<precision; ++i)
+	*p++ = decimal_digit(d, d.dp+i);
+    }
+  }
+  else {
+    *p++ = decimal_digit(d, 0);
+    if (precision > 0) {
+      *p++ = '.';
+      for (int i=1; i<=precision; ++i)
+	*p++ = decimal_digit(d, i);
+    }
+
+    // at least two digits in the exponent (like printf)
+    *p++ = 'e';
+    *p++ = (exp10 < 0 ? '-': '+');
+    int absExp = exp10 < 0 ? -exp10: exp10;
+    if (absExp >= 100)
+      *p++ = static_cast<Char>('0' + absExp/100);
+    *p++ = static_cast<Char>('0' + absExp/10 % 10);
+    *p++ = static_cast<Char>('0' + absExp % 10);
+  }
+
+  assert(p - buf == len);
+  *p = 0;
+  return len;
+}
+
+/**
+   Parses the number at the beginning of the range [@a begin, @a end).
+
+   These functions do not depend on the locale and do not allocate
+   memory. Leading whitespace is not skipped. Integers out of the
+   range of the type are saturated (like @c strtol), and floating
+   point numbers are correctly rounded.
+
+   @return
+     A pointer to the first character after the number, or @a begin
+     if there is no number (in that case @a value is not modified).
+
+   @see format_number
+*/
+const Char* Vaca::parse_number(const Char* begin, const Char* end, int& value)
+{
+  return parse_signed(begin, end, value);
+}
+
+const Char* Vaca::parse_number(const Char* begin, const Char* end, long& value)
+{
+  return parse_signed(begin, end, value);
+}
+
+const Char* Vaca::parse_number(const Char* begin, const Char* end, unsigned int& value)
+{
+  return parse_unsigned(begin, end, value);
+}
+
+const Char* Vaca::parse_number(const Char* begin, const Char* end, unsigned long& value)
+{
+  return parse_unsigned(begin, end, value);
+}
+
+const Char* Vaca::parse_number(const Char* begin, const Char* end, float& value)
+{
+  return parse_float<FloatInfo>(begin, end, value);
+}
+
+const Char* Vaca::parse_number(const Char* begin, const Char* end, double& value)
+{
+  return parse_float<DoubleInfo>(begin, end, value);
+}
@@ -0,0 +1,256 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/Path.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Vaca;
+
+// ======================================================================
+// PathView
+
+/**
+   Returns the index where the file name starts (after the last
+   separator).
+
+   @internal
+*/
+size_t PathView::findFileName() const
+{
+  size_t i = m_path.size();
+  while (i > 0 && !isSeparator(m_path[i-1]))
+    --i;
+  return i;
+}
+
+/**
+   Returns the root of the path, the part that cannot be removed
+   going to the parent directory:
+   @li The leading separators ("/" in "/usr/lib").
+   @li With PathSeparator::Windows, the drive ("C:\" in "C:\foo",
+       "C:" in "C:foo") or the server and share of an UNC path
+       ("\\server\share\" in "\\server\share\foo").
+
+   The root of a relative path is empty.
+*/
+StringView PathView::getRoot() const
+{
+  size_t size = m_path.size();
+  size_t i = 0;
+
+  if (m_separator == PathSeparator::Windows && size >= 2) {
+    // drive letter
+    if (m_path[1] == L':' &&
+	((m_path[0] >= L'A' && m_path[0] <= L'Z') ||
+	 (m_path[0] >= L'a' && m_path[0] <= L'z'))) {
+      i = 2;
+      if (i < size && isSeparator(m_path[i]))
+	++i;
+      return m_path.substr(0, i);
+    }
+
+    // UNC path, the server and the share names are part of the root
+    if (isSeparator(m_path[0]) && isSeparator(m_path[1])) {
+      i = 2;
+      for (int c=0; c<2; ++c) {
+	while (i < size && !isSeparator(m_path[i]))
+	  ++i;
+	if (i < size)
+	  ++i;
+      }
+      return m_path.substr(0, i);
+    }
+  }
+
+  while (i < size && isSeparator(m_path[i]))
+    ++i;
+
+  return m_path.substr(0, i);
+}
+
+/**
+   Returns the path without the file name and without the last
+   separator (the directory of "C:\foo\main.cpp" is "C:\foo").
+
+   @see file_path
+*/
+StringView PathView::getDirectory() const
+{
+  size_t i = findFileName();
+  return m_path.substr(0, i > 0 ? i-1: 0);
+}
+
+/**
+   Returns the file name (the file name of "C:\foo\main.cpp" is
+   "main.cpp").
+
+   @see file_name
+*/
+StringView PathView::getFileName() const
+{
+  return m_path.substr(findFileName());
+}
+
+/**
+   Returns the extension of the file name without the dot (the
+   extension of "C:\foo\pack.tar.gz" is "gz").
+
+   @see file_extension
+*/
+StringView PathView::getExtension() const
+{
+  StringView name = getFileName();
+  size_t dot = name.rfind(L'.');
+  if (dot == StringView::npos)
+    return StringView();
+  else
+    return name.substr(dot+1);
+}
+
+/**
+   Returns the file name without the extension (the title of
+   "C:\foo\pack.tar.gz" is "pack.tar").
+
+   @see file_title
+*/
+StringView PathView::getTitle() const
+{
+  StringView name = getFileName();
+  size_t dot = name.rfind(L'.');
+  if (dot == StringView::npos)
+    return name;
+  else
+    return name.substr(0, dot);
+}
+
+/**
+   Gets the next component of the path (skipping separators).
+
+   @code
+   PathView path(L"C:\\foo\\main.cpp");
+   StringView component;
+   size_t pos = 0;
+   while (path.nextComponent(pos, component)) {
+     // "C:", "foo", "main.cpp"
+   }
+   @endcode
+
+   @param pos
+     Where the search starts (zero to start from the beginning). It
+     is moved after the returned component.
+
+   @return False if there are no more components.
+*/
+bool PathView::nextComponent(size_t& pos, StringView& component) const
+{
+  size_t size = m_path.size();
+
+  while (pos < size && isSeparator(m_path[pos]))
+    ++pos;
+
+  if (pos >= size)
+    return false;
+
+  size_t start = pos;
+  while (pos < size && !isSeparator(m_path[pos]))
+    ++pos;
+
+  component = m_path.substr(start, pos - start);
+  return true;
+}
+
+// ======================================================================
+// PathBuilder
+
+PathBuilder::PathBuilder(PathSeparator separator, size_t capacity)
+  : m_separator(separator)
+{
+  m_path.reserve(capacity);
+}
+
+PathBuilder::PathBuilder(const StringView& path, PathSeparator separator, size_t capacity)
+  : m_separator(separator)
+{
+  m_path.reserve(std::max(capacity, path.size()));
+  m_path.assign(path.data(), path.size());
+}
+
+/**
+   Adds a component at the end of the path, with a separator if it is
+   needed.
+
+   @return The previous size of the path, so you can go back to it
+	   with truncate.
+*/
+size_t PathBuilder::push(const StringView& component)
+{
+  size_t oldSize = m_path.size();
+
+  if (!m_path.empty() && !view().isSeparator(m_path[oldSize-1]))
+    m_path.push_back(view().getPreferredSeparator());
+
+  m_path.append(component.data(), component.size());
+  return oldSize;
+}
+
+/**
+   Removes the last component and its separator. The root of the path
+   is never removed (e.g. "/usr" goes to "/", and "C:\foo" to "C:\").
+
+   @see PathView#getRoot
+*/
+void PathBuilder::pop()
+{
+  PathView path = view();
+  m_path.resize(std::max(path.getRoot().size(),
+			 path.getDirectory().size()));
+}
+
+/**
+   Goes back to a previous @a size of the path (e.g. the value
+   returned by push).
+*/
+void PathBuilder::truncate(size_t size)
+{
+  assert(size <= m_path.size());
+
+  m_path.resize(size);
+}
+
+/**
+   Removes all the components (the reserved memory is kept).
+*/
+void PathBuilder::clear()
+{
+  m_path.clear();
+}
@@ -30,6 +30,8 @@
 // OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Vaca/Pen.h"
+#include "Vaca/GdiObjectCache.h"
+#include "Vaca/Thread.h"
 
 #if defined(VACA_WINDOWS)
   #include "win32/PenImpl.h"
@@ -39,9 +41,36 @@
 
 using namespace Vaca;
 
+// Returns the key to share the pens in the GdiObjectCache. A simple
+// pen (the ones created without style) uses -1 as style.
+static GdiObjectKey make_pen_key(const Color& color, int width,
+				 int style = -1, int endCap = -1, int join = -1)
+{
+  GdiObjectKey key(GdiObjectKey::PenObject);
+  key.add(color.getR());
+  key.add(color.getG());
+  key.add(color.getB());
+  key.add(width);
+  key.add(style);
+  key.add(endCap);
+  key.add(join);
+  return key;
+}
+
+/**
+   Creates a black pen of one pixel of width.
+*/
 Pen::Pen()
-  : m_impl(new PenImpl())
 {
+  GdiObjectCache& cache = CurrentThread::getGdiObjectCache();
+  GdiObjectKey key = make_pen_key(Color(0, 0, 0), 1);
+
+  m_impl.reset(static_cast<PenImpl*>(cache.find(key)));
+  if (!m_impl) {
+    m_impl.reset(new PenImpl());
+    if (m_impl->isValid())
+      cache.insert(key, m_impl.get());
+  }
 }
 
 Pen::Pen(const Pen& pen)
@@ -52,19 +81,39 @@ Pen::Pen(const Pen& pen)
 /**
    Creates a pen.
 
+   If a pen with the same attributes was created before in this
+   thread, the new one will reference the same handle (see
+   GdiObjectCache).
+
    @param color Color of the pen.
    @param width Width of the pen. If it's 1, the pen will be cosmetic,
 		if width > 0 the pen will be geometric.
 */
 Pen::Pen(const Color& color, int width)
-  : m_impl(new PenImpl(color, width))
 {
+  GdiObjectCache& cache = CurrentThread::getGdiObjectCache();
+  GdiObjectKey key = make_pen_key(color, width);
+
+  m_impl.reset(static_cast<PenImpl*>(cache.find(key)));
+  if (!m_impl) {
+    m_impl.reset(new PenImpl(color, width));
+    if (m_impl->isValid())
+      cache.insert(key, m_impl.get());
+  }
 }
 
 Pen::Pen(const Color& color, int width,
 	 PenStyle style, PenEndCap endCap, PenJoin join)
-  : m_impl(new PenImpl(color, width, style, endCap, join))
 {
+  GdiObjectCache& cache = CurrentThread::getGdiObjectCache();
+  GdiObjectKey key = make_pen_key(color, width, style, endCap, join);
+
+  m_impl.reset(static_cast<PenImpl*>(cache.find(key)));
+  if (!m_impl) {
+    m_impl.reset(new PenImpl(color, width, style, endCap, join));
+    if (m_impl->isValid())
+      cache.insert(key, m_impl.get());
+  }
 }
 
 /**
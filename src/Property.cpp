@@ -50,6 +50,15 @@ Property::~Property()
 }
 
 String Property::getName() const
+{
+  return m_name.str();
+}
+
+/**
+   Returns the name of the property as it is stored in the pool of
+   interned strings (the key used by Component::getProperties).
+*/
+const InternedString& Property::getInternedName() const
 {
   return m_name;
 }
@@ -0,0 +1,195 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/SharedMutex.h"
+#include "Vaca/ScopedLock.h"
+
+#include <cassert>
+
+#ifdef VACA_ON_WINDOWS
+  #include <windows.h>
+#endif
+
+using namespace Vaca;
+
+// m_state value when a writer has the mutex (in other case m_state is
+// the number of readers)
+#define WRITER		0x40000000L
+
+// ======================================================================
+// Atomic operations (all of them are full memory barriers)
+
+static inline long atomic_increment(volatile long* value)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedIncrement(value);
+#else
+  return __sync_add_and_fetch(value, 1);
+#endif
+}
+
+static inline long atomic_decrement(volatile long* value)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedDecrement(value);
+#else
+  return __sync_sub_and_fetch(value, 1);
+#endif
+}
+
+static inline bool atomic_compare_and_swap(volatile long* value, long oldValue, long newValue)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedCompareExchange(value, newValue, oldValue) == oldValue;
+#else
+  return __sync_bool_compare_and_swap(value, oldValue, newValue);
+#endif
+}
+
+// ======================================================================
+// SharedMutex
+
+// How the threads are blocked without losing wake-ups: a waiting
+// thread increments its m_waiting* counter and then checks m_state
+// (with m_mutex locked until it waits), while the unlocking thread
+// modifies m_state and then reads the counters (locking m_mutex to
+// notify). As the modifications are full barriers, at least one of
+// them sees the change of the other. Plain (volatile) reads are
+// enough after a barrier, so the uncontended lockShared/unlockShared
+// are one atomic operation each, as Mutex#lock/unlock.
+
+SharedMutex::SharedMutex()
+  : m_state(0)
+  , m_waitingWriters(0)
+  , m_waitingReaders(0)
+{
+}
+
+SharedMutex::~SharedMutex()
+{
+  assert(m_state == 0);
+}
+
+/**
+   Locks the mutex in exclusive mode (as a writer). Waits the current
+   writer or all the current readers to unlock it.
+
+   @see unlock, ScopedExclusiveLock
+*/
+void SharedMutex::lock()
+{
+  if (tryLock())
+    return;
+
+  ScopedLock hold(m_mutex);
+  atomic_increment(&m_waitingWriters);
+  while (!tryLock())
+    m_writers.wait(hold);
+  atomic_decrement(&m_waitingWriters);
+}
+
+/**
+   Tries to lock the mutex in exclusive mode, returns false if it is
+   locked (by readers or a writer).
+*/
+bool SharedMutex::tryLock()
+{
+  return atomic_compare_and_swap(&m_state, 0, WRITER);
+}
+
+/**
+   Unlocks the mutex locked with #lock. Other writer has preference
+   to lock it, if there is not waiting writers, all waiting readers
+   are woken up.
+*/
+void SharedMutex::unlock()
+{
+  assert(m_state == WRITER);
+
+  atomic_compare_and_swap(&m_state, WRITER, 0);
+
+  if (m_waitingWriters > 0 || m_waitingReaders > 0) {
+    ScopedLock hold(m_mutex);
+    if (m_waitingWriters > 0)
+      m_writers.notifyOne();
+    else
+      m_readers.notifyAll();
+  }
+}
+
+/**
+   Locks the mutex in shared mode (as a reader). It waits only if a
+   writer has the mutex or is waiting for it.
+
+   @see unlockShared, ScopedSharedLock
+*/
+void SharedMutex::lockShared()
+{
+  if (tryLockShared())
+    return;
+
+  ScopedLock hold(m_mutex);
+  atomic_increment(&m_waitingReaders);
+  while (!tryLockShared())
+    m_readers.wait(hold);
+  atomic_decrement(&m_waitingReaders);
+}
+
+/**
+   Tries to lock the mutex in shared mode, returns false if a writer
+   has the mutex or is waiting for it.
+*/
+bool SharedMutex::tryLockShared()
+{
+  for (;;) {
+    long state = m_state;
+    if (state == WRITER || m_waitingWriters > 0)
+      return false;
+
+    if (atomic_compare_and_swap(&m_state, state, state+1))
+      return true;
+    // other reader came first, try again
+  }
+}
+
+/**
+   Unlocks the mutex locked with #lockShared. The last reader wakes up
+   a waiting writer.
+*/
+void SharedMutex::unlockShared()
+{
+  assert(m_state > 0 && m_state != WRITER);
+
+  if (atomic_decrement(&m_state) == 0 && m_waitingWriters > 0) {
+    ScopedLock hold(m_mutex);
+    m_writers.notifyOne();
+  }
+}
@@ -34,16 +34,27 @@
 #include "Vaca/String.h"
 #include "Vaca/Debug.h"
 #include "Vaca/Exception.h"
+#include "Vaca/Path.h"
+#include "Vaca/StringTokenizer.h"
+#include "Vaca/Unicode.h"
+#include "Vaca/Url.h"
 #include <cstdarg>
 #include <cstdlib>
 #include <cctype>
 #include <vector>
 #include <iterator>
-#include <wininet.h>
 
 #include <algorithm>
 #include <memory>
 
+// SSE2 is available in all x64 processors, and in x86 when the
+// compiler is configured to generate SSE2 code
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define VACA_STRING_SSE2
+  #include <emmintrin.h>
+#endif
+
 using namespace Vaca;
 
 String Vaca::format_string(const Char* fmt, ...)
@@ -73,98 +84,175 @@ String Vaca::format_string(const Char* fmt, ...)
   return String(buf.get());
 }
 
+// ======================================================================
+// Trim
+
+// The whitespace characters of the "C" locale: ' ', '\t', '\n', '\v',
+// '\f' and '\r'.
+static inline bool is_space_char(Char chr)
+{
+  return chr == L' ' || (chr >= L'\t' && chr <= L'\r');
+}
+
+#ifdef VACA_STRING_SSE2
+
+// Number of characters in a SSE2 register
+static const size_t sse2_chars = 16 / sizeof(Char);
+
+/**
+   Returns true if the 16 bytes in @a ptr are whitespace characters.
+*/
+static inline bool all_spaces(const Char* ptr)
+{
+  __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+  __m128i res;
+
+  if (sizeof(Char) == 2) {
+    // chr == ' ' || (chr - '\t') <= 4 (unsigned)
+    __m128i ctrl = _mm_subs_epu16(_mm_sub_epi16(chars, _mm_set1_epi16(9)),
+				  _mm_set1_epi16(4));
+    res = _mm_or_si128(_mm_cmpeq_epi16(chars, _mm_set1_epi16(32)),
+		       _mm_cmpeq_epi16(ctrl, _mm_setzero_si128()));
+  }
+  else {
+    // chr == ' ' || (chr - '\t' > -1 && chr - '\t' < 5)
+    __m128i ctrl = _mm_sub_epi32(chars, _mm_set1_epi32(9));
+    res = _mm_or_si128(_mm_cmpeq_epi32(chars, _mm_set1_epi32(32)),
+		       _mm_and_si128(_mm_cmpgt_epi32(ctrl, _mm_set1_epi32(-1)),
+				     _mm_cmplt_epi32(ctrl, _mm_set1_epi32(5))));
+  }
+
+  return _mm_movemask_epi8(res) == 0xffff;
+}
+
+#endif
+
+static const Char* skip_spaces(const Char* begin, const Char* end)
+{
+#ifdef VACA_STRING_SSE2
+  while (static_cast<size_t>(end - begin) >= sse2_chars && all_spaces(begin))
+    begin += sse2_chars;
+#endif
+
+  while (begin < end && is_space_char(*begin))
+    ++begin;
+  return begin;
+}
+
+static const Char* skip_spaces_backward(const Char* begin, const Char* end)
+{
+#ifdef VACA_STRING_SSE2
+  while (static_cast<size_t>(end - begin) >= sse2_chars && all_spaces(end - sse2_chars))
+    end -= sse2_chars;
+#endif
+
+  while (end > begin && is_space_char(*(end-1)))
+    --end;
+  return end;
+}
+
+/**
+   Returns a copy of @a str without the whitespace characters at the
+   beginning and at the end.
+
+   @see trim_view, trim_string_in_place
+*/
 String Vaca::trim_string(const String& str)
 {
-  return trim_string(str.c_str());
+  StringView res = trim_view(str);
+  return String(res.data(), res.size());
 }
 
 String Vaca::trim_string(const Char* str)
 {
   assert(str != NULL);
 
-  String res(str);
-  while (!res.empty() && std::isspace(res.at(0)))
-    res.erase(res.begin());
-  while (!res.empty() && std::isspace(res.at(res.size()-1)))
-    res.erase(res.end()-1);
-
-  return res;
+  StringView res = trim_view(str);
+  return String(res.data(), res.size());
 }
 
-std::string Vaca::to_utf8(const String& string)
+/**
+   Returns the range of @a str without the whitespace characters at
+   the beginning and at the end (' ', '\t', '\n', '\v', '\f' and
+   '\r'). Long runs of whitespace are skipped with SSE2 when it is
+   available.
+
+   @see trim_string, trim_string_in_place
+*/
+StringView Vaca::trim_view(const StringView& str)
 {
-  int required_size =
-    WideCharToMultiByte(CP_UTF8, 0,
-			string.c_str(), string.size(),
-			NULL, 0, NULL, NULL);
+  const Char* begin = skip_spaces(str.begin(), str.end());
+  const Char* end = skip_spaces_backward(begin, str.end());
+  return StringView(begin, end - begin);
+}
 
-  if (required_size == 0)
-    return std::string();
+/**
+   Removes the whitespace characters at the beginning and at the end
+   of @a str, moving the characters at most once.
 
-  std::vector<char> buf(++required_size);
+   @see trim_string, trim_view
+*/
+void Vaca::trim_string_in_place(String& str)
+{
+  StringView res = trim_view(str);
+  size_t begin = res.data() - str.c_str();
 
-  WideCharToMultiByte(CP_UTF8, 0, 
-		      string.c_str(), string.size(),
-		      &buf[0], required_size,
-		      NULL, NULL);
+  str.erase(begin + res.size());
+  str.erase(0, begin);
+}
 
-  return std::string(&buf[0]);
+std::string Vaca::to_utf8(const String& string)
+{
+  std::string result;
+  wide_to_utf8(string.c_str(), string.size(), result);
+  return result;
 }
 
 String Vaca::from_utf8(const std::string& string)
 {
-  int required_size =
-    MultiByteToWideChar(CP_UTF8, 0,
-			string.c_str(), string.size(),
-			NULL, 0);
-
-  if (required_size == 0)
-    return String();
-
-  std::vector<wchar_t> buf(++required_size);
-
-  MultiByteToWideChar(CP_UTF8, 0,
-		      string.c_str(), string.size(),
-		      &buf[0], required_size);
-
-  return String(&buf[0]);
-}
-
-namespace {
-  struct is_separator
-  {
-    const String* separators;
-    is_separator(const String* separators) : separators(separators) { }
-    bool operator()(Char chr)
-    {
-      for (String::const_iterator
-	     it = separators->begin(),
-	     end = separators->end(); it != end; ++it) {
-	if (chr == *it)
-	  return true;
-      }
-      return false;
-    }
-  };
+  String result;
+  utf8_to_wide(string.c_str(), string.size(), result);
+  return result;
 }
 
+/**
+   Splits the @a string in @a parts. Each character of @a separators
+   ends a part, so a string with @e N separators has @e N+1 parts.
+
+   The strings already in @a parts are reused to avoid allocating
+   memory for each part.
+
+   @see StringTokenizer
+*/
 void Vaca::split_string(const String& string, std::vector<String>& parts, const String& separators)
 {
-  size_t elements = 1 + std::count_if(string.begin(), string.end(), is_separator(&separators));
-  parts.resize(elements);
+  StringTokenizer tok(string, separators);
+  StringView token;
+  size_t count = 0;
 
-  size_t beg = 0, end;
-  while (true) {
-    end = string.find_first_of(separators);
-    if (end != String::npos) {
-      parts.push_back(string.substr(beg, end - beg));
-      beg = end+1;
-    }
-    else {
-      parts.push_back(string.substr(beg));
-      break;
-    }
+  while (tok.next(token)) {
+    if (count < parts.size())
+      parts[count].assign(token.begin(), token.end());
+    else
+      parts.push_back(token.str());
+    ++count;
   }
+
+  parts.resize(count);
+}
+
+/**
+   Splits the @a string in @a parts without copying the characters:
+   each part is a view over @a string.
+*/
+void Vaca::split_string(const StringView& string, std::vector<StringView>& parts, const StringView& separators)
+{
+  StringTokenizer tok(string, separators);
+  StringView token;
+
+  parts.clear();
+  while (tok.next(token))
+    parts.push_back(token);
 }
 
 template<> std::string Vaca::convert_to(const Char* const& from)
@@ -189,34 +277,56 @@ template<> std::string Vaca::convert_to(const String& from)
     return std::string(ansiBuf.get());
 }
 
+// Parses the number in "from" skipping the leading whitespace (the
+// result is zero if there is no number)
+template<typename T>
+static T parse_string(const String& from)
+{
+  const Char* begin = from.c_str();
+  const Char* end = begin + from.size();
+  T value = 0;
+
+  begin = skip_spaces(begin, end);
+  parse_number(begin, end, value);
+  return value;
+}
+
+template<typename T>
+static String format_string_from(T value)
+{
+  Char buf[NumberBufferSize];
+  int len = format_number(value, buf, NumberBufferSize);
+  return String(buf, len);
+}
+
 template<> int Vaca::convert_to(const String& from)
 {
-  return (int)std::wcstol(from.c_str(), NULL, 10);
+  return parse_string<int>(from);
 }
 
 template<> long Vaca::convert_to(const String& from)
 {
-  return (long)std::wcstol(from.c_str(), NULL, 10);
+  return parse_string<long>(from);
 }
 
 template<> unsigned int Vaca::convert_to(const String& from)
 {
-  return (unsigned int)std::wcstoul(from.c_str(), NULL, 10);
+  return parse_string<unsigned int>(from);
 }
 
 template<> unsigned long Vaca::convert_to(const String& from)
 {
-  return (unsigned long)std::wcstoul(from.c_str(), NULL, 10);
+  return parse_string<unsigned long>(from);
 }
 
 template<> float Vaca::convert_to(const String& from)
 {
-  return (float)std::wcstod(from.c_str(), NULL);
+  return parse_string<float>(from);
 }
 
 template<> double Vaca::convert_to(const String& from)
 {
-  return std::wcstod(from.c_str(), NULL);
+  return parse_string<double>(from);
 }
 
 template<> String Vaca::convert_to(const char* const& from)
@@ -243,32 +353,32 @@ template<> String Vaca::convert_to(const std::string& from)
 
 template<> String Vaca::convert_to(const int& from)
 {
-  return format_string(L"%d", from);
+  return format_string_from(from);
 }
 
 template<> String Vaca::convert_to(const long& from)
 {
-  return format_string(L"%ld", from);
+  return format_string_from(from);
 }
 
 template<> String Vaca::convert_to(const unsigned int& from)
 {
-  return format_string(L"%u", from);
+  return format_string_from(from);
 }
 
 template<> String Vaca::convert_to(const unsigned long& from)
 {
-  return format_string(L"%lu", from);
+  return format_string_from(from);
 }
 
 template<> String Vaca::convert_to(const float& from)
 {
-  return format_string(L"%.16g", from);
+  return format_string_from(from);
 }
 
 template<> String Vaca::convert_to(const double& from)
 {
-  return format_string(L"%.16g", from);
+  return format_string_from(from);
 }
 
 /**
@@ -297,12 +407,10 @@ void Vaca::copy_string_to(const String& src, Char* dest, int size)
 */
 String Vaca::operator/(const String& path, const String& comp)
 {
-  String res(path);
-
-  if (!res.empty() && *(res.end()-1) != L'/' && *(res.end()-1) != L'\\')
-    res.push_back(L'\\');
-
-  res += comp;
+  String res;
+  res.reserve(path.size() + 1 + comp.size());
+  res = path;
+  res /= comp;
   return res;
 }
 
@@ -334,45 +442,22 @@ String& Vaca::operator/=(String& path, const String& comp)
    Returns the file path (the path of "C:\foo\main.cpp" is "C:\foo"
    without the file name).
 
-   @see file_name
+   @see file_name, PathView#getDirectory
 */
 String Vaca::file_path(const String& fullpath)
 {
-  String::const_reverse_iterator rit;
-  String res;
-
-  for (rit=fullpath.rbegin(); rit!=fullpath.rend(); ++rit)
-    if (*rit == L'\\' || *rit == L'/')
-      break;
-
-  if (rit != fullpath.rend()) {
-    ++rit;
-    std::copy(fullpath.begin(), String::const_iterator(rit.base()),
-	      std::back_inserter(res));
-  }
-
-  return res;
+  return PathView(fullpath, PathSeparator::Windows).getDirectory().str();
 }
 
 /**
    Returns the file name (the file name of "C:\foo\main.cpp" is
    "main.cpp", without the path).
 
-   @see file_path, file_title
+   @see file_path, file_title, PathView#getFileName
 */
 String Vaca::file_name(const String& fullpath)
 {
-  String::const_reverse_iterator rit;
-  String res;
-
-  for (rit=fullpath.rbegin(); rit!=fullpath.rend(); ++rit)
-    if (*rit == L'\\' || *rit == L'/')
-      break;
-
-  std::copy(String::const_iterator(rit.base()), fullpath.end(),
-	    std::back_inserter(res));
-
-  return res;
+  return PathView(fullpath, PathSeparator::Windows).getFileName().str();
 }
 
 /**
@@ -382,27 +467,11 @@ String Vaca::file_name(const String& fullpath)
    @warning
      For a file name like "pack.tar.gz" the extension is "gz".
 
-   @see file_path, file_title
+   @see file_path, file_title, PathView#getExtension
 */
 String Vaca::file_extension(const String& fullpath)
 {
-  String::const_reverse_iterator rit;
-  String res;
-
-  // search for the first dot from the end of the string
-  for (rit=fullpath.rbegin(); rit!=fullpath.rend(); ++rit) {
-    if (*rit == L'\\' || *rit == L'/')
-      return res;
-    else if (*rit == L'.')
-      break;
-  }
-
-  if (rit != fullpath.rend()) {
-    std::copy(String::const_iterator(rit.base()), fullpath.end(),
-	      std::back_inserter(res));
-  }
-
-  return res;
+  return PathView(fullpath, PathSeparator::Windows).getExtension().str();
 }
 
 /**
@@ -412,96 +481,68 @@ String Vaca::file_extension(const String& fullpath)
    @warning
      For a file name like "pack.tar.gz" the title is "pack.tar".
 
-   @see file_path, file_extension
+   @see file_path, file_extension, PathView#getTitle
 */
 String Vaca::file_title(const String& fullpath)
 {
-  String::const_reverse_iterator rit;
-  String::const_iterator last_dot = fullpath.end();
-  String res;
-
-  for (rit=fullpath.rbegin(); rit!=fullpath.rend(); ++rit) {
-    if (*rit == L'\\' || *rit == L'/')
-      break;
-    else if (*rit == L'.' && last_dot == fullpath.end())
-      last_dot = rit.base()-1;
-  }
-
-  for (String::const_iterator it(rit.base()); it!=fullpath.end(); ++it) {
-    if (it == last_dot)
-      break;
-    else
-      res.push_back(*it);
-  }
-
-  return res;
+  return PathView(fullpath, PathSeparator::Windows).getTitle().str();
 }
 
+/**
+   Returns the host of the @a url (the host of
+   "http://www.example.com:8080/index.html" is "www.example.com").
+
+   @see url_object, UrlView
+*/
 String Vaca::url_host(const String& url)
 {
-  String host;
-  int len = url.size();
-  for (int c=0; c<len; ++c) {
-    if (url[c] == L':' && url[c+1] == L'/' && url[c+2] == L'/') {
-      for (c+=3; c<len && url[c] != L'/'; ++c)
-	host.push_back(url[c]);
-    }
-  }
-  return host;
+  return UrlView(url).getHost().str();
 }
 
+/**
+   Returns the path and query of the @a url (the object of
+   "http://www.example.com/index.html?q=1#top" is "/index.html?q=1").
+
+   @see url_host, UrlView#getObject
+*/
 String Vaca::url_object(const String& url)
 {
-  String object;
-  int len = url.size();
-  for (int c=0; c<len; ++c) {
-    if (url[c] == ':' && url[c+1] == '/' && url[c+2] == '/') {
-      for (c+=3; c<len && url[c] != '/'; ++c)
-	;
-      for (; c<len; ++c)
-	object.push_back(url[c]);
-    }
-  }
-  return object;
+  return UrlView(url).getObject().str();
 }
 
+/**
+   Encodes the characters that are not valid in an URL as "%XX"
+   sequences.
+
+   @see decode_url, encode_url_to
+*/
 String Vaca::encode_url(const String& url)
 {
-  std::auto_ptr<Char> buf;
-  DWORD size = 1024;
-
-  while (true) {
-    buf = std::auto_ptr<Char>(new Char[size]);
-
-    if (::InternetCanonicalizeUrl(url.c_str(), buf.get(), &size, 0))
-      break;
-
-    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
-      throw Exception();
+  String res;
+  res.reserve(url.size());
 
-    // else continue growing the buffer...
-  }
+  Char buf[256];
+  size_t pos = 0, len;
+  while ((len = encode_url_to(url, pos, buf, 256)) > 0)
+    res.append(buf, len);
 
-  return String(buf.get());
+  return res;
 }
 
+/**
+   Decodes the "%XX" sequences of an URL.
+
+   @see encode_url, decode_url_to
+*/
 String Vaca::decode_url(const String& url)
 {
-  std::auto_ptr<Char> buf;
-  DWORD size = 1024;
-
-  while (true) {
-    buf = std::auto_ptr<Char>(new Char[size]);
-
-    if (::InternetCanonicalizeUrl(url.c_str(), buf.get(), &size,
-				  ICU_DECODE | ICU_NO_ENCODE))
-      break;
-
-    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
-      throw Exception();
+  String res;
+  res.reserve(url.size());
 
-    // else continue growing the buffer...
-  }
+  Char buf[256];
+  size_t pos = 0, len;
+  while ((len = decode_url_to(url, pos, buf, 256)) > 0)
+    res.append(buf, len);
 
-  return String(buf.get());
+  return res;
 }
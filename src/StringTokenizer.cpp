@@ -0,0 +1,102 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/StringTokenizer.h"
+
+using namespace Vaca;
+
+/**
+   Creates a tokenizer for @a string.
+
+   @param separators
+     Each character of this string is a separator.
+*/
+StringTokenizer::StringTokenizer(const StringView& string, const StringView& separators)
+  : m_string(string)
+  , m_separators(separators)
+{
+  for (int i=0; i<8; ++i)
+    m_table[i] = 0;
+
+  for (StringView::const_iterator
+	 it=separators.begin(); it!=separators.end(); ++it) {
+    unsigned int code = *it;
+    if (code < 256)
+      m_table[code >> 5] |= 1u << (code & 31);
+  }
+
+  reset();
+}
+
+/**
+   Gets the next token.
+
+   @return
+     False if there are no more tokens.
+*/
+bool StringTokenizer::next(StringView& token)
+{
+  if (m_finished)
+    return false;
+
+  const Char* begin = m_string.begin() + m_pos;
+  const Char* end = m_string.end();
+  const Char* it;
+
+  // with just one separator we can use wmemchr
+  if (m_separators.size() == 1) {
+    it = std::wmemchr(begin, m_separators[0], end - begin);
+    if (!it)
+      it = end;
+  }
+  else {
+    for (it=begin; it!=end && !isSeparator(*it); ++it)
+      ;
+  }
+
+  token = StringView(begin, it - begin);
+
+  if (it == end)
+    m_finished = true;
+  else
+    m_pos = it - m_string.begin() + 1;
+
+  return true;
+}
+
+/**
+   Goes back to the first token.
+*/
+void StringTokenizer::reset()
+{
+  m_pos = 0;
+  m_finished = false;
+}
@@ -0,0 +1,157 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/StringView.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Vaca;
+
+const size_t StringView::npos;
+
+/**
+   Returns a view of @a count characters starting in @a pos (or the
+   characters until the end of this view if there are less).
+*/
+StringView StringView::substr(size_t pos, size_t count) const
+{
+  assert(pos <= m_size);
+
+  return StringView(m_data + pos, std::min(count, m_size - pos));
+}
+
+/**
+   Moves the start of the view @a count characters forward.
+*/
+void StringView::removePrefix(size_t count)
+{
+  assert(count <= m_size);
+
+  m_data += count;
+  m_size -= count;
+}
+
+/**
+   Moves the end of the view @a count characters backward.
+*/
+void StringView::removeSuffix(size_t count)
+{
+  assert(count <= m_size);
+
+  m_size -= count;
+}
+
+/**
+   Returns the position of the first @a chr from @a pos, or
+   StringView::npos if it is not found.
+*/
+size_t StringView::find(Char chr, size_t pos) const
+{
+  if (pos >= m_size)
+    return npos;
+
+  const Char* found = std::wmemchr(m_data + pos, chr, m_size - pos);
+  return found ? found - m_data: npos;
+}
+
+/**
+   Returns the position of the last @a chr before or at @a pos, or
+   StringView::npos if it is not found.
+*/
+size_t StringView::rfind(Char chr, size_t pos) const
+{
+  if (m_size == 0)
+    return npos;
+
+  for (size_t i = std::min(pos, m_size-1)+1; i > 0; --i)
+    if (m_data[i-1] == chr)
+      return i-1;
+
+  return npos;
+}
+
+/**
+   Returns the position of the first occurrence of @a str from @a
+   pos, or StringView::npos if it is not found.
+*/
+size_t StringView::find(const StringView& str, size_t pos) const
+{
+  if (pos > m_size)
+    return npos;
+
+  const Char* found = std::search(begin() + pos, end(), str.begin(), str.end());
+  return found != end() || str.empty() ? found - m_data: npos;
+}
+
+bool StringView::startsWith(const StringView& str) const
+{
+  return m_size >= str.m_size
+    && std::wmemcmp(m_data, str.m_data, str.m_size) == 0;
+}
+
+bool StringView::endsWith(const StringView& str) const
+{
+  return m_size >= str.m_size
+    && std::wmemcmp(m_data + m_size - str.m_size, str.m_data, str.m_size) == 0;
+}
+
+/**
+   Compares the characters of both views (like String#compare).
+*/
+int StringView::compare(const StringView& str) const
+{
+  int res = std::wmemcmp(m_data, str.m_data, std::min(m_size, str.m_size));
+  if (res != 0)
+    return res;
+  else if (m_size < str.m_size)
+    return -1;
+  else if (m_size > str.m_size)
+    return 1;
+  else
+    return 0;
+}
+
+bool StringView::operator==(const StringView& str) const
+{
+  return m_size == str.m_size
+    && std::wmemcmp(m_data, str.m_data, m_size) == 0;
+}
+
+bool StringView::operator!=(const StringView& str) const
+{
+  return !operator==(str);
+}
+
+bool StringView::operator<(const StringView& str) const
+{
+  return compare(str) < 0;
+}
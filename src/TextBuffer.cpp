@@ -0,0 +1,681 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/TextBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+using namespace Vaca;
+
+// Maximum number of characters in one piece. It limits the time that
+// is spent scanning a piece to get a character or a line.
+#define MAX_PIECE_SIZE		4096
+
+// Minimum size of each block of the storage (in characters)
+#define MIN_BLOCK_SIZE		65536
+
+/**
+   @internal
+
+   A node of the treap: a piece of the storage plus the
+   summary of its subtree. Nodes are shared between snapshots, so they
+   are modified in place only when they have one reference.
+*/
+struct TextBuffer::Piece
+{
+  int refs;
+  unsigned priority;
+  Piece* left;
+  Piece* right;
+  const Char* data;
+  size_t length;
+  size_t breaks;
+  size_t totalLength;
+  size_t totalBreaks;
+};
+
+/**
+   @internal
+
+   Append-only memory for the characters of a TextBuffer and all its
+   snapshots.
+*/
+struct TextBuffer::Storage
+{
+  int refs;
+  std::vector<Char*> blocks;
+  Char* tail;
+  size_t available;
+  unsigned seed;
+
+  Storage() : refs(1), tail(NULL), available(0), seed(2463534242u) { }
+
+  ~Storage() {
+    for (size_t i=0; i<blocks.size(); ++i)
+      delete[] blocks[i];
+  }
+
+  // Makes room for @a size contiguous characters at the tail
+  Char* reserve(size_t size) {
+    if (available < size) {
+      size_t blockSize = std::max<size_t>(MIN_BLOCK_SIZE, size);
+      blocks.push_back(new Char[blockSize]);
+      tail = blocks.back();
+      available = blockSize;
+    }
+    return tail;
+  }
+
+  const Char* append(const Char* text, size_t size) {
+    Char* dst = reserve(size);
+    std::copy(text, text+size, dst);
+    commit(size);
+    return dst;
+  }
+
+  void commit(size_t size) {
+    tail += size;
+    available -= size;
+  }
+
+  // xorshift32
+  unsigned random() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  }
+};
+
+typedef TextBuffer::Piece Piece;
+
+static size_t count_breaks(const Char* text, size_t size)
+{
+  return std::count(text, text+size, L'\n');
+}
+
+static inline size_t total_length(const Piece* node)
+{
+  return node ? node->totalLength: 0;
+}
+
+static inline size_t total_breaks(const Piece* node)
+{
+  return node ? node->totalBreaks: 0;
+}
+
+static inline void update(Piece* node)
+{
+  node->totalLength = total_length(node->left) + node->length + total_length(node->right);
+  node->totalBreaks = total_breaks(node->left) + node->breaks + total_breaks(node->right);
+}
+
+static inline Piece* retain(Piece* node)
+{
+  if (node)
+    ++node->refs;
+  return node;
+}
+
+static void release(Piece* node)
+{
+  if (node && --node->refs == 0) {
+    release(node->left);
+    release(node->right);
+    delete node;
+  }
+}
+
+// Creates a node which takes the references of @a left and @a right
+static Piece* make_node(const Char* data, size_t length, size_t breaks,
+		       unsigned priority, Piece* left, Piece* right)
+{
+  Piece* node = new Piece;
+  node->refs = 1;
+  node->priority = priority;
+  node->left = left;
+  node->right = right;
+  node->data = data;
+  node->length = length;
+  node->breaks = breaks;
+  update(node);
+  return node;
+}
+
+// Concatenates two trees, taking their references
+static Piece* merge(Piece* a, Piece* b)
+{
+  if (!a) return b;
+  if (!b) return a;
+
+  if (a->priority >= b->priority) {
+    if (a->refs == 1) {
+      a->right = merge(a->right, b);
+      update(a);
+      return a;
+    }
+    Piece* node = make_node(a->data, a->length, a->breaks, a->priority,
+			   retain(a->left), merge(retain(a->right), b));
+    release(a);
+    return node;
+  }
+  else {
+    if (b->refs == 1) {
+      b->left = merge(a, b->left);
+      update(b);
+      return b;
+    }
+    Piece* node = make_node(b->data, b->length, b->breaks, b->priority,
+			   merge(a, retain(b->left)), retain(b->right));
+    release(b);
+    return node;
+  }
+}
+
+// Splits @a tree in the first @a offset characters (@a a) and the
+// rest (@a b). The tree is not modified.
+static void split(Piece* tree, size_t offset, Piece*& a, Piece*& b)
+{
+  if (!tree) {
+    a = b = NULL;
+  }
+  else if (offset == 0) {
+    a = NULL;
+    b = retain(tree);
+  }
+  else if (offset >= tree->totalLength) {
+    a = retain(tree);
+    b = NULL;
+  }
+  else {
+    size_t leftLength = total_length(tree->left);
+
+    if (offset <= leftLength) {
+      Piece* rest;
+      split(tree->left, offset, a, rest);
+      b = make_node(tree->data, tree->length, tree->breaks, tree->priority,
+		    rest, retain(tree->right));
+    }
+    else if (offset >= leftLength + tree->length) {
+      Piece* rest;
+      split(tree->right, offset - leftLength - tree->length, rest, b);
+      a = make_node(tree->data, tree->length, tree->breaks, tree->priority,
+		    retain(tree->left), rest);
+    }
+    // the piece must be cut in two
+    else {
+      size_t head = offset - leftLength;
+      size_t headBreaks = count_breaks(tree->data, head);
+
+      a = make_node(tree->data, head, headBreaks, tree->priority,
+		    retain(tree->left), NULL);
+      b = make_node(tree->data + head, tree->length - head, tree->breaks - headBreaks,
+		    tree->priority, NULL, retain(tree->right));
+    }
+  }
+}
+
+static void update_subtree(Piece* node)
+{
+  if (node) {
+    update_subtree(node->left);
+    update_subtree(node->right);
+    update(node);
+  }
+}
+
+// Appends the characters of @a tree in [offset, offset+count)
+static void collect(const Piece* tree, size_t offset, size_t count, String& dst)
+{
+  while (tree && count > 0) {
+    size_t leftLength = total_length(tree->left);
+
+    if (offset < leftLength) {
+      size_t n = std::min(count, leftLength - offset);
+      collect(tree->left, offset, n, dst);
+      offset += n;
+      count -= n;
+    }
+
+    offset -= leftLength;
+    if (count > 0 && offset < tree->length) {
+      size_t n = std::min(count, tree->length - offset);
+      dst.append(tree->data + offset, n);
+      offset += n;
+      count -= n;
+    }
+
+    offset -= tree->length;
+    tree = tree->right;
+  }
+}
+
+// Adds @a size characters (which were already written at the end of
+// the piece) to the piece that ends in @a offset. Returns NULL if that
+// piece cannot grow. Nodes with only one reference (in all the path)
+// are modified in place, the others are copied.
+static Piece* extend(Piece* tree, size_t offset, const Char* tail,
+		    size_t size, size_t breaks, bool unique)
+{
+  if (!tree)
+    return NULL;
+
+  unique = unique && tree->refs == 1;
+
+  size_t leftLength = total_length(tree->left);
+  size_t end = leftLength + tree->length;
+
+  if (offset <= leftLength) {
+    Piece* left = extend(tree->left, offset, tail, size, breaks, unique);
+    if (!left)
+      return NULL;
+
+    if (unique) {
+      if (left != tree->left) {
+	release(tree->left);
+	tree->left = left;
+      }
+      update(tree);
+      return tree;
+    }
+    return make_node(tree->data, tree->length, tree->breaks, tree->priority,
+		     left, retain(tree->right));
+  }
+  else if (offset > end) {
+    Piece* right = extend(tree->right, offset - end, tail, size, breaks, unique);
+    if (!right)
+      return NULL;
+
+    if (unique) {
+      if (right != tree->right) {
+	release(tree->right);
+	tree->right = right;
+      }
+      update(tree);
+      return tree;
+    }
+    return make_node(tree->data, tree->length, tree->breaks, tree->priority,
+		     retain(tree->left), right);
+  }
+  else if (offset == end &&
+	   tree->data + tree->length == tail &&
+	   tree->length + size <= MAX_PIECE_SIZE) {
+    if (unique) {
+      tree->length += size;
+      tree->breaks += breaks;
+      update(tree);
+      return tree;
+    }
+    return make_node(tree->data, tree->length + size, tree->breaks + breaks,
+		     tree->priority, retain(tree->left), retain(tree->right));
+  }
+  else
+    return NULL;
+}
+
+// ======================================================================
+// TextBuffer
+
+/**
+   Creates an empty buffer.
+*/
+TextBuffer::TextBuffer()
+  : m_root(NULL)
+  , m_storage(new Storage)
+{
+}
+
+/**
+   Creates a buffer with a copy of @a text.
+*/
+TextBuffer::TextBuffer(const String& text)
+  : m_root(NULL)
+  , m_storage(new Storage)
+{
+  m_root = createPieces(text.c_str(), text.size());
+}
+
+/**
+   Creates a buffer with a copy of the first @a size characters of
+   @a text.
+*/
+TextBuffer::TextBuffer(const Char* text, size_t size)
+  : m_root(NULL)
+  , m_storage(new Storage)
+{
+  m_root = createPieces(text, size);
+}
+
+/**
+   Makes a snapshot of @a other. It is O(1): the text is not copied,
+   and the next changes in any of both buffers do not affect the
+   other one.
+*/
+TextBuffer::TextBuffer(const TextBuffer& other)
+  : m_root(retain(other.m_root))
+  , m_storage(other.m_storage)
+{
+  ++m_storage->refs;
+}
+
+TextBuffer::~TextBuffer()
+{
+  release(m_root);
+  if (--m_storage->refs == 0)
+    delete m_storage;
+}
+
+TextBuffer& TextBuffer::operator=(const TextBuffer& other)
+{
+  TextBuffer copy(other);
+  std::swap(m_root, copy.m_root);
+  std::swap(m_storage, copy.m_storage);
+  return *this;
+}
+
+/**
+   Returns the number of characters in the buffer.
+*/
+size_t TextBuffer::size() const
+{
+  return total_length(m_root);
+}
+
+bool TextBuffer::empty() const
+{
+  return m_root == NULL;
+}
+
+/**
+   Returns the number of lines (the number of '\\n' plus one). An
+   empty buffer has one line.
+*/
+size_t TextBuffer::getLineCount() const
+{
+  return total_breaks(m_root) + 1;
+}
+
+/**
+   Returns the character in the specified @a offset. It is O(log n).
+*/
+Char TextBuffer::at(size_t offset) const
+{
+  assert(offset < size());
+
+  const Piece* node = m_root;
+  for (;;) {
+    size_t leftLength = total_length(node->left);
+
+    if (offset < leftLength)
+      node = node->left;
+    else if (offset < leftLength + node->length)
+      return node->data[offset - leftLength];
+    else {
+      offset -= leftLength + node->length;
+      node = node->right;
+    }
+  }
+}
+
+/**
+   Returns all the text of the buffer.
+*/
+String TextBuffer::getText() const
+{
+  return getText(0, size());
+}
+
+/**
+   Returns @a count characters from the specified @a offset. The range
+   is clipped to the size of the buffer.
+*/
+String TextBuffer::getText(size_t offset, size_t count) const
+{
+  size_t length = size();
+  String res;
+
+  if (offset < length) {
+    count = std::min(count, length - offset);
+    res.reserve(count);
+    collect(m_root, offset, count, res);
+  }
+  return res;
+}
+
+/**
+   Returns the text of the specified @a line without its '\\n' (a
+   '\\r' before it is kept).
+*/
+String TextBuffer::getLine(size_t line) const
+{
+  size_t start = offsetFromLine(line);
+  size_t end = (line+1 < getLineCount() ? offsetFromLine(line+1)-1: size());
+
+  return getText(start, end - start);
+}
+
+void TextBuffer::insert(size_t offset, Char chr)
+{
+  insert(offset, &chr, 1);
+}
+
+void TextBuffer::insert(size_t offset, const String& text)
+{
+  insert(offset, text.c_str(), text.size());
+}
+
+/**
+   Inserts the first @a size characters of @a text before the
+   specified @a offset. It is O(log n) plus the time to copy the text.
+
+   Consecutive insertions (e.g. the user typing) grow the same piece,
+   so they do not make the tree bigger.
+*/
+void TextBuffer::insert(size_t offset, const Char* text, size_t size)
+{
+  assert(offset <= this->size());
+
+  if (size == 0 || extendPiece(offset, text, size))
+    return;
+
+  Piece* a;
+  Piece* b;
+  split(m_root, offset, a, b);
+  release(m_root);
+  m_root = merge(merge(a, createPieces(text, size)), b);
+}
+
+/**
+   Removes @a count characters from the specified @a offset. It is
+   O(log n). The range is clipped to the size of the buffer.
+*/
+void TextBuffer::erase(size_t offset, size_t count)
+{
+  if (count == 0 || offset >= size())
+    return;
+
+  Piece* a;
+  Piece* rest;
+  Piece* middle;
+  Piece* b;
+  split(m_root, offset, a, rest);
+  split(rest, count, middle, b);
+  release(rest);
+  release(middle);
+  release(m_root);
+  m_root = merge(a, b);
+}
+
+/**
+   Removes all the text. The snapshots of the buffer keep their text.
+*/
+void TextBuffer::clear()
+{
+  release(m_root);
+  m_root = NULL;
+}
+
+/**
+   Returns the line (starting from zero) where is the character in
+   the specified @a offset.
+
+   @see offsetFromLine
+*/
+size_t TextBuffer::lineFromOffset(size_t offset) const
+{
+  const Piece* node = m_root;
+  size_t line = 0;
+
+  while (node) {
+    size_t leftLength = total_length(node->left);
+
+    if (offset <= leftLength)
+      node = node->left;
+    else {
+      offset -= leftLength;
+      line += total_breaks(node->left);
+
+      if (offset <= node->length)
+	return line + count_breaks(node->data, offset);
+
+      offset -= node->length;
+      line += node->breaks;
+      node = node->right;
+    }
+  }
+  return line;
+}
+
+/**
+   Returns the offset of the first character of the specified
+   @a line. If the line does not exist returns the size of the buffer.
+
+   @see lineFromOffset
+*/
+size_t TextBuffer::offsetFromLine(size_t line) const
+{
+  const Piece* node = m_root;
+  size_t offset = 0;
+
+  if (line == 0 || line > total_breaks(m_root))
+    return line == 0 ? 0: size();
+
+  // looks for the line-th '\n'
+  while (node) {
+    size_t leftBreaks = total_breaks(node->left);
+
+    if (line <= leftBreaks)
+      node = node->left;
+    else {
+      line -= leftBreaks;
+      offset += total_length(node->left);
+
+      if (line <= node->breaks) {
+	const Char* p = node->data;
+	for (;; ++p)
+	  if (*p == L'\n' && --line == 0)
+	    return offset + (p - node->data) + 1;
+      }
+
+      line -= node->breaks;
+      offset += node->length;
+      node = node->right;
+    }
+  }
+
+  assert(false);
+  return size();
+}
+
+/**
+   Copies @a text to the storage and returns a tree with its pieces.
+*/
+TextBuffer::Piece* TextBuffer::createPieces(const Char* text, size_t size)
+{
+  // builds the treap from left to right, the stack has the right
+  // spine of the tree
+  std::vector<Piece*> spine;
+
+  while (size > 0) {
+    size_t length = std::min<size_t>(size, MAX_PIECE_SIZE);
+    const Char* data = m_storage->append(text, length);
+    Piece* node = make_node(data, length, count_breaks(data, length),
+			   m_storage->random(), NULL, NULL);
+    Piece* last = NULL;
+
+    while (!spine.empty() && spine.back()->priority < node->priority) {
+      last = spine.back();
+      spine.pop_back();
+    }
+    node->left = last;
+    if (!spine.empty())
+      spine.back()->right = node;
+    spine.push_back(node);
+
+    text += length;
+    size -= length;
+  }
+
+  if (spine.empty())
+    return NULL;
+
+  Piece* root = spine.front();
+  update_subtree(root);
+  return root;
+}
+
+/**
+   Tries to insert the text at the end of the piece which ends in
+   @a offset (if that piece is the last one in the storage).
+*/
+bool TextBuffer::extendPiece(size_t offset, const Char* text, size_t size)
+{
+  if (offset == 0 || m_storage->available < size)
+    return false;
+
+  // the characters are written but not committed until the piece grows
+  Char* tail = m_storage->tail;
+  std::copy(text, text+size, tail);
+
+  Piece* root = extend(m_root, offset, tail, size, count_breaks(text, size),
+		      m_root->refs == 1);
+  if (!root)
+    return false;
+
+  m_storage->commit(size);
+  if (root != m_root) {
+    release(m_root);
+    m_root = root;
+  }
+  return true;
+}
@@ -0,0 +1,263 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/TextLayoutCache.h"
+#include "Vaca/LruCache.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/Size.h"
+#include "Vaca/String.h"
+
+using namespace Vaca;
+
+// default memory budget (in bytes)
+#define DEFAULT_MEMORY_BUDGET	(256*1024)
+
+// approximated memory used by each entry without its text (map and
+// list nodes)
+#define ENTRY_OVERHEAD		(sizeof(Key) + sizeof(Size) + 16*sizeof(void*))
+
+namespace {
+
+  // The key of a lookup points to the text of the caller, so finding
+  // a measure does not copy the text. The copies of a key (the ones
+  // stored in the cache) own a copy of the text.
+  struct Key
+  {
+    size_t hash;
+    HFONT font;
+    int fitInWidth;
+    int flags;
+    const String* text;
+    String ownText;
+
+    Key(HFONT font, const String& text, int fitInWidth, int flags)
+      : hash(hash_text(text))
+      , font(font)
+      , fitInWidth(fitInWidth)
+      , flags(flags)
+      , text(&text) { }
+
+    Key(const Key& other)
+      : hash(other.hash)
+      , font(other.font)
+      , fitInWidth(other.fitInWidth)
+      , flags(other.flags)
+      , text(&ownText)
+      , ownText(*other.text) { }
+
+    Key& operator=(const Key& other) {
+      hash = other.hash;
+      font = other.font;
+      fitInWidth = other.fitInWidth;
+      flags = other.flags;
+      ownText = *other.text;
+      text = &ownText;
+      return *this;
+    }
+
+    // the text is compared only when everything else is equal
+    bool operator<(const Key& other) const {
+      if (hash != other.hash) return hash < other.hash;
+      if (font != other.font) return font < other.font;
+      if (fitInWidth != other.fitInWidth) return fitInWidth < other.fitInWidth;
+      if (flags != other.flags) return flags < other.flags;
+      return *text < *other.text;
+    }
+
+    // FNV-1a
+    static size_t hash_text(const String& text) {
+      size_t hash = 2166136261u;
+      for (String::const_iterator it=text.begin(); it!=text.end(); ++it) {
+	hash ^= static_cast<size_t>(*it);
+	hash *= 16777619u;
+      }
+      return hash;
+    }
+  };
+
+  struct SameFont
+  {
+    HFONT font;
+    SameFont(HFONT font) : font(font) { }
+    bool operator()(const Key& key, const Size&) const {
+      return key.font == font;
+    }
+  };
+
+  typedef LruCache<Key, Size> Cache;
+
+  struct CacheHolder
+  {
+    Mutex mutex;
+    Cache cache;
+    bool alive;
+
+    CacheHolder() : cache(DEFAULT_MEMORY_BUDGET), alive(true) { }
+    ~CacheHolder() { alive = false; }
+  };
+
+}
+
+// Fonts can be destroyed after this object (e.g. static fonts), so
+// the "alive" flag is checked before using it.
+static CacheHolder s_holder;
+
+static size_t get_entry_cost(const String& text)
+{
+  return ENTRY_OVERHEAD + text.size() * sizeof(Char);
+}
+
+/**
+   Looks for the size of a string measured previously.
+
+   @param size
+     Output parameter to receive the cached size.
+
+   @return
+     True if the measure was in the cache.
+*/
+bool TextLayoutCache::find(HFONT font, const String& text, int fitInWidth, int flags, Size& size)
+{
+  if (!s_holder.alive)
+    return false;
+
+  Key key(font, text, fitInWidth, flags);
+  ScopedLock hold(s_holder.mutex);
+
+  Size* cached = s_holder.cache.find(key);
+  if (cached) {
+    size = *cached;
+    return true;
+  }
+  else
+    return false;
+}
+
+/**
+   Adds the size of a measured string to the cache.
+*/
+void TextLayoutCache::insert(HFONT font, const String& text, int fitInWidth, int flags, const Size& size)
+{
+  if (!s_holder.alive)
+    return;
+
+  Key key(font, text, fitInWidth, flags);
+  ScopedLock hold(s_holder.mutex);
+  s_holder.cache.insert(key, size, get_entry_cost(text));
+}
+
+/**
+   Removes all the measures made with the specified font.
+
+   It is called when the handle of a Font is destroyed, because a new
+   font could get the same handle.
+*/
+void TextLayoutCache::removeFont(HFONT font)
+{
+  if (!s_holder.alive)
+    return;
+
+  ScopedLock hold(s_holder.mutex);
+  s_holder.cache.eraseIf(SameFont(font));
+}
+
+/**
+   Removes all the entries from the cache.
+*/
+void TextLayoutCache::clear()
+{
+  ScopedLock hold(s_holder.mutex);
+  s_holder.cache.clear();
+}
+
+/**
+   Returns the maximum number of bytes that the cache can use.
+*/
+size_t TextLayoutCache::getMemoryBudget()
+{
+  ScopedLock hold(s_holder.mutex);
+  return s_holder.cache.getCapacity();
+}
+
+/**
+   Changes the maximum number of bytes that the cache can use.
+
+   @param bytes
+     The new budget, use zero to disable the cache.
+*/
+void TextLayoutCache::setMemoryBudget(size_t bytes)
+{
+  ScopedLock hold(s_holder.mutex);
+  s_holder.cache.setCapacity(bytes);
+}
+
+/**
+   Returns the approximated number of bytes used by the cache.
+*/
+size_t TextLayoutCache::getMemoryUsage()
+{
+  ScopedLock hold(s_holder.mutex);
+  return s_holder.cache.getCost();
+}
+
+size_t TextLayoutCache::getEntryCount()
+{
+  ScopedLock hold(s_holder.mutex);
+  return s_holder.cache.size();
+}
+
+/**
+   Returns the number of measures that were found in the cache.
+*/
+size_t TextLayoutCache::getHits()
+{
+  ScopedLock hold(s_holder.mutex);
+  return s_holder.cache.getHits();
+}
+
+/**
+   Returns the number of measures that were not found in the cache.
+*/
+size_t TextLayoutCache::getMisses()
+{
+  ScopedLock hold(s_holder.mutex);
+  return s_holder.cache.getMisses();
+}
+
+/**
+   Resets the hits and misses counters.
+*/
+void TextLayoutCache::resetStats()
+{
+  ScopedLock hold(s_holder.mutex);
+  s_holder.cache.resetStats();
+}
@@ -31,109 +31,51 @@
 
 #include "Vaca/Thread.h"
 #include "Vaca/Debug.h"
-#include "Vaca/Frame.h"
-#include "Vaca/Signal.h"
-#include "Vaca/Timer.h"
-#include "Vaca/Mutex.h"
-#include "Vaca/ScopedLock.h"
 #include "Vaca/Slot.h"
-#include "Vaca/TimePoint.h"
 
-#include <vector>
-#include <algorithm>
+#ifdef VACA_WINDOWS
+  #include "Vaca/GdiObjectCache.h"
+#endif
+
+#include <cassert>
 #include <memory>
 
 using namespace Vaca;
 
-// ======================================================================
-
-// TODO
-// - replace with some C++0x's Thread-Local Storage
-// - use __thread in GCC, and __declspec( thread ) in MSVC
-// - use TlsAlloc
-
-struct ThreadData
-{
-  /**
-     The ID of this thread.
-  */
-  ThreadId threadId;
-
-  /**
-     Visible frames in this thread. A frame is an instance of Frame
-     class.
-  */
-  std::vector<Frame*> frames;
-
-  TimePoint updateIndicatorsMark;
-  bool updateIndicators : 1;
-
-  /**
-     True if the message-loop must be stopped.
-  */
-  bool breakLoop : 1;
-
-  /**
-     Widget used to call createHandle.
-  */
-  Widget* outsideWidget;
-
-  ThreadData(ThreadId id) {
-    threadId = id;
-    breakLoop = false;
-    updateIndicators = true;
-    outsideWidget = NULL;
-  }
-
-};
-
-static Mutex data_mutex;
-static std::vector<ThreadData*> dataOfEachThread;
-
-static ThreadData* get_thread_data()
-{
-  ScopedLock hold(data_mutex);
-  std::vector<ThreadData*>::iterator it, end = dataOfEachThread.end();
-  ThreadId id = ::GetCurrentThreadId();
-
-  // first of all search the thread-data in the list "dataOfEachThread"...
-  for (it=dataOfEachThread.begin();
-       it!=end;
-       ++it) {
-    if ((*it)->threadId == id)	// it's already created...
-      return *it;		// return it
-  }
-
-  // create the data for the this thread
-  ThreadData* data = new ThreadData(id);
-  VACA_TRACE("new data-thread %d\n", id);
-
-  // add it to the list
-  dataOfEachThread.push_back(data);
-
-  // return the allocated data
-  return data;
-}
+#if defined(VACA_ON_WINDOWS)
+  #include "win32/ThreadImpl.h"
+#elif defined(VACA_ON_UNIXLIKE)
+  #include "unix/ThreadImpl.h"
+#else
+  #error Your platform does not support threads
+#endif
 
 // ======================================================================
 
-static DWORD WINAPI ThreadProxy(LPVOID slot)
+static void thread_proxy(void* slot)
 {
+#ifdef VACA_WINDOWS
   // Force the creation of a message queue in this new thread...
   {
     MSG msg;
     PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
   }
+#endif
 
   std::auto_ptr<Slot0<void> > slot_ptr(reinterpret_cast<Slot0<void>*>(slot));
   (*slot_ptr)();
-  return 0;
+
+#ifdef VACA_WINDOWS
+  // release the GDI objects cached by this thread
+  CurrentThread::getGdiObjectCache().clear();
+#endif
 }
 
 Thread::Thread()
 {
-  m_handle = ::GetCurrentThread();
-  m_id = ::GetCurrentThreadId();
+  m_impl = new ThreadImpl();
+  m_id = m_impl->getId();
+  m_queue = NULL;
 
   VACA_TRACE("current Thread (%p, %d)\n", this, m_id);
 }
@@ -148,31 +90,21 @@ Thread::Thread()
 */
 void Thread::_Thread(const Slot0<void>& slot)
 {
-  Slot0<void>* slotclone = slot.clone();
-  DWORD id;
-
-  m_handle = CreateThread(NULL, 0,
-			  ThreadProxy,
-			  // clone the slot
-			  reinterpret_cast<LPVOID>(slotclone),
-			  CREATE_SUSPENDED, &id);
-  if (!m_handle) {
-    delete slotclone;
-    throw CreateThreadException();
-  }
+  // clone the slot (it is deleted by thread_proxy)
+  std::auto_ptr<Slot0<void> > slotclone(slot.clone());
 
-  m_id = id;
+  m_impl = new ThreadImpl(thread_proxy, slotclone.get());
+  m_id = m_impl->getId();
+  m_queue = NULL;
+  slotclone.release();
 
   VACA_TRACE("new Thread (%p, %d)\n", this, m_id);
-  ResumeThread(m_handle);
 }
 
 Thread::~Thread()
 {
-  if (isJoinable() && m_handle != NULL) {
-     CloseHandle(reinterpret_cast<HANDLE>(m_handle));
-     m_handle = NULL;
-  }
+  // if the thread was not joined, it continues running detached
+  delete m_impl;
 
   VACA_TRACE("delete Thread (%p, %d)\n", this, m_id);
 }
@@ -184,6 +116,9 @@ Thread::~Thread()
      This is equal to @msdn{GetCurrentThreadId} for the current
      thread or the ID returned by @msdn{CreateThread}.
    @endwin32
+
+   On POSIX systems IDs are given by Vaca (starting from 1) because
+   @c pthread_t is not an integer.
 */
 ThreadId Thread::getId() const
 {
@@ -195,12 +130,9 @@ ThreadId Thread::getId() const
 */
 void Thread::join()
 {
-  assert(m_handle != NULL);
   assert(isJoinable());
 
-  WaitForSingleObject(reinterpret_cast<HANDLE>(m_handle), INFINITE);
-  CloseHandle(reinterpret_cast<HANDLE>(m_handle));
-  m_handle = NULL;
+  m_impl->join();
 
   VACA_TRACE("join Thread (%p, %d)\n", this, m_id);
 }
@@ -210,7 +142,7 @@ void Thread::join()
 */
 bool Thread::isJoinable() const
 {
-  return m_id != ::GetCurrentThreadId();
+  return m_id != get_current_thread_id();
 }
 
 /**
@@ -238,35 +170,7 @@ bool Thread::isJoinable() const
 */
 void Thread::setThreadPriority(ThreadPriority priority)
 {
-  assert(m_handle != NULL);
-
-  int nPriority;
-  switch (priority) {
-    case ThreadPriority::Idle:         nPriority = THREAD_PRIORITY_IDLE; break;
-    case ThreadPriority::Lowest:       nPriority = THREAD_PRIORITY_LOWEST; break;
-    case ThreadPriority::Low:          nPriority = THREAD_PRIORITY_BELOW_NORMAL; break;
-    case ThreadPriority::Normal:       nPriority = THREAD_PRIORITY_NORMAL; break;
-    case ThreadPriority::High:         nPriority = THREAD_PRIORITY_ABOVE_NORMAL; break;
-    case ThreadPriority::Highest:      nPriority = THREAD_PRIORITY_HIGHEST; break;
-    case ThreadPriority::TimeCritical: nPriority = THREAD_PRIORITY_TIME_CRITICAL; break;
-    default:
-      assert(false);	      // TODO throw invalid argument exception
-      return;
-  }
-
-  ::SetThreadPriority(m_handle, nPriority);
-}
-
-void Thread::enqueueMessage(const Message& message)
-{
-  MSG const* msg = (MSG const*)message;
-
-  // Post the message
-  while (::PostThreadMessage(m_id, msg->message, msg->wParam, msg->lParam) == 0) {
-    // ...If the routine fail is because the thread does not have a message queue yet...
-    // Wait some time and retry...
-    ::Sleep(10);
-  }
+  m_impl->setPriority(priority);
 }
 
 // ======================================================================
@@ -274,245 +178,15 @@ void Thread::enqueueMessage(const Message& message)
 
 ThreadId CurrentThread::getId()
 {
-  return ::GetCurrentThreadId();
-}
-
-void CurrentThread::enqueueMessage(const Message& message)
-{
-  Thread currentThread;
-  currentThread.enqueueMessage(message);
-}
-
-/**
-   Does the message loop while there are
-   visible @link Vaca::Frame frames@endlink.
-
-   @see Frame::setVisible
-*/
-void Vaca::CurrentThread::doMessageLoop()
-{
-  // message loop
-  Message msg;
-  while (getMessage(msg))
-    processMessage(msg);
-}
-
-/**
-   Does the message loop until the @a widget is hidden.
-*/
-void Vaca::CurrentThread::doMessageLoopFor(Widget* widget)
-{
-  // get widget HWND
-  HWND hwnd = widget->getHandle();
-  assert(::IsWindow(hwnd));
-
-  // get parent HWND
-  HWND hparent = widget->getParentHandle();
-
-  // disable the parent HWND
-  if (hparent != NULL)
-    ::EnableWindow(hparent, FALSE);
-
-  // message loop
-  Message message;
-  while (widget->isVisible() && getMessage(message))
-    processMessage(message);
-
-  // enable the parent HWND
-  if (hparent)
-    ::EnableWindow(hparent, TRUE);
-}
-
-void Vaca::CurrentThread::pumpMessageQueue()
-{
-  Message msg;
-  while (peekMessage(msg))
-    processMessage(msg);
-}
-
-void Vaca::CurrentThread::breakMessageLoop()
-{
-  get_thread_data()->breakLoop = true;
-  ::PostThreadMessage(::GetCurrentThreadId(), WM_NULL, 0, 0);
+  return get_current_thread_id();
 }
 
 void Vaca::CurrentThread::yield()
 {
-  ::Sleep(0);
+  yield_current_thread();
 }
 
 void Vaca::CurrentThread::sleep(int msecs)
 {
-  ::Sleep(msecs);
-}
-
-/**
-   Gets a message waiting for it: locks the execution of the program
-   until a message is received from the operating system.
-
-   @return
-     True if the @a message parameter was filled (because a message was received)
-     or false if there aren't more visible @link Frame frames@endlink
-     to dispatch messages.
-*/
-bool Vaca::CurrentThread::getMessage(Message& message)
-{
-  ThreadData* data = get_thread_data();
-
-  // break this loop? (explicit break or no-more visible frames)
-  if (data->breakLoop || data->frames.empty())
-    return false;
-
-  // we have to update indicators?
-  if (data->updateIndicators &&
-      data->updateIndicatorsMark.elapsed() > 0.1) {
-    data->updateIndicators = false;
-
-    // for each registered frame we should call updateIndicators to
-    // update the state of all visible indicators (like top-level
-    // items in the menu-bar and buttons in the tool-bar)
-    for (std::vector<Frame*>::iterator
-	   it = data->frames.begin(),
-	   end = data->frames.end(); it != end; ++it) {
-      (*it)->updateIndicators();
-    }
-  }
-
-  // get the message from the queue
-  LPMSG msg = (LPMSG)message;
-  msg->hwnd = NULL;
-  BOOL bRet = ::GetMessage(msg, NULL, 0, 0);
-
-  // WM_QUIT received?
-  if (bRet == 0)
-    return false;
-
-  // WM_NULL message... maybe Timers or CallInNextRound
-  if (msg->message == WM_NULL)
-    Timer::pollTimers();
-
-  return true;
-}
-
-/**
-   Gets a message without waiting for it, if the queue is empty, this
-   member function returns false.
-
-   The message is removed from the queue.
-
-   @return
-     Returns true if the @a msg parameter was filled with the next message
-     in the queue or false if the queue was empty.
-*/
-bool CurrentThread::peekMessage(Message& message)
-{
-  LPMSG msg = (LPMSG)message;
-  msg->hwnd = NULL;
-  return ::PeekMessage(msg, NULL, 0, 0, PM_REMOVE) != FALSE;
-}
-
-void CurrentThread::processMessage(Message& message)
-{
-  LPMSG msg = (LPMSG)message;
-
-  if (!CurrentThread::details::preTranslateMessage(message)) {
-    // Send preTranslateMessage to the active window (useful for
-    // modeless dialogs). WARNING: Don't use GetForegroundWindow
-    // because it returns windows from other applications
-    HWND hactive = GetActiveWindow();
-    if (hactive != NULL && hactive != msg->hwnd) {
-      Widget* activeWidget = Widget::fromHandle(hactive);
-      if (activeWidget != NULL && activeWidget->preTranslateMessage(message))
-	return;
-    }
-
-    //if (!TranslateAccelerator(msg->hwnd, hAccelTable, msg))
-    //{
-    ::TranslateMessage(msg);
-    ::DispatchMessage(msg);
-    //}
-  }
-}
-
-// ======================================================================
-// Vaca internals
-
-/**
-   Pretranslates the message. The main function is to retrieve the
-   Widget pointer (using Widget::fromHandle()) and then (if it isn't
-   NULL), call its Widget#preTranslateMessage.
-*/
-bool CurrentThread::details::preTranslateMessage(Message& message)
-{
-  LPMSG msg = (LPMSG)message;
-
-  // TODO process messages that produce a update-indicators event
-  if ((msg->message == WM_ACTIVATE) ||
-      (msg->message == WM_CLOSE) ||
-      (msg->message == WM_SETFOCUS) ||
-      (msg->message == WM_KILLFOCUS) ||
-      (msg->message >= WM_LBUTTONDOWN && msg->message <= WM_MBUTTONDBLCLK) ||
-      (msg->message >= WM_KEYDOWN && msg->message <= WM_DEADCHAR)) {
-    ThreadData* data = get_thread_data();
-    data->updateIndicators = true;
-    data->updateIndicatorsMark = TimePoint();
-  }
-
-  if (msg->hwnd != NULL) {
-    Widget* widget = Widget::fromHandle(msg->hwnd);
-    if (widget && widget->preTranslateMessage(message))
-      return true;
-  }
-
-  return false;
-}
-
-/**
-    @internal
- */
-Widget* CurrentThread::details::getOutsideWidget()
-{
-  return get_thread_data()->outsideWidget;
-}
-
-/**
-   @internal
- */
-void CurrentThread::details::setOutsideWidget(Widget* widget)
-{
-  get_thread_data()->outsideWidget = widget;
-}
-
-/**
-   @internal
- */
-void CurrentThread::details::addFrame(Frame* frame)
-{
-  get_thread_data()->frames.push_back(frame);
-}
-
-/**
-   @internal
- */
-void CurrentThread::details::removeFrame(Frame* frame)
-{
-  remove_from_container(get_thread_data()->frames, frame);
-
-  // when this thread doesn't have more Frames to continue we must to
-  // break the current message loop
-  if (get_thread_data()->frames.empty())
-    CurrentThread::breakMessageLoop();
-}
-
-void details::removeAllThreadData()
-{
-  ScopedLock hold(data_mutex);
-  std::vector<ThreadData*>::iterator it, end = dataOfEachThread.end();
-
-  for (it=dataOfEachThread.begin(); it!=end; ++it) {
-    VACA_TRACE("delete data-thread %d\n", (*it)->threadId);
-    delete *it;
-  }
-
-  dataOfEachThread.clear();
+  sleep_current_thread(msecs);
 }
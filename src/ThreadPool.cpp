@@ -0,0 +1,607 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/ThreadPool.h"
+#include "Vaca/Bind.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/Thread.h"
+#include "Vaca/Unicode.h"
+
+#include <cassert>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#ifdef VACA_ON_WINDOWS
+  #include <windows.h>
+#endif
+
+using namespace Vaca;
+using namespace Vaca::details;
+
+// ======================================================================
+// Atomic operations (all of them are full memory barriers)
+
+static inline long atomic_load(volatile long* value)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedCompareExchange(value, 0, 0);
+#else
+  return __sync_fetch_and_add(value, 0);
+#endif
+}
+
+static inline void atomic_store(volatile long* value, long newValue)
+{
+#ifdef VACA_ON_WINDOWS
+  InterlockedExchange(value, newValue);
+#else
+  __sync_lock_test_and_set(value, newValue);
+  __sync_synchronize();
+#endif
+}
+
+static inline long atomic_increment(volatile long* value)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedIncrement(value);
+#else
+  return __sync_add_and_fetch(value, 1);
+#endif
+}
+
+static inline long atomic_decrement(volatile long* value)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedDecrement(value);
+#else
+  return __sync_sub_and_fetch(value, 1);
+#endif
+}
+
+static inline bool atomic_compare_and_swap(volatile long* value, long oldValue, long newValue)
+{
+#ifdef VACA_ON_WINDOWS
+  return InterlockedCompareExchange(value, newValue, oldValue) == oldValue;
+#else
+  return __sync_bool_compare_and_swap(value, oldValue, newValue);
+#endif
+}
+
+// ======================================================================
+// WorkDeque
+
+/**
+   @internal
+
+   Chase-Lev deque of tasks. Only the owner of the deque (a worker)
+   can #push and #pop tasks (at the bottom), the other workers can
+   #steal tasks (from the top).
+
+   The arrays replaced when the deque grows are kept until the deque
+   is destroyed, because a thief could be reading them.
+*/
+class WorkDeque : private NonCopyable
+{
+  struct Array {
+    long mask;
+    TaskState* volatile* items;
+
+    Array(long size) : mask(size-1), items(new TaskState*[size]) { }
+    ~Array() { delete[] items; }
+  };
+
+  volatile long m_top;
+  volatile long m_bottom;
+  Array* volatile m_array;
+  std::vector<Array*> m_oldArrays;
+
+public:
+
+  WorkDeque() : m_top(0), m_bottom(0), m_array(new Array(256)) { }
+
+  ~WorkDeque() {
+    delete m_array;
+    for (size_t i=0; i<m_oldArrays.size(); ++i)
+      delete m_oldArrays[i];
+  }
+
+  void push(TaskState* task) {
+    long bottom = m_bottom;
+    long top = atomic_load(&m_top);
+    Array* array = m_array;
+
+    if (bottom - top > array->mask)
+      array = grow(array, top, bottom);
+
+    array->items[bottom & array->mask] = task;
+    atomic_store(&m_bottom, bottom+1);
+  }
+
+  TaskState* pop() {
+    long bottom = m_bottom - 1;
+    Array* array = m_array;
+    atomic_store(&m_bottom, bottom);
+
+    long top = m_top;
+    if (top > bottom) {		// empty
+      atomic_store(&m_bottom, bottom+1);
+      return NULL;
+    }
+
+    TaskState* task = array->items[bottom & array->mask];
+    if (top == bottom) {
+      // the last task, a thief could be taking it
+      if (!atomic_compare_and_swap(&m_top, top, top+1))
+	task = NULL;
+      atomic_store(&m_bottom, bottom+1);
+    }
+    return task;
+  }
+
+  TaskState* steal() {
+    long top = atomic_load(&m_top);
+    long bottom = atomic_load(&m_bottom);
+    if (top >= bottom)
+      return NULL;
+
+    Array* array = m_array;
+    TaskState* task = array->items[top & array->mask];
+    if (!atomic_compare_and_swap(&m_top, top, top+1))
+      return NULL;		// other thread took it
+
+    return task;
+  }
+
+private:
+
+  Array* grow(Array* array, long top, long bottom) {
+    Array* newArray = new Array(2*(array->mask+1));
+    for (long i=top; i<bottom; ++i)
+      newArray->items[i & newArray->mask] = array->items[i & array->mask];
+
+    m_oldArrays.push_back(array);
+    m_array = newArray;
+    return newArray;
+  }
+
+};
+
+// ======================================================================
+// ThreadPoolImpl
+
+/**
+   @internal
+*/
+class ThreadPool::ThreadPoolImpl : private NonCopyable
+{
+  struct Worker {
+    WorkDeque deque;
+    Thread* thread;
+    ThreadId id;
+    unsigned seed;
+  };
+
+  std::vector<Worker*> m_workers;
+
+  // tasks submitted from threads outside the pool
+  Mutex m_queueMutex;
+  std::deque<TaskState*> m_queue;
+
+  // number of tasks waiting to be taken by a worker
+  volatile long m_pending;
+
+  // number of tasks that were not finished yet
+  volatile long m_unfinished;
+
+  // idle workers sleep in m_wakeUp
+  Mutex m_sleepMutex;
+  ConditionVariable m_wakeUp;
+  volatile long m_idle;
+  bool m_stop;
+
+  Mutex m_doneMutex;
+  ConditionVariable m_allDone;
+
+public:
+
+  ThreadPoolImpl(int threads)
+    : m_pending(0)
+    , m_unfinished(0)
+    , m_idle(0)
+    , m_stop(false)
+  {
+    for (int i=0; i<threads; ++i) {
+      Worker* worker = new Worker;
+      worker->thread = NULL;
+      worker->id = 0;
+      worker->seed = 2463534242u + i;
+      m_workers.push_back(worker);
+    }
+
+    // the workers start when all of them were created (a worker can
+    // steal from all the others)
+    for (int i=0; i<threads; ++i) {
+      Worker* worker = m_workers[i];
+      worker->thread = new Thread(Bind<void>(&ThreadPoolImpl::workerLoop, this, worker));
+      worker->id = worker->thread->getId();
+    }
+  }
+
+  ~ThreadPoolImpl() {
+    {
+      ScopedLock hold(m_sleepMutex);
+      m_stop = true;
+      m_wakeUp.notifyAll();
+    }
+
+    // all threads must finish before a deque is destroyed (they
+    // could be stealing from it)
+    for (size_t i=0; i<m_workers.size(); ++i)
+      m_workers[i]->thread->join();
+
+    for (size_t i=0; i<m_workers.size(); ++i) {
+      delete m_workers[i]->thread;
+      delete m_workers[i];
+    }
+  }
+
+  int getThreadCount() const {
+    return m_workers.size();
+  }
+
+  void enqueue(TaskState* task) {
+    atomic_increment(&m_unfinished);
+
+    Worker* worker = getCurrentWorker();
+    if (worker)
+      worker->deque.push(task);
+    else {
+      ScopedLock hold(m_queueMutex);
+      m_queue.push_back(task);
+    }
+
+    atomic_increment(&m_pending);
+
+    // wake up a worker (only if someone is sleeping)
+    if (atomic_load(&m_idle) > 0) {
+      ScopedLock hold(m_sleepMutex);
+      m_wakeUp.notifyOne();
+    }
+  }
+
+  void waitForAll() {
+    ScopedLock hold(m_doneMutex);
+    while (atomic_load(&m_unfinished) > 0)
+      m_allDone.wait(hold);
+  }
+
+  bool isWorkerThread() const {
+    return getCurrentWorker() != NULL;
+  }
+
+  bool runPendingTask() {
+    TaskState* task = findTask(getCurrentWorker());
+    if (task) {
+      runTask(task);
+      return true;
+    }
+    else
+      return false;
+  }
+
+private:
+
+  Worker* getCurrentWorker() const {
+    ThreadId id = CurrentThread::getId();
+    for (size_t i=0; i<m_workers.size(); ++i)
+      if (m_workers[i]->id == id)
+	return m_workers[i];
+    return NULL;
+  }
+
+  void workerLoop(Worker* worker) {
+    for (;;) {
+      TaskState* task = findTask(worker);
+      if (task) {
+	runTask(task);
+	continue;
+      }
+
+      ScopedLock hold(m_sleepMutex);
+      atomic_increment(&m_idle);
+
+      // m_pending is incremented before m_idle is checked in
+      // #enqueue, so we cannot miss a task here
+      while (atomic_load(&m_pending) == 0 && !m_stop)
+	m_wakeUp.wait(hold);
+
+      atomic_decrement(&m_idle);
+      if (m_stop && atomic_load(&m_pending) == 0)
+	break;
+    }
+  }
+
+  // Takes a task from the deque of the worker, the shared queue, or
+  // steals one from other worker
+  TaskState* findTask(Worker* worker) {
+    TaskState* task = NULL;
+
+    if (worker)
+      task = worker->deque.pop();
+
+    if (!task) {
+      ScopedLock hold(m_queueMutex);
+      if (!m_queue.empty()) {
+	task = m_queue.front();
+	m_queue.pop_front();
+      }
+    }
+
+    if (!task && m_workers.size() > 1) {
+      // starts stealing from a random victim
+      size_t n = m_workers.size();
+      size_t first = 0;
+      if (worker) {
+	worker->seed ^= worker->seed << 13;
+	worker->seed ^= worker->seed >> 17;
+	worker->seed ^= worker->seed << 5;
+	first = worker->seed % n;
+      }
+
+      for (size_t i=0; i<n && !task; ++i) {
+	Worker* victim = m_workers[(first+i) % n];
+	if (victim != worker)
+	  task = victim->deque.steal();
+      }
+    }
+
+    if (task)
+      atomic_decrement(&m_pending);
+
+    return task;
+  }
+
+  void runTask(TaskState* task) {
+    task->run();
+    task->unref();
+
+    if (atomic_decrement(&m_unfinished) == 0) {
+      ScopedLock hold(m_doneMutex);
+      m_allDone.notifyAll();
+    }
+  }
+
+};
+
+// ======================================================================
+// ThreadPool
+
+/**
+   Creates the threads of the pool.
+
+   @param threads
+     Number of threads, zero means one thread for each processor
+     (see #getProcessorCount).
+
+   @throw CreateThreadException
+     If a thread could not be created.
+*/
+ThreadPool::ThreadPool(int threads)
+{
+  assert(threads >= 0);
+  m_impl = new ThreadPoolImpl(threads > 0 ? threads: getProcessorCount());
+}
+
+/**
+   Waits the submitted tasks to finish and destroys the threads.
+*/
+ThreadPool::~ThreadPool()
+{
+  delete m_impl;
+}
+
+int ThreadPool::getThreadCount() const
+{
+  return m_impl->getThreadCount();
+}
+
+/**
+   Waits all the submitted tasks (and the tasks that they submit) to
+   finish. It must not be called from a task.
+*/
+void ThreadPool::waitForAll()
+{
+  assert(!isWorkerThread());
+  m_impl->waitForAll();
+}
+
+/**
+   Returns the number of processors in the system.
+*/
+int ThreadPool::getProcessorCount()
+{
+  return details::getProcessorCount();
+}
+
+/**
+   @internal
+*/
+void ThreadPool::enqueue(TaskState* task)
+{
+  m_impl->enqueue(task);
+}
+
+/**
+   @internal
+*/
+bool ThreadPool::isWorkerThread() const
+{
+  return m_impl->isWorkerThread();
+}
+
+/**
+   Runs a pending task in the current thread, returns false if there
+   was no task to run.
+
+   @internal
+*/
+bool ThreadPool::runPendingTask()
+{
+  return m_impl->runPendingTask();
+}
+
+// ======================================================================
+// TaskState
+
+/**
+   Creates the state of a new task, the creator (the ThreadPool) has
+   the first reference.
+*/
+TaskState::TaskState(ThreadPool* pool)
+  : m_refs(1)
+  , m_pool(pool)
+  , m_ready(false)
+  , m_failed(false)
+  , m_continuation(NULL)
+  , m_continuationThread(0)
+{
+}
+
+TaskState::~TaskState()
+{
+  delete m_continuation;
+}
+
+void TaskState::ref()
+{
+  atomic_increment(&m_refs);
+}
+
+void TaskState::unref()
+{
+  if (atomic_decrement(&m_refs) == 0)
+    delete this;
+}
+
+/**
+   Executes the task (in a thread of the pool), wakes up the threads
+   which are waiting for it, and enqueues the continuation (if there
+   is one).
+*/
+void TaskState::run()
+{
+  try {
+    execute();
+  }
+  catch (Exception& e) {
+    m_failed = true;
+    m_error = e.getMessage();
+  }
+  catch (std::exception& e) {
+    m_failed = true;
+    const char* what = e.what();
+    utf8_to_wide(what, std::strlen(what), m_error);
+  }
+  catch (...) {
+    m_failed = true;
+  }
+
+  Slot0<void>* continuation;
+  {
+    ScopedLock hold(m_mutex);
+    m_ready = true;
+    m_done.notifyAll();
+
+    continuation = m_continuation;
+    m_continuation = NULL;
+  }
+
+  if (continuation)
+    details::enqueueCall(m_continuationThread, continuation);
+}
+
+bool TaskState::isReady() const
+{
+  return m_ready;
+}
+
+/**
+   Waits the task to finish. Threads of the pool run other tasks while
+   they wait (so a task can wait for other task without dead-locks).
+*/
+void TaskState::wait()
+{
+  if (m_ready)
+    return;
+
+  // m_pool is valid because the task is not finished
+  if (m_pool->isWorkerThread()) {
+    while (!m_ready)
+      if (!m_pool->runPendingTask())
+	CurrentThread::yield();
+  }
+  else {
+    ScopedLock hold(m_mutex);
+    while (!m_ready)
+      m_done.wait(hold);
+  }
+}
+
+/**
+   @throw TaskException
+     If the task threw an exception.
+*/
+void TaskState::checkError() const
+{
+  if (m_failed)
+    throw TaskException(m_error);
+}
+
+/**
+   Sets the slot to be called in the current thread when the task
+   finishes. If it was already finished, the slot is enqueued right
+   now.
+*/
+void TaskState::setContinuation(Slot0<void>* continuation)
+{
+  {
+    ScopedLock hold(m_mutex);
+    if (!m_ready) {
+      delete m_continuation;
+      m_continuation = continuation;
+      m_continuationThread = CurrentThread::getId();
+      return;
+    }
+  }
+
+  details::enqueueCall(CurrentThread::getId(), continuation);
+}
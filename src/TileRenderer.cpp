@@ -0,0 +1,311 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/TileRenderer.h"
+#include "Vaca/Bind.h"
+#include "Vaca/Debug.h"
+#include "Vaca/Graphics.h"
+#include "Vaca/Image.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/ThreadPool.h"
+
+#include <vector>
+
+using namespace Vaca;
+
+/**
+   Queue of tiles shared by all the threads that render an image.
+
+   @internal
+*/
+class TileRenderer::TileQueue : private NonCopyable
+{
+public:
+  TileRenderer* renderer;
+  Graphics* target;		// where the tiles are composed
+  Size tileSize;
+  std::vector<Rect> tiles;
+  size_t next;
+  Mutex mutex;			// protects "next" and the "target" DC
+
+  TileQueue(TileRenderer* renderer, Graphics* target, const Size& tileSize)
+    : renderer(renderer)
+    , target(target)
+    , tileSize(tileSize)
+    , next(0)
+  {
+  }
+
+  // Removes the tiles that were not taken yet
+  void cancel()
+  {
+    ScopedLock hold(mutex);
+    next = tiles.size();
+  }
+};
+
+/**
+   Creates a new tile renderer.
+
+   @param tileSize
+     Size of each tile. The default 256x256 tile with 32-bit pixels
+     uses 256 KB, which fits in the L2 cache of most processors.
+
+   @param threads
+     Number of threads to be used (including the thread which calls
+     #render). Zero means one thread for each processor.
+*/
+TileRenderer::TileRenderer(const Size& tileSize, int threads)
+  : m_tileSize(tileSize)
+  , m_threads(threads)
+  , m_pool(NULL)
+{
+  assert(tileSize.w > 0 && tileSize.h > 0);
+  assert(threads >= 0);
+}
+
+/**
+   Destroys the renderer and the threads of its pool.
+*/
+TileRenderer::~TileRenderer()
+{
+  delete m_pool;
+}
+
+Size TileRenderer::getTileSize() const
+{
+  return m_tileSize;
+}
+
+void TileRenderer::setTileSize(const Size& tileSize)
+{
+  assert(tileSize.w > 0 && tileSize.h > 0);
+  m_tileSize = tileSize;
+}
+
+/**
+   Returns the number of threads that #render uses, zero means
+   one thread for each processor.
+
+   @see getProcessorCount
+*/
+int TileRenderer::getThreadCount() const
+{
+  return m_threads;
+}
+
+void TileRenderer::setThreadCount(int threads)
+{
+  assert(threads >= 0);
+
+  if (m_threads != threads) {
+    m_threads = threads;
+
+    // the next render creates a new pool
+    delete m_pool;
+    m_pool = NULL;
+  }
+}
+
+/**
+   Renders the whole @a image.
+
+   @see render(Image&, const Rect&)
+*/
+void TileRenderer::render(Image& image)
+{
+  render(image, Rect(image.getSize()));
+}
+
+/**
+   Renders the specified area of the @a image.
+
+   The area is split in tiles, and the tiles are distributed between
+   the threads. This routine returns when all the tiles were painted
+   and composed in the @a image.
+
+   @param image
+     The image to be painted. A 32-bit image (see Image#Image(int, int, int))
+     avoids color conversions when tiles are composed.
+
+   @param bounds
+     The area of the image to be painted.
+*/
+void TileRenderer::render(Image& image, const Rect& bounds)
+{
+  Rect area = bounds.createIntersect(Rect(image.getSize()));
+  if (area.isEmpty())
+    return;
+
+  TileQueue queue(this, &image.getGraphics(), m_tileSize);
+
+  // split the area in tiles (row by row, so consecutive tiles are
+  // near in memory)
+  for (int y=area.y; y<area.y+area.h; y+=m_tileSize.h)
+    for (int x=area.x; x<area.x+area.w; x+=m_tileSize.w)
+      queue.tiles.push_back(Rect(x, y,
+				 min_value(m_tileSize.w, area.x+area.w-x),
+				 min_value(m_tileSize.h, area.y+area.h-y)));
+
+  int threads = m_threads > 0 ? m_threads: getProcessorCount();
+  threads = min_value<int>(threads, queue.tiles.size());
+
+  // the current thread works too, so the pool runs "threads-1" tasks
+  std::vector<Future<void> > workers;
+  try {
+    if (threads > 1) {
+      ThreadPool* pool = getPool(threads-1);
+      for (int c=1; c<threads; ++c)
+	workers.push_back(pool->submit<void>(Bind<void>(&TileRenderer::render_tiles, &queue)));
+    }
+
+    render_tiles(&queue);
+  }
+  catch (...) {
+    // the tasks use the queue, so they must finish before it is
+    // destroyed
+    queue.cancel();
+    for (size_t c=0; c<workers.size(); ++c)
+      workers[c].wait();
+    throw;
+  }
+
+  for (size_t c=0; c<workers.size(); ++c)
+    workers[c].wait();
+
+  // throws a TaskException if a painter failed in other thread
+  for (size_t c=0; c<workers.size(); ++c)
+    workers[c].get();
+}
+
+/**
+   Returns the number of processors in the system.
+*/
+int TileRenderer::getProcessorCount()
+{
+  return ThreadPool::getProcessorCount();
+}
+
+/**
+   Returns the pool with at least @a workers threads, it is created
+   the first time.
+
+   @internal
+*/
+ThreadPool* TileRenderer::getPool(int workers)
+{
+  if (m_pool != NULL && m_pool->getThreadCount() < workers) {
+    delete m_pool;
+    m_pool = NULL;
+  }
+
+  if (m_pool == NULL)
+    m_pool = new ThreadPool(workers);
+
+  return m_pool;
+}
+
+/**
+   Called for each tile to paint it. By default it fires the #Paint
+   signal.
+
+   @param g
+     Graphics to draw the tile. Its clipping bounds (Graphics#getClipBounds)
+     are the tile bounds in image coordinates.
+
+   @warning
+     This event is generated from several threads at the same time.
+*/
+void TileRenderer::onPaint(Graphics& g)
+{
+  Paint(g);
+}
+
+/**
+   Takes tiles from the queue and paints them until the queue is
+   empty. Each thread that renders the image runs this routine. If
+   the painter throws an exception, the remaining tiles are
+   canceled.
+
+   @internal
+*/
+void TileRenderer::render_tiles(TileQueue* queue)
+{
+  // back buffer of this thread, it is reused for every tile
+  Image buffer(queue->tileSize, 32);
+  Graphics& g = buffer.getGraphics();
+  HDC hdc = g.getHandle();
+  HDC target = queue->target->getHandle();
+
+  while (true) {
+    Rect tile;
+
+    {
+      ScopedLock hold(queue->mutex);
+      if (queue->next == queue->tiles.size())
+	break;
+
+      tile = queue->tiles[queue->next++];
+
+      // start with the current content of the image, so the painter
+      // can draw over it
+      ::BitBlt(hdc, 0, 0, tile.w, tile.h, target, tile.x, tile.y, SRCCOPY);
+    }
+
+    // move the origin so the tile can be painted with image
+    // coordinates, and clip everything outside the tile
+    ::SetViewportOrgEx(hdc, -tile.x, -tile.y, NULL);
+    ::SelectClipRgn(hdc, NULL);
+    ::IntersectClipRect(hdc, tile.x, tile.y, tile.x+tile.w, tile.y+tile.h);
+
+    try {
+      queue->renderer->onPaint(g);
+    }
+    catch (...) {
+      queue->cancel();
+      throw;
+    }
+
+    ::SelectClipRgn(hdc, NULL);
+    ::SetViewportOrgEx(hdc, 0, 0, NULL);
+
+    // GDI batches calls per thread, flush them before the composition
+    ::GdiFlush();
+
+    {
+      ScopedLock hold(queue->mutex);
+      ::BitBlt(target, tile.x, tile.y, tile.w, tile.h, hdc, 0, 0, SRCCOPY);
+    }
+  }
+
+  ::GdiFlush();
+}
@@ -40,7 +40,6 @@ using namespace Vaca;
 */
 TimePoint::TimePoint()
 {
-  QueryPerformanceFrequency(&m_freq);
   reset();
 }
 
@@ -61,7 +60,7 @@ TimePoint::~TimePoint()
 */
 void TimePoint::reset()
 {
-  QueryPerformanceCounter(&m_point);
+  m_point = Clock::now();
 }
 
 /**
@@ -70,12 +69,18 @@ void TimePoint::reset()
    The life-time is the elapsed time from the construction of the
    object (or from the last call to #reset member function).
 
-   @see reset
+   @see reset, elapsedNanoseconds
 */
 double TimePoint::elapsed() const
 {
-  LARGE_INTEGER now;
-  QueryPerformanceCounter(&now);
-  return static_cast<double>(now.QuadPart - m_point.QuadPart)
-    / static_cast<double>(m_freq.QuadPart);
+  return Clock::toSeconds(Clock::now() - m_point);
+}
+
+/**
+   Returns the life-time of this object in nanoseconds (the same as
+   #elapsed without converting it to seconds).
+*/
+Nanoseconds TimePoint::elapsedNanoseconds() const
+{
+  return Clock::now() - m_point;
 }
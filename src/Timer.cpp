@@ -34,17 +34,17 @@
 #include "Vaca/Debug.h"
 #include "Vaca/Mutex.h"
 #include "Vaca/ScopedLock.h"
+#include "Vaca/SharedMutex.h"
+#include "Vaca/ScopedSharedLock.h"
 #include "Vaca/TimePoint.h"
 #include "Vaca/ConditionVariable.h"
 
-#include <limits>
-#include <limits.h>		// because MSVC
-
 using namespace Vaca;
 
 static Mutex               timer_mutex;		// monitor
 static Thread*             timer_thread = NULL; // the thread that process timers
 static std::vector<Timer*> timers;              // list of timers to be processed
+static SharedMutex         timers_mutex;        // "timers" is read by each thread (see fire_timers_for_thread)
 static bool                timer_break = false; // break the loop in timer_thread_proc()
 static ConditionVariable   wakeup_condition;    // wake-up the timer thread loop
 
@@ -54,11 +54,14 @@ static ConditionVariable   wakeup_condition;    // wake-up the timer thread loop
 Timer::Timer(int interval)
   : m_threadOwnerId(::GetCurrentThreadId())
   , m_running(false)
+  , m_highPrecision(false)
   , m_interval(interval)
-  , m_timeCounter(0)
+  , m_deadline(0)
+  , m_firstDue(0)
   , m_tickCounter(0)
 {
   assert(interval > 0);
+  resetStats();
 }
 
 Timer::~Timer()
@@ -99,6 +102,83 @@ bool Timer::isRunning()
   return m_running;
 }
 
+/**
+   Returns true if the timer is in high-precision mode.
+
+   @see setHighPrecision
+*/
+bool Timer::isHighPrecision()
+{
+  return m_highPrecision;
+}
+
+/**
+   Activates the high-precision mode: the timer thread wakes up a
+   little before the tick (see Clock#PreciseMargin) and yields the
+   processor until the exact time. It is useful for animations that
+   need sub-millisecond precision, but it consumes more CPU.
+
+   @see Clock#sleepUntil
+*/
+void Timer::setHighPrecision(bool state)
+{
+  ScopedLock hold(timer_mutex);
+  m_highPrecision = state;
+}
+
+/**
+   Returns what the timer does with ticks that its thread could not
+   process on time.
+
+   @see setPolicy
+*/
+TimerPolicy Timer::getPolicy()
+{
+  return m_policy;
+}
+
+/**
+   Changes what the timer does with ticks that were accumulated while
+   its thread was busy. By default it is TimerPolicy::FireAll.
+
+   With TimerPolicy::Coalesce or TimerPolicy::SkipMissed a long stall
+   of the thread does not produce a storm of Tick events when the
+   thread returns to the message loop.
+
+   @see TimerStats#dropped
+*/
+void Timer::setPolicy(TimerPolicy policy)
+{
+  m_policy = policy;
+}
+
+/**
+   Returns the statistics of the Tick events delivered by this timer.
+
+   They are updated in the thread that created the timer, so you
+   should call this member function from that thread.
+
+   @see resetStats
+*/
+TimerStats Timer::getStats()
+{
+  return m_stats;
+}
+
+/**
+   Sets to zero all the counters of the statistics.
+
+   @see getStats
+*/
+void Timer::resetStats()
+{
+  m_stats.ticks = 0;
+  m_stats.dropped = 0;
+  m_stats.deliveries = 0;
+  m_stats.totalLag = 0;
+  m_stats.maxLag = 0;
+}
+
 /**
    Starts the ticks generation.
 
@@ -114,12 +194,13 @@ void Timer::start()
 
     if (!m_running) {
       // add timer
+      ScopedExclusiveLock hold2(timers_mutex);
       timers.push_back(this);
       m_running = true;
     }
 
-    m_firstTick = true;
-    m_timeCounter = m_interval;
+    // the deadlines of all ticks are relative to this point
+    m_deadline = Clock::now() + m_interval * 1000000LL;
     m_tickCounter = 0;
 
     // wake up timer thread
@@ -136,7 +217,7 @@ void Timer::stop()
     Timer::remove_timer(this);
 
     m_running = false;
-    m_timeCounter = 0;
+    m_deadline = 0;
     m_tickCounter = 0;
   }
 }
@@ -175,51 +256,45 @@ void Timer::onTick()
 void Timer::run_timer_thread()
 {
   ScopedLock hold(timer_mutex);
-  unsigned int start, end, period, delay;
-  unsigned int inf = UINT_MAX; // std::numeric_limits<unsigned int>::max();
+  Nanoseconds now, next;
+  bool precise;
   std::vector<Timer*>::iterator it;
   Timer* timer;
 
   // is it needed?
   // ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
 
-  start = timeGetTime();
-
   while (!timer_break) {
     // yield
     ::Sleep(0);
 
-    end = timeGetTime();
-    period = end-start;    // how much time pass from the last event
-    start = end;
+    now = Clock::now();
 
-    // "delay" will contain the minimum account of time to reach
-    // the next Timer's event
-    delay = inf;
+    // "next" will contain the nearest deadline of all timers (-1 if
+    // there is no timers)
+    next = -1;
+    precise = false;
 
     // threads to send a NULL message to wake up
     std::vector<int> threads;
 
-    // timers loop
+    // timers loop (the list is modified only with timer_mutex locked,
+    // so we do not need timers_mutex here)
     for (it = timers.begin(); it != timers.end(); ++it) {
       timer = *it;
 
-      // decrement "mTimeCounter" to known that we pass a "period"
-      // amount of time
-      if (!timer->m_firstTick)
-	timer->m_timeCounter -= period;
-      else
-	timer->m_firstTick = false;
-
-      // if we accomplish one (or more) interval(s) of this timer...
-      if (timer->m_timeCounter <= 0) {
-	// ...we must to generate ticks for each time that we
-	// accomplish the time interval
-	while (timer->m_timeCounter <= 0) {
-	  // generate one tick for each "m_interval" period of time
-	  timer->m_tickCounter++;
-	  timer->m_timeCounter += timer->m_interval;
-	}
+      // if we reach one (or more) deadline(s) of this timer...
+      if (timer->m_deadline <= now) {
+	Nanoseconds interval = timer->m_interval * 1000000LL;
+	int ticks = static_cast<int>((now - timer->m_deadline) / interval) + 1;
+
+	// ...we must to generate a tick for each one, the next
+	// deadline is in the same "grid" of the first one (it is not
+	// relative to "now", so the timer does not drift)
+	if (timer->m_tickCounter == 0)
+	  timer->m_firstDue = timer->m_deadline;
+	timer->m_tickCounter += ticks;
+	timer->m_deadline += ticks * interval;
 
 	// thread owner ID
 	int id = timer->m_threadOwnerId;
@@ -233,17 +308,29 @@ void Timer::run_timer_thread()
 	}
       }
 
-      // maybe the "delay" is too big to reach the next event
-      if (delay == inf ||
-	  delay > static_cast<unsigned int>(timer->m_timeCounter))
-	delay = static_cast<unsigned int>(timer->m_timeCounter);
+      // is it the nearest deadline?
+      if (next < 0 || next > timer->m_deadline) {
+	next = timer->m_deadline;
+	precise = timer->m_highPrecision;
+      }
+      else if (next == timer->m_deadline && timer->m_highPrecision)
+	precise = true;
     }
 
-    // wait wake-up condition or the "delay" to process the next timer-event
-    if (delay == inf)
+    // wait wake-up condition or the "next" timer-event
+    if (next < 0)
       wakeup_condition.wait(hold);
-    else
-      wakeup_condition.waitFor(hold, delay / 1000.0);
+    else if (!precise)
+      wakeup_condition.waitUntil(hold, next);
+    else if (next - now > Clock::PreciseMargin)
+      wakeup_condition.waitUntil(hold, next - Clock::PreciseMargin);
+    else {
+      // the last microseconds of a high-precision timer (other
+      // threads can start/stop timers meanwhile)
+      timer_mutex.unlock();
+      Clock::sleepUntil(next, true);
+      timer_mutex.lock();
+    }
   }
 }
 
@@ -254,8 +341,10 @@ void Timer::start_timer_thread()
 {
   ScopedLock hold(timer_mutex);
 
-  if (timer_thread == NULL)
+  if (timer_thread == NULL) {
+    timer_break = false;	// it could be stopped by a previous Application
     timer_thread = new Thread(&run_timer_thread);
+  }
 }
 
 /**
@@ -292,6 +381,7 @@ void Timer::stop_timer_thread()
 void Timer::remove_timer(Timer* t)
 {
   ScopedLock hold(timer_mutex);
+  ScopedExclusiveLock hold2(timers_mutex);
 
   remove_from_container(timers, t);
 }
@@ -306,9 +396,10 @@ void Timer::fire_timers_for_thread()
   std::vector<Timer*>::iterator it;
   Timer* timer;
 
-  // make a copy of timers for this thread only
+  // make a copy of timers for this thread only (several threads can
+  // do it at the same time, and while the timer thread is running)
   {
-    ScopedLock hold(timer_mutex);
+    ScopedSharedLock hold(timers_mutex);
 
     for (it = timers.begin(); it != timers.end(); ) {
       timer = *(it++);
@@ -324,22 +415,84 @@ void Timer::fire_timers_for_thread()
        it != timers_for_thread.end(); ) {
     timer = *(it++);
 
-    TimePoint warning_time;
-    double timeout = timer->m_interval / 1000.0;
+    // without ticks we do not need to lock the mutex
+    if (timer->m_tickCounter == 0)
+      continue;
+
+    // take the accumulated ticks (the timer thread can be adding
+    // more ticks at the same time)
+    int ticks;
+    Nanoseconds firstDue;
+    {
+      ScopedLock hold(timer_mutex);
+      ticks = timer->m_tickCounter;
+      firstDue = timer->m_firstDue;
+      timer->m_tickCounter = 0;
+    }
+
+    if (ticks > 0)
+      timer->fire_ticks(ticks, firstDue);
+  }
+
+  CurrentThread::yield();
+}
+
+/**
+   Generates the Tick events for the accumulated @a ticks (the first
+   one was due at @a firstDue) following the timer's policy.
+
+   @internal
+*/
+void Timer::fire_ticks(int ticks, Nanoseconds firstDue)
+{
+  Nanoseconds interval = m_interval * 1000000LL;
+  Nanoseconds now = Clock::now();
+  Nanoseconds lag = now - firstDue;
+
+  m_stats.deliveries++;
+  m_stats.totalLag += lag;
+  if (m_stats.maxLag < lag)
+    m_stats.maxLag = lag;
 
-    // for each accumulated tick
-    while (timer->m_tickCounter > 0) {
-      timer->m_tickCounter--;
+  switch (m_policy) {
 
-      // fire event
-      timer->onTick();
+    case TimerPolicy::FireAll: {
+      TimePoint warning_time;
+      double timeout = m_interval / 1000.0;
 
-      // warning! if this is taking to long, we have to force a break
-      // of the loop discarding the rest of ticks (m_tickCounter)
-      if (warning_time.elapsed() > timeout)
-	timer->m_tickCounter = 0;
+      // for each accumulated tick
+      while (ticks > 0 && m_running) {
+	ticks--;
+
+	// fire event
+	m_stats.ticks++;
+	onTick();
+
+	// warning! if this is taking to long, we have to force a break
+	// of the loop discarding the rest of ticks
+	if (warning_time.elapsed() > timeout)
+	  break;
+      }
+      m_stats.dropped += ticks;
+      break;
     }
-  }
 
-  CurrentThread::yield();
+    case TimerPolicy::Coalesce:
+      m_stats.ticks++;
+      m_stats.dropped += ticks-1;
+      onTick();
+      break;
+
+    case TimerPolicy::SkipMissed:
+      // a tick is on time if it is less than one interval late (so
+      // if there are two or more ticks, all of them were missed)
+      if (lag < interval) {
+	m_stats.ticks++;
+	m_stats.dropped += ticks-1;
+	onTick();
+      }
+      else
+	m_stats.dropped += ticks;
+      break;
+  }
 }
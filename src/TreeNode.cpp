@@ -186,7 +186,7 @@ bool TreeNode::hasChildren()
 */
 String TreeNode::getText()
 {
-  return m_text;
+  return m_text.str();
 }
 
 /**
@@ -0,0 +1,376 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/Unicode.h"
+
+// SSE2 is available in all x64 processors, and in x86 when the
+// compiler is configured to generate SSE2 code
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define VACA_UNICODE_SSE2
+  #include <emmintrin.h>
+#endif
+
+using namespace Vaca;
+
+// Code point returned by decode_utf8 for invalid sequences
+static const unsigned int invalid_char = 0xffffffff;
+
+static const unsigned int replacement_char = 0xfffd;
+
+// Maximum number of UTF-8 bytes for each wide character (a UTF-16
+// surrogate pair is two characters which need four bytes)
+static const size_t max_utf8_per_wide = sizeof(Char) == 2 ? 3: 4;
+
+static inline unsigned int code_unit(Char chr)
+{
+  return sizeof(Char) == 2 ? static_cast<unsigned short>(chr):
+			     static_cast<unsigned int>(chr);
+}
+
+/**
+   Copies the ASCII characters at the beginning of @a src to @a dst.
+
+   @return
+     The number of copied characters. It is less than @a len if a
+     non-ASCII byte was found.
+*/
+static size_t ascii_to_wide(const unsigned char* src, size_t len, Char* dst)
+{
+  size_t i = 0;
+
+#ifdef VACA_UNICODE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+
+  for (; i+16 <= len; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+
+    // some byte with the high bit
+    if (_mm_movemask_epi8(bytes) != 0)
+      break;
+
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+    __m128i* out = reinterpret_cast<__m128i*>(dst+i);
+
+    if (sizeof(Char) == 2) {
+      _mm_storeu_si128(out,   lo);
+      _mm_storeu_si128(out+1, hi);
+    }
+    else {
+      _mm_storeu_si128(out,   _mm_unpacklo_epi16(lo, zero));
+      _mm_storeu_si128(out+1, _mm_unpackhi_epi16(lo, zero));
+      _mm_storeu_si128(out+2, _mm_unpacklo_epi16(hi, zero));
+      _mm_storeu_si128(out+3, _mm_unpackhi_epi16(hi, zero));
+    }
+  }
+#endif
+
+  for (; i<len && src[i] < 0x80; ++i)
+    dst[i] = src[i];
+
+  return i;
+}
+
+/**
+   Copies the ASCII characters at the beginning of @a src to @a dst.
+
+   @return
+     The number of copied characters.
+*/
+static size_t ascii_to_utf8(const Char* src, size_t len, char* dst)
+{
+  size_t i = 0;
+
+#ifdef VACA_UNICODE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+
+  if (sizeof(Char) == 2) {
+    const __m128i mask = _mm_set1_epi16(static_cast<short>(0xff80));
+
+    for (; i+16 <= len; i += 16) {
+      const __m128i* in = reinterpret_cast<const __m128i*>(src+i);
+      __m128i a = _mm_loadu_si128(in);
+      __m128i b = _mm_loadu_si128(in+1);
+      __m128i bits = _mm_and_si128(_mm_or_si128(a, b), mask);
+
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(bits, zero)) != 0xffff)
+	break;
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),
+		       _mm_packus_epi16(a, b));
+    }
+  }
+  else {
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(0xffffff80));
+
+    for (; i+16 <= len; i += 16) {
+      const __m128i* in = reinterpret_cast<const __m128i*>(src+i);
+      __m128i a = _mm_loadu_si128(in);
+      __m128i b = _mm_loadu_si128(in+1);
+      __m128i c = _mm_loadu_si128(in+2);
+      __m128i d = _mm_loadu_si128(in+3);
+      __m128i bits = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b),
+						_mm_or_si128(c, d)), mask);
+
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(bits, zero)) != 0xffff)
+	break;
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),
+		       _mm_packus_epi16(_mm_packs_epi32(a, b),
+					_mm_packs_epi32(c, d)));
+    }
+  }
+#endif
+
+  for (; i<len && code_unit(src[i]) < 0x80; ++i)
+    dst[i] = static_cast<char>(src[i]);
+
+  return i;
+}
+
+/**
+   Decodes the UTF-8 sequence which starts in @a src.
+
+   @return
+     The code point, or @c invalid_char if the sequence is not
+     valid. In that case @a src is moved after the maximal invalid
+     subpart of the sequence (at least one byte).
+*/
+static unsigned int decode_utf8(const unsigned char*& src, const unsigned char* end)
+{
+  unsigned int chr = *src++;
+  unsigned int lo = 0x80, hi = 0xbf;	// range of the second byte
+  unsigned int codepoint;
+  int trail;
+
+  if (chr < 0x80)
+    return chr;
+  else if (chr >= 0xc2 && chr <= 0xdf) {
+    codepoint = chr & 0x1f;
+    trail = 1;
+  }
+  else if (chr >= 0xe0 && chr <= 0xef) {
+    codepoint = chr & 0x0f;
+    trail = 2;
+    if (chr == 0xe0) lo = 0xa0;		// overlong
+    else if (chr == 0xed) hi = 0x9f;	// surrogates
+  }
+  else if (chr >= 0xf0 && chr <= 0xf4) {
+    codepoint = chr & 0x07;
+    trail = 3;
+    if (chr == 0xf0) lo = 0x90;		// overlong
+    else if (chr == 0xf4) hi = 0x8f;	// beyond U+10FFFF
+  }
+  else
+    return invalid_char;
+
+  for (; trail > 0; --trail) {
+    if (src == end || *src < lo || *src > hi)
+      return invalid_char;
+
+    codepoint = (codepoint << 6) | (*src++ & 0x3f);
+    lo = 0x80;
+    hi = 0xbf;
+  }
+
+  return codepoint;
+}
+
+/**
+   Decodes the wide character (or UTF-16 surrogate pair) in the @a i
+   position of @a src.
+
+   @return
+     The code point, or @c invalid_char for unpaired surrogates and
+     values beyond U+10FFFF.
+*/
+static unsigned int decode_wide(const Char* src, size_t& i, size_t len)
+{
+  unsigned int chr = code_unit(src[i++]);
+
+  if (chr >= 0xd800 && chr <= 0xdfff) {
+    if (sizeof(Char) == 2 && chr <= 0xdbff && i < len) {
+      unsigned int low = code_unit(src[i]);
+      if (low >= 0xdc00 && low <= 0xdfff) {
+	++i;
+	return 0x10000 + ((chr - 0xd800) << 10) + (low - 0xdc00);
+      }
+    }
+    return invalid_char;
+  }
+  else if (chr > 0x10ffff)
+    return invalid_char;
+
+  return chr;
+}
+
+static inline void encode_wide(unsigned int codepoint, Char*& dst)
+{
+  if (sizeof(Char) == 2 && codepoint >= 0x10000) {
+    codepoint -= 0x10000;
+    *dst++ = static_cast<Char>(0xd800 + (codepoint >> 10));
+    *dst++ = static_cast<Char>(0xdc00 + (codepoint & 0x3ff));
+  }
+  else
+    *dst++ = static_cast<Char>(codepoint);
+}
+
+static inline void encode_utf8(unsigned int codepoint, char*& dst)
+{
+  if (codepoint < 0x80)
+    *dst++ = static_cast<char>(codepoint);
+  else if (codepoint < 0x800) {
+    *dst++ = static_cast<char>(0xc0 | (codepoint >> 6));
+    *dst++ = static_cast<char>(0x80 | (codepoint & 0x3f));
+  }
+  else if (codepoint < 0x10000) {
+    *dst++ = static_cast<char>(0xe0 | (codepoint >> 12));
+    *dst++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+    *dst++ = static_cast<char>(0x80 | (codepoint & 0x3f));
+  }
+  else {
+    *dst++ = static_cast<char>(0xf0 | (codepoint >> 18));
+    *dst++ = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3f));
+    *dst++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+    *dst++ = static_cast<char>(0x80 | (codepoint & 0x3f));
+  }
+}
+
+/**
+   Returns true if the @a len bytes of @a src are well-formed UTF-8
+   (without overlong forms, surrogates or code points beyond
+   U+10FFFF).
+*/
+bool Vaca::is_valid_utf8(const char* src, size_t len)
+{
+  const unsigned char* it = reinterpret_cast<const unsigned char*>(src);
+  const unsigned char* end = it + len;
+
+  while (it != end) {
+#ifdef VACA_UNICODE_SSE2
+    // skip blocks of ASCII characters
+    while (end - it >= 16 &&
+	   _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it))) == 0)
+      it += 16;
+    if (it == end)
+      break;
+#endif
+
+    if (*it < 0x80)
+      ++it;
+    else if (decode_utf8(it, end) == invalid_char)
+      return false;
+  }
+  return true;
+}
+
+/**
+   Converts the @a len bytes of UTF-8 text in @a src to a wide string.
+
+   The characters are written directly in @a dst (its previous
+   content is replaced), runs of ASCII characters are expanded
+   sixteen at a time.
+*/
+void Vaca::utf8_to_wide(const char* src, size_t len, String& dst)
+{
+  // each byte produces one wide character at most (four bytes can
+  // produce a UTF-16 surrogate pair)
+  dst.resize(len);
+  if (len == 0)
+    return;
+
+  const unsigned char* it = reinterpret_cast<const unsigned char*>(src);
+  const unsigned char* end = it + len;
+  Char* begin = &dst[0];
+  Char* out = begin;
+
+  while (it != end) {
+    size_t ascii = ascii_to_wide(it, end - it, out);
+    it += ascii;
+    out += ascii;
+
+    while (it != end && *it >= 0x80) {
+      unsigned int codepoint = decode_utf8(it, end);
+      if (codepoint == invalid_char)
+	codepoint = replacement_char;
+
+      encode_wide(codepoint, out);
+    }
+  }
+
+  dst.resize(out - begin);
+}
+
+/**
+   Converts the @a len wide characters of @a src to UTF-8.
+
+   The bytes are written directly in @a dst (its previous content is
+   replaced). ASCII text is converted sixteen characters at a time,
+   and the string grows only when non-ASCII characters are found.
+*/
+void Vaca::wide_to_utf8(const Char* src, size_t len, std::string& dst)
+{
+  dst.resize(len);
+  if (len == 0)
+    return;
+
+  char* out = &dst[0];
+  size_t i = 0;
+  bool grown = false;
+
+  while (i < len) {
+    size_t ascii = ascii_to_utf8(src+i, len-i, out);
+    i += ascii;
+    out += ascii;
+
+    if (i == len)
+      break;
+
+    // make space for the worst case of the remaining characters
+    if (!grown) {
+      size_t pos = out - &dst[0];
+      dst.resize(pos + (len-i)*max_utf8_per_wide);
+      out = &dst[0] + pos;
+      grown = true;
+    }
+
+    while (i < len && code_unit(src[i]) >= 0x80) {
+      unsigned int codepoint = decode_wide(src, i, len);
+      if (codepoint == invalid_char)
+	codepoint = replacement_char;
+
+      encode_utf8(codepoint, out);
+    }
+  }
+
+  dst.resize(out - &dst[0]);
+}
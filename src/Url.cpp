@@ -0,0 +1,401 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Vaca/Url.h"
+#include "Vaca/String.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cwchar>
+
+using namespace Vaca;
+
+namespace {
+
+enum {
+  SchemeChar   = 1,		// letters, digits, '+', '-' and '.'
+  AuthorityEnd = 2,		// '/', '?' and '#'
+  PathEnd      = 4,		// '?' and '#'
+  EncodeChar   = 8		// characters that cannot be in an URL
+};
+
+// Classes of the ASCII characters
+const unsigned char url_chars[128] = {
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+  8, 0, 8, 6, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 2,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 8, 0, 8, 6,
+  0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 8, 0, 8, 0,
+  8, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 8, 8, 8, 0, 8,
+};
+
+// the UTF-8 of a character encoded with "%XX" takes 12 characters at most
+enum { MaxEncodedChar = 12 };
+
+inline bool is_class(Char chr, int flags)
+{
+  return static_cast<unsigned int>(chr) < 128 && (url_chars[chr] & flags) != 0;
+}
+
+inline bool is_alpha(Char chr)
+{
+  return (chr >= L'a' && chr <= L'z') || (chr >= L'A' && chr <= L'Z');
+}
+
+inline int hex_value(Char chr)
+{
+  if (chr >= L'0' && chr <= L'9') return chr - L'0';
+  if (chr >= L'a' && chr <= L'f') return chr - L'a' + 10;
+  if (chr >= L'A' && chr <= L'F') return chr - L'A' + 10;
+  return -1;
+}
+
+/**
+   Returns the byte of a "%XX" sequence in @a str, or -1 if there is
+   not a valid one.
+
+   @internal
+*/
+inline int percent_byte(const Char* str, size_t size)
+{
+  if (size < 3 || str[0] != L'%')
+    return -1;
+
+  int hi = hex_value(str[1]);
+  int lo = hex_value(str[2]);
+  return (hi < 0 || lo < 0) ? -1: (hi << 4) | lo;
+}
+
+inline Char* write_percent(Char* dst, unsigned int byte)
+{
+  static const Char digits[] = L"0123456789ABCDEF";
+  dst[0] = L'%';
+  dst[1] = digits[byte >> 4];
+  dst[2] = digits[byte & 15];
+  return dst+3;
+}
+
+} // anonymous namespace
+
+// ======================================================================
+// UrlView
+
+/**
+   Parses the @a url. The previous components are replaced.
+*/
+void UrlView::parse(const StringView& url)
+{
+  const Char* str = url.data();
+  size_t n = url.size();
+  size_t i = 0;
+
+  m_scheme = m_userInfo = m_host = m_port = m_query = m_fragment = StringView();
+
+  // scheme ":"
+  if (n > 0 && is_alpha(str[0])) {
+    i = 1;
+    while (i < n && is_class(str[i], SchemeChar))
+      ++i;
+
+    if (i < n && str[i] == L':')
+      m_scheme = url.substr(0, i++);
+    else
+      i = 0;
+  }
+
+  // "//" [userinfo "@"] host [":" port]
+  if (i+1 < n && str[i] == L'/' && str[i+1] == L'/') {
+    size_t start = (i += 2);
+    size_t at = StringView::npos;
+    size_t colon = StringView::npos;
+    bool ipv6 = false;
+
+    for (; i < n && !is_class(str[i], AuthorityEnd); ++i) {
+      switch (str[i]) {
+	case L'@': at = i; colon = StringView::npos; break;
+	case L'[': ipv6 = true; break;
+	case L']': ipv6 = false; break;
+	case L':': if (!ipv6) colon = i; break;
+      }
+    }
+
+    if (at != StringView::npos) {
+      m_userInfo = url.substr(start, at - start);
+      start = at+1;
+    }
+
+    if (colon != StringView::npos) {
+      m_host = url.substr(start, colon - start);
+      m_port = url.substr(colon+1, i - colon - 1);
+    }
+    else
+      m_host = url.substr(start, i - start);
+  }
+
+  // path
+  size_t start = i;
+  while (i < n && !is_class(str[i], PathEnd))
+    ++i;
+  m_path = url.substr(start, i - start);
+
+  // "?" query
+  if (i < n && str[i] == L'?') {
+    start = ++i;
+    while (i < n && str[i] != L'#')
+      ++i;
+    m_query = url.substr(start, i - start);
+  }
+
+  // "#" fragment
+  if (i < n)
+    m_fragment = url.substr(i+1);
+}
+
+/**
+   Returns the port as a number, or -1 if the URL does not have a
+   valid port.
+*/
+int UrlView::getPortNumber() const
+{
+  int port = -1;
+  const Char* end = m_port.end();
+
+  if (m_port.empty() ||
+      parse_number(m_port.begin(), end, port) != end ||
+      port < 0 || port > 65535)
+    return -1;
+
+  return port;
+}
+
+/**
+   Returns the path and the query (the object of a HTTP request).
+*/
+StringView UrlView::getObject() const
+{
+  if (m_query.empty())
+    return m_path;
+  else
+    return StringView(m_path.data(), m_query.end() - m_path.data());
+}
+
+// ======================================================================
+// Encoding
+
+/**
+   Encodes the characters of @a src that are not valid in an URL
+   (spaces, control characters, non-ASCII characters and some
+   symbols) as "%XX" sequences of their UTF-8 bytes. Other characters
+   (including '%', '/', '?', '&', etc.) are copied as they are.
+
+   It can be called several times to encode a big string by parts:
+   @code
+   Char buf[256];
+   size_t pos = 0, len;
+   while ((len = encode_url_to(url, pos, buf, 256)) > 0)
+     output.append(buf, len);
+   @endcode
+
+   @param pos
+     Index of the first character to encode. It is moved after the
+     last encoded character.
+
+   @param size
+     Size of @a dst. It must be at least 12 characters.
+
+   @return The number of characters written in @a dst (zero if all
+	   the characters were encoded).
+
+   @see decode_url_to, encode_url
+*/
+size_t Vaca::encode_url_to(const StringView& src, size_t& pos, Char* dst, size_t size)
+{
+  assert(size >= MaxEncodedChar);
+
+  const Char* p = src.data() + pos;
+  const Char* end = src.end();
+  Char* out = dst;
+  Char* outEnd = dst + size;
+
+  while (p < end) {
+    unsigned int chr = static_cast<unsigned int>(*p);
+
+    if (chr < 128) {
+      if (!(url_chars[chr] & EncodeChar)) {
+	if (out == outEnd)
+	  break;
+	*out++ = *p++;
+      }
+      else {
+	if (outEnd - out < 3)
+	  break;
+	out = write_percent(out, chr);
+	++p;
+      }
+      continue;
+    }
+
+    if (outEnd - out < MaxEncodedChar)
+      break;
+
+    unsigned int codepoint = chr;
+    int units = 1;
+
+    // surrogate pairs (in 16-bit wchar_t)
+    if (chr >= 0xD800 && chr <= 0xDFFF) {
+      if (chr <= 0xDBFF && p+1 < end &&
+	  static_cast<unsigned int>(p[1]) >= 0xDC00 &&
+	  static_cast<unsigned int>(p[1]) <= 0xDFFF) {
+	codepoint = 0x10000 + ((chr - 0xD800) << 10) + (static_cast<unsigned int>(p[1]) - 0xDC00);
+	units = 2;
+      }
+      else
+	codepoint = 0xFFFD;
+    }
+    else if (chr > 0x10FFFF)
+      codepoint = 0xFFFD;
+
+    if (codepoint < 0x800) {
+      out = write_percent(out, 0xC0 | (codepoint >> 6));
+    }
+    else if (codepoint < 0x10000) {
+      out = write_percent(out, 0xE0 | (codepoint >> 12));
+      out = write_percent(out, 0x80 | ((codepoint >> 6) & 0x3F));
+    }
+    else {
+      out = write_percent(out, 0xF0 | (codepoint >> 18));
+      out = write_percent(out, 0x80 | ((codepoint >> 12) & 0x3F));
+      out = write_percent(out, 0x80 | ((codepoint >> 6) & 0x3F));
+    }
+    out = write_percent(out, 0x80 | (codepoint & 0x3F));
+    p += units;
+  }
+
+  pos = p - src.data();
+  return out - dst;
+}
+
+/**
+   Decodes the "%XX" sequences of @a src. Sequences of UTF-8 bytes
+   are decoded as one character, and other bytes are decoded as
+   Latin-1 characters. Invalid sequences (like "%G1" or a '%' at the
+   end) are copied as they are.
+
+   @param pos
+     Index of the first character to decode. It is moved after the
+     last decoded character.
+
+   @param size
+     Size of @a dst. It must be at least 2 characters.
+
+   @return The number of characters written in @a dst (zero if all
+	   the characters were decoded).
+
+   @see encode_url_to, decode_url
+*/
+size_t Vaca::decode_url_to(const StringView& src, size_t& pos, Char* dst, size_t size)
+{
+  assert(size >= 2);
+
+  const Char* p = src.data() + pos;
+  const Char* end = src.end();
+  Char* out = dst;
+  Char* outEnd = dst + size;
+
+  while (p < end && out < outEnd) {
+    // copy everything until the next '%'
+    const Char* percent = std::wmemchr(p, L'%', end - p);
+    if (percent != p) {
+      size_t n = std::min<size_t>((percent ? percent: end) - p, outEnd - out);
+      std::wmemcpy(out, p, n);
+      out += n;
+      p += n;
+      continue;
+    }
+
+    int byte = percent_byte(p, end - p);
+    if (byte < 0) {
+      *out++ = *p++;
+      continue;
+    }
+
+    // UTF-8 sequence: lead byte, number of continuation bytes, and
+    // the valid range of the first continuation byte
+    unsigned int codepoint = byte;
+    int count = 0;
+    int lo = 0x80, hi = 0xBF;
+
+    if (byte >= 0xC2 && byte <= 0xDF) { codepoint = byte & 0x1F; count = 1; }
+    else if (byte >= 0xE0 && byte <= 0xEF) {
+      codepoint = byte & 0x0F; count = 2;
+      if (byte == 0xE0) lo = 0xA0;
+      else if (byte == 0xED) hi = 0x9F;
+    }
+    else if (byte >= 0xF0 && byte <= 0xF4) {
+      codepoint = byte & 0x07; count = 3;
+      if (byte == 0xF0) lo = 0x90;
+      else if (byte == 0xF4) hi = 0x8F;
+    }
+
+    const Char* q = p+3;
+    int i;
+    for (i=0; i<count; ++i, q+=3) {
+      int next = percent_byte(q, end - q);
+      if (next < lo || next > hi)
+	break;
+      codepoint = (codepoint << 6) | (next & 0x3F);
+      lo = 0x80;
+      hi = 0xBF;
+    }
+
+    if (i < count) {
+      // invalid UTF-8: just one Latin-1 character
+      codepoint = byte;
+      q = p+3;
+    }
+
+    if (sizeof(Char) == 2 && codepoint >= 0x10000) {
+      if (outEnd - out < 2)
+	break;
+      *out++ = static_cast<Char>(0xD800 + ((codepoint - 0x10000) >> 10));
+      *out++ = static_cast<Char>(0xDC00 + ((codepoint - 0x10000) & 0x3FF));
+    }
+    else
+      *out++ = static_cast<Char>(codepoint);
+
+    p = q;
+  }
+
+  pos = p - src.data();
+  return out - dst;
+}
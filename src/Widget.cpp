@@ -38,6 +38,7 @@
 #include "Vaca/Dialog.h"
 #include "Vaca/DropFilesEvent.h"
 #include "Vaca/Font.h"
+#include "Vaca/Format.h"
 #include "Vaca/Frame.h"
 #include "Vaca/Image.h"
 #include "Vaca/KeyEvent.h"
@@ -2409,8 +2410,8 @@ void Widget::create(const WidgetClassName& className, Widget* parent, Style styl
   }
 
   if (m_handle == NULL || !::IsWindow(m_handle))
-    throw CreateWidgetException(format_string(L"Error creating widget of class \"%s\"",
-					      className.c_str()));
+    throw CreateWidgetException(format_text(L"Error creating widget of class \"{}\"",
+					    className.c_str()));
 
   subClass();
 
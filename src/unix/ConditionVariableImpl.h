@@ -0,0 +1,106 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+// A pthread condition variable. Timed waits use CLOCK_MONOTONIC (where
+// it is available) so changes of the wall-clock do not affect them.
+class Vaca::ConditionVariable::ConditionVariableImpl
+{
+  pthread_cond_t m_handle;
+
+public:
+
+  ConditionVariableImpl()
+  {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+
+    int res = pthread_cond_init(&m_handle, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (res != 0)
+      throw CreateConditionVariableException();
+  }
+
+  ~ConditionVariableImpl()
+  {
+    pthread_cond_destroy(&m_handle);
+  }
+
+  void notifyOne()
+  {
+    pthread_cond_signal(&m_handle);
+  }
+
+  void notifyAll()
+  {
+    pthread_cond_broadcast(&m_handle);
+  }
+
+  void wait(ScopedLock& lock)
+  {
+    pthread_cond_wait(&m_handle, lock.getMutex().m_impl->getHandle());
+  }
+
+  bool waitUntil(ScopedLock& lock, Nanoseconds deadline)
+  {
+    struct timespec timeout;
+    int res;
+
+#if defined(__APPLE__)
+    // Mac OS X does not have pthread_condattr_setclock
+    Nanoseconds left = deadline - Clock::now();
+    if (left < 0)
+      left = 0;
+    timeout.tv_sec = static_cast<time_t>(left / 1000000000LL);
+    timeout.tv_nsec = static_cast<long>(left % 1000000000LL);
+    res = pthread_cond_timedwait_relative_np(&m_handle,
+					     lock.getMutex().m_impl->getHandle(),
+					     &timeout);
+#else
+    // Clock::now uses CLOCK_MONOTONIC too
+    timeout.tv_sec = static_cast<time_t>(deadline / 1000000000LL);
+    timeout.tv_nsec = static_cast<long>(deadline % 1000000000LL);
+    res = pthread_cond_timedwait(&m_handle,
+				 lock.getMutex().m_impl->getHandle(),
+				 &timeout);
+#endif
+
+    return res != ETIMEDOUT;
+  }
+
+};
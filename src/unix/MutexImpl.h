@@ -1,5 +1,5 @@
 // Vaca - Visual Application Components Abstraction
-!// Copyright (c) 2005-2010 David Capello
+// Copyright (c) 2005-2010 David Capello
 // All rights reserved.
 //
 // Redistribution and use in source and binary forms, with or without
@@ -55,7 +55,7 @@ public:
 
   bool tryLock()
   {
-    return pthread_mutex_trylock(&m_handle) != EBUSY;
+    return pthread_mutex_trylock(&m_handle) == 0;
   }
 
   void unlock()
@@ -63,5 +63,11 @@ public:
     pthread_mutex_unlock(&m_handle);
   }
 
+  // used by ConditionVariable to wait on this mutex
+  pthread_mutex_t* getHandle()
+  {
+    return &m_handle;
+  }
+
 };
 
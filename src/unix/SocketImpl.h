@@ -0,0 +1,143 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+typedef int socket_t;
+
+static const socket_t invalid_socket = -1;
+
+static void init_sockets()
+{
+}
+
+static void close_socket(socket_t s)
+{
+  ::close(s);
+}
+
+static bool set_nonblocking(socket_t s)
+{
+  int flags = fcntl(s, F_GETFL, 0);
+  if (flags < 0 || fcntl(s, F_SETFL, flags | O_NONBLOCK) < 0)
+    return false;
+
+#ifdef SO_NOSIGPIPE
+  // write to a closed socket must not kill the program (BSD/Mac OS X)
+  int on = 1;
+  setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+  return true;
+}
+
+// returns true if the last operation failed only because it would
+// block (or the connection is in progress)
+static bool would_block()
+{
+  return (errno == EAGAIN ||
+	  errno == EWOULDBLOCK ||
+	  errno == EINPROGRESS ||
+	  errno == EINTR);
+}
+
+static int send_bytes(socket_t s, const char* buf, int len)
+{
+#ifdef MSG_NOSIGNAL
+  return ::send(s, buf, len, MSG_NOSIGNAL);
+#else
+  return ::send(s, buf, len, 0);
+#endif
+}
+
+static int recv_bytes(socket_t s, char* buf, int len)
+{
+  return ::recv(s, buf, len, 0);
+}
+
+// result of a non-blocking connect (zero if it was successful)
+static int get_socket_error(socket_t s)
+{
+  int error = 0;
+  socklen_t len = sizeof(error);
+  if (getsockopt(s, SOL_SOCKET, SO_ERROR, &error, &len) < 0)
+    return errno;
+  return error;
+}
+
+// a pair of connected sockets, used to wake up a wait_sockets()
+static bool make_socket_pair(socket_t pair[2])
+{
+  return socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0;
+}
+
+// a socket for wait_sockets()
+struct socket_wait
+{
+  socket_t socket;
+  bool read, write;		// events to wait
+  bool readable, writable;	// events received
+};
+
+// poll() has no limit in the number or the value of the descriptors
+// (select() cannot watch descriptors >= FD_SETSIZE)
+static const size_t max_waited_sockets = static_cast<size_t>(-1);
+
+// waits until some of the sockets can be read or written (errors and
+// hang-ups are reported as the waited events, so the next recv/send
+// fails)
+static bool wait_sockets(std::vector<socket_wait>& sockets)
+{
+  std::vector<pollfd> fds(sockets.size());
+  for (size_t i=0; i<sockets.size(); ++i) {
+    fds[i].fd = sockets[i].socket;
+    fds[i].events = ((sockets[i].read ? POLLIN: 0) |
+		     (sockets[i].write ? POLLOUT: 0));
+    fds[i].revents = 0;
+  }
+
+  if (::poll(&fds[0], fds.size(), -1) < 0)
+    return false;
+
+  for (size_t i=0; i<sockets.size(); ++i) {
+    short events = fds[i].revents;
+    sockets[i].readable = sockets[i].read && (events & (POLLIN | POLLHUP | POLLERR)) != 0;
+    sockets[i].writable = sockets[i].write && (events & (POLLOUT | POLLHUP | POLLERR)) != 0;
+  }
+  return true;
+}
@@ -0,0 +1,176 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <pthread.h>
+#include <sched.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+
+// POSIX does not have small integer IDs for threads, so we give one
+// to each thread the first time it is needed (the 0 is never used)
+static ThreadId next_thread_id = 0;
+static __thread ThreadId current_thread_id = 0;
+
+static ThreadId new_thread_id()
+{
+  return __sync_add_and_fetch(&next_thread_id, 1);
+}
+
+static ThreadId get_current_thread_id()
+{
+  if (current_thread_id == 0)
+    current_thread_id = new_thread_id();
+  return current_thread_id;
+}
+
+static void yield_current_thread()
+{
+  sched_yield();
+}
+
+static void sleep_current_thread(int msecs)
+{
+  struct timespec req, rem;
+  req.tv_sec = msecs / 1000;
+  req.tv_nsec = (msecs % 1000) * 1000000L;
+
+  // continue sleeping if a signal interrupted us
+  while (nanosleep(&req, &rem) == -1 && errno == EINTR)
+    req = rem;
+}
+
+class Vaca::Thread::ThreadImpl
+{
+  struct StartData
+  {
+    void (*proc)(void*);
+    void* arg;
+    ThreadId id;
+  };
+
+  pthread_t m_handle;
+  ThreadId m_id;
+  bool m_joinable;
+
+  static void* threadProc(void* data)
+  {
+    StartData start = *reinterpret_cast<StartData*>(data);
+    delete reinterpret_cast<StartData*>(data);
+
+    current_thread_id = start.id;
+    start.proc(start.arg);
+    return NULL;
+  }
+
+public:
+
+  // the current thread
+  ThreadImpl()
+  {
+    m_handle = pthread_self();
+    m_id = get_current_thread_id();
+    m_joinable = false;
+  }
+
+  // a new thread that calls proc(arg)
+  ThreadImpl(void (*proc)(void*), void* arg)
+  {
+    StartData* start = new StartData;
+    start->proc = proc;
+    start->arg = arg;
+    start->id = new_thread_id();
+
+    // the ID must be known before the thread starts (e.g. to
+    // enqueue messages to it)
+    m_id = start->id;
+
+    if (pthread_create(&m_handle, NULL, threadProc, start) != 0) {
+      delete start;
+      throw CreateThreadException();
+    }
+
+    m_joinable = true;
+  }
+
+  ~ThreadImpl()
+  {
+    if (m_joinable)
+      pthread_detach(m_handle);
+  }
+
+  ThreadId getId() const
+  {
+    return m_id;
+  }
+
+  void join()
+  {
+    assert(m_joinable);
+
+    pthread_join(m_handle, NULL);
+    m_joinable = false;
+  }
+
+  // The priority is mapped to the range of the scheduling policy of
+  // the thread. With the default policy (SCHED_OTHER) the range is
+  // empty on Linux, so the priority is not changed.
+  void setPriority(ThreadPriority priority)
+  {
+    int policy;
+    struct sched_param param;
+    if (pthread_getschedparam(m_handle, &policy, &param) != 0)
+      return;
+
+    int lo = sched_get_priority_min(policy);
+    int hi = sched_get_priority_max(policy);
+    if (lo < 0 || hi < 0)
+      return;
+
+    int level;
+    switch (priority) {
+      case ThreadPriority::Idle:         level = 0; break;
+      case ThreadPriority::Lowest:       level = 1; break;
+      case ThreadPriority::Low:          level = 2; break;
+      case ThreadPriority::Normal:       level = 3; break;
+      case ThreadPriority::High:         level = 4; break;
+      case ThreadPriority::Highest:      level = 5; break;
+      case ThreadPriority::TimeCritical: level = 6; break;
+      default:
+	assert(false);	      // TODO throw invalid argument exception
+	return;
+    }
+
+    param.sched_priority = lo + (hi - lo) * level / 6;
+    pthread_setschedparam(m_handle, policy, &param);
+  }
+
+};
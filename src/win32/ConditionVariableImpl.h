@@ -0,0 +1,233 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0400
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <limits>
+
+// A condition variable made with two semaphores and a mutex (Win32
+// does not have condition variables before Windows Vista).
+class Vaca::ConditionVariable::ConditionVariableImpl
+{
+  HANDLE m_gate;
+  HANDLE m_queue;
+  HANDLE m_mutex;
+  unsigned m_gone;         // # threads that timed out and never made it to m_queue
+  unsigned long m_blocked; // # threads blocked on the condition
+  unsigned m_waiting;      // # threads no longer waiting for the condition but
+			   // still waiting to be removed from m_queue
+
+  class ScopedUnlock : private NonCopyable
+  {
+    ScopedLock& m_lock;
+  public:
+    ScopedUnlock(ScopedLock& lock) : m_lock(lock) {
+      m_lock.getMutex().unlock();
+    }
+    ~ScopedUnlock() {
+      m_lock.getMutex().lock();
+    }
+  };
+
+public:
+
+  ConditionVariableImpl()
+    : m_gone(0)
+    , m_blocked(0)
+    , m_waiting(0)
+  {
+    m_gate = CreateSemaphore(0, 1, 1, NULL);
+    m_queue = CreateSemaphore(0, 0, (std::numeric_limits<long>::max)(), NULL);
+    m_mutex = CreateMutex(0, 0, NULL);
+
+    if (!m_gate || !m_queue || !m_mutex) {
+      if (m_gate) CloseHandle(m_gate);
+      if (m_queue) CloseHandle(m_queue);
+      if (m_mutex) CloseHandle(m_mutex);
+      throw CreateConditionVariableException();
+    }
+  }
+
+  ~ConditionVariableImpl()
+  {
+    CloseHandle(m_gate);
+    CloseHandle(m_queue);
+    CloseHandle(m_mutex);
+  }
+
+  void notifyOne()
+  {
+    unsigned signals = 0;
+
+    WaitForSingleObject(m_mutex, INFINITE);
+    if (m_waiting != 0) { // the m_gate is already closed
+      if (m_blocked == 0) {
+	ReleaseMutex(m_mutex);
+	return;
+      }
+
+      ++m_waiting;
+      --m_blocked;
+      signals = 1;
+    }
+    else {
+      WaitForSingleObject(m_gate, INFINITE);
+      if (m_blocked > m_gone) {
+	if (m_gone != 0) {
+	  m_blocked -= m_gone;
+	  m_gone = 0;
+	}
+	signals = m_waiting = 1;
+	--m_blocked;
+      }
+      else
+	ReleaseSemaphore(m_gate, 1, 0);
+    }
+
+    ReleaseMutex(m_mutex);
+    if (signals)
+      ReleaseSemaphore(m_queue, signals, 0);
+  }
+
+  void notifyAll()
+  {
+    unsigned signals = 0;
+
+    WaitForSingleObject(m_mutex, INFINITE);
+    if (m_waiting != 0) { // the m_gate is already closed
+      if (m_blocked == 0) {
+	ReleaseMutex(m_mutex);
+	return;
+      }
+
+      m_waiting += (signals = m_blocked);
+      m_blocked = 0;
+    }
+    else {
+      WaitForSingleObject(m_gate, INFINITE);
+      if (m_blocked > m_gone) {
+	if (m_gone != 0) {
+	  m_blocked -= m_gone;
+	  m_gone = 0;
+	}
+	signals = m_waiting = m_blocked;
+	m_blocked = 0;
+      }
+      else
+	ReleaseSemaphore(m_gate, 1, 0);
+    }
+
+    ReleaseMutex(m_mutex);
+    if (signals)
+      ReleaseSemaphore(m_queue, signals, 0);
+  }
+
+  void wait(ScopedLock& lock)
+  {
+    enterWait();
+    ScopedUnlock unlock(lock);
+
+    WaitForSingleObject(m_queue, INFINITE);
+    leaveWait(true);
+  }
+
+  bool waitUntil(ScopedLock& lock, Nanoseconds deadline)
+  {
+    // round up, so we never return before the deadline
+    Nanoseconds left = deadline - Clock::now();
+    DWORD milliseconds = left <= 0 ? 0: static_cast<DWORD>((left + 999999LL) / 1000000LL);
+
+    enterWait();
+    ScopedUnlock unlock(lock);
+
+    bool ret = (WaitForSingleObject(m_queue, milliseconds) == WAIT_OBJECT_0);
+    leaveWait(ret);
+    return ret;
+  }
+
+private:
+
+  void enterWait()
+  {
+    WaitForSingleObject(m_gate, INFINITE);
+    ++m_blocked;
+    ReleaseSemaphore(m_gate, 1, 0);
+  }
+
+  void leaveWait(bool signaled)
+  {
+    unsigned was_waiting = 0;
+    unsigned was_gone = 0;
+
+    WaitForSingleObject(m_mutex, INFINITE);
+    was_waiting = m_waiting;
+    was_gone = m_gone;
+    if (was_waiting != 0) {
+      if (!signaled) { // timeout
+	if (m_blocked != 0)
+	  --m_blocked;
+	else
+	  ++m_gone; // count spurious wakeups
+      }
+      if (--m_waiting == 0) {
+	if (m_blocked != 0) {
+	  ReleaseSemaphore(m_gate, 1, 0); // open m_gate
+	  was_waiting = 0;
+	}
+	else if (m_gone != 0)
+	  m_gone = 0;
+      }
+    }
+    else if (++m_gone == ((std::numeric_limits<unsigned>::max)() / 2)) {
+      // timeout occured, normalize the m_gone count
+      // this may occur if many calls to wait with a timeout are made and
+      // no call to notify_* is made
+      WaitForSingleObject(m_gate, INFINITE);
+      m_blocked -= m_gone;
+      ReleaseSemaphore(m_gate, 1, 0);
+      m_gone = 0;
+    }
+    ReleaseMutex(m_mutex);
+
+    if (was_waiting == 1) {
+      for (; was_gone; --was_gone) {
+	// better now than spurious later
+	WaitForSingleObject(m_queue, INFINITE);
+      }
+      ReleaseSemaphore(m_gate, 1, 0);
+    }
+  }
+
+};
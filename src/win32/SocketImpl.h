@@ -0,0 +1,168 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// <winsock2.h> and <ws2tcpip.h> are included by the .cpp file,
+// because they must be included before <windows.h>
+
+typedef SOCKET socket_t;
+
+static const socket_t invalid_socket = INVALID_SOCKET;
+
+static void init_sockets()
+{
+  static bool initialized = false;
+  if (!initialized) {
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+    initialized = true;
+  }
+}
+
+static void close_socket(socket_t s)
+{
+  ::closesocket(s);
+}
+
+static bool set_nonblocking(socket_t s)
+{
+  u_long on = 1;
+  return ::ioctlsocket(s, FIONBIO, &on) == 0;
+}
+
+// returns true if the last operation failed only because it would
+// block (or the connection is in progress)
+static bool would_block()
+{
+  int error = ::WSAGetLastError();
+  return (error == WSAEWOULDBLOCK ||
+	  error == WSAEINPROGRESS ||
+	  error == WSAEINTR);
+}
+
+static int send_bytes(socket_t s, const char* buf, int len)
+{
+  return ::send(s, buf, len, 0);
+}
+
+static int recv_bytes(socket_t s, char* buf, int len)
+{
+  return ::recv(s, buf, len, 0);
+}
+
+// result of a non-blocking connect (zero if it was successful)
+static int get_socket_error(socket_t s)
+{
+  int error = 0;
+  int len = sizeof(error);
+  if (::getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &len) != 0)
+    return ::WSAGetLastError();
+  return error;
+}
+
+// a pair of connected sockets, used to wake up a wait_sockets() (Winsock
+// does not have socketpair, so we connect two sockets through the
+// loopback interface)
+static bool make_socket_pair(socket_t pair[2])
+{
+  socket_t listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (listener == INVALID_SOCKET)
+    return false;
+
+  sockaddr_in addr;
+  int len = sizeof(addr);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+
+  pair[0] = pair[1] = INVALID_SOCKET;
+
+  if (::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+      ::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) == 0 &&
+      ::listen(listener, 1) == 0) {
+    pair[1] = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (pair[1] != INVALID_SOCKET &&
+	::connect(pair[1], reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+      pair[0] = ::accept(listener, NULL, NULL);
+  }
+
+  ::closesocket(listener);
+
+  if (pair[0] == INVALID_SOCKET) {
+    if (pair[1] != INVALID_SOCKET)
+      ::closesocket(pair[1]);
+    return false;
+  }
+  return true;
+}
+
+// a socket for wait_sockets()
+struct socket_wait
+{
+  socket_t socket;
+  bool read, write;		// events to wait
+  bool readable, writable;	// events received
+};
+
+// the fd_set of Winsock is an array of FD_SETSIZE sockets (the value
+// of the sockets does not matter, but their number does)
+static const size_t max_waited_sockets = FD_SETSIZE;
+
+// waits until some of the sockets can be read or written (a failed
+// connect is reported in the except set, it is given as writable so
+// get_socket_error is called)
+static bool wait_sockets(std::vector<socket_wait>& sockets)
+{
+  assert(sockets.size() <= max_waited_sockets);
+
+  fd_set reads, writes, excepts;
+  FD_ZERO(&reads);
+  FD_ZERO(&writes);
+  FD_ZERO(&excepts);
+  for (size_t i=0; i<sockets.size(); ++i) {
+    if (sockets[i].read)
+      FD_SET(sockets[i].socket, &reads);
+    if (sockets[i].write) {
+      FD_SET(sockets[i].socket, &writes);
+      FD_SET(sockets[i].socket, &excepts);
+    }
+  }
+
+  if (::select(0, &reads, &writes, &excepts, NULL) == SOCKET_ERROR)
+    return false;
+
+  for (size_t i=0; i<sockets.size(); ++i) {
+    sockets[i].readable = sockets[i].read && FD_ISSET(sockets[i].socket, &reads) != 0;
+    sockets[i].writable = sockets[i].write && (FD_ISSET(sockets[i].socket, &writes) ||
+					       FD_ISSET(sockets[i].socket, &excepts));
+  }
+  return true;
+}
@@ -0,0 +1,145 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in
+//   the documentation and/or other materials provided with the
+//   distribution.
+// * Neither the name of the author nor the names of its contributors
+//   may be used to endorse or promote products derived from this
+//   software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0400
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <assert.h>
+
+static ThreadId get_current_thread_id()
+{
+  return ::GetCurrentThreadId();
+}
+
+static void yield_current_thread()
+{
+  ::Sleep(0);
+}
+
+static void sleep_current_thread(int msecs)
+{
+  ::Sleep(msecs);
+}
+
+class Vaca::Thread::ThreadImpl
+{
+  struct StartData
+  {
+    void (*proc)(void*);
+    void* arg;
+  };
+
+  HANDLE m_handle;
+  ThreadId m_id;
+  bool m_joinable;
+
+  static DWORD WINAPI threadProc(LPVOID data)
+  {
+    StartData start = *reinterpret_cast<StartData*>(data);
+    delete reinterpret_cast<StartData*>(data);
+
+    start.proc(start.arg);
+    return 0;
+  }
+
+public:
+
+  // the current thread
+  ThreadImpl()
+  {
+    m_handle = ::GetCurrentThread();
+    m_id = ::GetCurrentThreadId();
+    m_joinable = false;
+  }
+
+  // a new thread that calls proc(arg)
+  ThreadImpl(void (*proc)(void*), void* arg)
+  {
+    StartData* start = new StartData;
+    start->proc = proc;
+    start->arg = arg;
+
+    DWORD id;
+    m_handle = ::CreateThread(NULL, 0, threadProc,
+			      reinterpret_cast<LPVOID>(start),
+			      0, &id);
+    if (!m_handle) {
+      delete start;
+      throw CreateThreadException();
+    }
+
+    m_id = id;
+    m_joinable = true;
+  }
+
+  ~ThreadImpl()
+  {
+    if (m_joinable)
+      ::CloseHandle(m_handle);
+  }
+
+  ThreadId getId() const
+  {
+    return m_id;
+  }
+
+  void join()
+  {
+    assert(m_joinable);
+
+    ::WaitForSingleObject(m_handle, INFINITE);
+    ::CloseHandle(m_handle);
+    m_handle = NULL;
+    m_joinable = false;
+  }
+
+  void setPriority(ThreadPriority priority)
+  {
+    int nPriority;
+    switch (priority) {
+      case ThreadPriority::Idle:         nPriority = THREAD_PRIORITY_IDLE; break;
+      case ThreadPriority::Lowest:       nPriority = THREAD_PRIORITY_LOWEST; break;
+      case ThreadPriority::Low:          nPriority = THREAD_PRIORITY_BELOW_NORMAL; break;
+      case ThreadPriority::Normal:       nPriority = THREAD_PRIORITY_NORMAL; break;
+      case ThreadPriority::High:         nPriority = THREAD_PRIORITY_ABOVE_NORMAL; break;
+      case ThreadPriority::Highest:      nPriority = THREAD_PRIORITY_HIGHEST; break;
+      case ThreadPriority::TimeCritical: nPriority = THREAD_PRIORITY_TIME_CRITICAL; break;
+      default:
+	assert(false);	      // TODO throw invalid argument exception
+	return;
+    }
+
+    ::SetThreadPriority(m_handle, nPriority);
+  }
+
+};
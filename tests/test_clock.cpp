@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+#include "Vaca/Clock.h"
+#include "Vaca/TimePoint.h"
+#include "Vaca/Thread.h"
+
+using namespace std;
+using namespace Vaca;
+
+TEST(Clock, Monotonic)
+{
+  Nanoseconds last = Clock::now();
+  for (int i=0; i<100000; ++i) {
+    Nanoseconds now = Clock::now();
+    ASSERT_GE(now, last);
+    last = now;
+  }
+}
+
+TEST(Clock, Conversions)
+{
+  EXPECT_EQ(1500000000LL, Clock::fromSeconds(1.5));
+  EXPECT_EQ(1000LL, Clock::fromSeconds(0.000001));
+  EXPECT_DOUBLE_EQ(0.25, Clock::toSeconds(250000000LL));
+
+  // more than 49.7 days (the limit of 32-bit milliseconds)
+  Nanoseconds days = 60LL*24*60*60*1000000000LL;
+  EXPECT_DOUBLE_EQ(60.0*24*60*60, Clock::toSeconds(days));
+  EXPECT_LT(Clock::now() - (Clock::now() + days), 0);
+}
+
+TEST(Clock, TimePoint)
+{
+  TimePoint t;
+  Nanoseconds start = Clock::now();
+  CurrentThread::sleep(20);
+
+  Nanoseconds a = t.elapsedNanoseconds();
+  Nanoseconds b = Clock::now() - start;
+  EXPECT_GE(a, 20000000LL);
+  EXPECT_NEAR(Clock::toSeconds(b), Clock::toSeconds(a), 0.005);
+  EXPECT_NEAR(t.elapsed(), Clock::toSeconds(a), 0.005);
+}
+
+// Generates "ticks" each 2 milliseconds (with absolute deadlines) and
+// measures the error (how late each thread wake-up is)
+static void measure_jitter(bool precise, Nanoseconds& p50, Nanoseconds& p99)
+{
+  const int ticks = 500;
+  const Nanoseconds period = 2000000LL;
+  vector<Nanoseconds> errors;
+
+  Nanoseconds deadline = Clock::now();
+  for (int i=0; i<ticks; ++i) {
+    deadline += period;
+    Clock::sleepUntil(deadline, precise);
+    errors.push_back(Clock::now() - deadline);
+  }
+
+  sort(errors.begin(), errors.end());
+  EXPECT_GE(errors.front(), 0);	// never before the deadline
+
+  p50 = errors[ticks*50/100];
+  p99 = errors[ticks*99/100];
+}
+
+TEST(Clock, Jitter)
+{
+  Nanoseconds p50, p99, precise_p50, precise_p99;
+
+  measure_jitter(false, p50, p99);
+  measure_jitter(true, precise_p50, precise_p99);
+
+  std::printf("tick error   p50 (us)  p99 (us)\n");
+  std::printf("normal      %9.1f %9.1f\n", p50/1000.0, p99/1000.0);
+  std::printf("precise     %9.1f %9.1f\n", precise_p50/1000.0, precise_p99/1000.0);
+}
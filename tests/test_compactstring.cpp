@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "Vaca/CompactString.h"
+#include "Vaca/String.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+// Counts the allocations of the test
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+void* operator new(size_t size)
+{
+  ++allocations;
+  allocated_bytes += size;
+  void* ptr = std::malloc(size ? size: 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) throw()
+{
+  std::free(ptr);
+}
+
+TEST(CompactString, Basic)
+{
+  CompactString a, b(L"Short"), c(L"A longer text which is not inline");
+
+  EXPECT_EQ(32u, sizeof(CompactString));
+  EXPECT_TRUE(a.empty());
+  EXPECT_TRUE(b.isInline());
+  EXPECT_FALSE(c.isInline());
+  EXPECT_EQ(5u, b.size());
+  EXPECT_EQ(L"Short", b.str());
+  EXPECT_EQ(String(L"A longer text which is not inline"), c.str());
+  EXPECT_EQ(0, b.data()[5]);
+
+  EXPECT_TRUE(CompactString(String(14, L'x')).isInline());
+  EXPECT_FALSE(CompactString(String(15, L'x')).isInline());
+
+  // copies share the buffer
+  CompactString d(c);
+  EXPECT_EQ(c.data(), d.data());
+  EXPECT_TRUE(c == d);
+  d = b;
+  EXPECT_TRUE(d == b);
+  EXPECT_TRUE(d != c);
+  EXPECT_TRUE(c < b);
+  EXPECT_TRUE(CompactString(L"ab") < CompactString(L"abc"));
+  EXPECT_EQ(0, CompactString(L"abc").compare(L"abc"));
+
+  // compatibility with String functions
+  EXPECT_EQ(L"Short", trim_string(CompactString(L"  Short  ")));
+  EXPECT_EQ(L"name", file_title(CompactString(L"C:\\name.txt")));
+  EXPECT_EQ(12, convert_to<int>(CompactString(L"12").str()));
+}
+
+TEST(CompactString, Utf16)
+{
+  String text = from_utf8("a\xF0\x9F\x98\x80" "b");	// U+1F600
+  CompactString str(text);
+
+  EXPECT_EQ(text, str.str());
+  if (sizeof(Char) == 4) {
+    ASSERT_EQ(4u, str.size());
+    EXPECT_EQ(0xD83D, str.data()[1]);
+    EXPECT_EQ(0xDE00, str.data()[2]);
+  }
+}
+
+// A list model with 1M rows and 3 columns (name, size, type)
+template<typename Text>
+static void measure_model(const char* name, const std::vector<String>& texts)
+{
+  size_t count = allocations, bytes = allocated_bytes;
+  TimePoint start;
+  {
+    std::vector<Text> model(texts.begin(), texts.end());
+    double fill = start.elapsed();
+    size_t fillCount = allocations - count;
+    size_t fillBytes = allocated_bytes - bytes;
+
+    // copy of the whole model
+    count = allocations;
+    start.reset();
+    std::vector<Text> copy(model);
+    double copyTime = start.elapsed();
+
+    std::printf("%s: %u bytes in %u allocations (%.0f ms), "
+		"%u allocations to copy it (%.0f ms)\n",
+		name,
+		static_cast<unsigned>(fillBytes),
+		static_cast<unsigned>(fillCount),
+		fill * 1000,
+		static_cast<unsigned>(allocations - count),
+		copyTime * 1000);
+  }
+}
+
+TEST(CompactString, ListModel)
+{
+  const int rows = 1000000;
+  std::vector<String> texts;
+  texts.reserve(rows*3);
+  for (int i=0; i<rows; ++i) {
+    texts.push_back(L"Item " + convert_to<String>(i));
+    texts.push_back(convert_to<String>(i % 1000) + L" KB");
+    texts.push_back(i % 10 == 0 ? L"Compressed (zipped) Folder": L"Text Document");
+  }
+
+  measure_model<String>("String", texts);
+  measure_model<CompactString>("CompactString", texts);
+}
@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <deque>
+#include <cstdio>
+
+#include "Vaca/ConditionVariable.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/Thread.h"
+#include "Vaca/TimePoint.h"
+
+using namespace std;
+using namespace Vaca;
+
+namespace contention {
+
+  // a bounded queue, producers wait while it is full and consumers
+  // while it is empty
+  Mutex mutex;
+  ConditionVariable notFull;
+  ConditionVariable notEmpty;
+  deque<int> items;
+  const size_t capacity = 4;
+  const int itemsPerProducer = 20000;
+  long long consumed = 0;
+
+  bool is_not_full() { return items.size() < capacity; }
+  bool is_not_empty() { return !items.empty(); }
+
+  void produce()
+  {
+    for (int i=1; i<=itemsPerProducer; ++i) {
+      ScopedLock hold(mutex);
+      notFull.wait(hold, &is_not_full);
+      items.push_back(i);
+      notEmpty.notifyOne();
+    }
+  }
+
+  void consume()
+  {
+    for (;;) {
+      ScopedLock hold(mutex);
+      notEmpty.wait(hold, &is_not_empty);
+      int item = items.front();
+      items.pop_front();
+      notFull.notifyOne();
+
+      if (item == 0)		// end of the work
+	break;
+      consumed += item;
+    }
+  }
+
+  TEST(ConditionVariable, Contention)
+  {
+    const int producers = 4;
+    const int consumers = 4;
+    vector<Thread*> threads;
+
+    TimePoint t;
+    for (int c=0; c<consumers; ++c) threads.push_back(new Thread(&consume));
+    for (int c=0; c<producers; ++c) threads.push_back(new Thread(&produce));
+    for (int c=0; c<producers; ++c) threads[consumers+c]->join();
+
+    // one zero for each consumer
+    for (int c=0; c<consumers; ++c) {
+      ScopedLock hold(mutex);
+      notFull.wait(hold, &is_not_full);
+      items.push_back(0);
+      notEmpty.notifyOne();
+    }
+    for (int c=0; c<consumers; ++c) threads[c]->join();
+
+    std::printf("%d items through a queue of %d: %.1f ms\n",
+		producers*itemsPerProducer, (int)capacity, t.elapsed()*1000.0);
+
+    for (size_t c=0; c<threads.size(); ++c)
+      delete threads[c];
+
+    long long n = itemsPerProducer;
+    EXPECT_EQ(producers * n*(n+1)/2, consumed);
+    EXPECT_TRUE(items.empty());
+  }
+
+}
+
+namespace notify_all {
+
+  Mutex mutex;
+  ConditionVariable cond;
+  bool go = false;
+  int waiting = 0;
+  int awake = 0;
+
+  bool can_go() { return go; }
+
+  void waiter()
+  {
+    ScopedLock hold(mutex);
+    ++waiting;
+    cond.wait(hold, &can_go);
+    ++awake;
+  }
+
+  TEST(ConditionVariable, NotifyAll)
+  {
+    const int n = 8;
+    vector<Thread*> threads;
+    for (int c=0; c<n; ++c) threads.push_back(new Thread(&waiter));
+
+    // wait all threads to be waiting
+    for (;;) {
+      {
+	ScopedLock hold(mutex);
+	if (waiting == n)
+	  break;
+      }
+      CurrentThread::yield();
+    }
+
+    {
+      ScopedLock hold(mutex);
+      go = true;
+      cond.notifyAll();
+    }
+
+    for (int c=0; c<n; ++c) threads[c]->join();
+    for (int c=0; c<n; ++c) delete threads[c];
+    EXPECT_EQ(n, awake);
+  }
+
+}
+
+namespace spurious {
+
+  // The notifier wakes up the waiter many times without changing the
+  // condition (that is what a spurious wake-up looks like for the
+  // waiter), the predicate must keep it waiting.
+  Mutex mutex;
+  ConditionVariable cond;
+  int value = 0;
+  int checks = 0;
+
+  bool is_ready()
+  {
+    ++checks;
+    return value == 100;
+  }
+
+  void notifier()
+  {
+    for (int i=1; i<=100; ++i) {
+      ScopedLock hold(mutex);
+      value = i;
+      cond.notifyAll();
+    }
+  }
+
+  TEST(ConditionVariable, SpuriousWakeups)
+  {
+    Thread thread(&notifier);
+    {
+      ScopedLock hold(mutex);
+      cond.wait(hold, &is_ready);
+      EXPECT_EQ(100, value);
+    }
+    thread.join();
+    EXPECT_GE(checks, 1);
+  }
+
+}
+
+namespace timeouts {
+
+  Mutex mutex;
+  ConditionVariable cond;
+  bool done = false;
+
+  bool never() { return false; }
+  bool is_done() { return done; }
+
+  void keep_notifying()
+  {
+    for (;;) {
+      CurrentThread::sleep(5);
+
+      ScopedLock hold(mutex);
+      if (done)
+	break;
+      cond.notifyAll();
+    }
+  }
+
+  TEST(ConditionVariable, WaitForTimeout)
+  {
+    const double timeouts[] = { 0.001, 0.01, 0.05, 0.1 };
+    ScopedLock hold(mutex);
+
+    for (int i=0; i<4; ++i) {
+      TimePoint t;
+      bool notified = cond.waitFor(hold, timeouts[i]);
+      double elapsed = t.elapsed();
+
+      std::printf("waitFor(%.3f) returned after %.3f ms\n", timeouts[i], elapsed*1000.0);
+
+      // without notifications it can only return by time-out (or a
+      // spurious wake-up)
+      if (!notified) {
+	EXPECT_GE(elapsed, timeouts[i] - 0.0005);
+      }
+      EXPECT_LT(elapsed, timeouts[i] + 0.1);
+    }
+  }
+
+  TEST(ConditionVariable, WaitForPredicateKeepsDeadline)
+  {
+    Thread thread(&keep_notifying);
+
+    // the notifications wake up the waiter each 5 ms, but the
+    // time-out is not restarted
+    {
+      ScopedLock hold(mutex);
+      TimePoint t;
+      EXPECT_FALSE(cond.waitFor(hold, 0.1, &never));
+      double elapsed = t.elapsed();
+
+      EXPECT_GE(elapsed, 0.1 - 0.0005);
+      EXPECT_LT(elapsed, 0.2);
+
+      done = true;
+    }
+    thread.join();
+
+    ScopedLock hold(mutex);
+    EXPECT_TRUE(cond.waitFor(hold, 0.1, &is_done));
+  }
+
+}
+
+namespace pingpong {
+
+  Mutex mutex;
+  ConditionVariable cond;
+  int turn = 0;			// 0 = ping, 1 = pong
+  const int rounds = 20000;
+
+  bool is_turn_0() { return turn == 0; }
+  bool is_turn_1() { return turn == 1; }
+
+  void pong()
+  {
+    for (int i=0; i<rounds; ++i) {
+      ScopedLock hold(mutex);
+      cond.wait(hold, &is_turn_1);
+      turn = 0;
+      cond.notifyOne();
+    }
+  }
+
+  TEST(ConditionVariable, PingPong)
+  {
+    Thread thread(&pong);
+
+    TimePoint t;
+    for (int i=0; i<rounds; ++i) {
+      ScopedLock hold(mutex);
+      cond.wait(hold, &is_turn_0);
+      turn = 1;
+      cond.notifyOne();
+    }
+    thread.join();
+
+    std::printf("%d round-trips: %.2f us each\n",
+		rounds, t.elapsed()*1e6 / rounds);
+  }
+
+}
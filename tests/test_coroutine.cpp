@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "Vaca/Application.h"
+#include "Vaca/Bind.h"
+#include "Vaca/Clock.h"
+#include "Vaca/Coroutine.h"
+#include "Vaca/ThreadPool.h"
+#include "Vaca/TimePoint.h"
+
+using namespace std;
+using namespace Vaca;
+
+class CoroutineTest : public testing::Test {
+  Application app;
+};
+
+static int answer()
+{
+  return 42;
+}
+
+static int slow_square(int x)
+{
+  CurrentThread::sleep(50);
+  return x*x;
+}
+
+static int fail()
+{
+  throw Exception(L"Task failed");
+}
+
+static Task<int> immediate()
+{
+  co_return 42;
+}
+
+static Task<int> await_pool(ThreadPool& pool, bool* sameThread)
+{
+  ThreadId id = CurrentThread::getId();
+  int a = co_await pool.submit<int>(&answer);
+  int b = co_await pool.submit<int>(Bind<int>(&slow_square, 3));
+  *sameThread = (id == CurrentThread::getId());
+  co_return a + b;
+}
+
+TEST_F(CoroutineTest, Immediate)
+{
+  Task<int> task = immediate();
+  EXPECT_TRUE(task.isReady());
+  EXPECT_EQ(42, task.get());
+  EXPECT_EQ(42, waitInMessageLoop(task));
+}
+
+TEST_F(CoroutineTest, AwaitFuture)
+{
+  ThreadPool pool(2);
+  bool sameThread = false;
+
+  Task<int> task = await_pool(pool, &sameThread);
+  EXPECT_FALSE(task.isReady());	// it is waiting the pool
+
+  EXPECT_EQ(51, waitInMessageLoop(task));
+  EXPECT_TRUE(sameThread);
+}
+
+static Task<String> await_failure(ThreadPool& pool)
+{
+  try {
+    co_await pool.submit<int>(&fail);
+  }
+  catch (TaskException& e) {
+    co_return e.getMessage();
+  }
+  co_return L"";
+}
+
+static Task<> throw_after_yield()
+{
+  co_await yieldToMessageLoop();
+  throw Exception(L"Coroutine failed");
+}
+
+TEST_F(CoroutineTest, Exceptions)
+{
+  ThreadPool pool(2);
+
+  EXPECT_EQ(L"Task failed", waitInMessageLoop(await_failure(pool)));
+  EXPECT_THROW(waitInMessageLoop(throw_after_yield()), Exception);
+}
+
+static Task<> switch_threads(ThreadPool& pool, vector<ThreadId>* ids)
+{
+  ThreadId uiThread = CurrentThread::getId();
+  ids->push_back(CurrentThread::getId());
+
+  co_await resumeOn(pool);
+  ids->push_back(CurrentThread::getId());
+
+  co_await resumeOn(uiThread);
+  ids->push_back(CurrentThread::getId());
+}
+
+TEST_F(CoroutineTest, ResumeOn)
+{
+  ThreadPool pool(2);
+  vector<ThreadId> ids;
+
+  waitInMessageLoop(switch_threads(pool, &ids));
+
+  ASSERT_EQ(3, ids.size());
+  EXPECT_EQ(CurrentThread::getId(), ids[0]);
+  EXPECT_NE(CurrentThread::getId(), ids[1]);
+  EXPECT_EQ(CurrentThread::getId(), ids[2]);
+}
+
+static Task<double> wait_delay(int msecs)
+{
+  TimePoint t;
+  co_await delay(msecs);
+  co_return t.elapsed();
+}
+
+TEST_F(CoroutineTest, Delay)
+{
+  double elapsed = waitInMessageLoop(wait_delay(20));
+  EXPECT_GE(elapsed, 0.020 - 0.0005);
+  EXPECT_LT(elapsed, 0.5);
+}
+
+namespace interleave {
+
+  // A coroutine waits a slow task, meanwhile the message loop keeps
+  // running other (detached) coroutines.
+  int steps = 0;
+  bool stop = false;
+
+  Task<> background_steps()
+  {
+    while (!stop) {
+      ++steps;
+      co_await yieldToMessageLoop();
+    }
+  }
+
+  Task<int> wait_slow_task(ThreadPool& pool)
+  {
+    int result = co_await pool.submit<int>(Bind<int>(&slow_square, 4));
+    stop = true;
+    co_return result;
+  }
+
+  TEST_F(CoroutineTest, MessageLoopIsNotBlocked)
+  {
+    ThreadPool pool(1);
+
+    background_steps();		// detached
+    EXPECT_EQ(16, waitInMessageLoop(wait_slow_task(pool)));
+    EXPECT_GT(steps, 10);
+
+    // the detached coroutine finishes (and is destroyed) in the next message
+    waitInMessageLoop(immediate());
+    CurrentThread::pumpMessageQueue();
+  }
+
+}
+
+static Task<int> add(Task<int> a, Task<int> b)
+{
+  int x = co_await a;
+  int y = co_await b;
+  co_return x + y;
+}
+
+TEST_F(CoroutineTest, AwaitTask)
+{
+  ThreadPool pool(2);
+  bool sameThread;
+
+  EXPECT_EQ(42+51, waitInMessageLoop(add(immediate(), await_pool(pool, &sameThread))));
+}
+
+namespace benchmark {
+
+  const int rounds = 2000;
+
+  // The latency is the time from the moment a coroutine is suspended
+  // until it is resumed in the message loop.
+  Task<> measure(ThreadPool& pool, int kind, vector<Nanoseconds>* samples)
+  {
+    ThreadId uiThread = CurrentThread::getId();
+
+    for (int i=0; i<rounds; ++i) {
+      Nanoseconds start = Clock::now();
+      switch (kind) {
+	case 0:
+	  co_await yieldToMessageLoop();
+	  break;
+	case 1:
+	  co_await pool.submit<int>(&answer);
+	  break;
+	case 2:
+	  co_await resumeOn(pool);
+	  co_await resumeOn(uiThread);
+	  break;
+      }
+      samples->push_back(Clock::now() - start);
+    }
+  }
+
+  TEST_F(CoroutineTest, Latency)
+  {
+    const char* names[] = { "yieldToMessageLoop",
+			    "co_await Future",
+			    "resumeOn(pool) + back" };
+    ThreadPool pool(2);
+
+    std::printf("%-24s %9s %9s\n", "round-trip", "p50 (us)", "p99 (us)");
+    for (int kind=0; kind<3; ++kind) {
+      vector<Nanoseconds> samples;
+      waitInMessageLoop(measure(pool, kind, &samples));
+
+      ASSERT_EQ(rounds, samples.size());
+      sort(samples.begin(), samples.end());
+      std::printf("%-24s %9.1f %9.1f\n", names[kind],
+		  samples[rounds*50/100] / 1000.0,
+		  samples[rounds*99/100] / 1000.0);
+    }
+  }
+
+}
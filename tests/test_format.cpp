@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <cstdio>
+#include <limits>
+
+#include "Vaca/Format.h"
+#include "Vaca/String.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+TEST(Format, Text)
+{
+  EXPECT_EQ(L"",		format_text(L""));
+  EXPECT_EQ(L"Hello",		format_text(L"Hello"));
+  EXPECT_EQ(L"{Hello}",		format_text(L"{{Hello}}"));
+  EXPECT_EQ(L"a-b-c",		format_text(L"{}-{}-{}", L"a", String(L"b"), StringView(L"c")));
+  EXPECT_EQ(L"c b a",		format_text(L"{2} {1} {0}", L"a", L"b", L"c"));
+  EXPECT_EQ(L"x x",		format_text(L"{0} {0}", L'x'));
+  EXPECT_EQ(L"true false",	format_text(L"{} {}", true, false));
+}
+
+TEST(Format, Numbers)
+{
+  EXPECT_EQ(L"2",		format_text(L"{}", 2));
+  EXPECT_EQ(L"-2147483648",	format_text(L"{}", INT_MIN));
+  EXPECT_EQ(L"4294967295",	format_text(L"{}", UINT_MAX));
+  EXPECT_EQ(L"-9223372036854775808", format_text(L"{}", LLONG_MIN));
+  EXPECT_EQ(L"18446744073709551615", format_text(L"{}", ULLONG_MAX));
+  EXPECT_EQ(L"7",		format_text(L"{}", sizeof(int)+3));
+  EXPECT_EQ(L"ffffffffff",	format_text(L"{:x}", 0xffffffffffULL));
+  EXPECT_EQ(L"0.1 0.1",		format_text(L"{} {}", 0.1, 0.1f));
+  EXPECT_EQ(L"20.32",		format_text(L"{:.2f}", 20.3248));
+  EXPECT_EQ(L"1.500000",	format_text(L"{:f}", 1.5));
+  EXPECT_EQ(L"1.5e+03",		format_text(L"{:.1e}", 1500.0));
+  EXPECT_EQ(L"  202",		format_text(L"{:5}", 202));
+  EXPECT_EQ(L"00202",		format_text(L"{:05}", 202));
+  EXPECT_EQ(L"-0202",		format_text(L"{:05}", -202));
+  EXPECT_EQ(L"ff00",		format_text(L"{:04x}", 0xff00));
+  EXPECT_EQ(L"00FF",		format_text(L"{:04X}", 0xffu));
+  EXPECT_EQ(L"-ff",		format_text(L"{:x}", -255));
+  EXPECT_EQ(L"inf",		format_text(L"{:.2f}", std::numeric_limits<double>::infinity()));
+}
+
+TEST(Format, Alignment)
+{
+  EXPECT_EQ(L"ab   |",		format_text(L"{:5}|", L"ab"));
+  EXPECT_EQ(L"   ab|",		format_text(L"{:>5}|", L"ab"));
+  EXPECT_EQ(L"*ab**|",		format_text(L"{:*^5}|", L"ab"));
+  EXPECT_EQ(L"12...|",		format_text(L"{:.<5}|", 12));
+  EXPECT_EQ(L"abc|",		format_text(L"{:.3}|", L"abcdef"));
+  EXPECT_EQ(String(300, L'-') + L"x",
+	    format_text(L"{:->301}", L'x'));
+}
+
+TEST(Format, Append)
+{
+  String str(L"Items: ");
+  for (int i=0; i<3; ++i)
+    format_append(str, i == 0 ? L"{}": L", {}", i);
+  EXPECT_EQ(L"Items: 0, 1, 2", str);
+
+  // longer than the internal buffer
+  String big(1000, L'a');
+  str = format_text(L"[{}] [{}]", big, big);
+  EXPECT_EQ(L"[" + big + L"] [" + big + L"]", str);
+}
+
+TEST(Format, Errors)
+{
+  EXPECT_THROW(format_text(L"{"), FormatException);
+  EXPECT_THROW(format_text(L"}"), FormatException);
+  EXPECT_THROW(format_text(L"{}"), FormatException);
+  EXPECT_THROW(format_text(L"{} {}", 1), FormatException);
+  EXPECT_THROW(format_text(L"{1}", 1), FormatException);
+  EXPECT_THROW(format_text(L"{:x}", L"str"), FormatException);
+  EXPECT_THROW(format_text(L"{:x}", 1.0), FormatException);
+  EXPECT_THROW(format_text(L"{:.2}", 1), FormatException);
+  EXPECT_THROW(format_text(L"{:?}", 1), FormatException);
+}
+
+TEST(Format, Time)
+{
+  const int n = 200000;
+  String fileName = L"Document1.txt";
+  size_t sum = 0;
+
+  TimePoint start;
+  for (int i=0; i<n; ++i) {
+    String str = format_string(L"Can't load the icon resource %d", i);
+    sum += str.size();
+    str = format_string(L"%s - Editor (%d of %d)", fileName.c_str(), i, n);
+    sum += str.size();
+  }
+  double printf = start.elapsed();
+
+  start.reset();
+  for (int i=0; i<n; ++i) {
+    String str = format_text(L"Can't load the icon resource {}", i);
+    sum += str.size();
+    str = format_text(L"{} - Editor ({} of {})", fileName, i, n);
+    sum += str.size();
+  }
+  double text = start.elapsed();
+
+  std::printf("format_string: %.0f ns per string\n", printf * 1e9 / (2*n));
+  std::printf("format_text: %.0f ns per string\n", text * 1e9 / (2*n));
+  EXPECT_NE(0u, sum);
+}
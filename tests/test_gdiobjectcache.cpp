@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "Vaca/GdiObjectCache.h"
+#include "Vaca/Thread.h"
+#include "Vaca/Pen.h"
+#include "Vaca/Brush.h"
+#include "Vaca/Font.h"
+#include "Vaca/Color.h"
+#include "Vaca/Image.h"
+#include "Vaca/Graphics.h"
+#include "Vaca/TimePoint.h"
+#include "Vaca/win32.h"
+
+using namespace Vaca;
+
+TEST(GdiObjectCache, SharedBrushes)
+{
+  Brush a(Color(10, 20, 30));
+  Brush b(Color(10, 20, 30));
+  Brush c(Color(30, 20, 10));
+
+  EXPECT_EQ(convert_to<HBRUSH>(a), convert_to<HBRUSH>(b));
+  EXPECT_NE(convert_to<HBRUSH>(a), convert_to<HBRUSH>(c));
+  EXPECT_EQ(Color(10, 20, 30), b.getColor());
+}
+
+TEST(GdiObjectCache, SharedPens)
+{
+  Pen a(Color(255, 0, 0), 2);
+  Pen b(Color(255, 0, 0), 2);
+  Pen c(Color(255, 0, 0), 3);
+  Pen d(Color(255, 0, 0), 2, PenStyle::Dash);
+
+  EXPECT_EQ(convert_to<HPEN>(a), convert_to<HPEN>(b));
+  EXPECT_NE(convert_to<HPEN>(a), convert_to<HPEN>(c));
+  EXPECT_NE(convert_to<HPEN>(a), convert_to<HPEN>(d));
+  EXPECT_EQ(PenStyle::Dash, d.getStyle());
+}
+
+TEST(GdiObjectCache, SharedFonts)
+{
+  Font a(L"Tahoma", 10);
+  Font b(L"Tahoma", 10);
+  Font c(L"Tahoma", 10, FontStyle::Bold);
+
+  EXPECT_EQ(a.getHandle(), b.getHandle());
+  EXPECT_NE(a.getHandle(), c.getHandle());
+  EXPECT_EQ(c.getHandle(), Font(b, FontStyle::Bold).getHandle());
+}
+
+TEST(GdiObjectCache, Capacity)
+{
+  GdiObjectCache& cache = CurrentThread::getGdiObjectCache();
+  size_t oldCapacity = cache.getCapacity();
+
+  cache.clear();
+  cache.setCapacity(2);
+  cache.resetStats();
+
+  { Brush brush(Color(1, 0, 0)); }
+  { Brush brush(Color(2, 0, 0)); }
+  { Brush brush(Color(3, 0, 0)); }
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(3u, cache.getCreatedObjects());
+
+  // the first one was evicted
+  { Brush brush(Color(1, 0, 0)); }
+  EXPECT_EQ(4u, cache.getCreatedObjects());
+  { Brush brush(Color(1, 0, 0)); }
+  EXPECT_EQ(4u, cache.getCreatedObjects());
+  EXPECT_EQ(1u, cache.getHits());
+
+  cache.setCapacity(oldCapacity);
+}
+
+static double paint_loop(int frames)
+{
+  Image image(64, 64, 32);
+  Graphics& g = image.getGraphics();
+
+  TimePoint start;
+  for (int frame=0; frame<frames; ++frame) {
+    g.fillRect(Brush(Color(255, 255, 255)), Rect(0, 0, 64, 64));
+    for (int i=0; i<8; ++i) {
+      g.drawLine(Pen(Color(i*32, 0, 0), 1), 0, i*8, 64, i*8);
+      g.fillRect(Brush(Color(0, i*32, 0)), Rect(i*8, 0, 4, 4));
+    }
+  }
+  return start.elapsed();
+}
+
+TEST(GdiObjectCache, PaintLoop)
+{
+  GdiObjectCache& cache = CurrentThread::getGdiObjectCache();
+  size_t oldCapacity = cache.getCapacity();
+  int frames = 1000;
+
+  // without cache
+  cache.clear();
+  cache.setCapacity(0);
+  cache.resetStats();
+  double seconds = paint_loop(frames);
+  size_t created = cache.getCreatedObjects();
+  EXPECT_EQ(17u*frames, created);
+  std::printf("without cache: %d frames in %.4g seconds, %.0f handles created per second\n",
+	      frames, seconds, created / seconds);
+
+  // with cache
+  cache.setCapacity(oldCapacity);
+  cache.resetStats();
+  seconds = paint_loop(frames);
+  created = cache.getCreatedObjects();
+  EXPECT_EQ(17u, created);
+  std::printf("with cache: %d frames in %.4g seconds, %.0f handles created per second\n",
+	      frames, seconds, created / seconds);
+}
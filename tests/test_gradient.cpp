@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "Vaca/Gradient.h"
+#include "Vaca/ImagePixels.h"
+#include "Vaca/Image.h"
+#include "Vaca/Graphics.h"
+#include "Vaca/Rect.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+#define EXPECT_PIXEL(pixels, x, y, r, g, b)			\
+  {								\
+    ImagePixels::pixel_type color = pixels.getPixel(x, y);	\
+    EXPECT_EQ(r, ImagePixels::getR(color));			\
+    EXPECT_EQ(g, ImagePixels::getG(color));			\
+    EXPECT_EQ(b, ImagePixels::getB(color));			\
+  }
+
+TEST(Gradient, Horizontal)
+{
+  ImagePixels pixels(256, 3);
+  Gradient gradient(Color(0, 0, 0), Color(255, 255, 255));
+  gradient.fillRect(pixels, Rect(0, 0, 256, 3), Orientation::Horizontal);
+
+  for (int y=0; y<3; ++y)
+    for (int x=0; x<256; ++x)
+      EXPECT_PIXEL(pixels, x, y, x, x, x);
+}
+
+TEST(Gradient, Vertical)
+{
+  ImagePixels pixels(5, 3);
+  Gradient gradient(Color(255, 0, 0), Color(0, 0, 255));
+  gradient.fillRect(pixels, Rect(0, 0, 5, 3), Orientation::Vertical);
+
+  for (int x=0; x<5; ++x) {
+    EXPECT_PIXEL(pixels, x, 0, 255, 0, 0);
+    EXPECT_PIXEL(pixels, x, 1, 128, 0, 128);
+    EXPECT_PIXEL(pixels, x, 2, 0, 0, 255);
+  }
+}
+
+TEST(Gradient, MultipleStops)
+{
+  ImagePixels pixels(5, 1);
+  Gradient gradient;
+  gradient.addStop(0.0, Color(255, 0, 0));
+  gradient.addStop(1.0, Color(0, 0, 255));
+  gradient.addStop(0.5, Color(0, 255, 0));
+  gradient.fillRect(pixels, Rect(0, 0, 5, 1), Orientation::Horizontal);
+
+  EXPECT_PIXEL(pixels, 0, 0, 255, 0, 0);
+  EXPECT_PIXEL(pixels, 1, 0, 128, 128, 0);
+  EXPECT_PIXEL(pixels, 2, 0, 0, 255, 0);
+  EXPECT_PIXEL(pixels, 3, 0, 0, 128, 128);
+  EXPECT_PIXEL(pixels, 4, 0, 0, 0, 255);
+}
+
+TEST(Gradient, HardStop)
+{
+  ImagePixels pixels(4, 1);
+  Gradient gradient;
+  gradient.addStop(0.0, Color(255, 0, 0));
+  gradient.addStop(0.5, Color(255, 0, 0));
+  gradient.addStop(0.5, Color(0, 0, 255));
+  gradient.addStop(1.0, Color(0, 0, 255));
+  gradient.fillRect(pixels, Rect(0, 0, 4, 1), Orientation::Horizontal);
+
+  EXPECT_PIXEL(pixels, 0, 0, 255, 0, 0);
+  EXPECT_PIXEL(pixels, 1, 0, 255, 0, 0);
+  EXPECT_PIXEL(pixels, 2, 0, 0, 0, 255);
+  EXPECT_PIXEL(pixels, 3, 0, 0, 0, 255);
+}
+
+TEST(Gradient, EndPointsOfAllLengths)
+{
+  // lengths that are not multiple of four test the tails of the kernel
+  for (int w=1; w<=20; ++w) {
+    ImagePixels pixels(w, 1);
+    Gradient gradient(Color(10, 200, 30), Color(250, 0, 90));
+    gradient.fillRect(pixels, Rect(0, 0, w, 1), Orientation::Horizontal);
+
+    EXPECT_PIXEL(pixels, 0, 0, 10, 200, 30);
+    if (w > 1)
+      EXPECT_PIXEL(pixels, w-1, 0, 250, 0, 90);
+
+    // monotonic
+    for (int x=1; x<w; ++x) {
+      EXPECT_LE(ImagePixels::getR(pixels.getPixel(x-1, 0)), ImagePixels::getR(pixels.getPixel(x, 0)));
+      EXPECT_GE(ImagePixels::getG(pixels.getPixel(x-1, 0)), ImagePixels::getG(pixels.getPixel(x, 0)));
+    }
+  }
+}
+
+TEST(Gradient, Clipping)
+{
+  ImagePixels pixels(4, 4);
+  for (int y=0; y<4; ++y)
+    for (int x=0; x<4; ++x)
+      pixels.setPixel(x, y, 0);
+
+  // only the last half of the gradient is inside the pixels
+  Gradient gradient(Color(0, 0, 0), Color(0, 0, 255));
+  gradient.fillRect(pixels, Rect(-3, 1, 6, 2), Orientation::Horizontal);
+
+  EXPECT_EQ(0, pixels.getPixel(0, 0));
+  EXPECT_PIXEL(pixels, 0, 1, 0, 0, 153);
+  EXPECT_PIXEL(pixels, 1, 1, 0, 0, 204);
+  EXPECT_PIXEL(pixels, 2, 2, 0, 0, 255);
+  EXPECT_EQ(0, pixels.getPixel(3, 1));
+  EXPECT_EQ(0, pixels.getPixel(0, 3));
+}
+
+TEST(Gradient, Dithering)
+{
+  // the exact colors are not modified by the dithering
+  ImagePixels pixels(8, 8);
+  Gradient flat(Color(100, 100, 100), Color(100, 100, 100));
+  flat.setDithering(true);
+  flat.fillRect(pixels, Rect(0, 0, 8, 8), Orientation::Horizontal);
+  for (int y=0; y<8; ++y)
+    for (int x=0; x<8; ++x)
+      EXPECT_PIXEL(pixels, x, y, 100, 100, 100);
+
+  // values in the middle of two colors are 50% of each one
+  // (columns 1 and 3 have the values 0.5 and 1.5)
+  Gradient gradient(Color(0, 0, 0), Color(2, 2, 2));
+  gradient.setDithering(true);
+  gradient.fillRect(pixels, Rect(0, 0, 5, 8), Orientation::Horizontal);
+
+  int sum1 = 0, sum3 = 0;
+  for (int y=0; y<8; ++y) {
+    sum1 += ImagePixels::getR(pixels.getPixel(1, y));
+    sum3 += ImagePixels::getR(pixels.getPixel(3, y));
+    EXPECT_PIXEL(pixels, 0, y, 0, 0, 0);
+    EXPECT_PIXEL(pixels, 2, y, 1, 1, 1);
+    EXPECT_PIXEL(pixels, 4, y, 2, 2, 2);
+  }
+  EXPECT_EQ(4, sum1);		// 0.5 * 8 rows
+  EXPECT_EQ(12, sum3);		// 1.5 * 8 rows
+}
+
+TEST(Gradient, Graphics)
+{
+  Image image(256, 2, 32);
+  image.getGraphics().fillGradientRect(Rect(0, 0, 256, 2),
+				       Color(0, 0, 0), Color(255, 0, 255),
+				       Orientation::Horizontal);
+
+  ImagePixels pixels = image.getPixels();
+  for (int x=0; x<256; ++x) {
+    EXPECT_PIXEL(pixels, x, 0, x, 0, x);
+    EXPECT_PIXEL(pixels, x, 1, x, 0, x);
+  }
+}
+
+TEST(Gradient, Time)
+{
+  ImagePixels pixels(1024, 1024);
+  Gradient gradient(Color(0, 0, 0), Color(255, 255, 255));
+  gradient.addStop(0.3, Color(255, 0, 0));
+  gradient.setDithering(true);
+
+  for (int i=0; i<2; ++i) {
+    Orientation orientation = (i == 0 ? Orientation::Horizontal:
+					Orientation::Vertical);
+    TimePoint start;
+    for (int c=0; c<20; ++c)
+      gradient.fillRect(pixels, Rect(0, 0, 1024, 1024), orientation);
+
+    double seconds = start.elapsed();
+    std::printf("%s: %.1f megapixels per second\n",
+		i == 0 ? "horizontal": "vertical",
+		20.0 * 1024 * 1024 / seconds / 1e6);
+  }
+}
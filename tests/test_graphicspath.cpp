@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Vaca/Color.h"
+#include "Vaca/Graphics.h"
+#include "Vaca/GraphicsPath.h"
+#include "Vaca/Image.h"
+#include "Vaca/Pen.h"
+#include "Vaca/Region.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+TEST(GraphicsPath, LinesAreNotModified)
+{
+  GraphicsPath path;
+  path.moveTo(10, 10).lineTo(20, 10).lineTo(20, 20).closeFigure();
+
+  const GraphicsPath::Polylines& polylines = path.getPolylines();
+  ASSERT_EQ(1, polylines.getFigureCount());
+  ASSERT_EQ(3, polylines.getFigureSizes()[0]);
+  EXPECT_TRUE(polylines.isFigureClosed(0));
+  EXPECT_EQ(Point(10, 10), polylines.getPoints()[0]);
+  EXPECT_EQ(Point(20, 10), polylines.getPoints()[1]);
+  EXPECT_EQ(Point(20, 20), polylines.getPoints()[2]);
+}
+
+TEST(GraphicsPath, AdaptiveCurves)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).curveTo(0, 200, 300, 200, 300, 0);
+
+  size_t fine = path.getPolylines(0.1).getPoints().size();
+  size_t coarse = path.getPolylines(2.0).getPoints().size();
+  EXPECT_GT(fine, coarse);
+  EXPECT_GT(coarse, 2u);
+
+  // the end points of the curve are always included
+  const std::vector<Point>& points = path.getPolylines().getPoints();
+  EXPECT_EQ(Point(0, 0), points.front());
+  EXPECT_EQ(Point(300, 0), points.back());
+
+  // middle point of the curve: B(0.5) = (150, 150)
+  bool found = false;
+  for (size_t i=0; i<points.size(); ++i)
+    if (std::abs(points[i].x-150) <= 1 && std::abs(points[i].y-150) <= 1)
+      found = true;
+  EXPECT_TRUE(found);
+}
+
+TEST(GraphicsPath, Cache)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).curveTo(0, 100, 100, 100, 100, 0);
+
+  const GraphicsPath::Polylines* polylines = &path.getPolylines();
+  std::vector<Point> points = polylines->getPoints();
+
+  // same tolerance, same result
+  EXPECT_EQ(points, path.getPolylines().getPoints());
+
+  // the cache is translated with the path
+  path.offset(5, 7);
+  ASSERT_EQ(points.size(), path.getPolylines().getPoints().size());
+  for (size_t i=0; i<points.size(); ++i)
+    EXPECT_EQ(points[i] + Point(5, 7), path.getPolylines().getPoints()[i]);
+
+  // new nodes invalidate the cache
+  path.lineTo(50, 50);
+  EXPECT_EQ(points.size()+1, path.getPolylines().getPoints().size());
+  EXPECT_EQ(Point(50, 50), path.getPolylines().getPoints().back());
+}
+
+TEST(GraphicsPath, Figures)
+{
+  GraphicsPath path;
+  path.lineTo(10, 0).lineTo(10, 10).closeFigure()
+    .moveTo(20, 20).lineTo(30, 20);
+
+  const GraphicsPath::Polylines& polylines = path.getPolylines();
+  ASSERT_EQ(2, polylines.getFigureCount());
+  EXPECT_EQ(3, polylines.getFigureSizes()[0]);
+  EXPECT_EQ(2, polylines.getFigureSizes()[1]);
+  EXPECT_TRUE(polylines.isFigureClosed(0));
+  EXPECT_FALSE(polylines.isFigureClosed(1));
+}
+
+TEST(GraphicsPath, Flatten)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).curveTo(0, 100, 100, 100, 100, 0).closeFigure();
+  path.flatten();
+
+  for (GraphicsPath::iterator it=path.begin(); it!=path.end(); ++it)
+    EXPECT_TRUE(it->getType() == GraphicsPath::MoveTo ||
+		it->getType() == GraphicsPath::LineTo);
+
+  EXPECT_TRUE((path.end()-1)->isCloseFigure());
+}
+
+TEST(GraphicsPath, ToRegion)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).curveTo(0, 100, 100, 100, 100, 0).closeFigure();
+
+  Region rgn = path.toRegion();
+  EXPECT_TRUE(rgn.contains(Point(50, 50)));
+  EXPECT_FALSE(rgn.contains(Point(50, 90)));
+  EXPECT_FALSE(rgn.contains(Point(-5, 10)));
+}
+
+TEST(GraphicsPath, Benchmark)
+{
+  // a path of 10k curves (like a map with many borders)
+  GraphicsPath path;
+  unsigned seed = 1;
+  path.moveTo(0, 0);
+  for (int i=0; i<10000; ++i) {
+    int pts[6];
+    for (int j=0; j<6; ++j) {
+      seed = seed*1103515245 + 12345;
+      pts[j] = (seed >> 8) % 1024;
+    }
+    path.curveTo(pts[0], pts[1], pts[2], pts[3], pts[4], pts[5]);
+  }
+
+  const int redraws = 20;
+  Image img(1024, 1024, 32);
+  Graphics& g = img.getGraphics();
+  Pen pen(Color(0, 0, 0));
+
+  // flattening without cache (a different tolerance each time)
+  TimePoint t;
+  for (int i=0; i<redraws; ++i)
+    path.getPolylines(0.25 + (i & 1) * 0.01);
+  double flatten = t.elapsed();
+
+  // the curves are tessellated by GDI on each redraw
+  t.reset();
+  for (int i=0; i<redraws; ++i) {
+    g.tracePath(path, Point(0, 0));
+    g.strokePath(pen);
+  }
+  double gdi = t.elapsed();
+
+  // the cached polylines are used
+  path.getPolylines();
+  t.reset();
+  for (int i=0; i<redraws; ++i)
+    g.strokePath(path, pen, Point(0, 0));
+  double cached = t.elapsed();
+
+  std::printf("%d curves, %u points\n",
+	      10000, static_cast<unsigned>(path.getPolylines().getPoints().size()));
+  std::printf("getPolylines without cache: %.2f ms per redraw\n", flatten*1000.0/redraws);
+  std::printf("strokePath with GDI curves: %.2f ms per redraw\n", gdi*1000.0/redraws);
+  std::printf("strokePath with cached polylines: %.2f ms per redraw\n", cached*1000.0/redraws);
+}
@@ -0,0 +1,743 @@
+#include <gtest/gtest.h>
+
+#ifdef _WIN32
+  #include <winsock2.h>
+  typedef SOCKET socket_t;
+  #define close_socket closesocket
+  typedef int socklen_t;
+#else
+  #include <sys/types.h>
+  #include <sys/socket.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
+  #include <arpa/inet.h>
+  #include <unistd.h>
+  typedef int socket_t;
+  #define close_socket close
+#endif
+
+#ifndef MSG_NOSIGNAL
+  #define MSG_NOSIGNAL 0
+#endif
+
+#ifdef VACA_ZLIB
+  #include <zlib.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Vaca/HttpClient.h"
+#include "Vaca/HttpBodyReader.h"
+#include "Vaca/Bind.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/Thread.h"
+#include "Vaca/TimePoint.h"
+
+using namespace std;
+using namespace Vaca;
+
+// ======================================================================
+// A stand-in HTTP server in the loopback interface
+//
+// Paths:
+//   /hello          "Hello"
+//   /n?X            "X" (to check the order of responses)
+//   /close          "Bye" and closes the connection
+//   /noclen         "Until close" without Content-Length
+//   /echo           the body of the request
+//   /data?N         N bytes of make_data()
+//   /chunked?N      the same with the chunked transfer encoding (and
+//                   a X-Trailer header)
+//   /gzip?N         the same compressed with gzip (and chunked)
+//   /deflate?N      the same compressed with deflate (zlib format)
+//   /rawdeflate?N   the same compressed with deflate (without header)
+//   /huge           headers with a Content-Length of 5 GB (no body)
+//   /badlength      an invalid Content-Length
+//   /badchunk       a chunk size that does not fit in 64 bits
+
+// Compressible data, but not trivial
+static string make_data(size_t size)
+{
+  string data(size, 0);
+  for (size_t i=0; i<size; ++i)
+    data[i] = "Vaca HTTP body "[(i ^ (i >> 9)) % 15];
+  return data;
+}
+
+#ifdef VACA_ZLIB
+static string compress_data(const string& data, int windowBits)
+{
+  z_stream z;
+  memset(&z, 0, sizeof(z));
+  deflateInit2(&z, Z_BEST_SPEED, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+
+  string output(deflateBound(&z, (uLong)data.size()), 0);
+  z.next_in = (Bytef*)data.data();
+  z.avail_in = (uInt)data.size();
+  z.next_out = (Bytef*)&output[0];
+  z.avail_out = (uInt)output.size();
+  deflate(&z, Z_FINISH);
+  output.resize(z.total_out);
+  deflateEnd(&z);
+  return output;
+}
+#endif
+
+class TestServer
+{
+  socket_t m_listener;
+  int m_port;
+  Thread* m_thread;
+  Mutex m_mutex;
+  vector<Thread*> m_clients;
+  int m_connections;
+  bool m_stop;
+  map<string, string> m_bodies;	// cache of /data, /chunked, etc.
+
+public:
+
+  TestServer() : m_connections(0), m_stop(false) {
+#ifdef _WIN32
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+    m_listener = socket(AF_INET, SOCK_STREAM, 0);
+
+    int on = 1;
+    setsockopt(m_listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(m_listener, (sockaddr*)&addr, sizeof(addr));
+    getsockname(m_listener, (sockaddr*)&addr, &len);
+    listen(m_listener, 64);
+    m_port = ntohs(addr.sin_port);
+
+    m_thread = new Thread(Bind<void>(&TestServer::acceptLoop, this));
+  }
+
+  ~TestServer() {
+    {
+      ScopedLock hold(m_mutex);
+      m_stop = true;
+    }
+    // wake up the accept()
+    socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = address();
+    connect(s, (sockaddr*)&addr, sizeof(addr));
+    close_socket(s);
+
+    m_thread->join();
+    delete m_thread;
+    close_socket(m_listener);
+
+    for (size_t i=0; i<m_clients.size(); ++i) {
+      m_clients[i]->join();
+      delete m_clients[i];
+    }
+  }
+
+  String url(const char* path) const {
+    char buf[256];
+    sprintf(buf, "http://127.0.0.1:%d%s", m_port, path);
+    return String(buf, buf+strlen(buf));
+  }
+
+  int getConnections() {
+    ScopedLock hold(m_mutex);
+    return m_connections;
+  }
+
+  sockaddr_in address() const {
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(m_port);
+    return addr;
+  }
+
+private:
+
+  void acceptLoop() {
+    for (;;) {
+      socket_t s = accept(m_listener, NULL, NULL);
+      ScopedLock hold(m_mutex);
+      if (m_stop) {
+	close_socket(s);
+	break;
+      }
+      ++m_connections;
+
+      // pipelined responses are sent without waiting ACKs
+      int on = 1;
+      setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+
+      m_clients.push_back(new Thread(Bind<void>(&TestServer::serve, this, s)));
+    }
+  }
+
+  static void send_all(socket_t s, const string& data) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+      int bytes = send(s, data.data()+pos, (int)(data.size()-pos), MSG_NOSIGNAL);
+      if (bytes <= 0)
+	break;
+      pos += bytes;
+    }
+  }
+
+  static void reply(socket_t s, const string& body, const char* extraHeaders = "") {
+    char buf[256];
+    sprintf(buf, "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n%s\r\n",
+	    (int)body.size(), extraHeaders);
+    send_all(s, buf);
+    send_all(s, body);
+  }
+
+  // Sends a body already encoded with chunks (see chunked())
+  static void reply_chunked(socket_t s, const string& chunks, const char* extraHeaders = "") {
+    char buf[256];
+    sprintf(buf, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n%s\r\n",
+	    extraHeaders);
+    send_all(s, buf);
+    send_all(s, chunks);
+  }
+
+  // Encodes the body in chunks of different sizes
+  static string chunked(const string& body) {
+    const size_t sizes[] = { 1, 100, 4096, 16384, 65536 };
+    string data;
+
+    for (size_t pos=0, i=0; pos < body.size(); ++i) {
+      size_t size = sizes[i % 5];
+      if (size > body.size() - pos)
+	size = body.size() - pos;
+
+      char buf[32];
+      sprintf(buf, "%x;ext=1\r\n", (int)size);
+      data += buf;
+      data.append(body, pos, size);
+      data += "\r\n";
+      pos += size;
+    }
+    data += "0\r\nX-Trailer: done\r\n\r\n";
+    return data;
+  }
+
+  const string& cachedBody(const string& name, size_t size) {
+    ScopedLock hold(m_mutex);
+    char key[64];
+    sprintf(key, "%s?%lu", name.c_str(), (unsigned long)size);
+
+    if (m_bodies.find(key) == m_bodies.end()) {
+      string data = make_data(size);
+#ifdef VACA_ZLIB
+      if (name == "/gzip") data = compress_data(data, 15+16);
+      else if (name == "/deflate") data = compress_data(data, 15);
+      else if (name == "/rawdeflate") data = compress_data(data, -15);
+#endif
+      if (name == "/chunked" || name == "/gzip")
+	data = chunked(data);
+      m_bodies[key] = data;
+    }
+    return m_bodies[key];
+  }
+
+  void serve(socket_t s) {
+    string input;
+    char buf[4096];
+
+    for (;;) {
+      // read the whole request (several ones could be pipelined)
+      size_t end = input.find("\r\n\r\n");
+      if (end == string::npos) {
+	int bytes = recv(s, buf, sizeof(buf), 0);
+	if (bytes <= 0)
+	  break;
+	input.append(buf, bytes);
+	continue;
+      }
+
+      size_t contentLength = 0;
+      size_t clen = input.find("Content-Length: ");
+      if (clen != string::npos && clen < end)
+	contentLength = atoi(input.c_str() + clen + 16);
+
+      while (input.size() < end+4+contentLength) {
+	int bytes = recv(s, buf, sizeof(buf), 0);
+	if (bytes <= 0)
+	  break;
+	input.append(buf, bytes);
+      }
+
+      string request = input.substr(0, end+4);
+      string body = input.substr(end+4, contentLength);
+      input.erase(0, end+4+contentLength);
+
+      string path = request.substr(request.find(' ')+1);
+      path = path.substr(0, path.find(' '));
+
+      string name = path.substr(0, path.find('?'));
+      size_t size = 0;
+      if (name != path)
+	size = strtoul(path.c_str() + name.size() + 1, NULL, 10);
+
+      if (path == "/hello")
+	reply(s, "Hello");
+      else if (path.compare(0, 3, "/n?") == 0)
+	reply(s, path.substr(3));
+      else if (path == "/echo")
+	reply(s, body);
+      else if (name == "/data")
+	reply(s, cachedBody(name, size));
+      else if (name == "/chunked")
+	reply_chunked(s, cachedBody(name, size));
+      else if (name == "/gzip")
+	reply_chunked(s, cachedBody(name, size), "Content-Encoding: gzip\r\n");
+      else if (name == "/deflate" || name == "/rawdeflate")
+	reply(s, cachedBody(name, size), "Content-Encoding: deflate\r\n");
+      else if (path == "/close") {
+	reply(s, "Bye", "Connection: close\r\n");
+	break;
+      }
+      else if (path == "/huge") {
+	send_all(s, "HTTP/1.1 200 OK\r\nContent-Length: 5000000000\r\n\r\n");
+	break;
+      }
+      else if (path == "/badlength") {
+	send_all(s, "HTTP/1.1 200 OK\r\nContent-Length: 12abc\r\n\r\n");
+	break;
+      }
+      else if (path == "/badchunk") {
+	send_all(s, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+		 "10000000000000000\r\n");
+	break;
+      }
+      else if (path == "/noclen") {
+	send_all(s, "HTTP/1.1 200 OK\r\n\r\nUntil close");
+	break;
+      }
+      else {
+	send_all(s, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+      }
+    }
+    close_socket(s);
+  }
+
+};
+
+// ======================================================================
+
+struct Collect
+{
+  vector<HttpResponse>* responses;
+  Collect(vector<HttpResponse>* responses) : responses(responses) { }
+  void operator()(const HttpResponse& response) const {
+    responses->push_back(response);
+  }
+};
+
+// the callbacks are called from the message queue of this thread
+static void wait_responses(vector<HttpResponse>& responses, size_t n)
+{
+  while (responses.size() < n) {
+    CurrentThread::pumpMessageQueue();
+    CurrentThread::yield();
+  }
+}
+
+TEST(HttpClient, Get)
+{
+  TestServer server;
+  HttpClient client(1, 1);	// in order
+  vector<HttpResponse> responses;
+
+  client.get(server.url("/hello"), Collect(&responses));
+  client.get(server.url("/missing"), Collect(&responses));
+  wait_responses(responses, 2);
+
+  EXPECT_EQ(200, responses[0].getStatusCode());
+  EXPECT_EQ(L"", responses[0].getError());
+  EXPECT_EQ("Hello", responses[0].getBody());
+  EXPECT_TRUE(responses[0].hasHeader(L"content-length"));
+  EXPECT_EQ(L"5", responses[0].getHeader(L"Content-Length"));
+  EXPECT_EQ(404, responses[1].getStatusCode());
+  EXPECT_EQ(0, client.getPendingCount());
+}
+
+TEST(HttpClient, KeepAlive)
+{
+  TestServer server;
+  HttpClient client(1, 1);
+  vector<HttpResponse> responses;
+
+  for (int i=0; i<20; ++i) {
+    client.get(server.url("/hello"), Collect(&responses));
+    wait_responses(responses, i+1);
+    EXPECT_EQ("Hello", responses[i].getBody());
+  }
+
+  HttpClientStats stats = client.getStats();
+  EXPECT_EQ(1, server.getConnections());
+  EXPECT_EQ(1, stats.connections);
+  EXPECT_EQ(20, stats.requests);
+  EXPECT_EQ(19, stats.reused);
+  EXPECT_EQ(0, stats.pipelined);
+}
+
+TEST(HttpClient, Pipelining)
+{
+  TestServer server;
+  HttpClient client(1, 8);
+  vector<HttpResponse> responses;
+  const int n = 100;
+
+  for (int i=0; i<n; ++i) {
+    char path[32];
+    sprintf(path, "/n?%d", i);
+    client.get(server.url(path), Collect(&responses));
+  }
+  wait_responses(responses, n);
+
+  // one connection, so the responses come in order
+  for (int i=0; i<n; ++i) {
+    char body[32];
+    sprintf(body, "%d", i);
+    EXPECT_EQ(body, responses[i].getBody());
+  }
+
+  HttpClientStats stats = client.getStats();
+  EXPECT_EQ(1, server.getConnections());
+  EXPECT_GT(stats.pipelined, 0);
+}
+
+TEST(HttpClient, ConnectionClose)
+{
+  TestServer server;
+  HttpClient client(2, 4);
+  vector<HttpResponse> responses;
+
+  for (int i=0; i<10; ++i)
+    client.get(server.url(i & 1 ? "/close": "/noclen"), Collect(&responses));
+  wait_responses(responses, 10);
+
+  for (int i=0; i<10; ++i) {
+    EXPECT_EQ(200, responses[i].getStatusCode());
+    EXPECT_TRUE(responses[i].getBody() == "Bye" ||
+		responses[i].getBody() == "Until close");
+  }
+  EXPECT_EQ(10, server.getConnections());
+}
+
+TEST(HttpClient, Post)
+{
+  TestServer server;
+  HttpClient client(1, 1);	// in order
+  vector<HttpResponse> responses;
+  string body(100000, 'x');
+
+  client.post(server.url("/echo"), body, Collect(&responses));
+  client.post(server.url("/echo"), "", Collect(&responses));
+  wait_responses(responses, 2);
+
+  EXPECT_EQ(body, responses[0].getBody());
+  EXPECT_EQ("", responses[1].getBody());
+}
+
+TEST(HttpClient, Errors)
+{
+  int port;
+  {
+    TestServer server;
+    port = server.address().sin_port;
+  }
+
+  HttpClient client;
+  vector<HttpResponse> responses;
+  char url[64];
+  sprintf(url, "http://127.0.0.1:%d/", ntohs(port));
+
+  client.get(String(url, url+strlen(url)), Collect(&responses));
+  client.get(L"https://127.0.0.1/", Collect(&responses));
+  wait_responses(responses, 2);
+
+  EXPECT_EQ(0, responses[0].getStatusCode());
+  EXPECT_NE(L"", responses[0].getError());
+  EXPECT_EQ(0, responses[1].getStatusCode());
+  EXPECT_NE(L"", responses[1].getError());
+}
+
+TEST(HttpClient, Benchmark)
+{
+  const int n = 2000;
+  const struct {
+    const char* name;
+    const char* path;
+    int connections, depth;
+  } cases[] = {
+    { "new connection each one", "/close", 4, 1 },
+    { "keep-alive",              "/hello", 4, 1 },
+    { "keep-alive + pipelining", "/hello", 4, 8 },
+  };
+
+  TestServer server;
+  std::printf("%-26s %12s %12s\n", "", "requests/s", "connections");
+
+  for (int i=0; i<3; ++i) {
+    HttpClient client(cases[i].connections, cases[i].depth);
+    vector<HttpResponse> responses;
+    responses.reserve(n);
+
+    TimePoint t;
+    for (int j=0; j<n; ++j)
+      client.get(server.url(cases[i].path), Collect(&responses));
+    wait_responses(responses, n);
+    double elapsed = t.elapsed();
+
+    int ok = 0;
+    for (int j=0; j<n; ++j)
+      if (responses[j].getStatusCode() == 200)
+	++ok;
+    EXPECT_EQ(n, ok);
+
+    std::printf("%-26s %12.0f %12lu\n", cases[i].name, n / elapsed,
+		client.getStats().connections);
+  }
+}
+
+TEST(HttpClient, Chunked)
+{
+  TestServer server;
+  HttpClient client(1, 4);
+  vector<HttpResponse> responses;
+  const size_t sizes[] = { 0, 1, 5000, 100000, 300000 };
+
+  for (int i=0; i<5; ++i) {
+    char path[32];
+    sprintf(path, "/chunked?%d", (int)sizes[i]);
+    client.get(server.url(path), Collect(&responses));
+  }
+  client.get(server.url("/hello"), Collect(&responses));
+  wait_responses(responses, 6);
+
+  for (int i=0; i<5; ++i) {
+    EXPECT_EQ(200, responses[i].getStatusCode());
+    EXPECT_EQ(-1, responses[i].getContentLength());
+    EXPECT_TRUE(make_data(sizes[i]) == responses[i].getBody());
+    EXPECT_EQ(L"done", responses[i].getHeader(L"X-Trailer"));
+  }
+  EXPECT_EQ("Hello", responses[5].getBody());
+  EXPECT_EQ(5, responses[5].getContentLength());
+  EXPECT_EQ(1, server.getConnections());
+}
+
+TEST(HttpClient, BodyReaders)
+{
+  TestServer server;
+  HttpClient client;
+  vector<HttpResponse> responses;
+  string expected = make_data(200000);
+
+  vector<char> memory(expected.size());
+  HttpMemoryWriter memoryWriter(&memory[0], memory.size());
+
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file != NULL);
+  HttpFileWriter fileWriter(fileno(file));
+
+  client.get(server.url("/data?200000"), &memoryWriter, Collect(&responses));
+  client.get(server.url("/chunked?200000"), &fileWriter, Collect(&responses));
+  wait_responses(responses, 2);
+
+  EXPECT_EQ(200, responses[0].getStatusCode());
+  EXPECT_EQ(200, responses[1].getStatusCode());
+  EXPECT_EQ("", responses[0].getBody());
+  EXPECT_EQ("", responses[1].getBody());
+
+  ASSERT_EQ(expected.size(), memoryWriter.getSize());
+  EXPECT_TRUE(expected == string(memoryWriter.getData(), memoryWriter.getSize()));
+
+  ASSERT_EQ(expected.size(), fileWriter.getSize());
+  string content(expected.size(), 0);
+  rewind(file);
+  EXPECT_EQ(expected.size(), fread(&content[0], 1, content.size(), file));
+  EXPECT_TRUE(expected == content);
+  fclose(file);
+}
+
+TEST(HttpClient, CancelByReader)
+{
+  TestServer server;
+  HttpClient client(1, 1);
+  vector<HttpResponse> responses;
+  char memory[1000];
+  HttpMemoryWriter writer(memory, sizeof(memory));
+
+  // rejected by the Content-Length, and when the chunks overflow the memory
+  client.get(server.url("/data?5000"), &writer, Collect(&responses));
+  client.get(server.url("/chunked?5000"), &writer, Collect(&responses));
+  client.get(server.url("/chunked?1000"), &writer, Collect(&responses));
+  wait_responses(responses, 3);
+
+  EXPECT_EQ(0, responses[0].getStatusCode());
+  EXPECT_NE(L"", responses[0].getError());
+  EXPECT_EQ(0, responses[1].getStatusCode());
+  EXPECT_NE(L"", responses[1].getError());
+  EXPECT_EQ(200, responses[2].getStatusCode());
+  EXPECT_EQ(1000, writer.getSize());
+  EXPECT_TRUE(make_data(1000) == string(memory, 1000));
+
+  EXPECT_EQ(2, client.getStats().canceled);
+  EXPECT_EQ(3, server.getConnections());
+}
+
+// Keeps the Content-Length of the response and rejects the body
+struct LengthReader : public HttpBodyReader
+{
+  long long length;
+  LengthReader() : length(0) { }
+  virtual bool onResponse(const HttpResponse& response) {
+    length = response.getContentLength();
+    return false;
+  }
+  virtual bool onData(const char*, size_t) { return false; }
+};
+
+TEST(HttpClient, BigLengths)
+{
+  TestServer server;
+  HttpClient client(1, 1);
+  vector<HttpResponse> responses;
+  LengthReader reader;
+
+  // more than 32 bits
+  client.get(server.url("/huge"), &reader, Collect(&responses));
+  wait_responses(responses, 1);
+  EXPECT_EQ(5000000000LL, reader.length);
+
+  client.get(server.url("/badlength"), Collect(&responses));
+  client.get(server.url("/badchunk"), Collect(&responses));
+  client.get(server.url("/hello"), Collect(&responses));
+  wait_responses(responses, 4);
+
+  EXPECT_EQ(0, responses[1].getStatusCode());
+  EXPECT_NE(L"", responses[1].getError());
+  EXPECT_EQ(0, responses[2].getStatusCode());
+  EXPECT_NE(L"", responses[2].getError());
+  EXPECT_EQ("Hello", responses[3].getBody());
+}
+
+#ifdef VACA_ZLIB
+
+TEST(HttpClient, Compressed)
+{
+  TestServer server;
+  HttpClient client;
+  vector<HttpResponse> responses;
+  string expected = make_data(500000);
+
+  client.get(server.url("/gzip?500000"), Collect(&responses));
+  client.get(server.url("/deflate?500000"), Collect(&responses));
+  client.get(server.url("/rawdeflate?500000"), Collect(&responses));
+  wait_responses(responses, 3);
+
+  for (int i=0; i<3; ++i) {
+    EXPECT_EQ(200, responses[i].getStatusCode());
+    EXPECT_EQ(expected.size(), responses[i].getBody().size());
+    EXPECT_TRUE(expected == responses[i].getBody());
+  }
+  EXPECT_LT(responses[1].getContentLength(), (long long)expected.size());
+}
+
+#endif
+
+namespace throughput {
+
+  struct Result
+  {
+    int statusCode;
+    size_t size;
+  };
+
+  struct Done
+  {
+    Result* result;
+    Done(Result* result) : result(result) { }
+    void operator()(const HttpResponse& response) const {
+      result->statusCode = response.getStatusCode();
+      result->size = response.getBody().size();
+    }
+  };
+
+  TEST(HttpClient, Throughput)
+  {
+    const size_t size = 64*1024*1024;
+    const struct {
+      const char* name;
+      const char* path;
+      int reader;		// 0 = getBody, 1 = memory, 2 = file
+    } cases[] = {
+      { "Content-Length, getBody()", "/data", 0 },
+      { "Content-Length, memory",    "/data", 1 },
+      { "Content-Length, file",      "/data", 2 },
+      { "chunked, getBody()",        "/chunked", 0 },
+      { "chunked, memory",           "/chunked", 1 },
+#ifdef VACA_ZLIB
+      { "gzip, memory",              "/gzip", 1 },
+#endif
+    };
+
+    TestServer server;
+    HttpClient client;
+    vector<char> memory(size);
+
+    std::printf("%-26s %10s\n", "", "MB/s");
+    for (size_t i=0; i<sizeof(cases)/sizeof(cases[0]); ++i) {
+      char path[64];
+      sprintf(path, "%s?%lu", cases[i].path, (unsigned long)size);
+
+      // the first request fills the cache of the server
+      {
+	Result result = { 0, 0 };
+	client.get(server.url(path), Done(&result));
+	while (result.statusCode == 0)
+	  CurrentThread::pumpMessageQueue();
+      }
+
+      HttpMemoryWriter memoryWriter(&memory[0], memory.size());
+      FILE* file = tmpfile();
+      HttpFileWriter fileWriter(fileno(file));
+      HttpBodyReader* readers[] = { NULL, &memoryWriter, &fileWriter };
+
+      Result result = { 0, 0 };
+      TimePoint t;
+      client.get(server.url(path), readers[cases[i].reader], Done(&result));
+      while (result.statusCode == 0) {
+	CurrentThread::pumpMessageQueue();
+	CurrentThread::yield();
+      }
+      double elapsed = t.elapsed();
+      fclose(file);
+
+      EXPECT_EQ(200, result.statusCode);
+      switch (cases[i].reader) {
+	case 0: EXPECT_EQ(size, result.size); break;
+	case 1: EXPECT_EQ(size, memoryWriter.getSize()); break;
+	case 2: EXPECT_EQ(size, fileWriter.getSize()); break;
+      }
+
+      std::printf("%-26s %10.1f\n", cases[i].name, size / elapsed / (1024*1024));
+    }
+  }
+
+}
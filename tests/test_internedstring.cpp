@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <vector>
+
+#include "Vaca/Component.h"
+#include "Vaca/InternedString.h"
+#include "Vaca/Property.h"
+#include "Vaca/SharedPtr.h"
+#include "Vaca/String.h"
+#include "Vaca/TreeNode.h"
+
+using namespace Vaca;
+
+// Counts the bytes allocated by the test
+static size_t allocated_bytes = 0;
+
+void* operator new(size_t size)
+{
+  allocated_bytes += size;
+  void* ptr = std::malloc(size ? size: 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) throw()
+{
+  std::free(ptr);
+}
+
+TEST(InternedString, Basic)
+{
+  InternedString a, b(L""), c(L"Open"), d(String(L"Open")), e(StringView(L"Opened", 4));
+
+  EXPECT_TRUE(a.empty());
+  EXPECT_TRUE(a == b);
+  EXPECT_EQ(L"", a.str());
+
+  EXPECT_TRUE(c == d);
+  EXPECT_TRUE(c == e);
+  EXPECT_TRUE(c != a);
+  EXPECT_EQ(4, c.size());
+  EXPECT_EQ(L"Open", c.str());
+  EXPECT_EQ(0, std::wcscmp(L"Open", c.c_str()));
+  EXPECT_EQ(c.hash(), d.hash());
+  EXPECT_TRUE(c.view() == L"Open");
+
+  InternedString f(L"Close");
+  EXPECT_TRUE(c != f);
+  EXPECT_TRUE(f < c);
+  EXPECT_FALSE(c < f);
+  EXPECT_TRUE(InternedString(L"Op") < c);
+  EXPECT_TRUE(a < f);
+  EXPECT_EQ(0, c.compare(d));
+}
+
+TEST(InternedString, MapKeys)
+{
+  std::map<InternedString, int> map;
+  map[L"Width"] = 1;
+  map[L"Height"] = 2;
+  map[String(L"Width")] = 3;
+
+  EXPECT_EQ(2, map.size());
+  EXPECT_EQ(3, map[L"Width"]);
+  EXPECT_EQ(2, map[L"Height"]);
+
+  // sorted by name
+  map[L"Alpha"] = 4;
+  map[L"Zeta"] = 5;
+  std::map<InternedString, int>::iterator it = map.begin();
+  EXPECT_EQ(L"Alpha", (it++)->first.str());
+  EXPECT_EQ(L"Height", (it++)->first.str());
+  EXPECT_EQ(L"Width", (it++)->first.str());
+  EXPECT_EQ(L"Zeta", (it++)->first.str());
+}
+
+TEST(InternedString, Release)
+{
+  size_t count = InternedString::getPoolCount();
+  {
+    InternedString a(L"A temporary string");
+    InternedString b(a), c(L"A temporary string");
+    EXPECT_EQ(count+1, InternedString::getPoolCount());
+
+    a = InternedString(L"Another temporary string");
+    EXPECT_EQ(count+2, InternedString::getPoolCount());
+    b = a;
+    EXPECT_EQ(count+2, InternedString::getPoolCount());
+    c = InternedString();
+    EXPECT_EQ(count+1, InternedString::getPoolCount());
+  }
+  EXPECT_EQ(count, InternedString::getPoolCount());
+}
+
+TEST(InternedString, Find)
+{
+  size_t count = InternedString::getPoolCount();
+  InternedString result;
+
+  EXPECT_FALSE(InternedString::find(L"Not in the pool", result));
+  EXPECT_EQ(count, InternedString::getPoolCount());
+
+  {
+    InternedString str(L"In the pool");
+    EXPECT_TRUE(InternedString::find(L"In the pool", result));
+    EXPECT_TRUE(result == str);
+  }
+  // "result" keeps the string in the pool
+  EXPECT_EQ(count+1, InternedString::getPoolCount());
+  EXPECT_EQ(L"In the pool", result.str());
+
+  EXPECT_TRUE(InternedString::find(L"", result));
+  EXPECT_TRUE(result.empty());
+  EXPECT_EQ(count, InternedString::getPoolCount());
+}
+
+TEST(InternedString, ManyStrings)
+{
+  const int n = 20000;
+  std::vector<InternedString> strings;
+  for (int i=0; i<n; ++i)
+    strings.push_back(L"String " + convert_to<String>(i));
+
+  // a big one, outside the blocks
+  String big(100000, L'x');
+  InternedString bigA(big), bigB(big);
+  EXPECT_TRUE(bigA == bigB);
+  EXPECT_EQ(big, bigA.str());
+
+  for (int i=0; i<n; ++i) {
+    InternedString str(L"String " + convert_to<String>(i));
+    ASSERT_TRUE(str == strings[i]);
+    ASSERT_EQ(L"String " + convert_to<String>(i), str.str());
+  }
+
+  // remove the strings in a different order than they were added,
+  // the others must be found yet
+  size_t count = InternedString::getPoolCount();
+  for (int i=0; i<n; i += 3)
+    strings[i] = InternedString();
+  EXPECT_EQ(count - (n+2)/3, InternedString::getPoolCount());
+  for (int i=0; i<n; ++i) {
+    InternedString str;
+    ASSERT_EQ(i % 3 != 0, InternedString::find(L"String " + convert_to<String>(i), str));
+    if (i % 3 != 0)
+      ASSERT_TRUE(str == strings[i]);
+  }
+}
+
+TEST(InternedString, ComponentProperties)
+{
+  Component component;
+  component.setProperty(PropertyPtr(new Property(L"Width")));
+  component.setProperty(PropertyPtr(new Property(L"Alpha")));
+  component.setProperty(PropertyPtr(new Property(L"Height")));
+
+  EXPECT_TRUE(component.hasProperty(L"Width"));
+  EXPECT_EQ(L"Alpha", component.getProperty(L"Alpha")->getName());
+
+  // looking for names does not add them to the pool
+  size_t count = InternedString::getPoolCount();
+  EXPECT_FALSE(component.hasProperty(L"A property that nobody has"));
+  EXPECT_EQ(NULL, component.getProperty(L"Another property").get());
+  component.removeProperty(L"Yet another property");
+  EXPECT_EQ(count, InternedString::getPoolCount());
+
+  // sorted by name
+  const Component::Properties& properties = component.getProperties();
+  Component::Properties::const_iterator it = properties.begin();
+  EXPECT_EQ(L"Alpha", (it++)->first.str());
+  EXPECT_EQ(L"Height", (it++)->first.str());
+  EXPECT_EQ(L"Width", (it++)->first.str());
+
+  component.removeProperty(L"Height");
+  EXPECT_FALSE(component.hasProperty(L"Height"));
+  EXPECT_EQ(2, properties.size());
+}
+
+// A tree of 100k TreeNodes where the labels repeat (like the
+// folders of a file system)
+static String node_label(int i)
+{
+  static const Char* names[] = { L"Documents", L"Pictures", L"Music", L"Settings",
+				 L"Application Data", L"readme.txt", L"Makefile" };
+  return String(names[i % 7]) + L" " + convert_to<String>(i % 50);
+}
+
+static TreeNode* create_tree(int& count, int depth)
+{
+  TreeNode* node = new TreeNode(node_label(count++));
+  for (int i=0; i<10 && depth > 0 && count < 100000; ++i)
+    node->addNode(create_tree(count, depth-1));
+  return node;
+}
+
+TEST(InternedString, TreeMemory)
+{
+  // a real tree of TreeNodes
+  size_t bytes = allocated_bytes;
+  size_t poolBefore = InternedString::getPoolBytes();
+  int count = 0;
+  TreeNode* root = create_tree(count, 5);
+  size_t poolBytes = InternedString::getPoolBytes() - poolBefore;
+  size_t treeBytes = allocated_bytes - bytes + poolBytes;
+
+  EXPECT_EQ(100000, count);
+  EXPECT_EQ(node_label(0), root->getText());
+  EXPECT_EQ(node_label(1), root->getChildren()[0]->getText());
+
+  // the same labels stored in Strings
+  std::vector<String> strings;
+  strings.reserve(count);
+  bytes = allocated_bytes;
+  for (int i=0; i<count; ++i)
+    strings.push_back(node_label(i));
+  size_t stringBytes = count * sizeof(String) + (allocated_bytes - bytes);
+  size_t internedBytes = count * sizeof(InternedString) + poolBytes;
+
+  std::printf("%d TreeNodes: %u bytes, labels: %u bytes "
+	      "(%u bytes if they were Strings)\n",
+	      count,
+	      static_cast<unsigned>(treeBytes),
+	      static_cast<unsigned>(internedBytes),
+	      static_cast<unsigned>(stringBytes));
+  EXPECT_LT(internedBytes, stringBytes / 4);
+
+  delete root;
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <new>
+
+#include "Vaca/LruCache.h"
+#include "Vaca/TextLayoutCache.h"
+#include "Vaca/Size.h"
+#include "Vaca/String.h"
+
+using namespace Vaca;
+
+// Counts the allocations of the test
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+  ++allocations;
+  void* ptr = std::malloc(size ? size: 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) throw()
+{
+  std::free(ptr);
+}
+
+static bool is_odd(const int& key, const int&)
+{
+  return (key & 1) != 0;
+}
+
+TEST(LruCache, FindAndInsert)
+{
+  LruCache<int, int> cache(3);
+  EXPECT_TRUE(cache.empty());
+  EXPECT_TRUE(cache.find(1) == NULL);
+
+  cache.insert(1, 10);
+  cache.insert(2, 20);
+  ASSERT_TRUE(cache.find(1) != NULL);
+  EXPECT_EQ(10, *cache.find(1));
+  EXPECT_EQ(20, *cache.find(2));
+  EXPECT_EQ(2u, cache.size());
+
+  // replace
+  cache.insert(2, 21);
+  EXPECT_EQ(21, *cache.find(2));
+  EXPECT_EQ(2u, cache.size());
+
+  EXPECT_EQ(4u, cache.getHits());
+  EXPECT_EQ(1u, cache.getMisses());
+}
+
+TEST(LruCache, LeastRecentlyUsedIsEvicted)
+{
+  LruCache<int, int> cache(3);
+  cache.insert(1, 10);
+  cache.insert(2, 20);
+  cache.insert(3, 30);
+
+  // now 2 is the least recently used
+  cache.find(1);
+  cache.insert(4, 40);
+
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ(1u, cache.getEvictions());
+  EXPECT_TRUE(cache.find(2) == NULL);
+  EXPECT_TRUE(cache.find(1) != NULL);
+  EXPECT_TRUE(cache.find(3) != NULL);
+  EXPECT_TRUE(cache.find(4) != NULL);
+}
+
+TEST(LruCache, Cost)
+{
+  LruCache<int, int> cache(10);
+  EXPECT_TRUE(cache.insert(1, 10, 4));
+  EXPECT_TRUE(cache.insert(2, 20, 4));
+  EXPECT_EQ(8u, cache.getCost());
+
+  // too big
+  EXPECT_FALSE(cache.insert(3, 30, 11));
+  EXPECT_EQ(2u, cache.size());
+
+  // 1 is evicted
+  EXPECT_TRUE(cache.insert(3, 30, 5));
+  EXPECT_EQ(9u, cache.getCost());
+  EXPECT_TRUE(cache.find(1) == NULL);
+
+  cache.setCapacity(5);
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_TRUE(cache.find(3) != NULL);
+
+  cache.clear();
+  EXPECT_EQ(0u, cache.getCost());
+  EXPECT_TRUE(cache.empty());
+}
+
+TEST(LruCache, EraseIf)
+{
+  LruCache<int, int> cache(100);
+  for (int i=0; i<10; ++i)
+    cache.insert(i, i*10);
+
+  EXPECT_EQ(5u, cache.eraseIf(&is_odd));
+  EXPECT_EQ(5u, cache.size());
+  EXPECT_TRUE(cache.find(3) == NULL);
+  EXPECT_TRUE(cache.erase(4));
+  EXPECT_FALSE(cache.erase(4));
+  EXPECT_EQ(4u, cache.getCost());
+}
+
+TEST(TextLayoutCache, Measures)
+{
+  HFONT font1 = reinterpret_cast<HFONT>(1);
+  HFONT font2 = reinterpret_cast<HFONT>(2);
+  Size size;
+
+  TextLayoutCache::clear();
+  TextLayoutCache::resetStats();
+
+  EXPECT_FALSE(TextLayoutCache::find(font1, L"Hello", 100, 0, size));
+  TextLayoutCache::insert(font1, L"Hello", 100, 0, Size(30, 12));
+  TextLayoutCache::insert(font2, L"Hello", 100, 0, Size(40, 16));
+
+  EXPECT_TRUE(TextLayoutCache::find(font1, L"Hello", 100, 0, size));
+  EXPECT_EQ(Size(30, 12), size);
+  EXPECT_TRUE(TextLayoutCache::find(font2, L"Hello", 100, 0, size));
+  EXPECT_EQ(Size(40, 16), size);
+
+  // every part of the key is important
+  EXPECT_FALSE(TextLayoutCache::find(font1, L"Hello", 50, 0, size));
+  EXPECT_FALSE(TextLayoutCache::find(font1, L"Hello", 100, 1, size));
+  EXPECT_FALSE(TextLayoutCache::find(font1, L"Hellp", 100, 0, size));
+
+  EXPECT_EQ(2u, TextLayoutCache::getHits());
+  EXPECT_EQ(4u, TextLayoutCache::getMisses());
+  EXPECT_EQ(2u, TextLayoutCache::getEntryCount());
+
+  // destroyed fonts are removed
+  TextLayoutCache::removeFont(font1);
+  EXPECT_FALSE(TextLayoutCache::find(font1, L"Hello", 100, 0, size));
+  EXPECT_TRUE(TextLayoutCache::find(font2, L"Hello", 100, 0, size));
+}
+
+TEST(TextLayoutCache, MemoryBudget)
+{
+  HFONT font = reinterpret_cast<HFONT>(1);
+  size_t oldBudget = TextLayoutCache::getMemoryBudget();
+
+  TextLayoutCache::clear();
+  TextLayoutCache::setMemoryBudget(4096);
+
+  for (int i=0; i<1000; ++i)
+    TextLayoutCache::insert(font, format_string(L"Item %d", i), 100, 0, Size(i, 10));
+
+  EXPECT_LE(TextLayoutCache::getMemoryUsage(), 4096u);
+  EXPECT_GT(TextLayoutCache::getEntryCount(), 0u);
+  EXPECT_LT(TextLayoutCache::getEntryCount(), 1000u);
+
+  // the last one is still there
+  Size size;
+  EXPECT_TRUE(TextLayoutCache::find(font, L"Item 999", 100, 0, size));
+  EXPECT_EQ(Size(999, 10), size);
+
+  TextLayoutCache::setMemoryBudget(oldBudget);
+}
+
+TEST(TextLayoutCache, FindDoesNotCopyText)
+{
+  HFONT font = reinterpret_cast<HFONT>(1);
+  String text(L"A text which is too long for the small string buffer");
+  Size size;
+
+  TextLayoutCache::clear();
+  TextLayoutCache::insert(font, text, 100, 0, Size(200, 12));
+
+  size_t count = allocations;
+  EXPECT_TRUE(TextLayoutCache::find(font, text, 100, 0, size));
+  EXPECT_FALSE(TextLayoutCache::find(font, text, 50, 0, size));
+  EXPECT_EQ(count, allocations);
+  EXPECT_EQ(Size(200, 12), size);
+
+  // the cache keeps its own copy of the text
+  String copy = text;
+  text[0] = L'B';
+  EXPECT_FALSE(TextLayoutCache::find(font, text, 100, 0, size));
+  EXPECT_TRUE(TextLayoutCache::find(font, copy, 100, 0, size));
+}
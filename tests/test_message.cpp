@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "Vaca/Message.h"
+#include "Vaca/Thread.h"
+
+using namespace Vaca;
+
+static HWND hwnd_a = reinterpret_cast<HWND>(1);
+static HWND hwnd_b = reinterpret_cast<HWND>(2);
+
+static Message make_message(HWND hwnd, UINT type, WPARAM wParam, LPARAM lParam)
+{
+  Message message;
+  MSG* msg = message;
+  msg->hwnd = hwnd;
+  msg->message = type;
+  msg->wParam = wParam;
+  msg->lParam = lParam;
+  msg->time = 0;
+  return message;
+}
+
+TEST(Message, CoalesceMouseMove)
+{
+  Message move = make_message(hwnd_a, WM_MOUSEMOVE, 0, MAKELPARAM(10, 10));
+  EXPECT_TRUE(move.isCoalescible());
+
+  // the last position is kept
+  EXPECT_TRUE(move.coalesce(make_message(hwnd_a, WM_MOUSEMOVE, 0, MAKELPARAM(20, 30))));
+  EXPECT_EQ(MAKELPARAM(20, 30), static_cast<MSG*>(move)->lParam);
+
+  // other widget or other message
+  EXPECT_FALSE(move.coalesce(make_message(hwnd_b, WM_MOUSEMOVE, 0, 0)));
+  EXPECT_FALSE(move.coalesce(make_message(hwnd_a, WM_USER, 0, 0)));
+  EXPECT_EQ(MAKELPARAM(20, 30), static_cast<MSG*>(move)->lParam);
+
+  Message user = make_message(hwnd_a, WM_USER, 0, 0);
+  EXPECT_FALSE(user.isCoalescible());
+  EXPECT_FALSE(user.coalesce(make_message(hwnd_a, WM_USER, 0, 0)));
+}
+
+TEST(Message, CoalesceMouseWheel)
+{
+  Message wheel = make_message(hwnd_a, WM_MOUSEWHEEL, MAKEWPARAM(0, 120), 0);
+  EXPECT_TRUE(wheel.coalesce(make_message(hwnd_a, WM_MOUSEWHEEL, MAKEWPARAM(0, 240), 0)));
+  EXPECT_EQ(360, (short)HIWORD(static_cast<MSG*>(wheel)->wParam));
+
+  EXPECT_TRUE(wheel.coalesce(make_message(hwnd_a, WM_MOUSEWHEEL, MAKEWPARAM(0, -480), 0)));
+  EXPECT_EQ(-120, (short)HIWORD(static_cast<MSG*>(wheel)->wParam));
+}
+
+TEST(Message, CoalesceScroll)
+{
+  Message track = make_message(hwnd_a, WM_VSCROLL, MAKEWPARAM(SB_THUMBTRACK, 10), 0);
+  Message line = make_message(hwnd_a, WM_VSCROLL, MAKEWPARAM(SB_LINEDOWN, 0), 0);
+
+  EXPECT_TRUE(track.isCoalescible());
+  EXPECT_FALSE(line.isCoalescible());
+
+  EXPECT_TRUE(track.coalesce(make_message(hwnd_a, WM_VSCROLL, MAKEWPARAM(SB_THUMBTRACK, 50), 0)));
+  EXPECT_EQ(50, HIWORD(static_cast<MSG*>(track)->wParam));
+  EXPECT_FALSE(track.coalesce(line));
+}
+
+TEST(Message, CoalescibleCustomMessages)
+{
+  Message progress(L"Vaca.Test.Progress", true);
+  Message done(L"Vaca.Test.Done");
+
+  EXPECT_TRUE(progress.isCoalescible());
+  EXPECT_FALSE(done.isCoalescible());
+
+  // the same name is the same type of message
+  EXPECT_TRUE(Message(L"Vaca.Test.Progress").isCoalescible());
+
+  Message a(progress, reinterpret_cast<void*>(1));
+  Message b(progress, reinterpret_cast<void*>(2));
+  EXPECT_TRUE(a.coalesce(b));
+  EXPECT_EQ(reinterpret_cast<void*>(2), a.getPayload());
+  EXPECT_FALSE(a.coalesce(Message(done, NULL)));
+}
+
+TEST(Message, CoalesceInTheMessageLoop)
+{
+  ThreadId id = CurrentThread::getId();
+  Message progress(L"Vaca.Test.Progress", true);
+  UINT progressType = static_cast<MSG*>(progress)->message;
+
+  // create the message queue of this thread
+  MSG msg;
+  ::PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+
+  // the progress messages are merged, the second wheel rotation
+  // cannot be merged (it overflows) but it must not be lost
+  for (int i=1; i<=3; ++i)
+    ::PostThreadMessage(id, progressType, 0, i);
+  ::PostThreadMessage(id, WM_MOUSEWHEEL, MAKEWPARAM(0, 30000), 0);
+  ::PostThreadMessage(id, WM_MOUSEWHEEL, MAKEWPARAM(0, 30000), 0);
+  ::PostThreadMessage(id, WM_USER, 0, 0);
+
+  std::vector<MSG> received;
+  Message message;
+  while (CurrentThread::peekMessage(message))
+    received.push_back(*static_cast<MSG*>(message));
+
+  ASSERT_EQ(4, received.size());
+  EXPECT_EQ(progressType, received[0].message);
+  EXPECT_EQ(3, received[0].lParam);
+  EXPECT_EQ(WM_MOUSEWHEEL, received[1].message);
+  EXPECT_EQ(WM_MOUSEWHEEL, received[2].message);
+  EXPECT_EQ(30000, (short)HIWORD(received[2].wParam));
+  EXPECT_EQ(WM_USER, received[3].message);
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#include "Vaca/Bind.h"
+#include "Vaca/MessageQueue.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/Thread.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+static Message make_message(int producer, int value)
+{
+  Message message;
+  MSG* msg = message;
+  msg->hwnd = NULL;
+  msg->message = WM_USER;
+  msg->wParam = producer;
+  msg->lParam = value;
+  return message;
+}
+
+static int get_producer(const Message& message)
+{
+  return static_cast<const MSG*>(message)->wParam;
+}
+
+static int get_value(const Message& message)
+{
+  return static_cast<const MSG*>(message)->lParam;
+}
+
+TEST(MessageQueue, Order)
+{
+  MessageQueue queue;
+  Message message;
+
+  EXPECT_FALSE(queue.pop(message));
+
+  // only the first message of the batch wakes up the consumer
+  EXPECT_TRUE(queue.push(make_message(0, 1)));
+  EXPECT_FALSE(queue.push(make_message(0, 2)));
+  EXPECT_FALSE(queue.push(make_message(0, 3)));
+
+  for (int i=1; i<=3; ++i) {
+    ASSERT_TRUE(queue.front() != NULL);
+    EXPECT_EQ(i, get_value(*queue.front()));
+    ASSERT_TRUE(queue.pop(message));
+    EXPECT_EQ(i, get_value(message));
+  }
+  EXPECT_FALSE(queue.pop(message));
+  EXPECT_TRUE(queue.front() == NULL);
+
+  // the queue was found empty, so the next push signals again
+  EXPECT_TRUE(queue.push(make_message(0, 4)));
+  ASSERT_TRUE(queue.pop(message));
+  EXPECT_EQ(4, get_value(message));
+
+  // messages not taken are destroyed with the queue
+  queue.push(make_message(0, 5));
+}
+
+// ======================================================================
+// Producers
+
+static long wake_ups[4];
+
+static void produce(MessageQueue* queue, int producer, int count)
+{
+  for (int i=0; i<count; ++i)
+    if (queue->push(make_message(producer, i)))
+      ++wake_ups[producer];
+}
+
+// A queue with a mutex, to compare
+class LockedQueue
+{
+  Mutex m_mutex;
+  std::deque<Message> m_messages;
+public:
+  void push(const Message& message) {
+    ScopedLock hold(m_mutex);
+    m_messages.push_back(message);
+  }
+  bool pop(Message& message) {
+    ScopedLock hold(m_mutex);
+    if (m_messages.empty())
+      return false;
+    message = m_messages.front();
+    m_messages.pop_front();
+    return true;
+  }
+};
+
+static void produce_locked(LockedQueue* queue, int producer, int count)
+{
+  for (int i=0; i<count; ++i)
+    queue->push(make_message(producer, i));
+}
+
+TEST(MessageQueue, MultipleProducers)
+{
+  const int producers = 4;
+  const int count = 200000;
+
+  for (int mode=0; mode<2; ++mode) {
+    MessageQueue queue;
+    LockedQueue lockedQueue;
+    std::vector<Thread*> threads;
+    std::vector<int> next(producers, 0);
+
+    TimePoint start;
+    for (int p=0; p<producers; ++p) {
+      if (mode == 0)
+	threads.push_back(new Thread(Bind<void>(&produce, &queue, p, count)));
+      else
+	threads.push_back(new Thread(Bind<void>(&produce_locked, &lockedQueue, p, count)));
+    }
+
+    // consumer: the messages of each producer arrive in order
+    Message message;
+    for (int received=0; received<producers*count; ) {
+      if (mode == 0 ? queue.pop(message): lockedQueue.pop(message)) {
+	int p = get_producer(message);
+	ASSERT_EQ(next[p], get_value(message));
+	++next[p];
+	++received;
+      }
+      else
+	CurrentThread::yield();
+    }
+    double elapsed = start.elapsed();
+
+    for (int p=0; p<producers; ++p) {
+      threads[p]->join();
+      delete threads[p];
+    }
+
+    std::printf("%s: %.1f M messages/s",
+		mode == 0 ? "MessageQueue": "Mutex + std::deque",
+		producers*count / elapsed / 1e6);
+    if (mode == 0)
+      std::printf(" (%ld wake-ups)", wake_ups[0] + wake_ups[1] + wake_ups[2] + wake_ups[3]);
+    std::printf("\n");
+  }
+}
+
+// ======================================================================
+// Latency: ping-pong between two threads
+
+static void pong(MessageQueue* in, MessageQueue* out, int count)
+{
+  Message message;
+  for (int i=0; i<count; ) {
+    if (in->pop(message)) {
+      out->push(message);
+      ++i;
+    }
+    else
+      CurrentThread::yield();
+  }
+}
+
+TEST(MessageQueue, Latency)
+{
+  const int count = 20000;
+  MessageQueue ping, reply;
+  Thread thread(Bind<void>(&pong, &ping, &reply, count));
+
+  Message message;
+  TimePoint start;
+  for (int i=0; i<count; ++i) {
+    ping.push(make_message(0, i));
+    while (!reply.pop(message))
+      CurrentThread::yield();
+    ASSERT_EQ(i, get_value(message));
+  }
+  double elapsed = start.elapsed();
+  thread.join();
+
+  std::printf("round-trip: %.2f us\n", elapsed / count * 1e6);
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "Vaca/String.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+template<typename T>
+static String format(T value)
+{
+  Char buf[NumberBufferSize];
+  int len = format_number(value, buf, NumberBufferSize);
+  return String(buf, len);
+}
+
+template<typename T>
+static bool round_trip(T value)
+{
+  Char buf[NumberBufferSize];
+  int len = format_number(value, buf, NumberBufferSize);
+  T result;
+  if (parse_number(buf, buf+len, result) != buf+len)
+    return false;
+  return std::memcmp(&value, &result, sizeof(T)) == 0;
+}
+
+template<typename T>
+static T parse(const String& str, size_t expectedLength)
+{
+  T value = 0;
+  const Char* end = parse_number(str.c_str(), str.c_str()+str.size(), value);
+  EXPECT_EQ(expectedLength, end - str.c_str()) << str.c_str();
+  return value;
+}
+
+TEST(Number, FormatIntegers)
+{
+  EXPECT_EQ(L"0",		format(0));
+  EXPECT_EQ(L"7",		format(7));
+  EXPECT_EQ(L"-10",		format(-10));
+  EXPECT_EQ(L"99",		format(99));
+  EXPECT_EQ(L"100",		format(100));
+  EXPECT_EQ(L"-2147483648",	format(INT_MIN));
+  EXPECT_EQ(L"2147483647",	format(INT_MAX));
+  EXPECT_EQ(L"4294967295",	format(UINT_MAX));
+  EXPECT_EQ(convert_to<String>(LONG_MIN), format(LONG_MIN));
+  EXPECT_EQ(convert_to<String>(ULONG_MAX), format(ULONG_MAX));
+  EXPECT_EQ(L"-9223372036854775808",	format(LLONG_MIN));
+  EXPECT_EQ(L"18446744073709551615",	format(ULLONG_MAX));
+
+  // small buffers
+  Char buf[4];
+  EXPECT_EQ(3, format_number(123, buf, 4));
+  EXPECT_EQ(L'\0', buf[3]);
+  EXPECT_EQ(0, format_number(1234, buf, 4));
+}
+
+TEST(Number, ParseIntegers)
+{
+  EXPECT_EQ(0,		parse<int>(L"0", 1));
+  EXPECT_EQ(-42,	parse<int>(L"-42", 3));
+  EXPECT_EQ(42,		parse<int>(L"+42abc", 3));
+  EXPECT_EQ(INT_MAX,	parse<int>(L"2147483647", 10));
+  EXPECT_EQ(INT_MIN,	parse<int>(L"-2147483648", 11));
+  EXPECT_EQ(UINT_MAX,	parse<unsigned int>(L"4294967295", 10));
+
+  // saturation
+  EXPECT_EQ(INT_MAX,	parse<int>(L"2147483648", 10));
+  EXPECT_EQ(INT_MIN,	parse<int>(L"-99999999999999999999999", 24));
+  EXPECT_EQ(UINT_MAX,	parse<unsigned int>(L"4294967296", 10));
+
+  // no number (the value is not modified)
+  EXPECT_EQ(0,		parse<int>(L"", 0));
+  EXPECT_EQ(0,		parse<int>(L"-", 0));
+  EXPECT_EQ(0,		parse<int>(L" 1", 0));
+
+  // convert_to skips the whitespace
+  EXPECT_EQ(15,		convert_to<int>(String(L"  15")));
+  EXPECT_EQ(0,		convert_to<int>(String(L"abc")));
+}
+
+TEST(Number, FormatDoubles)
+{
+  EXPECT_EQ(L"0",			format(0.0));
+  EXPECT_EQ(L"-0",			format(-0.0));
+  EXPECT_EQ(L"1",			format(1.0));
+  EXPECT_EQ(L"0.1",			format(0.1));
+  EXPECT_EQ(L"0.30000000000000004",	format(0.1+0.2));
+  EXPECT_EQ(L"123456.789",		format(123456.789));
+  EXPECT_EQ(L"1500",			format(1500.0));
+  EXPECT_EQ(L"100000000000000000000",	format(1e20));
+  EXPECT_EQ(L"1e+21",			format(1e21));
+  EXPECT_EQ(L"0.000001",		format(1e-6));
+  EXPECT_EQ(L"1e-7",			format(1e-7));
+  EXPECT_EQ(L"-1.5e-7",			format(-1.5e-7));
+  EXPECT_EQ(L"5e-324",			format(4.9406564584124654e-324));
+  EXPECT_EQ(L"1.7976931348623157e+308",	format(std::numeric_limits<double>::max()));
+  EXPECT_EQ(L"inf",			format(std::numeric_limits<double>::infinity()));
+  EXPECT_EQ(L"-inf",			format(-std::numeric_limits<double>::infinity()));
+  EXPECT_EQ(L"nan",			format(std::numeric_limits<double>::quiet_NaN()));
+
+  EXPECT_EQ(L"0.1",			format(0.1f));
+  EXPECT_EQ(L"3.4028235e+38",		format(std::numeric_limits<float>::max()));
+  EXPECT_EQ(L"1e-45",			format(std::numeric_limits<float>::denorm_min()));
+}
+
+static String format(double value, Char type, int precision)
+{
+  Char buf[400];
+  int len = format_number(value, type, precision, buf, 400);
+  return String(buf, len);
+}
+
+TEST(Number, FormatPrecision)
+{
+  EXPECT_EQ(L"20.32",			format(20.3248, L'f', 2));
+  EXPECT_EQ(L"1.500000",		format(1.5, L'f', 6));
+  EXPECT_EQ(L"-2",			format(-1.5, L'f', 0));
+  EXPECT_EQ(L"2",			format(2.5, L'f', 0));	// ties to even
+  EXPECT_EQ(L"0.12",			format(0.125, L'f', 2));	// exact tie
+  EXPECT_EQ(L"0.13",			format(0.1251, L'f', 2));
+  EXPECT_EQ(L"0.01",			format(0.006, L'f', 2));
+  EXPECT_EQ(L"0.00",			format(0.0004, L'f', 2));
+  EXPECT_EQ(L"1000.0",			format(999.96, L'f', 1));
+  EXPECT_EQ(L"0.1000000000000000055511151231257827",
+	    format(0.1, L'f', 34));
+  EXPECT_EQ(L"1.5e+03",			format(1500.0, L'e', 1));
+  EXPECT_EQ(L"0.000e+00",		format(0.0, L'e', 3));
+  EXPECT_EQ(L"-1.00e-07",		format(-1e-7, L'e', 2));
+  EXPECT_EQ(L"1.797693e+308",		format(std::numeric_limits<double>::max(), L'e', 6));
+  EXPECT_EQ(L"4.9e-324",		format(4.9406564584124654e-324, L'e', 1));
+  EXPECT_EQ(L"inf",			format(std::numeric_limits<double>::infinity(), L'f', 2));
+  EXPECT_EQ(309+3, format(std::numeric_limits<double>::max(), L'f', 2).size());
+
+  // small buffers
+  Char buf[5];
+  EXPECT_EQ(4, format_number(1.25, L'f', 2, buf, 5));
+  EXPECT_EQ(L'\0', buf[4]);
+  EXPECT_EQ(0, format_number(10.25, L'f', 2, buf, 5));
+}
+
+TEST(Number, ParseDoubles)
+{
+  EXPECT_EQ(0.1,	parse<double>(L"0.1", 3));
+  EXPECT_EQ(0.1,	parse<double>(L".1", 2));
+  EXPECT_EQ(5.0,	parse<double>(L"5.", 2));
+  EXPECT_EQ(-2.5e10,	parse<double>(L"-25e+9", 6));
+  EXPECT_EQ(1.0,	parse<double>(L"1e", 1));
+  EXPECT_EQ(1.0,	parse<double>(L"1e+x", 1));
+  EXPECT_EQ(0.0,	parse<double>(L".", 0));
+  EXPECT_EQ(0.0,	parse<double>(L"1e-400", 6));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), parse<double>(L"1e400", 5));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), parse<double>(L"Infinity", 8));
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), parse<double>(L"-inf", 4));
+  EXPECT_EQ(4.9406564584124654e-324, parse<double>(L"5e-324", 6));
+
+  // more than 19 digits near to the halfway point between 1 and the
+  // next double (1 + 2^-53)
+  EXPECT_EQ(1.0,
+	    parse<double>(L"1.00000000000000011102230246251565404236316680908203125", 55));
+  EXPECT_EQ(1.0000000000000002,
+	    parse<double>(L"1.00000000000000011102230246251565404236316680908203126", 55));
+
+  // the decimal separator does not depend on the locale
+  EXPECT_EQ(1.5, convert_to<double>(String(L"1.5")));
+  EXPECT_EQ(1.0, convert_to<double>(String(L"1,5")));
+}
+
+TEST(Number, RoundTrip)
+{
+  // all the floats of [1, 2), and a sample of the rest
+  for (unsigned int bits=0; bits<0x7f800000; ) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(float));
+    ASSERT_TRUE(round_trip(value)) << bits;
+    ASSERT_TRUE(round_trip(-value)) << bits;
+
+    if ((bits >> 23) == 127)
+      ++bits;
+    else
+      bits += 4099;
+  }
+
+  // doubles with random bits
+  unsigned long long bits = 0x123456789abcdefULL;
+  for (int i=0; i<1000000; ++i) {
+    bits = bits*6364136223846793005ULL + 1442695040888963407ULL;
+
+    double value;
+    std::memcpy(&value, &bits, sizeof(double));
+    if (value == value && value - value == 0.0)	// finite
+      ASSERT_TRUE(round_trip(value)) << value;
+  }
+}
+
+TEST(Number, Time)
+{
+  const int n = 1000000;
+  Char buf[NumberBufferSize];
+  double sum = 0;
+
+  TimePoint start;
+  for (int i=0; i<n; ++i) {
+    int len = format_number(i * 1999, buf, NumberBufferSize);
+    int value;
+    parse_number(buf, buf+len, value);
+    sum += value;
+  }
+  double integers = start.elapsed();
+
+  start.reset();
+  for (int i=0; i<n; ++i) {
+    int len = format_number(i * 0.001234, buf, NumberBufferSize);
+    double value;
+    parse_number(buf, buf+len, value);
+    sum += value;
+  }
+  double doubles = start.elapsed();
+
+  start.reset();
+  for (int i=0; i<n; ++i) {
+    String str = format_string(L"%.16g", i * 0.001234);
+    sum += std::wcstod(str.c_str(), NULL);
+  }
+  double printf = start.elapsed();
+
+  std::printf("integers: %.0f ns per format+parse\n", integers * 1e9 / n);
+  std::printf("doubles: %.0f ns per format+parse\n", doubles * 1e9 / n);
+  std::printf("format_string+wcstod: %.0f ns\n", printf * 1e9 / n);
+  EXPECT_NE(0.0, sum);
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <cstdio>
+
+#include "Vaca/SharedMutex.h"
+#include "Vaca/ScopedSharedLock.h"
+#include "Vaca/Mutex.h"
+#include "Vaca/ScopedLock.h"
+#include "Vaca/Thread.h"
+#include "Vaca/TimePoint.h"
+#include "Vaca/Bind.h"
+
+using namespace std;
+using namespace Vaca;
+
+TEST(SharedMutex, TryLock)
+{
+  SharedMutex mutex;
+
+  EXPECT_TRUE(mutex.tryLockShared());
+  EXPECT_TRUE(mutex.tryLockShared());
+  EXPECT_FALSE(mutex.tryLock());
+  mutex.unlockShared();
+  mutex.unlockShared();
+
+  EXPECT_TRUE(mutex.tryLock());
+  EXPECT_FALSE(mutex.tryLockShared());
+  EXPECT_FALSE(mutex.tryLock());
+  mutex.unlock();
+
+  {
+    ScopedSharedLock hold(mutex);
+    EXPECT_FALSE(mutex.tryLock());
+  }
+  {
+    ScopedExclusiveLock hold(mutex);
+    EXPECT_FALSE(mutex.tryLockShared());
+  }
+  EXPECT_TRUE(mutex.tryLock());
+  mutex.unlock();
+}
+
+namespace exclusion {
+
+  // Writers keep "a" and "b" equal, readers check that they never see
+  // a half-written state.
+  SharedMutex mutex;
+  volatile int a = 0;
+  volatile int b = 0;
+  volatile int readers = 0;
+  volatile int maxReaders = 0;
+  volatile bool broken = false;
+  Mutex countMutex;
+
+  void reader()
+  {
+    for (int i=0; i<20000; ++i) {
+      ScopedSharedLock hold(mutex);
+      {
+	ScopedLock hold2(countMutex);
+	if (++readers > maxReaders)
+	  maxReaders = readers;
+      }
+      if (a != b)
+	broken = true;
+      if ((i % 64) == 0)
+	CurrentThread::yield();
+      {
+	ScopedLock hold2(countMutex);
+	--readers;
+      }
+    }
+  }
+
+  void writer()
+  {
+    for (int i=0; i<2000; ++i) {
+      ScopedExclusiveLock hold(mutex);
+      {
+	ScopedLock hold2(countMutex);
+	if (readers != 0)
+	  broken = true;
+      }
+      ++a;
+      CurrentThread::yield();
+      ++b;
+    }
+  }
+
+  TEST(SharedMutex, Exclusion)
+  {
+    vector<Thread*> threads;
+    for (int c=0; c<4; ++c) threads.push_back(new Thread(&reader));
+    for (int c=0; c<2; ++c) threads.push_back(new Thread(&writer));
+    for (size_t c=0; c<threads.size(); ++c) {
+      threads[c]->join();
+      delete threads[c];
+    }
+
+    EXPECT_FALSE(broken);
+    EXPECT_EQ(4000, a);
+    EXPECT_EQ(4000, b);
+    EXPECT_GT(maxReaders, 1);	// readers were together in the mutex
+  }
+
+}
+
+namespace preference {
+
+  // A continuous stream of readers must not starve a writer.
+  SharedMutex mutex;
+  volatile bool written = false;
+  volatile bool stop = false;
+
+  void reader()
+  {
+    while (!stop) {
+      ScopedSharedLock hold(mutex);
+      CurrentThread::yield();
+    }
+  }
+
+  TEST(SharedMutex, WritersAreNotStarved)
+  {
+    vector<Thread*> threads;
+    for (int c=0; c<4; ++c) threads.push_back(new Thread(&reader));
+    CurrentThread::sleep(10);
+
+    TimePoint t;
+    {
+      ScopedExclusiveLock hold(mutex);
+      written = true;
+    }
+    EXPECT_LT(t.elapsed(), 1.0);
+
+    stop = true;
+    for (size_t c=0; c<threads.size(); ++c) {
+      threads[c]->join();
+      delete threads[c];
+    }
+    EXPECT_TRUE(written);
+  }
+
+}
+
+namespace benchmark {
+
+  // Each thread does "iterations" lookups in a small table, a
+  // "readRatio" per thousand of them only read it.
+  const int iterations = 100000;
+  const int tableSize = 64;
+  int table[tableSize];
+  Mutex mutex;
+  SharedMutex sharedMutex;
+
+  void work_with_mutex(int readRatio, int seed)
+  {
+    unsigned int r = seed;
+    volatile int sum = 0;
+    for (int i=0; i<iterations; ++i) {
+      r = r*1103515245 + 12345;
+      ScopedLock hold(mutex);
+      if (int((r >> 16) % 1000) < readRatio) {
+	for (int j=0; j<tableSize; ++j)
+	  sum += table[j];
+      }
+      else
+	table[(r >> 8) % tableSize]++;
+    }
+  }
+
+  void work_with_shared_mutex(int readRatio, int seed)
+  {
+    unsigned int r = seed;
+    volatile int sum = 0;
+    for (int i=0; i<iterations; ++i) {
+      r = r*1103515245 + 12345;
+      if (int((r >> 16) % 1000) < readRatio) {
+	ScopedSharedLock hold(sharedMutex);
+	for (int j=0; j<tableSize; ++j)
+	  sum += table[j];
+      }
+      else {
+	ScopedExclusiveLock hold(sharedMutex);
+	table[(r >> 8) % tableSize]++;
+      }
+    }
+  }
+
+  template<typename F>
+  double run(F f, int threadCount, int readRatio)
+  {
+    vector<Thread*> threads;
+    TimePoint t;
+    for (int c=0; c<threadCount; ++c)
+      threads.push_back(new Thread(Bind<void>(f, readRatio, c+1)));
+    for (int c=0; c<threadCount; ++c) {
+      threads[c]->join();
+      delete threads[c];
+    }
+    return t.elapsed();
+  }
+
+  TEST(SharedMutex, Benchmark)
+  {
+    const int ratios[] = { 500, 900, 990 };
+    const int threadCounts[] = { 1, 2, 4, 8 };
+
+    std::printf("reads  threads  Mutex (ms)  SharedMutex (ms)\n");
+    for (int i=0; i<3; ++i) {
+      for (int j=0; j<4; ++j) {
+	double a = run(&work_with_mutex, threadCounts[j], ratios[i]);
+	double b = run(&work_with_shared_mutex, threadCounts[j], ratios[i]);
+	std::printf("%4.1f%%  %7d  %10.1f  %16.1f\n",
+		    ratios[i]/10.0, threadCounts[j], a*1000.0, b*1000.0);
+      }
+    }
+  }
+
+}
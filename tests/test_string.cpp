@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
+#include <cctype>
 #include <climits>
+#include <cstdio>
 
 #include "Vaca/String.h"
+#include "Vaca/TimePoint.h"
 
 using namespace Vaca;
 
@@ -151,6 +154,73 @@ TEST(String, TrimAlgorithm)
   EXPECT_EQ(L"No \n \r \ttrim", trim_string(L"\tNo \n \r \ttrim \n "));
 }
 
+TEST(String, TrimViewAndInPlace)
+{
+  String str(L" \t Text  with spaces \r\n");
+  StringView view = trim_view(str);
+  EXPECT_TRUE(view == L"Text  with spaces");
+  EXPECT_EQ(str.c_str() + 3, view.data());
+
+  trim_string_in_place(str);
+  EXPECT_EQ(L"Text  with spaces", str);
+
+  str = L"\v\f";
+  trim_string_in_place(str);
+  EXPECT_EQ(L"", str);
+
+  // whitespace runs longer than a SSE2 register, with other
+  // characters at every position
+  for (int i=0; i<40; ++i) {
+    for (int j=0; j<40; ++j) {
+      String a = String(i, L' ') + L"x" + String(j, L'\t');
+      String b = String(i, L'\n') + L"\x2009y\x00A0" + String(j, L'\r');
+      ASSERT_TRUE(trim_view(a) == L"x");
+      ASSERT_TRUE(trim_view(b) == L"\x2009y\x00A0");
+    }
+  }
+  EXPECT_TRUE(trim_view(String(100, L' ')).empty());
+}
+
+// The previous algorithm, it erases one character at a time
+static String erase_trim(const String& str)
+{
+  String res(str);
+  while (!res.empty() && std::isspace(res.at(0)))
+    res.erase(res.begin());
+  while (!res.empty() && std::isspace(res.at(res.size()-1)))
+    res.erase(res.end()-1);
+  return res;
+}
+
+TEST(String, TrimTime)
+{
+  // pathological inputs: long runs of whitespace
+  String lead = String(30000, L' ') + L"x";
+  String trail = L"x" + String(30000, L'\t');
+  String both = String(15000, L'\n') + L"x" + String(15000, L' ');
+  size_t sum = 0;
+
+  TimePoint start;
+  sum += erase_trim(lead).size() + erase_trim(trail).size() + erase_trim(both).size();
+  double erase = start.elapsed();
+
+  const int n = 1000;
+  start.reset();
+  for (int i=0; i<n; ++i)
+    sum += trim_string(lead).size() + trim_string(trail).size() + trim_string(both).size();
+  double copy = start.elapsed() / n;
+
+  start.reset();
+  for (int i=0; i<n; ++i)
+    sum += trim_view(lead).size() + trim_view(trail).size() + trim_view(both).size();
+  double view = start.elapsed() / n;
+
+  std::printf("previous trim_string: %.0f us\n", erase * 1e6);
+  std::printf("trim_string: %.1f us\n", copy * 1e6);
+  std::printf("trim_view: %.1f us\n", view * 1e6);
+  EXPECT_EQ(3u * (2*n+1), sum);
+}
+
 TEST(String, Format)
 {
   EXPECT_EQ(L"",	format_string(L""));
@@ -181,3 +251,26 @@ TEST(String, FormatOverflow)
     delete buf;
   }
 }
+
+TEST(String, Split)
+{
+  std::vector<String> parts;
+
+  split_string(L"a,b,,c", parts, L",");
+  ASSERT_EQ(4, parts.size());
+  EXPECT_EQ(L"a", parts[0]);
+  EXPECT_EQ(L"b", parts[1]);
+  EXPECT_EQ(L"",  parts[2]);
+  EXPECT_EQ(L"c", parts[3]);
+
+  // the previous content of parts is replaced
+  split_string(L"x y;z", parts, L" ;");
+  ASSERT_EQ(3, parts.size());
+  EXPECT_EQ(L"x", parts[0]);
+  EXPECT_EQ(L"y", parts[1]);
+  EXPECT_EQ(L"z", parts[2]);
+
+  split_string(L"", parts, L",");
+  ASSERT_EQ(1, parts.size());
+  EXPECT_EQ(L"", parts[0]);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "Vaca/String.h"
+#include "Vaca/StringTokenizer.h"
+#include "Vaca/StringView.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+TEST(StringView, Basic)
+{
+  String str = L"Hello World";
+  StringView view(str);
+
+  EXPECT_EQ(11, view.size());
+  EXPECT_EQ(str.c_str(), view.data());
+  EXPECT_EQ(L"World", view.substr(6).str());
+  EXPECT_EQ(L"Hello", view.substr(0, 5).str());
+  EXPECT_TRUE(view.substr(6) == L"World");
+  EXPECT_TRUE(view.startsWith(L"Hello"));
+  EXPECT_TRUE(view.endsWith(L"World"));
+  EXPECT_FALSE(view.endsWith(L"Hello"));
+
+  EXPECT_EQ(4, view.find(L'o'));
+  EXPECT_EQ(7, view.find(L'o', 5));
+  EXPECT_EQ(7, view.rfind(L'o'));
+  EXPECT_EQ(4, view.rfind(L'o', 6));
+  EXPECT_EQ(StringView::npos, view.find(L'x'));
+  EXPECT_EQ(6, view.find(StringView(L"Wor")));
+
+  StringView part = view;
+  part.removePrefix(6);
+  part.removeSuffix(2);
+  EXPECT_TRUE(part == L"Wor");
+
+  EXPECT_TRUE(StringView(L"abc") < StringView(L"abd"));
+  EXPECT_TRUE(StringView(L"ab") < StringView(L"abc"));
+  EXPECT_TRUE(StringView() == L"");
+}
+
+TEST(StringTokenizer, Tokens)
+{
+  String str = L"one,two;;three";
+  StringTokenizer tok(str, L",;");
+  StringView token;
+
+  ASSERT_TRUE(tok.next(token)); EXPECT_TRUE(token == L"one");
+  ASSERT_TRUE(tok.next(token)); EXPECT_TRUE(token == L"two");
+  ASSERT_TRUE(tok.next(token)); EXPECT_TRUE(token == L"");
+  ASSERT_TRUE(tok.next(token)); EXPECT_TRUE(token == L"three");
+  EXPECT_FALSE(tok.next(token));
+
+  // the tokens point to the original string
+  tok.reset();
+  ASSERT_TRUE(tok.next(token));
+  EXPECT_EQ(str.c_str(), token.data());
+}
+
+TEST(StringTokenizer, Separators)
+{
+  // separators outside the table of 256 characters
+  String str = L"a\x2022" L"b c";
+  std::vector<StringView> parts;
+  split_string(str, parts, StringView(L"\x2022 "));
+  ASSERT_EQ(3, parts.size());
+  EXPECT_TRUE(parts[0] == L"a");
+  EXPECT_TRUE(parts[1] == L"b");
+  EXPECT_TRUE(parts[2] == L"c");
+
+  // without separators
+  split_string(StringView(L"abc"), parts, StringView());
+  ASSERT_EQ(1, parts.size());
+  EXPECT_TRUE(parts[0] == L"abc");
+
+  // trailing separator
+  split_string(StringView(L"a,"), parts, StringView(L","));
+  ASSERT_EQ(2, parts.size());
+  EXPECT_TRUE(parts[1] == L"");
+}
+
+TEST(StringTokenizer, Time)
+{
+  // about 8 megabytes of CSV-like text
+  String csv;
+  while (csv.size() < (2 << 20))
+    csv += L"12345,John Smith,john@example.com,42.5\n";
+
+  std::vector<String> strings;
+  std::vector<StringView> views;
+  size_t count = 0;
+
+  TimePoint start;
+  StringTokenizer tok(csv, L",\n");
+  StringView token;
+  while (tok.next(token))
+    ++count;
+  double lazy = start.elapsed();
+
+  start.reset();
+  split_string(StringView(csv), views, StringView(L",\n"));
+  double viewParts = start.elapsed();
+
+  start.reset();
+  split_string(csv, strings, L",\n");
+  double stringParts = start.elapsed();
+
+  EXPECT_EQ(count, views.size());
+  EXPECT_EQ(count, strings.size());
+
+  double mb = csv.size() * sizeof(Char) / 1e6;
+  std::printf("StringTokenizer: %.0f MB/s\n", mb / lazy);
+  std::printf("split_string (views): %.0f MB/s\n", mb / viewParts);
+  std::printf("split_string (strings): %.0f MB/s\n", mb / stringParts);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Vaca/TextBuffer.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+static size_t model_line_from_offset(const String& text, size_t offset)
+{
+  return std::count(text.begin(), text.begin() + offset, L'\n');
+}
+
+static size_t model_offset_from_line(const String& text, size_t line)
+{
+  size_t offset = 0;
+  for (; line > 0; --line) {
+    offset = text.find(L'\n', offset);
+    if (offset == String::npos)
+      return text.size();
+    ++offset;
+  }
+  return offset;
+}
+
+TEST(TextBuffer, Basic)
+{
+  TextBuffer buf;
+  EXPECT_TRUE(buf.empty());
+  EXPECT_EQ(0, buf.size());
+  EXPECT_EQ(1, buf.getLineCount());
+  EXPECT_EQ(L"", buf.getText());
+
+  buf.insert(0, L"world");
+  buf.insert(0, L"Hello ");
+  buf.insert(11, L'!');
+  EXPECT_EQ(L"Hello world!", buf.getText());
+  EXPECT_EQ(L'w', buf.at(6));
+  EXPECT_EQ(L"world", buf.getText(6, 5));
+  EXPECT_EQ(L"!", buf.getText(11, 100));
+
+  buf.erase(5, 6);
+  EXPECT_EQ(L"Hello!", buf.getText());
+
+  buf.insert(5, L"\nsecond\r\nthird");
+  EXPECT_EQ(3, buf.getLineCount());
+  EXPECT_EQ(L"Hello", buf.getLine(0));
+  EXPECT_EQ(L"second\r", buf.getLine(1));
+  EXPECT_EQ(L"third!", buf.getLine(2));
+  EXPECT_EQ(0, buf.lineFromOffset(5));
+  EXPECT_EQ(1, buf.lineFromOffset(6));
+  EXPECT_EQ(6, buf.offsetFromLine(1));
+  EXPECT_EQ(buf.size(), buf.offsetFromLine(3));
+
+  buf.clear();
+  EXPECT_TRUE(buf.empty());
+}
+
+TEST(TextBuffer, Snapshots)
+{
+  TextBuffer buf(String(L"abc\ndef"));
+  TextBuffer snapshot(buf);
+
+  buf.insert(buf.size(), L"ghi");	// grows the last piece
+  buf.erase(0, 2);
+  EXPECT_EQ(L"c\ndefghi", buf.getText());
+  EXPECT_EQ(L"abc\ndef", snapshot.getText());
+
+  snapshot.insert(snapshot.size(), L"xyz");
+  EXPECT_EQ(L"abc\ndefxyz", snapshot.getText());
+  EXPECT_EQ(L"c\ndefghi", buf.getText());
+
+  buf = snapshot;
+  snapshot.clear();
+  EXPECT_EQ(L"abc\ndefxyz", buf.getText());
+  EXPECT_EQ(2, buf.getLineCount());
+}
+
+TEST(TextBuffer, RandomEdits)
+{
+  const Char* alphabet = L"ab\ncd\n\nef";
+  String model;
+  TextBuffer buf;
+  std::vector<std::pair<TextBuffer, String> > snapshots;
+
+  std::srand(1);
+  for (int i=0; i<5000; ++i) {
+    size_t offset = std::rand() % (model.size()+1);
+
+    if (std::rand() % 3 != 0 || model.empty()) {
+      String text;
+      int n = (std::rand() % 16 == 0 ? std::rand() % 10000: std::rand() % 5 + 1);
+      for (int j=0; j<n; ++j)
+	text.push_back(alphabet[std::rand() % 9]);
+
+      // consecutive typing
+      if (std::rand() % 2 == 0)
+	offset = model.size();
+
+      model.insert(offset, text);
+      buf.insert(offset, text);
+    }
+    else {
+      size_t count = std::rand() % 50;
+      model.erase(offset, count);
+      buf.erase(offset, count);
+    }
+
+    ASSERT_EQ(model.size(), buf.size());
+
+    if (i % 500 == 0) {
+      snapshots.push_back(std::make_pair(buf, model));
+      ASSERT_EQ(model, buf.getText());
+    }
+
+    offset = std::rand() % (model.size()+1);
+    size_t line = std::rand() % (buf.getLineCount()+1);
+    ASSERT_EQ(model_line_from_offset(model, offset), buf.lineFromOffset(offset));
+    ASSERT_EQ(model_offset_from_line(model, line), buf.offsetFromLine(line));
+    if (offset < model.size())
+      ASSERT_EQ(model[offset], buf.at(offset));
+  }
+
+  ASSERT_EQ(model, buf.getText());
+  EXPECT_EQ(model_line_from_offset(model, model.size())+1, buf.getLineCount());
+  for (size_t i=0; i<snapshots.size(); ++i)
+    ASSERT_EQ(snapshots[i].second, snapshots[i].first.getText());
+}
+
+TEST(TextBuffer, BigDocument)
+{
+  // a 100 MB document (with lines of 80 characters)
+  const size_t size = 100*1024*1024 / sizeof(Char);
+  String text(size, L'x');
+  for (size_t i=79; i<size; i+=80)
+    text[i] = L'\n';
+
+  TimePoint start;
+  TextBuffer buf(text);
+  double load = start.elapsed();
+
+  const int n = 100000;
+  std::srand(2);
+  start.reset();
+  for (int i=0; i<n; ++i)
+    buf.insert(std::rand() % buf.size(), L"text");
+  double insert = start.elapsed() / n;
+
+  start.reset();
+  for (int i=0; i<n; ++i)
+    buf.erase(std::rand() % buf.size(), 3);
+  double erase = start.elapsed() / n;
+
+  size_t sum = 0;
+  start.reset();
+  for (int i=0; i<n; ++i)
+    sum += buf.offsetFromLine(std::rand() % buf.getLineCount());
+  double line = start.elapsed() / n;
+
+  start.reset();
+  for (int i=0; i<n; ++i)
+    sum += buf.lineFromOffset(std::rand() % buf.size());
+  double offset = start.elapsed() / n;
+
+  start.reset();
+  TextBuffer snapshot(buf);
+  double copy = start.elapsed();
+
+  // the same insertions in a String
+  const int m = 20;
+  start.reset();
+  for (int i=0; i<m; ++i)
+    text.insert(std::rand() % text.size(), L"text");
+  double stringInsert = start.elapsed() / m;
+
+  std::printf("load: %.1f ms\n", load * 1e3);
+  std::printf("insert: %.2f us (String::insert: %.0f us)\n", insert * 1e6, stringInsert * 1e6);
+  std::printf("erase: %.2f us\n", erase * 1e6);
+  std::printf("offsetFromLine: %.2f us\n", line * 1e6);
+  std::printf("lineFromOffset: %.2f us\n", offset * 1e6);
+  std::printf("snapshot: %.2f us\n", copy * 1e6);
+
+  EXPECT_EQ(size + n, buf.size());
+  EXPECT_EQ(snapshot.getText(), buf.getText());
+  EXPECT_TRUE(sum > 0);
+}
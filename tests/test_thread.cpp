@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <vector>
+#include <algorithm>
 
 #include "Vaca/Thread.h"
 #include "Vaca/Mutex.h"
@@ -20,7 +21,7 @@ namespace test1 {
       ScopedLock hold(mutex);
       ++counter;
     }
-    ::Sleep(100);
+    CurrentThread::sleep(100);
   }
 
   TEST(Thread, Highload)
@@ -34,3 +35,35 @@ namespace test1 {
   }
 
 }
+
+namespace test2 {
+
+  Mutex mutex;
+  vector<ThreadId> ids;
+
+  void save_id()
+  {
+    ScopedLock hold(mutex);
+    ids.push_back(CurrentThread::getId());
+  }
+
+  TEST(Thread, Ids)
+  {
+    const int n = 10;
+    vector<Thread*> threads;
+    for (int c=0; c<n; c++) threads.push_back(new Thread(&save_id));
+    for (int c=0; c<n; c++) threads[c]->join();
+
+    Thread current;
+    EXPECT_EQ(CurrentThread::getId(), current.getId());
+    EXPECT_FALSE(current.isJoinable());
+
+    // each thread sees the same ID that Thread#getId returned
+    for (int c=0; c<n; c++) {
+      EXPECT_TRUE(threads[c]->getId() != current.getId());
+      EXPECT_EQ(1, count(ids.begin(), ids.end(), threads[c]->getId()));
+      delete threads[c];
+    }
+  }
+
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#include "Vaca/Bind.h"
+#include "Vaca/Thread.h"
+#include "Vaca/ThreadPool.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+static int answer()
+{
+  return 42;
+}
+
+static int square(int x)
+{
+  return x*x;
+}
+
+static void fill(std::vector<int>* values, int i)
+{
+  (*values)[i] = i;
+}
+
+static int fail()
+{
+  throw Exception(L"Task failed");
+}
+
+static int fail_std()
+{
+  throw std::runtime_error("Out of range");
+}
+
+TEST(ThreadPool, Submit)
+{
+  ThreadPool pool(4);
+  EXPECT_EQ(4, pool.getThreadCount());
+
+  Future<int> a = pool.submit<int>(&answer);
+  Future<int> b = pool.submit<int>(Bind<int>(&square, 9));
+  EXPECT_EQ(42, a.get());
+  EXPECT_EQ(81, b.get());
+  EXPECT_TRUE(a.isReady());
+
+  std::vector<int> values(10000, -1);
+  for (int i=0; i<(int)values.size(); ++i)
+    pool.submit<void>(Bind<void>(&fill, &values, i));
+  pool.waitForAll();
+
+  for (int i=0; i<(int)values.size(); ++i)
+    ASSERT_EQ(i, values[i]);
+}
+
+TEST(ThreadPool, Exception)
+{
+  ThreadPool pool(2);
+  Future<int> f = pool.submit<int>(&fail);
+
+  try {
+    f.get();
+    FAIL();
+  }
+  catch (TaskException& e) {
+    EXPECT_EQ(L"Task failed", e.getMessage());
+  }
+
+  // the message of a std::exception is kept too
+  Future<int> g = pool.submit<int>(&fail_std);
+  try {
+    g.get();
+    FAIL();
+  }
+  catch (TaskException& e) {
+    EXPECT_EQ(L"Out of range", e.getMessage());
+  }
+}
+
+// Tasks which submit other tasks and wait them (they are stolen by
+// other workers, or executed by the same worker while it waits)
+static ThreadPool* fib_pool;
+
+static int fib(int n)
+{
+  if (n < 2)
+    return n;
+  if (n < 12)
+    return fib(n-1) + fib(n-2);
+
+  Future<int> a = fib_pool->submit<int>(Bind<int>(&fib, n-1));
+  int b = fib(n-2);
+  return a.get() + b;
+}
+
+TEST(ThreadPool, NestedTasks)
+{
+  for (int threads=1; threads<=8; threads*=2) {
+    ThreadPool pool(threads);
+    fib_pool = &pool;
+    EXPECT_EQ(28657, pool.submit<int>(Bind<int>(&fib, 23)).get());
+  }
+}
+
+static int continuation_result = 0;
+static ThreadId continuation_thread = 0;
+
+static void on_result(Future<int> future)
+{
+  continuation_result = future.get();
+  continuation_thread = CurrentThread::getId();
+}
+
+TEST(ThreadPool, PostToUiThread)
+{
+  ThreadPool pool(2);
+  Future<int> f = pool.submit<int>(Bind<int>(&square, 12));
+  f.postToUiThread(&on_result);
+
+  while (continuation_result == 0) {
+    CurrentThread::pumpMessageQueue();
+    CurrentThread::sleep(1);
+  }
+  EXPECT_EQ(144, continuation_result);
+  EXPECT_EQ(CurrentThread::getId(), continuation_thread);
+
+  // a finished task posts the call right now
+  continuation_result = 0;
+  f.postToUiThread(&on_result);
+  CurrentThread::pumpMessageQueue();
+  EXPECT_EQ(144, continuation_result);
+}
+
+// A small job like hashing a block of a file
+static unsigned hash_block(unsigned seed)
+{
+  unsigned hash = seed;
+  for (int i=0; i<2000; ++i)
+    hash = hash*16777619u ^ i;
+  return hash;
+}
+
+static void hash_job(unsigned* result, unsigned seed)
+{
+  *result = hash_block(seed);
+}
+
+TEST(ThreadPool, Scaling)
+{
+  const int jobs = 20000;
+  std::vector<unsigned> results(jobs);
+
+  // a thread for each job
+  TimePoint start;
+  for (int i=0; i<jobs; ++i) {
+    Thread thread(Bind<void>(&hash_job, &results[i], i));
+    thread.join();
+  }
+  std::printf("Thread per job: %.1f ms\n", start.elapsed() * 1e3);
+
+  std::printf("%d processors\n", ThreadPool::getProcessorCount());
+  for (int threads=1; threads<=64; threads*=2) {
+    ThreadPool pool(threads);
+    std::vector<Future<unsigned> > futures;
+
+    start.reset();
+    for (int i=0; i<jobs; ++i)
+      futures.push_back(pool.submit<unsigned>(Bind<unsigned>(&hash_block, i)));
+    for (int i=0; i<jobs; ++i)
+      ASSERT_EQ(results[i], futures[i].get());
+
+    std::printf("ThreadPool(%d): %.1f ms\n", threads, start.elapsed() * 1e3);
+  }
+}
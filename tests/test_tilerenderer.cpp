@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#include "Vaca/TileRenderer.h"
+#include "Vaca/Image.h"
+#include "Vaca/Graphics.h"
+#include "Vaca/Color.h"
+#include "Vaca/Brush.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+#define EXPECT_PIXEL(pixels, x, y, r, g, b)			\
+  {								\
+    ImagePixels::pixel_type color = pixels.getPixel(x, y);	\
+    EXPECT_EQ(r, ImagePixels::getR(color));			\
+    EXPECT_EQ(g, ImagePixels::getG(color));			\
+    EXPECT_EQ(b, ImagePixels::getB(color));			\
+  }
+
+static void paint_chart(Graphics& g)
+{
+  // the painter receives image coordinates
+  g.fillRect(Brush(Color(0, 0, 255)), Rect(0, 0, 300, 200));
+
+  // skip the shapes outside the tile
+  Rect shape(100, 50, 100, 100);
+  if (g.getClipBounds().intersects(shape))
+    g.fillRect(Brush(Color(255, 0, 0)), shape);
+}
+
+TEST(TileRenderer, SingleThread)
+{
+  Image img(300, 200, 32);
+
+  TileRenderer renderer(Size(64, 64), 1);
+  renderer.Paint.connect(&paint_chart);
+  renderer.render(img);
+
+  ImagePixels pixels = img.getPixels();
+  EXPECT_PIXEL(pixels, 0, 0, 0, 0, 255);
+  EXPECT_PIXEL(pixels, 99, 50, 0, 0, 255);
+  EXPECT_PIXEL(pixels, 100, 50, 255, 0, 0);
+  EXPECT_PIXEL(pixels, 150, 100, 255, 0, 0);
+  EXPECT_PIXEL(pixels, 299, 199, 0, 0, 255);
+}
+
+TEST(TileRenderer, SameResultWithThreads)
+{
+  Image expected(300, 200, 32);
+  paint_chart(expected.getGraphics());
+
+  for (int threads=1; threads<=8; threads*=2) {
+    Image img(300, 200, 32);
+
+    TileRenderer renderer(Size(48, 32), threads);
+    renderer.Paint.connect(&paint_chart);
+    renderer.render(img);
+
+    ImagePixels a = expected.getPixels();
+    ImagePixels b = img.getPixels();
+    for (int y=0; y<200; ++y)
+      for (int x=0; x<300; ++x)
+	EXPECT_EQ(a.getPixel(x, y), b.getPixel(x, y));
+  }
+}
+
+TEST(TileRenderer, PartialArea)
+{
+  Image img(300, 200, 32);
+  img.getGraphics().fillRect(Brush(Color(0, 255, 0)), Rect(0, 0, 300, 200));
+
+  TileRenderer renderer(Size(64, 64), 4);
+  renderer.Paint.connect(&paint_chart);
+  renderer.render(img, Rect(100, 50, 100, 100));
+
+  // outside the rendered area the image keeps its old content
+  ImagePixels pixels = img.getPixels();
+  EXPECT_PIXEL(pixels, 0, 0, 0, 255, 0);
+  EXPECT_PIXEL(pixels, 120, 70, 255, 0, 0);
+  EXPECT_PIXEL(pixels, 299, 199, 0, 255, 0);
+}
+
+static void paint_and_fail(Graphics& g)
+{
+  if (g.getClipBounds().contains(Point(150, 100)))
+    throw std::runtime_error("painter failed");
+  paint_chart(g);
+}
+
+TEST(TileRenderer, PainterException)
+{
+  Image img(300, 200, 32);
+
+  for (int threads=1; threads<=4; threads*=2) {
+    TileRenderer renderer(Size(32, 32), threads);
+    renderer.Paint.connect(&paint_and_fail);
+    EXPECT_ANY_THROW(renderer.render(img));
+
+    // the renderer can be used again
+    renderer.Paint.disconnectAll();
+    renderer.Paint.connect(&paint_chart);
+    renderer.render(img);
+
+    ImagePixels pixels = img.getPixels();
+    EXPECT_PIXEL(pixels, 150, 100, 255, 0, 0);
+  }
+}
+
+// A chart of 8K x 8K pixels with 20000 shapes. Each tile paints only
+// the shapes that touch it.
+static std::vector<Rect> big_chart;
+
+static void paint_big_chart(Graphics& g)
+{
+  Rect bounds = g.getClipBounds();
+  Brush background(Color(255, 255, 255));
+  Brush red(Color(255, 0, 0));
+  Brush blue(Color(0, 0, 255));
+
+  g.fillRect(background, bounds);
+  for (size_t i=0; i<big_chart.size(); ++i)
+    if (bounds.intersects(big_chart[i]))
+      g.fillEllipse((i & 1) ? red: blue, big_chart[i]);
+}
+
+TEST(TileRenderer, Benchmark)
+{
+  const int size = 8192;
+  unsigned seed = 1;
+  for (int i=0; i<20000; ++i) {
+    seed = seed*1103515245 + 12345;
+    int x = (seed >> 8) % size;
+    seed = seed*1103515245 + 12345;
+    int y = (seed >> 8) % size;
+    int w = 8 + (seed >> 4) % 256;
+    big_chart.push_back(Rect(x, y, w, w));
+  }
+
+  Image img(size, size, 32);
+  int processors = TileRenderer::getProcessorCount();
+
+  std::printf("threads  time (ms)  speedup\n");
+  double single = 0.0;
+  for (int threads=1; ; threads*=2) {
+    threads = min_value(threads, processors);
+
+    TileRenderer renderer(Size(256, 256), threads);
+    renderer.Paint.connect(&paint_big_chart);
+
+    // the first render creates the threads of the pool
+    renderer.render(img, Rect(0, 0, 256, 256));
+
+    TimePoint t;
+    renderer.render(img);
+    double elapsed = t.elapsed();
+    if (threads == 1)
+      single = elapsed;
+
+    std::printf("%7d  %9.1f  %7.2f\n", threads, elapsed*1000.0, single / elapsed);
+
+    if (threads == processors)
+      break;
+  }
+
+  big_chart.clear();
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "Vaca/Application.h"
+#include "Vaca/Timer.h"
+#include "Vaca/Thread.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+class TimerTest : public testing::Test {
+  Application app;
+};
+
+class CountTimer : public Timer
+{
+public:
+  int count;
+  Nanoseconds lastTick;
+
+  CountTimer(int interval, TimerPolicy policy)
+    : Timer(interval), count(0), lastTick(0) {
+    setPolicy(policy);
+  }
+
+protected:
+  virtual void onTick() {
+    ++count;
+    lastTick = Clock::now();
+    Timer::onTick();
+  }
+};
+
+// processes the timers during "msecs" like a message loop
+static void poll_for(int msecs)
+{
+  TimePoint t;
+  while (t.elapsed() < msecs / 1000.0) {
+    Timer::pollTimers();
+    CurrentThread::sleep(1);
+  }
+}
+
+TEST_F(TimerTest, Policies)
+{
+  CountTimer fireAll(10, TimerPolicy::FireAll);
+  CountTimer coalesce(10, TimerPolicy::Coalesce);
+  CountTimer skipMissed(10, TimerPolicy::SkipMissed);
+
+  EXPECT_EQ(TimerPolicy::FireAll, Timer(10).getPolicy());
+  EXPECT_EQ(TimerPolicy::Coalesce, coalesce.getPolicy());
+
+  fireAll.start();
+  coalesce.start();
+  skipMissed.start();
+
+  // the thread is busy during ~10 ticks
+  CurrentThread::sleep(105);
+  Timer::pollTimers();
+
+  EXPECT_GE(fireAll.count, 9);
+  EXPECT_LE(fireAll.count, 11);
+  EXPECT_EQ(1, coalesce.count);
+  EXPECT_EQ(0, skipMissed.count);
+
+  TimerStats stats = coalesce.getStats();
+  EXPECT_EQ(1, stats.ticks);
+  EXPECT_EQ(1, stats.deliveries);
+  EXPECT_GE(stats.dropped, 8);
+  EXPECT_GE(stats.maxLag, 90000000LL);
+  EXPECT_EQ(stats.maxLag, stats.totalLag);
+
+  stats = skipMissed.getStats();
+  EXPECT_EQ(0, stats.ticks);
+  EXPECT_GE(stats.dropped, 9);
+
+  // now the thread processes the ticks on time, so all policies
+  // generate them
+  poll_for(100);
+
+  EXPECT_GE(coalesce.count, 1+5);
+  EXPECT_GE(skipMissed.count, 5);
+
+  skipMissed.resetStats();
+  EXPECT_EQ(0, skipMissed.getStats().ticks);
+  EXPECT_EQ(0, skipMissed.getStats().maxLag);
+}
+
+TEST_F(TimerTest, NoDrift)
+{
+  const int ticks = 50;
+  CountTimer timer(10, TimerPolicy::FireAll);
+
+  Nanoseconds start = Clock::now();
+  timer.start();
+  while (timer.count < ticks) {
+    Timer::pollTimers();
+    CurrentThread::sleep(1);
+  }
+
+  // the 50th tick is due at 500 ms from the start, the delay of the
+  // wake-ups must not accumulate
+  Nanoseconds error = timer.lastTick - start - ticks*10000000LL;
+  TimerStats stats = timer.getStats();
+
+  std::printf("tick %d: %.3f ms late, average lag %.3f ms, max lag %.3f ms\n",
+	      ticks, error / 1e6,
+	      stats.totalLag / 1e6 / stats.deliveries,
+	      stats.maxLag / 1e6);
+
+  EXPECT_GE(error, 0);
+  EXPECT_LT(error, 10000000LL);
+  EXPECT_EQ(0, stats.dropped);
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Vaca/Unicode.h"
+#include "Vaca/String.h"
+#include "Vaca/TimePoint.h"
+
+using namespace Vaca;
+
+// Reference encoder (one code point at a time)
+static std::string ref_utf8(unsigned int cp)
+{
+  std::string s;
+  if (cp < 0x80)
+    s += (char)cp;
+  else if (cp < 0x800) {
+    s += (char)(0xc0 | (cp >> 6));
+    s += (char)(0x80 | (cp & 0x3f));
+  }
+  else if (cp < 0x10000) {
+    s += (char)(0xe0 | (cp >> 12));
+    s += (char)(0x80 | ((cp >> 6) & 0x3f));
+    s += (char)(0x80 | (cp & 0x3f));
+  }
+  else {
+    s += (char)(0xf0 | (cp >> 18));
+    s += (char)(0x80 | ((cp >> 12) & 0x3f));
+    s += (char)(0x80 | ((cp >> 6) & 0x3f));
+    s += (char)(0x80 | (cp & 0x3f));
+  }
+  return s;
+}
+
+static String ref_wide(unsigned int cp)
+{
+  String s;
+  if (sizeof(Char) == 2 && cp >= 0x10000) {
+    s += (Char)(0xd800 + ((cp - 0x10000) >> 10));
+    s += (Char)(0xdc00 + ((cp - 0x10000) & 0x3ff));
+  }
+  else
+    s += (Char)cp;
+  return s;
+}
+
+static unsigned int random_codepoint()
+{
+  switch (std::rand() % 4) {
+    case 0: return std::rand() % 0x80;
+    case 1: return 0x80 + std::rand() % (0x800 - 0x80);
+    case 2: {
+      unsigned int cp = 0x800 + std::rand() % (0x10000 - 0x800);
+      return (cp >= 0xd800 && cp <= 0xdfff) ? 0xfffd: cp;
+    }
+    default: return 0x10000 + (((unsigned int)std::rand() << 8) ^ std::rand()) % 0x100000;
+  }
+}
+
+TEST(Unicode, Ascii)
+{
+  // different lengths to test the SIMD blocks and the tails
+  for (int len=0; len<70; ++len) {
+    std::string utf8;
+    String wide;
+    for (int i=0; i<len; ++i) {
+      utf8 += (char)(32 + (i*7) % 95);
+      wide += (Char)(32 + (i*7) % 95);
+    }
+    EXPECT_EQ(wide, from_utf8(utf8));
+    EXPECT_EQ(utf8, to_utf8(wide));
+    EXPECT_TRUE(is_valid_utf8(utf8.c_str(), utf8.size()));
+  }
+}
+
+TEST(Unicode, Multibyte)
+{
+  const char* utf8 = "a\xc3\xa1\xe2\x82\xac\xf0\x9f\x98\x80z";
+  String wide = L"a";
+  wide += ref_wide(0xe1);
+  wide += ref_wide(0x20ac);
+  wide += ref_wide(0x1f600);
+  wide += L"z";
+
+  EXPECT_EQ(wide, from_utf8(utf8));
+  EXPECT_EQ(utf8, to_utf8(wide));
+
+  // embedded null characters are preserved
+  std::string withNull("a\0b", 3);
+  EXPECT_EQ(3, from_utf8(withNull).size());
+  EXPECT_EQ(withNull, to_utf8(from_utf8(withNull)));
+}
+
+TEST(Unicode, InvalidSequences)
+{
+  String fffd = ref_wide(0xfffd);
+
+  struct { const char* utf8; int replacements; } tests[] = {
+    { "\x80", 1 },		// lonely continuation byte
+    { "\xc0\xaf", 2 },		// overlong (C0 is never valid)
+    { "\xe0\x80\xaf", 3 },	// overlong
+    { "\xed\xa0\x80", 3 },	// surrogate
+    { "\xf4\x90\x80\x80", 4 },	// beyond U+10FFFF
+    { "\xe2\x82", 1 },		// truncated (maximal subpart)
+    { "\xf0\x9f\x98", 1 },	// truncated (maximal subpart)
+    { "\xff", 1 },
+  };
+
+  for (size_t i=0; i<sizeof(tests)/sizeof(tests[0]); ++i) {
+    std::string utf8 = std::string("<") + tests[i].utf8 + ">";
+    String expected = L"<";
+    for (int j=0; j<tests[i].replacements; ++j)
+      expected += fffd;
+    expected += L">";
+
+    EXPECT_EQ(expected, from_utf8(utf8)) << "test " << i;
+    EXPECT_FALSE(is_valid_utf8(utf8.c_str(), utf8.size())) << "test " << i;
+  }
+
+  // unpaired surrogates (and out of range values) in wide strings
+  String wide = L"a";
+  wide += (Char)0xd800;
+  wide += L"b";
+  EXPECT_EQ("a\xef\xbf\xbd" "b", to_utf8(wide));
+}
+
+TEST(Unicode, Fuzz)
+{
+  std::srand(1234);
+
+  // round-trip of random valid text
+  for (int c=0; c<500; ++c) {
+    std::string utf8;
+    String wide;
+    int len = std::rand() % 100;
+    for (int i=0; i<len; ++i) {
+      unsigned int cp = random_codepoint();
+      utf8 += ref_utf8(cp);
+      wide += ref_wide(cp);
+    }
+    ASSERT_TRUE(is_valid_utf8(utf8.c_str(), utf8.size()));
+    ASSERT_EQ(wide, from_utf8(utf8));
+    ASSERT_EQ(utf8, to_utf8(wide));
+  }
+
+  // random bytes: the result must be always valid UTF-8 (and equal
+  // to the input when the input is valid)
+  for (int c=0; c<2000; ++c) {
+    std::string bytes;
+    int len = std::rand() % 40;
+    for (int i=0; i<len; ++i)
+      bytes += (char)(std::rand() % 3 == 0 ? std::rand() % 0x80: 0x80 + std::rand() % 0x80);
+
+    std::string result = to_utf8(from_utf8(bytes));
+    ASSERT_TRUE(is_valid_utf8(result.c_str(), result.size()));
+    if (is_valid_utf8(bytes.c_str(), bytes.size()))
+      ASSERT_EQ(bytes, result);
+  }
+}
+
+TEST(Unicode, Throughput)
+{
+  std::string ascii(16 << 20, 'a');
+  std::string mixed;
+  while (mixed.size() < ascii.size())
+    mixed += "Hello w\xc3\xb6rld, \xe4\xbd\xa0\xe5\xa5\xbd ";
+
+  const char* names[] = { "ascii", "mixed" };
+  const std::string* inputs[] = { &ascii, &mixed };
+  String wide;
+  std::string utf8;
+
+  for (int i=0; i<2; ++i) {
+    const std::string& input = *inputs[i];
+
+    TimePoint start;
+    for (int c=0; c<4; ++c)
+      utf8_to_wide(input.c_str(), input.size(), wide);
+    double decode = start.elapsed();
+
+    start.reset();
+    for (int c=0; c<4; ++c)
+      wide_to_utf8(wide.c_str(), wide.size(), utf8);
+    double encode = start.elapsed();
+
+    EXPECT_EQ(input, utf8);
+    std::printf("%s: utf8 -> wide %.2f GB/s, wide -> utf8 %.2f GB/s\n",
+		names[i],
+		4.0 * input.size() / decode / 1e9,
+		4.0 * input.size() / encode / 1e9);
+  }
+}